@@ -22,6 +22,11 @@ tfm_invalid_config(TFM_ISOLATION_LEVEL EQUAL 3 AND CONFIG_TFM_STACK_WATERMARKS)
 tfm_invalid_config(CONFIG_TFM_INCLUDE_STDLIBC AND CMAKE_C_COMPILER_ID STREQUAL Clang)
 
 tfm_invalid_config(CONFIG_TFM_LOG_SHARE_UART AND NOT SECURE_UART1)
+tfm_invalid_config(TFM_LOG_TOKENIZED AND NOT CMAKE_C_COMPILER_ID STREQUAL GNU)
+# The log buffer is drained by the idle partition, which is not built for SFN nor
+# for single-core TrustZone builds without FLIH or SLIH
+tfm_invalid_config(TFM_LOG_BUFFER_SIZE GREATER 0 AND NOT CONFIG_TFM_SPM_BACKEND_IPC)
+tfm_invalid_config(TFM_LOG_BUFFER_SIZE GREATER 0 AND TFM_LOAD_NS_IMAGE AND NOT (CONFIG_TFM_FLIH_API OR CONFIG_TFM_SLIH_API OR TFM_MULTI_CORE_TOPOLOGY))
 
 ########################## BL1 #################################################
 
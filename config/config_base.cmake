@@ -122,6 +122,7 @@ set(CONFIG_TFM_LOG_SHARE_UART           OFF         CACHE BOOL      "Allow TF-M
 ############################ Platform ##########################################
 
 set(NUM_MAILBOX_QUEUE_SLOT              1           CACHE BOOL      "Number of mailbox queue slots")
+set(MAILBOX_RING_PROTOCOL               OFF         CACHE BOOL      "Whether the mailbox passes requests and replies through rings instead of status bitmasks. Exported to the NS image in tfm_mailbox_config.h")
 set(TFM_PLAT_SPECIFIC_MULTI_CORE_COMM   OFF         CACHE BOOL      "Whether to use a platform specific inter-core communication instead of mailbox in dual-cpu topology")
 set(TFM_HYBRID_PLATFORM_API_BROKER      OFF         CACHE BOOL      "Use a API broker for API calls for Hybrid Platforms")
 
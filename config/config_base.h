@@ -43,11 +43,41 @@
 #define CRYPTO_ENGINE_BUF_SIZE                 0x3000
 #endif
 
-/* The max number of concurrent operations that can be active (allocated) at any time in Crypto */
+/* The max number of concurrent operations that a single client can have active (allocated) at any time in Crypto */
 #ifndef CRYPTO_CONC_OPER_NUM
 #define CRYPTO_CONC_OPER_NUM                   8
 #endif
 
+/* The number of concurrent hash operations that can be active at any time in Crypto */
+#ifndef CRYPTO_HASH_OPER_NUM
+#define CRYPTO_HASH_OPER_NUM                   4
+#endif
+
+/* The number of concurrent MAC operations that can be active at any time in Crypto */
+#ifndef CRYPTO_MAC_OPER_NUM
+#define CRYPTO_MAC_OPER_NUM                    2
+#endif
+
+/* The number of concurrent cipher operations that can be active at any time in Crypto */
+#ifndef CRYPTO_CIPHER_OPER_NUM
+#define CRYPTO_CIPHER_OPER_NUM                 2
+#endif
+
+/* The number of concurrent AEAD operations that can be active at any time in Crypto */
+#ifndef CRYPTO_AEAD_OPER_NUM
+#define CRYPTO_AEAD_OPER_NUM                   2
+#endif
+
+/* The number of concurrent key derivation operations that can be active at any time in Crypto */
+#ifndef CRYPTO_KEY_DERIVATION_OPER_NUM
+#define CRYPTO_KEY_DERIVATION_OPER_NUM         1
+#endif
+
+/* The number of concurrent PAKE operations that can be active at any time in Crypto */
+#ifndef CRYPTO_PAKE_OPER_NUM
+#define CRYPTO_PAKE_OPER_NUM                   1
+#endif
+
 /* Enable PSA Crypto random number generator module */
 #ifndef CRYPTO_RNG_MODULE_ENABLED
 #define CRYPTO_RNG_MODULE_ENABLED              1
@@ -93,6 +123,11 @@
 #define CRYPTO_KEY_DERIVATION_MODULE_ENABLED   1
 #endif
 
+/* Enable the Crypto batch module, running several single-part operations in one call */
+#ifndef CRYPTO_BATCH_MODULE_ENABLED
+#define CRYPTO_BATCH_MODULE_ENABLED            1
+#endif
+
 /* Default size of the internal scratch buffer used for PSA FF IOVec allocations */
 #ifndef CRYPTO_IOVEC_BUFFER_SIZE
 #define CRYPTO_IOVEC_BUFFER_SIZE               5120
@@ -133,6 +168,11 @@
 #define TFM_FWU_BUF_SIZE                       PSA_FWU_MAX_WRITE_SIZE
 #endif
 
+/* Hash the image while it is written instead of reading it back from flash */
+#ifndef TFM_FWU_STREAMING_HASH
+#define TFM_FWU_STREAMING_HASH                 1
+#endif
+
 /* The stack size of the Firmware Update Secure Partition */
 #ifndef FWU_STACK_SIZE
 #define FWU_STACK_SIZE                         0x600
@@ -179,6 +219,31 @@
 #define ITS_VALIDATE_METADATA_FROM_FLASH       1
 #endif
 
+/* Keep an in-RAM index of the file metadata table to avoid flash scans */
+#ifndef ITS_RAM_FILE_INDEX
+#define ITS_RAM_FILE_INDEX                     0
+#endif
+
+/* The maximum number of file metadata slots covered by the RAM file index */
+#ifndef ITS_RAM_FILE_INDEX_MAX_FILES
+#define ITS_RAM_FILE_INDEX_MAX_FILES           64
+#endif
+
+/* Store small files as logs of records updated in place */
+#ifndef ITS_LOG_MODE
+#define ITS_LOG_MODE                           0
+#endif
+
+/* The maximum size of a file stored as a log of records */
+#ifndef ITS_LOG_MAX_RECORD_SIZE
+#define ITS_LOG_MAX_RECORD_SIZE                32
+#endif
+
+/* The number of record slots allocated to a log file */
+#ifndef ITS_LOG_NUM_RECORDS
+#define ITS_LOG_NUM_RECORDS                    8
+#endif
+
 /* The maximum asset size to be stored in the Internal Trusted Storage */
 #ifndef ITS_MAX_ASSET_SIZE
 #define ITS_MAX_ASSET_SIZE                     512
@@ -249,6 +314,36 @@
 #define PS_NUM_ASSETS                          10
 #endif
 
+/* Index the Protected Storage object table by UID and client ID in RAM */
+#ifndef PS_OBJ_TABLE_INDEX
+#define PS_OBJ_TABLE_INDEX                     0
+#endif
+
+/* Commit Protected Storage object table updates as journaled deltas */
+#ifndef PS_OBJ_TABLE_JOURNAL
+#define PS_OBJ_TABLE_JOURNAL                   0
+#endif
+
+/* The number of journaled deltas between two full object table checkpoints */
+#ifndef PS_OBJ_TABLE_JOURNAL_MAX_DELTAS
+#define PS_OBJ_TABLE_JOURNAL_MAX_DELTAS        8
+#endif
+
+/* Encrypt Protected Storage objects in chunks with their own nonce and tag */
+#ifndef PS_AEAD_CHUNKED
+#define PS_AEAD_CHUNKED                        0
+#endif
+
+/* The size of an encrypted chunk of Protected Storage object data */
+#ifndef PS_AEAD_CHUNK_SIZE
+#define PS_AEAD_CHUNK_SIZE                     256
+#endif
+
+/* The number of derived Protected Storage keys kept for reuse, 0 to disable */
+#ifndef PS_CRYPTO_KEY_CACHE_SIZE
+#define PS_CRYPTO_KEY_CACHE_SIZE               0
+#endif
+
 /* The stack size of the Protected Storage Secure Partition */
 #ifndef PS_STACK_SIZE
 #define PS_STACK_SIZE                          0x700
@@ -301,11 +396,31 @@
 #endif
 #endif
 
+/* Track connection pool chunks in a per-chunk header list */
+#ifndef CONFIG_TFM_CONN_POOL_BITMAP
+#define CONFIG_TFM_CONN_POOL_BITMAP             0
+#endif
+
 /* Disable the doorbell APIs */
 #ifndef CONFIG_TFM_DOORBELL_API
 #define CONFIG_TFM_DOORBELL_API                 0
 #endif
 
+/* Select the next thread by walking the priority-sorted thread list */
+#ifndef CONFIG_TFM_SPM_SCHED_READY_BITMAP
+#define CONFIG_TFM_SPM_SCHED_READY_BITMAP       0
+#endif
+
+/* The maximal number of threads tracked by the scheduler ready bitmap */
+#ifndef CONFIG_TFM_SPM_THREAD_MAX_NUM
+#define CONFIG_TFM_SPM_THREAD_MAX_NUM           32
+#endif
+
+/* Hand psa_read()/psa_write() copies of at least this many bytes to the platform copy engine, 0 to disable */
+#ifndef CONFIG_TFM_SPM_COPY_ENGINE_THRESHOLD
+#define CONFIG_TFM_SPM_COPY_ENGINE_THRESHOLD    0
+#endif
+
 /*
  * Scheduling type for Hybrid Platforms (Currently in Experimental Stage)
  * Options can be found in spm/include/tfm_hybrid_platform.h
@@ -41,7 +41,7 @@
 #define CRYPTO_ENGINE_BUF_SIZE                 0x2080
 #endif
 
-/* The max number of concurrent operations that can be active (allocated) at any time in Crypto */
+/* The max number of concurrent operations that a single client can have active (allocated) at any time in Crypto */
 #ifndef CRYPTO_CONC_OPER_NUM
 #define CRYPTO_CONC_OPER_NUM                   8
 #endif
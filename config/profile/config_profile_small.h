@@ -41,11 +41,26 @@
 #define CRYPTO_ENGINE_BUF_SIZE                 0x400
 #endif
 
-/* The max number of concurrent operations that can be active (allocated) at any time in Crypto */
+/* The max number of concurrent operations that a single client can have active (allocated) at any time in Crypto */
 #ifndef CRYPTO_CONC_OPER_NUM
 #define CRYPTO_CONC_OPER_NUM                   4
 #endif
 
+/* The number of concurrent hash operations that can be active at any time in Crypto */
+#ifndef CRYPTO_HASH_OPER_NUM
+#define CRYPTO_HASH_OPER_NUM                   2
+#endif
+
+/* The number of concurrent MAC operations that can be active at any time in Crypto */
+#ifndef CRYPTO_MAC_OPER_NUM
+#define CRYPTO_MAC_OPER_NUM                    1
+#endif
+
+/* The number of concurrent AEAD operations that can be active at any time in Crypto */
+#ifndef CRYPTO_AEAD_OPER_NUM
+#define CRYPTO_AEAD_OPER_NUM                   1
+#endif
+
 /* Enable PSA Crypto random number generator module */
 #ifndef CRYPTO_RNG_MODULE_ENABLED
 #define CRYPTO_RNG_MODULE_ENABLED              1
@@ -8,6 +8,18 @@
 set(TFM_SPM_LOG_LEVEL           LOG_LEVEL_NONE   CACHE STRING    "Set default SPM log level as INFO level")
 set(TFM_PARTITION_LOG_LEVEL     LOG_LEVEL_NONE   CACHE STRING    "Set default Secure Partition log level as INFO level")
 
+# Buffer secure log output in RAM and write it out from low priority contexts.
+# 0 writes every message straight to the UART. The buffer is drained by the idle
+# partition, so it needs a build which has one (see check_config.cmake).
+set(TFM_LOG_BUFFER_SIZE         0                CACHE STRING    "Size in bytes of the secure log ring buffer, 0 to disable buffering")
+set(TFM_LOG_BUFFER_OVERFLOW     FLUSH            CACHE STRING    "What to do when a message does not fit in the log buffer [FLUSH, DROP_NEW, DROP_OLD]")
+set_property(CACHE TFM_LOG_BUFFER_OVERFLOW PROPERTY STRINGS "FLUSH;DROP_NEW;DROP_OLD")
+set(TFM_LOG_BUFFER_DROP_COUNTER ON               CACHE BOOL      "Count and report log messages discarded by the log buffer")
+
+# Log a token and the raw arguments instead of formatted text. The text is
+# rebuilt on the host with tools/tfm_log_decode.py.
+set(TFM_LOG_TOKENIZED           OFF              CACHE BOOL      "Emit tokenized binary records for secure log messages")
+
 # Secure regression tests also require SP log function
 # Enable SP log raw dump when SP log level is higher than silence or TF-M
 # regression test is enabled.
@@ -165,6 +165,53 @@ struct mailbox_init_t {
     struct mailbox_slot_t *slots;
 };
 
+/*
+ * Number of entries in a mailbox ring. It must be a power of 2 and not less
+ * than the number of slots. A slot is in at most one ring at a time, so a ring
+ * can never overflow.
+ */
+#define MAILBOX_RING_SIZE                   32
+
+/*
+ * Single-producer/single-consumer ring of slot indices, used by the mailbox
+ * ring protocol instead of the status bitmasks.
+ * head is only written by the producer and tail is only written by the
+ * consumer, so no critical section between cores is needed. Both are free
+ * running and wrap around at UINT32_MAX.
+ * This structure is an ABI between SPE and NSPE mailbox instances.
+ */
+struct mailbox_ring_t {
+    uint32_t head                       MAILBOX_ALIGN;
+    uint32_t tail                       MAILBOX_ALIGN;
+    uint8_t  entries[MAILBOX_RING_SIZE] MAILBOX_ALIGN;
+} MAILBOX_ALIGN;
+
+/* Rings shared between TF-M and mailbox client */
+struct mailbox_rings_t {
+    struct mailbox_ring_t req;          /* Slots pending for SPE handling,
+                                         * produced by NSPE
+                                         */
+    struct mailbox_ring_t comp;         /* Slots containing PSA client call
+                                         * return result, produced by SPE
+                                         */
+};
+
+/*
+ * Data used to send information to mailbox partition about mailbox queue
+ * allocated by non-secure image, when the ring protocol is used. It's expected
+ * that data in this structure is not modified by the secure side.
+ */
+struct mailbox_init_v2_t {
+    /* Shared rings with fixed size */
+    struct mailbox_rings_t *rings MAILBOX_ALIGN;
+
+    /* Number of slots allocated by NS. */
+    uint32_t slot_count;
+
+    /* Pointer to struct mailbox_slot_t[slot_count] allocated by NS */
+    struct mailbox_slot_t *slots;
+};
+
 #ifdef __cplusplus
 }
 #endif
@@ -60,6 +60,9 @@ struct ns_mailbox_slot_t {
 struct ns_mailbox_queue_t {
     struct mailbox_status_t status MAILBOX_ALIGN;
     struct mailbox_slot_t slots[NUM_MAILBOX_QUEUE_SLOT];
+#if MAILBOX_RING_PROTOCOL
+    struct mailbox_rings_t rings MAILBOX_ALIGN;
+#endif
 
     /* Following data are not shared with secure */
     struct ns_mailbox_slot_t slots_ns[NUM_MAILBOX_QUEUE_SLOT] MAILBOX_ALIGN;
@@ -79,6 +82,13 @@ struct ns_mailbox_queue_t {
                                                  */
 #endif
 
+#if MAILBOX_RING_PROTOCOL
+    mailbox_queue_status_t   replied_slots;     /* Bitmask of slots taken out
+                                                 * of the completion ring and
+                                                 * not collected yet
+                                                 */
+#endif
+
     bool                     is_full;           /* Queue if full */
 };
 
@@ -372,6 +382,65 @@ static inline void clear_queue_slot_empty(struct ns_mailbox_queue_t *queue_ptr,
     }
 }
 
+#if MAILBOX_RING_PROTOCOL
+/*
+ * Pushes a slot to the request ring. The request ring has a single producer,
+ * so concurrent NS callers must be serialized by the local spinlock.
+ */
+static inline void set_queue_slot_pend(struct ns_mailbox_queue_t *queue_ptr,
+                                       uint8_t idx)
+{
+    struct mailbox_ring_t *req = &queue_ptr->rings.req;
+    uint32_t head = req->head;
+
+    if (idx < NUM_MAILBOX_QUEUE_SLOT) {
+        req->entries[head & (MAILBOX_RING_SIZE - 1)] = idx;
+        /*
+         * The entry must be visible before the new head. Cache maintenance
+         * does not order the stores, so a barrier is required as well.
+         */
+        MAILBOX_CLEAN_CACHE(req->entries, sizeof(req->entries));
+        __DMB();
+        req->head = head + 1;
+        MAILBOX_CLEAN_CACHE(&req->head, sizeof(req->head));
+    }
+}
+
+/* Takes all the replied slots out of the completion ring */
+static inline mailbox_queue_status_t clear_queue_slot_all_replied(
+                                           struct ns_mailbox_queue_t *queue_ptr)
+{
+    struct mailbox_ring_t *comp = &queue_ptr->rings.comp;
+    mailbox_queue_status_t status = 0;
+    uint32_t head, tail = comp->tail;
+    uint8_t idx;
+
+    MAILBOX_INVALIDATE_CACHE(&comp->head, sizeof(comp->head));
+    head = comp->head;
+
+    if (head == tail) {
+        return 0;
+    }
+
+    /* The entries must be read after the head */
+    __DMB();
+    MAILBOX_INVALIDATE_CACHE(comp->entries, sizeof(comp->entries));
+
+    for (; tail != head; tail++) {
+        idx = comp->entries[tail & (MAILBOX_RING_SIZE - 1)];
+        if (idx < NUM_MAILBOX_QUEUE_SLOT) {
+            status |= (1UL << idx);
+        }
+    }
+
+    /* The entries must be read before SPE is allowed to reuse them */
+    __DMB();
+    comp->tail = tail;
+    MAILBOX_CLEAN_CACHE(&comp->tail, sizeof(comp->tail));
+
+    return status;
+}
+#else /* MAILBOX_RING_PROTOCOL */
 static inline void set_queue_slot_pend(struct ns_mailbox_queue_t *queue_ptr,
                                        uint8_t idx)
 {
@@ -397,6 +466,7 @@ static inline mailbox_queue_status_t clear_queue_slot_all_replied(
                         sizeof(queue_ptr->status));
     return status;
 }
+#endif /* MAILBOX_RING_PROTOCOL */
 
 /**
  * \brief Set the NS mailbox queue in the respective mailbox implementation.
@@ -65,8 +65,8 @@ struct tfm_crypto_pack_iovec {
 
 /**
  * \brief Type associated to the group of a function encoding. There can be
- *        nine groups (Random, Key management, Hash, MAC, Cipher, AEAD,
- *        Asym sign, Asym encrypt, Key derivation).
+ *        twelve groups (Random, Key management, Hash, MAC, Cipher, AEAD,
+ *        Asym sign, Asym encrypt, Key derivation, PAKE, Key wrapping, Batch).
  */
 enum tfm_crypto_group_id_t {
     TFM_CRYPTO_GROUP_ID_RANDOM          = UINT8_C(1),
@@ -79,7 +79,8 @@ enum tfm_crypto_group_id_t {
     TFM_CRYPTO_GROUP_ID_ASYM_ENCRYPT    = UINT8_C(8),
     TFM_CRYPTO_GROUP_ID_KEY_DERIVATION  = UINT8_C(9),
     TFM_CRYPTO_GROUP_ID_PAKE            = UINT8_C(10),
-    TFM_CRYPTO_GROUP_ID_KEY_WRAPPING    = UINT8_C(11)
+    TFM_CRYPTO_GROUP_ID_KEY_WRAPPING    = UINT8_C(11),
+    TFM_CRYPTO_GROUP_ID_BATCH           = UINT8_C(12)
 };
 
 /* Set of X macros describing each of the available PSA Crypto APIs */
@@ -183,6 +184,9 @@ enum tfm_crypto_group_id_t {
     X(TFM_CRYPTO_KEY_WRAPPING_WRAP)                 \
     X(TFM_CRYPTO_KEY_WRAPPING_UNWRAP)
 
+#define BATCH_FUNCS                                 \
+    X(TFM_CRYPTO_BATCH)
+
 #define BASE__VALUE(x) ((uint16_t)((((uint16_t)(x)) << 8) & 0xFF00))
 
 /**
@@ -221,6 +225,8 @@ enum tfm_crypto_func_sid_t {
     PAKE_FUNCS
     BASE__KEY_WRAPPING   = BASE__VALUE(TFM_CRYPTO_GROUP_ID_KEY_WRAPPING) - 1,
     KEY_WRAPPING_FUNCS
+    BASE__BATCH          = BASE__VALUE(TFM_CRYPTO_GROUP_ID_BATCH) - 1,
+    BATCH_FUNCS
 #undef X
 };
 
@@ -231,6 +237,64 @@ enum tfm_crypto_func_sid_t {
 #define TFM_CRYPTO_GET_GROUP_ID(_function_id) \
     ((enum tfm_crypto_group_id_t)(((uint16_t)(_function_id) >> 8) & 0xFF))
 
+/**
+ * \brief The maximum number of input buffers of an item of a batch request
+ */
+#define TFM_CRYPTO_BATCH_MAX_INPUTS (2u)
+
+/**
+ * \brief Location of a buffer of a batch request item, as an offset and a
+ *        length in the input (or output) buffer shared by all the items
+ */
+struct tfm_crypto_batch_slice {
+    uint32_t offset; /*!< Offset of the buffer in the shared buffer */
+    uint32_t len;    /*!< Length of the buffer in bytes */
+};
+
+/**
+ * \brief Describes one operation of a batch request. The \a iov is filled as
+ *        the single-part API would fill it, i.e. with one of the hash, MAC,
+ *        cipher or AEAD single-part function SIDs and its parameters. The
+ *        \a in slices map, in order, to the inputs of that function.
+ */
+struct tfm_crypto_batch_item {
+    struct tfm_crypto_pack_iovec iov;       /*!< Function and its parameters */
+    struct tfm_crypto_batch_slice in[TFM_CRYPTO_BATCH_MAX_INPUTS]; /*!< Inputs */
+    struct tfm_crypto_batch_slice out;      /*!< Output, if any */
+};
+
+/**
+ * \brief Outcome of one operation of a batch request
+ */
+struct tfm_crypto_batch_result {
+    psa_status_t status; /*!< Status returned by the operation */
+    uint32_t out_len;    /*!< Number of bytes written in the output slice */
+};
+
+/**
+ * \brief Runs a batch of independent single-part hash, MAC, cipher and AEAD
+ *        operations in a single call to the Crypto service. The operations are
+ *        run in order and a failing operation does not stop the batch.
+ *
+ * \param[in]  items         Array of operations to run
+ * \param[in]  item_count    Number of elements in \a items and \a results
+ * \param[in]  input         Buffer holding the inputs of all the operations
+ * \param[in]  input_length  Size in bytes of \a input
+ * \param[out] results       Status and output length of each operation
+ * \param[out] output        Buffer receiving the outputs of all the operations
+ * \param[in]  output_size   Size in bytes of \a output
+ *
+ * \return PSA_SUCCESS if the batch was run, in which case the status of each
+ *         operation is in \a results, or an error if the batch is malformed
+ */
+psa_status_t tfm_crypto_batch(const struct tfm_crypto_batch_item *items,
+                              size_t item_count,
+                              const uint8_t *input,
+                              size_t input_length,
+                              struct tfm_crypto_batch_result *results,
+                              uint8_t *output,
+                              size_t output_size);
+
 #ifdef __cplusplus
 }
 #endif
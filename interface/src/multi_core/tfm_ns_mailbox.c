@@ -50,6 +50,25 @@ static inline void clear_queue_slot_woken(uint8_t idx)
 }
 
 #ifndef TFM_MULTI_CORE_NS_OS
+#if MAILBOX_RING_PROTOCOL
+static inline void clear_queue_slot_replied(uint8_t idx)
+{
+    if (idx < NUM_MAILBOX_QUEUE_SLOT) {
+        mailbox_queue_ptr->replied_slots &= ~(1UL << idx);
+    }
+}
+
+static inline bool is_queue_slot_replied(uint8_t idx)
+{
+    if (idx < NUM_MAILBOX_QUEUE_SLOT) {
+        mailbox_queue_ptr->replied_slots |=
+                                clear_queue_slot_all_replied(mailbox_queue_ptr);
+        return mailbox_queue_ptr->replied_slots & (1UL << idx);
+    }
+
+    return false;
+}
+#else /* MAILBOX_RING_PROTOCOL */
 static inline void clear_queue_slot_replied(uint8_t idx)
 {
     if (idx < NUM_MAILBOX_QUEUE_SLOT) {
@@ -71,6 +90,7 @@ static inline bool is_queue_slot_replied(uint8_t idx)
 
     return false;
 }
+#endif /* MAILBOX_RING_PROTOCOL */
 #endif /* !defined TFM_MULTI_CORE_NS_OS */
 
 static uint8_t acquire_empty_slot(struct ns_mailbox_queue_t *queue)
@@ -114,7 +134,9 @@ static int32_t mailbox_tx_client_req(uint32_t call_type,
     uint8_t idx;
     struct mailbox_msg_t *msg_ptr;
     const void *task_handle;
+#if !MAILBOX_RING_PROTOCOL
     uint32_t critical_section;
+#endif
 
     idx = acquire_empty_slot(mailbox_queue_ptr);
     if (idx >= NUM_MAILBOX_QUEUE_SLOT) {
@@ -140,9 +162,15 @@ static int32_t mailbox_tx_client_req(uint32_t call_type,
     task_handle = tfm_ns_mailbox_os_get_task_handle();
     set_msg_owner(idx, task_handle);
 
+#if MAILBOX_RING_PROTOCOL
+    tfm_ns_mailbox_os_spin_lock();
+    set_queue_slot_pend(mailbox_queue_ptr, idx);
+    tfm_ns_mailbox_os_spin_unlock();
+#else
     critical_section = tfm_ns_mailbox_hal_enter_critical();
     set_queue_slot_pend(mailbox_queue_ptr, idx);
     tfm_ns_mailbox_hal_exit_critical(critical_section);
+#endif
 
     tfm_ns_mailbox_hal_notify_peer();
 
@@ -217,15 +245,22 @@ int32_t tfm_ns_mailbox_wake_reply_owner_isr(void)
 {
     uint8_t idx;
     mailbox_queue_status_t replied_status;
+#if !MAILBOX_RING_PROTOCOL
     uint32_t critical_section;
+#endif
 
     if (!mailbox_queue_ptr) {
         return MAILBOX_INIT_ERROR;
     }
 
+#if MAILBOX_RING_PROTOCOL
+    /* The ISR is the only consumer of the completion ring */
+    replied_status = clear_queue_slot_all_replied(mailbox_queue_ptr);
+#else
     critical_section = tfm_ns_mailbox_hal_enter_critical_isr();
     replied_status = clear_queue_slot_all_replied(mailbox_queue_ptr);
     tfm_ns_mailbox_hal_exit_critical_isr(critical_section);
+#endif
 
     if (!replied_status) {
         return MAILBOX_NO_PEND_EVENT;
@@ -273,6 +308,19 @@ static inline bool mailbox_wait_reply_signal(uint8_t idx)
     return is_set;
 }
 #else /* TFM_MULTI_CORE_NS_OS */
+#if MAILBOX_RING_PROTOCOL
+static inline bool mailbox_wait_reply_signal(uint8_t idx)
+{
+    bool is_set = false;
+
+    if (is_queue_slot_replied(idx)) {
+        clear_queue_slot_replied(idx);
+        is_set = true;
+    }
+
+    return is_set;
+}
+#else /* MAILBOX_RING_PROTOCOL */
 static inline bool mailbox_wait_reply_signal(uint8_t idx)
 {
     uint32_t critical_section;
@@ -289,6 +337,7 @@ static inline bool mailbox_wait_reply_signal(uint8_t idx)
 
     return is_set;
 }
+#endif /* MAILBOX_RING_PROTOCOL */
 #endif /* TFM_MULTI_CORE_NS_OS */
 
 static int32_t mailbox_wait_reply(uint8_t idx)
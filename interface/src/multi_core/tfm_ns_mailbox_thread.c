@@ -104,7 +104,9 @@ static int32_t mailbox_tx_client_call_msg(const struct ns_mailbox_req_t *req,
 {
     struct mailbox_msg_t *msg_ptr;
     struct ns_mailbox_slot_t *slot_ns;
+#if !MAILBOX_RING_PROTOCOL
     uint32_t critical_section;
+#endif
     uint8_t idx = NUM_MAILBOX_QUEUE_SLOT;
 
     idx = acquire_empty_slot(mailbox_queue_ptr);
@@ -134,9 +136,14 @@ static int32_t mailbox_tx_client_call_msg(const struct ns_mailbox_req_t *req,
      * from providing addresses of other applications or privileged area.
      */
 
+#if MAILBOX_RING_PROTOCOL
+    /* The mailbox thread is the only producer of the request ring */
+    set_queue_slot_pend(mailbox_queue_ptr, idx);
+#else
     critical_section = tfm_ns_mailbox_hal_enter_critical();
     set_queue_slot_pend(mailbox_queue_ptr, idx);
     tfm_ns_mailbox_hal_exit_critical(critical_section);
+#endif
 
     tfm_ns_mailbox_hal_notify_peer();
 
@@ -243,16 +250,23 @@ int32_t tfm_ns_mailbox_wake_reply_owner_isr(void)
 {
     uint8_t idx;
     const void *task_handle;
+#if !MAILBOX_RING_PROTOCOL
     uint32_t critical_section;
+#endif
     mailbox_queue_status_t replied_status, complete_slots = 0x0;
 
     if (!mailbox_queue_ptr) {
         return MAILBOX_INIT_ERROR;
     }
 
+#if MAILBOX_RING_PROTOCOL
+    /* The ISR is the only consumer of the completion ring */
+    replied_status = clear_queue_slot_all_replied(mailbox_queue_ptr);
+#else
     critical_section = tfm_ns_mailbox_hal_enter_critical_isr();
     replied_status = clear_queue_slot_all_replied(mailbox_queue_ptr);
     tfm_ns_mailbox_hal_exit_critical_isr(critical_section);
+#endif
 
     if (!replied_status) {
         return MAILBOX_NO_PEND_EVENT;
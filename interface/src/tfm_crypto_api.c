@@ -6,6 +6,7 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -1915,3 +1916,32 @@ TFM_CRYPTO_API(psa_status_t, psa_unwrap_key)(const psa_key_attributes_t * attrib
 
     return API_DISPATCH(in_vec, out_vec);
 }
+
+psa_status_t tfm_crypto_batch(const struct tfm_crypto_batch_item *items,
+                              size_t item_count,
+                              const uint8_t *input,
+                              size_t input_length,
+                              struct tfm_crypto_batch_result *results,
+                              uint8_t *output,
+                              size_t output_size)
+{
+    const struct tfm_crypto_pack_iovec iov = {
+        .function_id = TFM_CRYPTO_BATCH_SID,
+    };
+    psa_invec in_vec[] = {
+        {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
+        {.base = items, .len = item_count * sizeof(struct tfm_crypto_batch_item)},
+        {.base = input, .len = input_length},
+    };
+    psa_outvec out_vec[] = {
+        {.base = results, .len = item_count * sizeof(struct tfm_crypto_batch_result)},
+        {.base = output, .len = output_size},
+    };
+
+    if ((item_count == 0) ||
+        (item_count > (SIZE_MAX / sizeof(struct tfm_crypto_batch_item)))) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    return API_DISPATCH(in_vec, out_vec);
+}
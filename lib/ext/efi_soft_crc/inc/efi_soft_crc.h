@@ -26,6 +26,23 @@ extern "C" {
  */
 uint32_t efi_soft_crc32_update(uint32_t old_crc, const uint8_t *buf, size_t len);
 
+/**
+ * \brief Platform hook to update a CRC32 calculation using a hardware CRC unit.
+ *        Only called, and only needs to be provided, when the library is built
+ *        with EFI_SOFT_CRC32_HW_HOOK defined.
+ *
+ * \param[in]  old_crc Existing CRC value (0 for the first calculation).
+ * \param[in]  buf     Buffer of bytes to perform the calculation over.
+ * \param[in]  len     Length of \p buf in bytes.
+ * \param[out] crc     The calculated CRC32 value, as \ref efi_soft_crc32_update
+ *                     would return it.
+ *
+ * \return 0 on success. Any other value makes the caller fall back to the
+ *         software implementation, for example when the unit is busy or the
+ *         request is too small to be worth offloading.
+ */
+int efi_crc32_hw_update(uint32_t old_crc, const uint8_t *buf, size_t len, uint32_t *crc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,18 +5,35 @@
 
 #include "efi_soft_crc.h"
 
+/* Number of table rows used to fold in bytes: 0 for the table-free bitwise
+ * loop, 1 for a byte at a time, 4 or 8 to fold in that many bytes per step at
+ * the cost of 1 KiB of read-only data per row
+ */
+#ifndef EFI_SOFT_CRC32_SLICES
+#define EFI_SOFT_CRC32_SLICES 4
+#endif
+
+#if EFI_SOFT_CRC32_SLICES != 0 && EFI_SOFT_CRC32_SLICES != 1 && \
+    EFI_SOFT_CRC32_SLICES != 4 && EFI_SOFT_CRC32_SLICES != 8
+#error "EFI_SOFT_CRC32_SLICES must be 0, 1, 4 or 8!"
+#endif
+
+#if EFI_SOFT_CRC32_SLICES > 0
+#include "efi_soft_crc_table.h"
+#endif
+
 /* The standard polynomial, in reverse */
 #define POLYNOMIAL 0xEDB88320
 
+#if EFI_SOFT_CRC32_SLICES == 0
 /* Algorithmic approach to CRC calculation: avoids lookup tables, slow. Byte
  * reversal is avoided by shifting the crc register right instead of left and
  * by using a reversed 32-bit word to represent the polynomial.
  *
  * Derived from work by Henry S. Warren Jr.
  */
-uint32_t efi_soft_crc32_update(uint32_t old_crc32, const uint8_t *buf, size_t len)
+static uint32_t soft_crc32_update(uint32_t crc32, const uint8_t *buf, size_t len)
 {
-    register uint32_t crc32 = ~old_crc32;
     uint32_t mask;
 
     for ( ; len; --len, ++buf)
@@ -28,5 +45,71 @@ uint32_t efi_soft_crc32_update(uint32_t old_crc32, const uint8_t *buf, size_t le
         }
     }
 
-    return ~crc32;
+    return crc32;
+}
+#else /* EFI_SOFT_CRC32_SLICES == 0 */
+#if EFI_SOFT_CRC32_SLICES > 1
+/* Loads a little-endian word byte by byte, so that the buffer needs no
+ * particular alignment
+ */
+static inline uint32_t load_le32(const uint8_t *buf)
+{
+    return (uint32_t)buf[0] |
+           ((uint32_t)buf[1] << 8) |
+           ((uint32_t)buf[2] << 16) |
+           ((uint32_t)buf[3] << 24);
+}
+#endif
+
+/* Table-driven approach to CRC calculation. Each step looks up one table row
+ * per byte and folds EFI_SOFT_CRC32_SLICES bytes into the register at once,
+ * with any remaining bytes folded in one at a time.
+ */
+static uint32_t soft_crc32_update(uint32_t crc32, const uint8_t *buf, size_t len)
+{
+#if EFI_SOFT_CRC32_SLICES == 8
+    for ( ; len >= 8; len -= 8, buf += 8) {
+        const uint32_t lo = crc32 ^ load_le32(buf);
+        const uint32_t hi = load_le32(buf + 4);
+
+        crc32 = crc32_table[7][lo & 0xFF] ^
+                crc32_table[6][(lo >> 8) & 0xFF] ^
+                crc32_table[5][(lo >> 16) & 0xFF] ^
+                crc32_table[4][lo >> 24] ^
+                crc32_table[3][hi & 0xFF] ^
+                crc32_table[2][(hi >> 8) & 0xFF] ^
+                crc32_table[1][(hi >> 16) & 0xFF] ^
+                crc32_table[0][hi >> 24];
+    }
+#elif EFI_SOFT_CRC32_SLICES == 4
+    for ( ; len >= 4; len -= 4, buf += 4) {
+        crc32 ^= load_le32(buf);
+
+        crc32 = crc32_table[3][crc32 & 0xFF] ^
+                crc32_table[2][(crc32 >> 8) & 0xFF] ^
+                crc32_table[1][(crc32 >> 16) & 0xFF] ^
+                crc32_table[0][crc32 >> 24];
+    }
+#endif
+
+    for ( ; len; --len, ++buf) {
+        crc32 = (crc32 >> 8) ^ crc32_table[0][(crc32 ^ *buf) & 0xFF];
+    }
+
+    return crc32;
+}
+#endif /* EFI_SOFT_CRC32_SLICES == 0 */
+
+uint32_t efi_soft_crc32_update(uint32_t old_crc32, const uint8_t *buf, size_t len)
+{
+#ifdef EFI_SOFT_CRC32_HW_HOOK
+    uint32_t hw_crc32;
+
+    /* Fall back to software if the hardware cannot take this request */
+    if (efi_crc32_hw_update(old_crc32, buf, len, &hw_crc32) == 0) {
+        return hw_crc32;
+    }
+#endif
+
+    return ~soft_crc32_update(~old_crc32, buf, len);
 }
@@ -0,0 +1,168 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "efi_soft_crc.h"
+
+/* Lengths up to and including this value are checked for every alignment */
+#define MAX_LEN         (1024u)
+#define MAX_ALIGN       (8u)
+
+/* Size of a full GPT partition array: 128 entries of 128 bytes */
+#define ARRAY_LEN       (16u * 1024u)
+
+static uint8_t test_buf[MAX_ALIGN + ARRAY_LEN];
+
+/* Bitwise CRC-32 the engine is checked against */
+static uint32_t reference_crc32(uint32_t old_crc32, const uint8_t *buf, size_t len)
+{
+    uint32_t crc32 = ~old_crc32;
+
+    for (size_t i = 0; i < len; ++i) {
+        crc32 ^= buf[i];
+        for (size_t bit = 0; bit < 8; ++bit) {
+            crc32 = (crc32 >> 1) ^ (0xEDB88320 & -(crc32 & 1));
+        }
+    }
+
+    return ~crc32;
+}
+
+static void fill(uint8_t *buf, size_t len, uint32_t seed)
+{
+    for (size_t i = 0; i < len; ++i) {
+        seed = (seed * 1103515245u) + 12345u;
+        buf[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+#ifdef EFI_SOFT_CRC32_HW_HOOK
+/* Stands in for a hardware CRC unit. It only takes requests whilst enabled and
+ * of at least HW_MIN_LEN bytes, leaving the rest to software.
+ */
+#define HW_MIN_LEN      (64u)
+
+static bool hw_enabled;
+static unsigned int hw_calls;
+static unsigned int hw_accepted;
+
+int efi_crc32_hw_update(uint32_t old_crc, const uint8_t *buf, size_t len, uint32_t *crc)
+{
+    hw_calls++;
+    if (!hw_enabled || len < HW_MIN_LEN) {
+        return -1;
+    }
+
+    hw_accepted++;
+    *crc = reference_crc32(old_crc, buf, len);
+    return 0;
+}
+#endif /* EFI_SOFT_CRC32_HW_HOOK */
+
+void setUp(void)
+{
+#ifdef EFI_SOFT_CRC32_HW_HOOK
+    hw_enabled = false;
+    hw_calls = 0;
+    hw_accepted = 0;
+#endif
+}
+
+void tearDown(void)
+{
+}
+
+void test_efi_soft_crc32_update_should_matchCheckValue(void)
+{
+    const uint8_t check[] = "123456789";
+
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, efi_soft_crc32_update(0, check, sizeof(check) - 1));
+    TEST_ASSERT_EQUAL_HEX32(0, efi_soft_crc32_update(0, check, 0));
+    TEST_ASSERT_EQUAL_HEX32(0x12345678, efi_soft_crc32_update(0x12345678, NULL, 0));
+}
+
+void test_efi_soft_crc32_update_should_matchReferenceForAllAlignmentsAndLengths(void)
+{
+    fill(test_buf, MAX_ALIGN + MAX_LEN, 0x5A);
+
+    for (size_t align = 0; align < MAX_ALIGN; ++align) {
+        for (size_t len = 0; len <= MAX_LEN; ++len) {
+            const uint32_t expected = reference_crc32(0, test_buf + align, len);
+            const uint32_t actual = efi_soft_crc32_update(0, test_buf + align, len);
+
+            if (actual != expected) {
+                char msg[64];
+
+                snprintf(msg, sizeof(msg), "align %zu len %zu", align, len);
+                TEST_FAIL_MESSAGE(msg);
+            }
+        }
+    }
+}
+
+void test_efi_soft_crc32_update_should_chainAcrossSplits(void)
+{
+    const size_t len = 300;
+    uint32_t expected;
+
+    fill(test_buf, len, 0xC3);
+    expected = reference_crc32(0, test_buf, len);
+
+    for (size_t split = 0; split <= len; ++split) {
+        uint32_t crc = efi_soft_crc32_update(0, test_buf, split);
+        crc = efi_soft_crc32_update(crc, test_buf + split, len - split);
+        TEST_ASSERT_EQUAL_HEX32(expected, crc);
+    }
+}
+
+void test_efi_soft_crc32_update_should_useHardwareWhenAccepted(void)
+{
+#ifdef EFI_SOFT_CRC32_HW_HOOK
+    fill(test_buf, ARRAY_LEN, 0x77);
+    hw_enabled = true;
+
+    TEST_ASSERT_EQUAL_HEX32(reference_crc32(0, test_buf, ARRAY_LEN),
+                            efi_soft_crc32_update(0, test_buf, ARRAY_LEN));
+    TEST_ASSERT_EQUAL(1, hw_calls);
+    TEST_ASSERT_EQUAL(1, hw_accepted);
+#else
+    TEST_IGNORE_MESSAGE("EFI_SOFT_CRC32_HW_HOOK not defined");
+#endif
+}
+
+void test_efi_soft_crc32_update_should_fallBackWhenHardwareDeclines(void)
+{
+#ifdef EFI_SOFT_CRC32_HW_HOOK
+    fill(test_buf, HW_MIN_LEN, 0x78);
+    hw_enabled = true;
+
+    /* Too short for the hardware, so software calculates it */
+    TEST_ASSERT_EQUAL_HEX32(reference_crc32(0, test_buf, HW_MIN_LEN - 1),
+                            efi_soft_crc32_update(0, test_buf, HW_MIN_LEN - 1));
+    TEST_ASSERT_EQUAL(1, hw_calls);
+    TEST_ASSERT_EQUAL(0, hw_accepted);
+#else
+    TEST_IGNORE_MESSAGE("EFI_SOFT_CRC32_HW_HOOK not defined");
+#endif
+}
+
+void test_efi_soft_crc32_update_should_matchReferenceForPartitionArray(void)
+{
+    fill(test_buf, ARRAY_LEN, 0x11);
+
+    TEST_ASSERT_EQUAL_HEX32(reference_crc32(0, test_buf, ARRAY_LEN),
+                            efi_soft_crc32_update(0, test_buf, ARRAY_LEN));
+    TEST_ASSERT_EQUAL_HEX32(reference_crc32(0, test_buf + 1, ARRAY_LEN - 1),
+                            efi_soft_crc32_update(0, test_buf + 1, ARRAY_LEN - 1));
+}
@@ -0,0 +1,22 @@
+#-------------------------------------------------------------------------------
+# SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+#-------------------------------------------------------------------------------
+
+# Define what is being unit tested and by what
+set(UNIT_UNDER_TEST ${TFM_ROOT_DIR}/lib/ext/efi_soft_crc/src/efi_soft_crc.c)
+set(UNIT_TEST_SUITE ${CMAKE_CURRENT_LIST_DIR}/test_efi_soft_crc.c)
+
+# Dependencies for the UUT, that get linked into the executable
+
+# Include directories for compilation
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/ext/efi_soft_crc/inc)
+
+# Headers to be mocked
+
+# Compile-time definitions
+list(APPEND UNIT_TEST_COMPILE_DEFS EFI_SOFT_CRC32_SLICES=4)
+# The test suite provides a hardware unit that only takes some requests
+list(APPEND UNIT_TEST_COMPILE_DEFS EFI_SOFT_CRC32_HW_HOOK)
@@ -9,6 +9,7 @@
 #define __TFM_GPT_H__
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "psa/error.h"
@@ -231,13 +232,31 @@ psa_status_t gpt_validate(bool is_primary);
 psa_status_t gpt_restore(bool is_primary);
 
 /**
- * \brief Defragments the GPT, ensuring free space becomes contiguous.
+ * \brief Defragments the GPT, ensuring free space becomes contiguous. The fewest blocks
+ *        are moved that leave a single free region: partitions already packed against
+ *        either end of the usable space stay where they are, so the free region is not
+ *        necessarily after the last partition.
  *
  * \retval PSA_SUCCESS Success.
  * \retval PSA_ERROR_STORAGE_FAILURE I/O failure.
  */
 psa_status_t gpt_defragment(void);
 
+/**
+ * \brief Defragments the GPT as \ref gpt_defragment does, moving partition data through the
+ *        given work buffer. As many blocks as fit in the buffer are moved at a time, using the
+ *        driver's multi-block routines where provided.
+ *
+ * \param[in] work_buf Buffer used to move partition data, or NULL to use an internal buffer
+ *                     of one block.
+ * \param[in] work_buf_size Size of \p work_buf in bytes.
+ *
+ * \retval PSA_SUCCESS Success.
+ * \retval PSA_ERROR_INVALID_ARGUMENT \p work_buf is not NULL but smaller than one block.
+ * \retval PSA_ERROR_STORAGE_FAILURE I/O failure.
+ */
+psa_status_t gpt_defragment_with_buffer(void *work_buf, size_t work_buf_size);
+
 /**
  * \brief Reads the GPT header from the second block (LBA 1).
  *
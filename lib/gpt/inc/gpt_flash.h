@@ -73,6 +73,42 @@ __attribute__((nonnull(2)))
 typedef ssize_t (*gpt_flash_write_t)(uint64_t    lba,
                                      const void *buf);
 
+/**
+ * \brief Function that reads consecutive logical blocks.
+ *
+ * \param[in]  lba Starting logical block address.
+ * \param[in]  num_blocks Number of blocks to read.
+ * \param[out] buf Buffer to populate. Must be at least \p num_blocks LBAs in size.
+ *
+ * \return Number of bytes read on success or a negative error code on failure.
+ * \retval GPT_FLASH_NOT_INIT The flash driver has not been initialised.
+ * \retval GPT_FLASH_UNAVAILABLE The flash driver is unavailable.
+ * \retval GPT_FLASH_BAD_PARAM \p lba or \p num_blocks is not valid (for example exceeding the flash size).
+ * \retval GPT_FLASH_GENERIC_ERROR Unspecified error.
+ */
+__attribute__((nonnull(3)))
+typedef ssize_t (*gpt_flash_read_blocks_t)(uint64_t lba,
+                                           size_t   num_blocks,
+                                           void    *buf);
+
+/**
+ * \brief Function that writes to consecutive logical blocks.
+ *
+ * \param[in] lba Starting logical block address.
+ * \param[in] num_blocks Number of blocks to write.
+ * \param[in] buf Buffer to write from. Must be at least \p num_blocks LBAs in size.
+ *
+ * \return Number of bytes written on success or a negative error code on failure.
+ * \retval GPT_FLASH_NOT_INIT The flash driver has not been initialised.
+ * \retval GPT_FLASH_UNAVAILABLE The flash driver is unavailable.
+ * \retval GPT_FLASH_BAD_PARAM \p lba or \p num_blocks is not valid (for example exceeding the flash size).
+ * \retval GPT_FLASH_GENERIC_ERROR Unspecified error.
+ */
+__attribute__((nonnull(3)))
+typedef ssize_t (*gpt_flash_write_blocks_t)(uint64_t    lba,
+                                            size_t      num_blocks,
+                                            const void *buf);
+
 /**
  * \brief Function that erases consecutive logical blocks.
  *
@@ -99,6 +135,8 @@ struct gpt_flash_driver_t {
     gpt_flash_read_t read;       /**< Routine used to read a logical block. */
     gpt_flash_write_t write;     /**< Routine used to write a logical block. */
     gpt_flash_erase_t erase;     /**< Routine used to erase logical blocks. */
+    gpt_flash_read_blocks_t read_blocks;   /**< Optional routine used to read consecutive logical blocks. */
+    gpt_flash_write_blocks_t write_blocks; /**< Optional routine used to write consecutive logical blocks. */
 };
 
 #ifdef __cplusplus
@@ -30,6 +30,24 @@
 #error "TFM_GPT_BLOCK_SIZE must be at least 512!"
 #endif
 
+/* Number of LBAs cached in memory. With more than one, accesses to the headers
+ * and the partition array do not evict each other.
+ */
+#ifndef TFM_GPT_CACHE_NUM_LBAS
+#define TFM_GPT_CACHE_NUM_LBAS 2
+#endif
+#if TFM_GPT_CACHE_NUM_LBAS < 1
+#error "TFM_GPT_CACHE_NUM_LBAS must be at least 1!"
+#endif
+
+/* Maximum number of partition entries indexed in memory, so that entries can be
+ * found without reading the whole partition array. Zero disables the index. It
+ * is also not used whilst the table holds more entries than this.
+ */
+#ifndef TFM_GPT_INDEX_MAX_ENTRIES
+#define TFM_GPT_INDEX_MAX_ENTRIES 0
+#endif
+
 /* Where Master Boot Record (MBR) is on flash */
 #define MBR_LBA 0ULL
 
@@ -151,6 +169,28 @@ struct gpt_t {
  */
 typedef bool (*gpt_entry_cmp_t)(const struct gpt_entry_t *, const void *);
 
+/* An LBA held in the in-memory cache */
+struct lba_cache_line_t {
+    uint8_t buf[TFM_GPT_BLOCK_SIZE];    /* Contents of the LBA */
+    uint64_t lba;                       /* LBA cached, zero if unused */
+    uint32_t last_used;                 /* Age used to evict the least recently used line */
+    bool dirty;                         /* True if modified but not written to flash */
+};
+
+#if TFM_GPT_INDEX_MAX_ENTRIES > 0
+/* The fields of a partition entry that it can be looked up by */
+struct gpt_index_entry_t {
+    struct efi_guid_t unique_guid;      /* Unique GUID of the partition */
+    struct efi_guid_t partition_type;   /* Partition type */
+    uint32_t name_hash;                 /* Hash of the partition name */
+};
+
+/* As gpt_entry_cmp_t, but for an index entry. A name hash match only means the
+ * entry might match, so every match must be confirmed against the entry.
+ */
+typedef bool (*gpt_index_cmp_t)(const struct gpt_index_entry_t *, const void *);
+#endif
+
 /* The LBA for the backup table */
 static uint64_t backup_gpt_lba = 0;
 
@@ -174,16 +214,26 @@ static uint32_t plat_max_partitions = 0;
  */
 static struct gpt_t primary_gpt = {0};
 
-/* Buffer to use for LBA I/O */
-static uint8_t lba_buf[TFM_GPT_BLOCK_SIZE] = {0};
-
-/* LBA that is cached in the buffer. Zero is valid only for protective MBR, all
- * other GPT operations must have LBA of one or greater
+/* Cache of LBAs used for I/O. Only LBAs of the primary partition array are ever
+ * dirty. An LBA of zero marks an unused line: zero is valid only for the
+ * protective MBR, which is never cached, all other GPT operations must have LBA
+ * of one or greater
  */
-static uint64_t cached_lba = 0;
+static struct lba_cache_line_t lba_cache[TFM_GPT_CACHE_NUM_LBAS] = {0};
+
+/* The line most recently read into or accessed */
+static struct lba_cache_line_t *cur_line = &lba_cache[0];
 
-/* True if write was buffered */
-static bool write_buffered = false;
+/* Incremented on each cache access to age the lines */
+static uint32_t lba_cache_clock = 0;
+
+#if TFM_GPT_INDEX_MAX_ENTRIES > 0
+/* In-memory index of the in-use entries of the primary partition array */
+static struct gpt_index_entry_t entry_index[TFM_GPT_INDEX_MAX_ENTRIES];
+
+/* True if the index mirrors every in-use entry of the primary partition array */
+static bool entry_index_valid = false;
+#endif
 
 /* Helper function prototypes */
 __attribute__((unused))
@@ -201,14 +251,24 @@ static psa_status_t count_used_partitions(const struct gpt_t *table,
                                           uint32_t *num_used);
 static inline void parse_entry(const struct gpt_entry_t *entry,
                                struct partition_entry_t *partition_entry);
+static struct lba_cache_line_t *cache_lookup(uint64_t lba);
+static struct lba_cache_line_t *cache_victim(void);
+static bool cache_is_dirty(void);
+static void cache_invalidate(void);
+static void cache_drop_copies(uint64_t lba, const struct lba_cache_line_t *keep);
+static void cache_drop_range(uint64_t lba, uint64_t num_blocks);
+static psa_status_t cache_claim_line(struct lba_cache_line_t **line);
 static psa_status_t read_from_flash(uint64_t required_lba);
 static psa_status_t read_entry_from_flash(const struct gpt_t *table,
                                           uint32_t array_index,
                                           struct gpt_entry_t *entry);
 static psa_status_t read_table_from_flash(struct gpt_t *table, bool is_primary);
 static psa_status_t flush_lba_buf(void);
+static psa_status_t write_line_to_flash(uint64_t lba, const struct lba_cache_line_t *line);
 static psa_status_t write_to_flash(uint64_t lba);
-static psa_status_t write_entries_to_flash(uint32_t lbas_into_array, bool no_header_update);
+static psa_status_t write_entries_to_flash(const struct lba_cache_line_t *line,
+                                           bool no_header_update);
+static psa_status_t write_back_lines(void);
 static psa_status_t write_entry(uint32_t                  array_index,
                                 const struct gpt_entry_t *entry,
                                 bool                      no_header_update);
@@ -221,14 +281,39 @@ static psa_status_t find_gpt_entry(const struct gpt_t      *table,
                                    const uint32_t           repeat_index,
                                    struct gpt_entry_t      *entry,
                                    uint32_t                *array_index);
-static psa_status_t move_lba(const uint64_t old_lba, const uint64_t new_lba);
+static psa_status_t read_blocks_from_flash(uint64_t lba, size_t num_blocks, uint8_t *buf);
+static psa_status_t write_blocks_to_flash(uint64_t lba, size_t num_blocks, const uint8_t *buf);
+static psa_status_t move_blocks(const uint64_t old_lba,
+                                const uint64_t new_lba,
+                                const size_t   num_blocks,
+                                uint8_t       *work_buf);
 static psa_status_t move_partition(const uint64_t old_lba,
                                    const uint64_t new_lba,
-                                   const uint64_t num_blocks);
+                                   const uint64_t num_blocks,
+                                   uint8_t       *work_buf,
+                                   const size_t   work_buf_blocks);
+static psa_status_t read_entry_extent(uint32_t array_index,
+                                      uint64_t *start,
+                                      uint64_t *num_blocks);
+static psa_status_t plan_defragment(uint32_t  num_partitions,
+                                    uint32_t *split);
+static psa_status_t relocate_entry(uint32_t       array_index,
+                                   uint64_t       new_start,
+                                   uint8_t       *work_buf,
+                                   const size_t   work_buf_blocks);
 static psa_status_t mbr_load(struct mbr_t *mbr);
 static bool gpt_entry_cmp_guid(const struct gpt_entry_t *entry, const void *guid);
 static bool gpt_entry_cmp_name(const struct gpt_entry_t *entry, const void *name);
 static bool gpt_entry_cmp_type(const struct gpt_entry_t *entry, const void *type);
+#if TFM_GPT_INDEX_MAX_ENTRIES > 0
+static uint32_t name_hash(const char name[GPT_ENTRY_NAME_LENGTH]);
+static void index_set(uint32_t array_index, const struct gpt_entry_t *entry);
+static void index_remove(uint32_t array_index);
+static gpt_index_cmp_t index_cmp_for(gpt_entry_cmp_t compare);
+static bool gpt_index_cmp_guid(const struct gpt_index_entry_t *entry, const void *guid);
+static bool gpt_index_cmp_name(const struct gpt_index_entry_t *entry, const void *name);
+static bool gpt_index_cmp_type(const struct gpt_index_entry_t *entry, const void *type);
+#endif
 static psa_status_t validate_backup_gpt_lba(const uint64_t backup_lba,
                                             const uint64_t primary_lba,
                                             const uint64_t partition_array_end,
@@ -452,10 +537,10 @@ psa_status_t gpt_entry_move(const struct efi_guid_t *guid,
      * first, then the others to avoid reading this LBA twice
      */
     struct gpt_entry_t entry;
-    const uint64_t checked_lba = cached_lba;
+    const uint64_t checked_lba = cur_line->lba;
     const uint64_t array_end_lba = partition_array_last_lba(&primary_gpt);
     uint32_t num_entries_in_cached_lba;
-    if (cached_lba == array_end_lba) {
+    if (cur_line->lba == array_end_lba) {
         /* If this is 0, then the last LBA is full */
         uint32_t num_entries_in_last_lba = primary_gpt.num_used_partitions % gpt_entry_per_lba_count();
         if (num_entries_in_last_lba == 0) {
@@ -469,7 +554,7 @@ psa_status_t gpt_entry_move(const struct efi_guid_t *guid,
 
     /* Cached LBA */
     for (uint32_t i = 0; i < num_entries_in_cached_lba; ++i) {
-        memcpy(&entry, lba_buf + (i * GPT_ENTRY_SIZE), GPT_ENTRY_SIZE);
+        memcpy(&entry, cur_line->buf + (i * GPT_ENTRY_SIZE), GPT_ENTRY_SIZE);
 
         const struct efi_guid_t ent_guid = entry.unique_guid;
         if (efi_guid_cmp(&ent_guid, guid) == 0) {
@@ -506,7 +591,9 @@ psa_status_t gpt_entry_move(const struct efi_guid_t *guid,
     ret = move_partition(
             cached_entry.start,
             start,
-            end - start + 1);
+            end - start + 1,
+            NULL,
+            0);
     if (ret != PSA_SUCCESS) {
         return ret;
     }
@@ -619,16 +706,8 @@ psa_status_t gpt_entry_create(const struct efi_guid_t *type,
         return ret;
     }
 
-    /* Flush the buffered LBA if not done so. This will cause the header to be
-     * updated
-     */
-    if (write_buffered) {
-        /* flush_lba_buf will update the header */
-        ret = flush_lba_buf();
-    } else {
-        ret = update_header(primary_gpt.num_used_partitions);
-    }
-
+    /* Update the header, which also writes the buffered LBA if not done so */
+    ret = update_header(primary_gpt.num_used_partitions);
     if (ret != PSA_SUCCESS) {
         return ret;
     }
@@ -668,8 +747,8 @@ psa_status_t gpt_entry_remove(const struct efi_guid_t *guid)
         const uint32_t lba_index = cached_index % gpt_entry_per_lba_count();
         if (lba_index + 1 != gpt_entry_per_lba_count()) {
             memmove(
-                    lba_buf + lba_index * GPT_ENTRY_SIZE,
-                    lba_buf + (lba_index + 1) * GPT_ENTRY_SIZE,
+                    cur_line->buf + lba_index * GPT_ENTRY_SIZE,
+                    cur_line->buf + (lba_index + 1) * GPT_ENTRY_SIZE,
                     (gpt_entry_per_lba_count() - lba_index - 1) * GPT_ENTRY_SIZE);
         }
 
@@ -685,15 +764,21 @@ psa_status_t gpt_entry_remove(const struct efi_guid_t *guid)
                 ++i)
         {
             uint8_t array_buf[TFM_GPT_BLOCK_SIZE] = {0};
-            int read_ret = plat_flash_driver->read(i, array_buf);
-            if (read_ret != TFM_GPT_BLOCK_SIZE) {
-                ERROR("Unable to read LBA 0x%08x%08x\n",
-                        (uint32_t)(i >> 32), (uint32_t)i);
-                return PSA_ERROR_STORAGE_FAILURE;
+            const struct lba_cache_line_t *line = cache_lookup(i);
+            if (line != NULL) {
+                /* The cached copy may hold entries not yet written */
+                memcpy(array_buf, line->buf, TFM_GPT_BLOCK_SIZE);
+            } else {
+                int read_ret = plat_flash_driver->read(i, array_buf);
+                if (read_ret != TFM_GPT_BLOCK_SIZE) {
+                    ERROR("Unable to read LBA 0x%08x%08x\n",
+                            (uint32_t)(i >> 32), (uint32_t)i);
+                    return PSA_ERROR_STORAGE_FAILURE;
+                }
             }
 
             memcpy(
-                    lba_buf + GPT_ENTRY_SIZE * (gpt_entry_per_lba_count() - 1),
+                    cur_line->buf + GPT_ENTRY_SIZE * (gpt_entry_per_lba_count() - 1),
                     array_buf,
                     GPT_ENTRY_SIZE);
 
@@ -713,35 +798,42 @@ psa_status_t gpt_entry_remove(const struct efi_guid_t *guid)
                     array_buf,
                     array_buf + GPT_ENTRY_SIZE,
                     sizeof(array_buf) - GPT_ENTRY_SIZE);
-            memcpy(lba_buf, array_buf, TFM_GPT_BLOCK_SIZE);
+            memcpy(cur_line->buf, array_buf, TFM_GPT_BLOCK_SIZE);
         }
     }
 
-    /* What was the final LBA is now cached and may be empty or partially-filled */
-    cached_lba = array_end_lba;
-    write_buffered = false;
+    /* What was the final LBA is now cached and may be empty or partially-filled.
+     * Any other copy of it is out of date.
+     */
+    cache_drop_copies(array_end_lba, cur_line);
+    cur_line->lba = array_end_lba;
+    cur_line->dirty = false;
+#if TFM_GPT_INDEX_MAX_ENTRIES > 0
+    index_remove(cached_index);
+#endif
     uint32_t entries_in_last_lba = (--primary_gpt.num_used_partitions) % gpt_entry_per_lba_count();
     if (entries_in_last_lba == 0) {
         /* There's nothing left in this LBA, so zero it all and write it out.
          * There is also no need to do an erase just to zero afterwards.
          */
-        memset(lba_buf, 0, TFM_GPT_BLOCK_SIZE);
+        memset(cur_line->buf, 0, TFM_GPT_BLOCK_SIZE);
         if (backup_gpt_array_lba != 0) {
-            int write_ret = plat_flash_driver->write(
-                    backup_gpt_array_lba + array_end_lba - PRIMARY_GPT_ARRAY_LBA,
-                    lba_buf);
+            const uint64_t backup_end_lba =
+                backup_gpt_array_lba + array_end_lba - PRIMARY_GPT_ARRAY_LBA;
+            cache_drop_copies(backup_end_lba, NULL);
+            int write_ret = plat_flash_driver->write(backup_end_lba, cur_line->buf);
             if (write_ret != TFM_GPT_BLOCK_SIZE) {
                 return PSA_ERROR_STORAGE_FAILURE;
             }
         }
-        int write_ret = plat_flash_driver->write(array_end_lba, lba_buf);
+        int write_ret = plat_flash_driver->write(array_end_lba, cur_line->buf);
         if (write_ret != TFM_GPT_BLOCK_SIZE) {
             return PSA_ERROR_STORAGE_FAILURE;
         }
     } else {
         /* Zero what is not needed anymore */
         memset(
-                lba_buf + GPT_ENTRY_SIZE * entries_in_last_lba,
+                cur_line->buf + GPT_ENTRY_SIZE * entries_in_last_lba,
                 0,
                 (gpt_entry_per_lba_count() - entries_in_last_lba) * GPT_ENTRY_SIZE);
         if (backup_gpt_array_lba != 0) {
@@ -773,15 +865,11 @@ psa_status_t gpt_validate(bool is_primary)
      * a table. The in-memory header needs to be updated if the flushed LBA was
      * part of the entry array
      */
-    psa_status_t ret;
-    if (write_buffered) {
-        ret = flush_lba_buf();
-        if (ret != PSA_SUCCESS) {
-            return ret;
-        }
-        write_buffered = false;
+    psa_status_t ret = flush_lba_buf();
+    if (ret != PSA_SUCCESS) {
+        return ret;
     }
-    cached_lba = 0;
+    cache_invalidate();
 
     if (is_primary) {
         return validate_table(&primary_gpt, true);
@@ -806,15 +894,11 @@ psa_status_t gpt_restore(bool is_primary)
      * table. The in-memory header needs to be updated if the flushed LBA was
      * part of the entry array
      */
-    psa_status_t ret;
-    if (write_buffered) {
-        ret = flush_lba_buf();
-        if (ret != PSA_SUCCESS) {
-            return ret;
-        }
-        write_buffered = false;
+    psa_status_t ret = flush_lba_buf();
+    if (ret != PSA_SUCCESS) {
+        return ret;
     }
-    cached_lba = 0;
+    cache_invalidate();
 
     if (is_primary) {
         struct gpt_t backup_gpt;
@@ -834,9 +918,24 @@ psa_status_t gpt_restore(bool is_primary)
 
 psa_status_t gpt_defragment(void)
 {
+    return gpt_defragment_with_buffer(NULL, 0);
+}
+
+psa_status_t gpt_defragment_with_buffer(void *work_buf, size_t work_buf_size)
+{
+    if (work_buf != NULL && work_buf_size < TFM_GPT_BLOCK_SIZE) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+    const size_t work_buf_blocks = work_buf_size / TFM_GPT_BLOCK_SIZE;
+    const uint32_t num_partitions = primary_gpt.num_used_partitions;
+
+    if (num_partitions == 0) {
+        return PSA_SUCCESS;
+    }
+
     /* First, sort the partition array according to start LBA. This means that
-     * moving partitions towards the start of the flash sequentially is safe
-     * and will not result in lost data.
+     * moving partitions towards either end of the flash in order is safe and
+     * will not result in lost data.
      */
     psa_status_t ret = sort_partition_array(&primary_gpt);
     if (ret != PSA_SUCCESS) {
@@ -844,59 +943,56 @@ psa_status_t gpt_defragment(void)
         return ret;
     }
 
-    uint64_t prev_end = primary_gpt.header.first_lba;
-    struct gpt_entry_t entry;
+    uint64_t start;
+    uint64_t num_blocks;
+    uint32_t split;
 
-    for (uint32_t i = 0; i < primary_gpt.num_used_partitions; ++i) {
-        ret = read_entry_from_flash(&primary_gpt, i, &entry);
+    ret = plan_defragment(num_partitions, &split);
+    if (ret != PSA_SUCCESS) {
+        return ret;
+    }
+
+    /* Partitions before the split are packed towards the start, lowest first,
+     * and the rest towards the end, highest first. Each then only ever moves
+     * into free space or over its own old location.
+     */
+    uint64_t next_start = primary_gpt.header.first_lba;
+    for (uint32_t i = 0; i < split; ++i) {
+        ret = read_entry_extent(i, &start, &num_blocks);
         if (ret != PSA_SUCCESS) {
             return ret;
         }
-
-        /* Move to be next to previous entry. Continue if already where it
-         * needs to be.
-         */
-        if (prev_end == entry.start) {
-            prev_end = entry.end + 1;
-            continue;
+        ret = relocate_entry(i, next_start, work_buf, work_buf_blocks);
+        if (ret != PSA_SUCCESS) {
+            return ret;
         }
+        next_start += num_blocks;
+    }
 
-        const uint64_t num_blocks = entry.end - entry.start + 1;
-        ret = move_partition(entry.start, prev_end, num_blocks);
+    uint64_t next_end = primary_gpt.header.last_lba + 1;
+    for (uint32_t i = num_partitions; i > split; --i) {
+        ret = read_entry_extent(i - 1, &start, &num_blocks);
         if (ret != PSA_SUCCESS) {
             return ret;
         }
-
-        /* Update header information */
-        entry.start = prev_end;
-        entry.end = entry.start + num_blocks - 1;
-        prev_end = entry.end + 1;
-
-        /* Write the entry change, skipping header update until every entry
-         * written
-         */
-        ret = write_entry(i, &entry, true);
+        next_end -= num_blocks;
+        ret = relocate_entry(i - 1, next_end, work_buf, work_buf_blocks);
         if (ret != PSA_SUCCESS) {
             return ret;
         }
     }
 
     /* Write everything to flash after defragmentation if not done so already.
-     * The previous loop will write the last entry to the LBA buffer, which may
-     * or not may not be flushed
+     * Moved entries are written to the cache, which may or not may not have
+     * been flushed. Updating the header writes them.
      */
-    if (write_buffered) {
-        return flush_lba_buf();
-    }
-
-    return update_header(primary_gpt.num_used_partitions);
+    return update_header(num_partitions);
 }
 
 /* Initialises GPT from first block. */
 psa_status_t gpt_init(struct gpt_flash_driver_t *flash_driver, uint64_t max_partitions)
 {
-    cached_lba = 0;
-    write_buffered = false;
+    cache_invalidate();
     if (max_partitions < GPT_MIN_PARTITIONS) {
         ERROR("Minimum number of partitions is %d\n", GPT_MIN_PARTITIONS);
         return PSA_ERROR_INVALID_ARGUMENT;
@@ -985,8 +1081,7 @@ fail_load:
     plat_max_partitions = 0;
     backup_gpt_lba = 0;
     backup_gpt_array_lba = 0;
-    cached_lba = 0;
-    write_buffered = false;
+    cache_invalidate();
 
     return ret;
 }
@@ -997,9 +1092,7 @@ psa_status_t gpt_uninit(void)
 
     if (plat_flash_driver) {
         /* Flush the in-memory buffer */
-        if (write_buffered) {
-            ret = flush_lba_buf();
-        }
+        ret = flush_lba_buf();
 
         /* Uninitialise driver if function provided */
         if (plat_flash_driver->uninit != NULL) {
@@ -1014,8 +1107,7 @@ psa_status_t gpt_uninit(void)
     plat_max_partitions = 0;
     backup_gpt_lba = 0;
     backup_gpt_array_lba = 0;
-    cached_lba = 0;
-    write_buffered = false;
+    cache_invalidate();
 
     return ret;
 }
@@ -1062,6 +1154,81 @@ static bool gpt_entry_cmp_type(const struct gpt_entry_t *entry, const void *type
     return efi_guid_cmp(&entry_type, cmp_type) == 0;
 }
 
+#if TFM_GPT_INDEX_MAX_ENTRIES > 0
+/* Returns the 32-bit FNV-1a hash of an entry name */
+static uint32_t name_hash(const char name[GPT_ENTRY_NAME_LENGTH])
+{
+    uint32_t hash = 0x811C9DC5;
+
+    for (uint32_t i = 0; i < GPT_ENTRY_NAME_LENGTH; ++i) {
+        hash = (hash ^ (uint8_t)name[i]) * 0x01000193;
+    }
+
+    return hash;
+}
+
+/* Records the entry at the given index of the primary partition array */
+static void index_set(uint32_t array_index, const struct gpt_entry_t *entry)
+{
+    if (array_index >= TFM_GPT_INDEX_MAX_ENTRIES) {
+        return;
+    }
+
+    entry_index[array_index].unique_guid = entry->unique_guid;
+    entry_index[array_index].partition_type = entry->partition_type;
+    entry_index[array_index].name_hash = name_hash(entry->name);
+}
+
+/* Removes the entry at the given index, shuffling the rest up as is done for
+ * the primary partition array
+ */
+static void index_remove(uint32_t array_index)
+{
+    if (!entry_index_valid) {
+        return;
+    }
+
+    if (array_index + 1 < primary_gpt.num_used_partitions) {
+        memmove(&entry_index[array_index],
+                &entry_index[array_index + 1],
+                (primary_gpt.num_used_partitions - array_index - 1) *
+                sizeof(entry_index[0]));
+    }
+}
+
+/* Compare the index entry with the given guid */
+static bool gpt_index_cmp_guid(const struct gpt_index_entry_t *entry, const void *guid)
+{
+    return efi_guid_cmp(&entry->unique_guid, (const struct efi_guid_t *)guid) == 0;
+}
+
+/* Compare the index entry with the hash of the given name */
+static bool gpt_index_cmp_name(const struct gpt_index_entry_t *entry, const void *name)
+{
+    return entry->name_hash == name_hash((const char *)name);
+}
+
+/* Compare the index entry with the given type */
+static bool gpt_index_cmp_type(const struct gpt_index_entry_t *entry, const void *type)
+{
+    return efi_guid_cmp(&entry->partition_type, (const struct efi_guid_t *)type) == 0;
+}
+
+/* Returns the index comparison matching an entry comparison, if any */
+static gpt_index_cmp_t index_cmp_for(gpt_entry_cmp_t compare)
+{
+    if (compare == gpt_entry_cmp_guid) {
+        return gpt_index_cmp_guid;
+    } else if (compare == gpt_entry_cmp_name) {
+        return gpt_index_cmp_name;
+    } else if (compare == gpt_entry_cmp_type) {
+        return gpt_index_cmp_type;
+    }
+
+    return NULL;
+}
+#endif /* TFM_GPT_INDEX_MAX_ENTRIES > 0 */
+
 /* Read entry with given GUID from given table and return it if found. */
 static psa_status_t find_gpt_entry(const struct gpt_t        *table,
                                    gpt_entry_cmp_t            compare,
@@ -1074,9 +1241,29 @@ static psa_status_t find_gpt_entry(const struct gpt_t        *table,
         return PSA_ERROR_DOES_NOT_EXIST;
     }
 
+#if TFM_GPT_INDEX_MAX_ENTRIES > 0
+    const gpt_index_cmp_t index_compare =
+        (table == &primary_gpt && entry_index_valid) ? index_cmp_for(compare) : NULL;
+    /* Only names are hashed; GUIDs and types are held in full */
+    const bool index_is_exact = (index_compare != NULL) && (compare != gpt_entry_cmp_name);
+#endif
+
     uint32_t num_found = 0;
     bool io_failure = false;
     for (uint32_t i = 0; i < table->num_used_partitions; ++i) {
+#if TFM_GPT_INDEX_MAX_ENTRIES > 0
+        /* Only read the entries the index cannot rule out */
+        if (index_compare != NULL && !index_compare(&entry_index[i], cmp_attr)) {
+            continue;
+        }
+
+        /* Earlier exact matches can be counted without being read */
+        if (index_is_exact && num_found < repeat_index) {
+            ++num_found;
+            continue;
+        }
+#endif
+
         const psa_status_t ret = read_entry_from_flash(table, i, entry);
         if (ret != PSA_SUCCESS) {
             /* This might not have been the partition being sought after anyway,
@@ -1097,55 +1284,256 @@ static psa_status_t find_gpt_entry(const struct gpt_t        *table,
     return io_failure ? PSA_ERROR_STORAGE_FAILURE : PSA_ERROR_DOES_NOT_EXIST;
 }
 
-/* Move a single LBAs data to somewhere else */
-static psa_status_t move_lba(const uint64_t old_lba, const uint64_t new_lba)
+/* Reads consecutive LBAs straight into a buffer, bypassing the cache */
+static psa_status_t read_blocks_from_flash(uint64_t lba, size_t num_blocks, uint8_t *buf)
+{
+    if (plat_flash_driver->read_blocks != NULL) {
+        if (plat_flash_driver->read_blocks(lba, num_blocks, buf) !=
+                (ssize_t)(num_blocks * TFM_GPT_BLOCK_SIZE)) {
+            ERROR("Unable to read %u blocks from flash at block 0x%08x%08x\n",
+                    (uint32_t)num_blocks,
+                    (uint32_t)(lba >> 32),
+                    (uint32_t)lba);
+            return PSA_ERROR_STORAGE_FAILURE;
+        }
+        return PSA_SUCCESS;
+    }
+
+    for (size_t block = 0; block < num_blocks; ++block) {
+        if (plat_flash_driver->read(lba + block, buf + (block * TFM_GPT_BLOCK_SIZE)) !=
+                TFM_GPT_BLOCK_SIZE) {
+            ERROR("Unable to read from flash at block 0x%08x%08x\n",
+                    (uint32_t)((lba + block) >> 32),
+                    (uint32_t)(lba + block));
+            return PSA_ERROR_STORAGE_FAILURE;
+        }
+    }
+
+    return PSA_SUCCESS;
+}
+
+/* Programs consecutive, already erased LBAs from a buffer, bypassing the cache */
+static psa_status_t write_blocks_to_flash(uint64_t lba, size_t num_blocks, const uint8_t *buf)
 {
-    const psa_status_t ret = read_from_flash(old_lba);
+    if (plat_flash_driver->write_blocks != NULL) {
+        if (plat_flash_driver->write_blocks(lba, num_blocks, buf) !=
+                (ssize_t)(num_blocks * TFM_GPT_BLOCK_SIZE)) {
+            ERROR("Unable to program %u blocks of flash at LBA 0x%08x%08x\n",
+                    (uint32_t)num_blocks,
+                    (uint32_t)(lba >> 32),
+                    (uint32_t)lba);
+            return PSA_ERROR_STORAGE_FAILURE;
+        }
+        return PSA_SUCCESS;
+    }
+
+    for (size_t block = 0; block < num_blocks; ++block) {
+        if (plat_flash_driver->write(lba + block, buf + (block * TFM_GPT_BLOCK_SIZE)) !=
+                TFM_GPT_BLOCK_SIZE) {
+            ERROR("Unable to program flash at LBA 0x%08x%08x\n",
+                    (uint32_t)((lba + block) >> 32),
+                    (uint32_t)(lba + block));
+            return PSA_ERROR_STORAGE_FAILURE;
+        }
+    }
+
+    return PSA_SUCCESS;
+}
+
+/* Moves as many consecutive LBAs as fit in the work buffer somewhere else.
+ * The whole source is read before the destination is erased, so the two may
+ * overlap.
+ */
+static psa_status_t move_blocks(const uint64_t old_lba,
+                                const uint64_t new_lba,
+                                const size_t   num_blocks,
+                                uint8_t       *work_buf)
+{
+    psa_status_t ret = read_blocks_from_flash(old_lba, num_blocks, work_buf);
     if (ret != PSA_SUCCESS) {
         return ret;
     }
 
-    return write_to_flash(new_lba);
+    /* Cached copies of the destination no longer match flash */
+    cache_drop_range(new_lba, num_blocks);
+
+    if (plat_flash_driver->erase(new_lba, num_blocks) != (ssize_t)num_blocks) {
+        ERROR("Unable to erase flash at LBA 0x%08x%08x\n",
+                (uint32_t)(new_lba >> 32),
+                (uint32_t)new_lba);
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+    return write_blocks_to_flash(new_lba, num_blocks, work_buf);
 }
 
-/* Moves a partition's data to start from one logical block to another */
+/* Moves a partition's data to start from one logical block to another, as
+ * many blocks at a time as fit in the work buffer. Without a work buffer, a
+ * cache line is borrowed and blocks are moved one at a time.
+ */
 static psa_status_t move_partition(const uint64_t old_lba,
                                    const uint64_t new_lba,
-                                   const uint64_t num_blocks)
+                                   const uint64_t num_blocks,
+                                   uint8_t       *work_buf,
+                                   const size_t   work_buf_blocks)
 {
     if (old_lba == new_lba) {
         return PSA_SUCCESS;
     }
 
-    if (old_lba < new_lba) {
-        /* Move block by block backwards */
-        for (uint64_t block = num_blocks; block > 0; --block) {
-            const psa_status_t ret = move_lba(old_lba + block - 1, new_lba + block - 1);
-            if (ret != PSA_SUCCESS) {
-                return ret;
-            }
+    size_t chunk_blocks = work_buf_blocks;
+    if (work_buf == NULL) {
+        struct lba_cache_line_t *line;
+        const psa_status_t ret = cache_claim_line(&line);
+        if (ret != PSA_SUCCESS) {
+            return ret;
         }
-    } else {
-        /* Move block by block forwards */
-        for (uint64_t block = 0; block < num_blocks; ++block) {
-            const psa_status_t ret = move_lba(old_lba + block, new_lba + block);
-            if (ret != PSA_SUCCESS) {
-                return ret;
-            }
+        work_buf = line->buf;
+        chunk_blocks = 1;
+    }
+
+    uint64_t remaining = num_blocks;
+    while (remaining > 0) {
+        const size_t chunk = (remaining < chunk_blocks) ? (size_t)remaining : chunk_blocks;
+        uint64_t offset;
+
+        if (old_lba < new_lba) {
+            /* Move chunk by chunk backwards */
+            offset = remaining - chunk;
+        } else {
+            /* Move chunk by chunk forwards */
+            offset = num_blocks - remaining;
         }
+
+        const psa_status_t ret = move_blocks(old_lba + offset, new_lba + offset, chunk, work_buf);
+        if (ret != PSA_SUCCESS) {
+            return ret;
+        }
+        remaining -= chunk;
     }
 
-    write_buffered = false;
+    return PSA_SUCCESS;
+}
+
+/* Reads the start LBA and the size in blocks of the partition of an entry */
+static psa_status_t read_entry_extent(uint32_t array_index,
+                                      uint64_t *start,
+                                      uint64_t *num_blocks)
+{
+    struct gpt_entry_t entry;
+    const psa_status_t ret = read_entry_from_flash(&primary_gpt, array_index, &entry);
+    if (ret != PSA_SUCCESS) {
+        return ret;
+    }
+
+    *start = entry.start;
+    *num_blocks = entry.end - entry.start + 1;
 
     return PSA_SUCCESS;
 }
 
+/* Chooses where defragmentation leaves the free space, with the entries sorted
+ * by start LBA. Partitions before the split are packed against the first
+ * usable LBA and the rest against the last usable LBA. Of all such splits, the
+ * one moving the fewest blocks is chosen, so runs already packed at either end
+ * stay put. Ties favour leaving the free space at the end.
+ *
+ * The blocks moved by a split k are start(k) + end_total - end(k), where
+ * start(k) and end(k) count the blocks among the first k partitions that move
+ * when packed against the start and against the end respectively. end_total is
+ * the same for every split, so the split minimising start(k) - end(k) is
+ * chosen. The entries are read through the cache rather than copied, so stack
+ * use does not depend on the number of partitions.
+ */
+static psa_status_t plan_defragment(uint32_t  num_partitions,
+                                    uint32_t *split)
+{
+    uint64_t start;
+    uint64_t num_blocks;
+    uint64_t total_blocks = 0;
+    psa_status_t ret;
+
+    for (uint32_t i = 0; i < num_partitions; ++i) {
+        ret = read_entry_extent(i, &start, &num_blocks);
+        if (ret != PSA_SUCCESS) {
+            return ret;
+        }
+        total_blocks += num_blocks;
+    }
+
+    /* Where the first partition would start when all are packed at the end */
+    uint64_t next_end_start = primary_gpt.header.last_lba + 1 - total_blocks;
+    uint64_t next_start = primary_gpt.header.first_lba;
+    /* start(k) - end(k), offset so that it never goes below zero */
+    uint64_t cost = total_blocks;
+    uint64_t best_cost = cost;
+
+    *split = 0;
+    for (uint32_t i = 0; i < num_partitions; ++i) {
+        ret = read_entry_extent(i, &start, &num_blocks);
+        if (ret != PSA_SUCCESS) {
+            return ret;
+        }
+
+        cost += (start != next_start) ? num_blocks : 0;
+        cost -= (start != next_end_start) ? num_blocks : 0;
+        next_start += num_blocks;
+        next_end_start += num_blocks;
+
+        if (cost <= best_cost) {
+            best_cost = cost;
+            *split = i + 1;
+        }
+    }
+
+    return PSA_SUCCESS;
+}
+
+/* Moves the partition of an entry to start at the given LBA and records that
+ * in the entry, leaving the header to be updated by the caller
+ */
+static psa_status_t relocate_entry(uint32_t       array_index,
+                                   uint64_t       new_start,
+                                   uint8_t       *work_buf,
+                                   const size_t   work_buf_blocks)
+{
+    struct gpt_entry_t entry;
+    psa_status_t ret = read_entry_from_flash(&primary_gpt, array_index, &entry);
+    if (ret != PSA_SUCCESS) {
+        return ret;
+    }
+
+    /* Continue if already where it needs to be */
+    if (entry.start == new_start) {
+        return PSA_SUCCESS;
+    }
+
+    const uint64_t num_blocks = entry.end - entry.start + 1;
+    ret = move_partition(entry.start, new_start, num_blocks, work_buf, work_buf_blocks);
+    if (ret != PSA_SUCCESS) {
+        return ret;
+    }
+
+    entry.start = new_start;
+    entry.end = entry.start + num_blocks - 1;
+
+    return write_entry(array_index, &entry, true);
+}
+
 /* Updates the header of the GPT based on new number of partitions */
 static psa_status_t update_header(uint32_t num_partitions)
 {
     primary_gpt.num_used_partitions = num_partitions;
     struct gpt_header_t *header = &(primary_gpt.header);
 
+    /* The CRC is taken over the cached partition array, so write any modified
+     * LBAs first for the headers to match what is on flash
+     */
+    psa_status_t ret = write_back_lines();
+    if (ret != PSA_SUCCESS) {
+        return ret;
+    }
+
     /* Take the CRC of the partition array */
     uint32_t crc = 0;
     for (uint32_t i = 0; i < header->num_partitions; ++i) {
@@ -1153,7 +1541,7 @@ static psa_status_t update_header(uint32_t num_partitions)
         memset(entry_buf, 0, GPT_ENTRY_SIZE);
         struct gpt_entry_t *entry = (struct gpt_entry_t *)entry_buf;
 
-        psa_status_t ret = read_entry_from_flash(&primary_gpt, i, entry);
+        ret = read_entry_from_flash(&primary_gpt, i, entry);
         if (ret != PSA_SUCCESS) {
             return ret;
         }
@@ -1172,7 +1560,7 @@ static psa_status_t update_header(uint32_t num_partitions)
     backup_crc32 = efi_soft_crc32_update(0, (uint8_t *)&backup_header, GPT_HEADER_SIZE);
 
     /* Write headers */
-    const psa_status_t ret = write_headers_to_flash();
+    ret = write_headers_to_flash();
     if (ret != PSA_SUCCESS) {
         ERROR("Unable to write headers to flash\n");
         return ret;
@@ -1186,16 +1574,18 @@ static psa_status_t mbr_load(struct mbr_t *mbr)
 {
     /* Read the beginning of the first block of flash, which will contain either
      * a legacy MBR or a protective MBR (in the case of GPT). The first
-     * MBR_UNUSED_BYTES are unused and so do not need to be considered.
+     * MBR_UNUSED_BYTES are unused and so do not need to be considered. The
+     * cache is empty at this point, so the current line is free to use as a
+     * buffer.
      */
-    ssize_t ret = plat_flash_driver->read(MBR_LBA, lba_buf);
+    ssize_t ret = plat_flash_driver->read(MBR_LBA, cur_line->buf);
     if (ret != TFM_GPT_BLOCK_SIZE) {
         ERROR("Unable to read from flash at block 0x%08x%08x\n",
                 (uint32_t)(MBR_LBA >> 32),
                 (uint32_t)MBR_LBA);
         return PSA_ERROR_STORAGE_FAILURE;
     }
-    memcpy(mbr, lba_buf + MBR_UNUSED_BYTES, sizeof(*mbr));
+    memcpy(mbr, cur_line->buf + MBR_UNUSED_BYTES, sizeof(*mbr));
 
     /* Check MBR boot signature */
     if (mbr->sig != MBR_SIG) {
@@ -1206,30 +1596,149 @@ static psa_status_t mbr_load(struct mbr_t *mbr)
     return PSA_SUCCESS;
 }
 
-/* Reads an LBA from the flash device and caches it. If the requested LBA is
- * already cached, this is a no-op
+/* Returns the cache line holding the given LBA, or NULL if it is not cached */
+static struct lba_cache_line_t *cache_lookup(uint64_t lba)
+{
+    if (lba == 0) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < TFM_GPT_CACHE_NUM_LBAS; ++i) {
+        if (lba_cache[i].lba == lba) {
+            return &lba_cache[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* Returns the line to read a new LBA into: an unused line if there is one,
+ * otherwise the least recently used
+ */
+static struct lba_cache_line_t *cache_victim(void)
+{
+    struct lba_cache_line_t *victim = &lba_cache[0];
+
+    for (uint32_t i = 0; i < TFM_GPT_CACHE_NUM_LBAS; ++i) {
+        if (lba_cache[i].lba == 0) {
+            return &lba_cache[i];
+        }
+        if ((uint32_t)(lba_cache_clock - lba_cache[i].last_used) >
+                (uint32_t)(lba_cache_clock - victim->last_used)) {
+            victim = &lba_cache[i];
+        }
+    }
+
+    return victim;
+}
+
+/* Returns true if any cached LBA has not been written to flash */
+static bool cache_is_dirty(void)
+{
+    for (uint32_t i = 0; i < TFM_GPT_CACHE_NUM_LBAS; ++i) {
+        if (lba_cache[i].dirty) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Forgets every cached LBA, including any that have not been written */
+static void cache_invalidate(void)
+{
+    for (uint32_t i = 0; i < TFM_GPT_CACHE_NUM_LBAS; ++i) {
+        lba_cache[i].lba = 0;
+        lba_cache[i].dirty = false;
+    }
+    cur_line = &lba_cache[0];
+}
+
+/* Forgets the cached copies of an LBA other than keep, as the LBA is being
+ * overwritten on flash from another buffer
+ */
+static void cache_drop_copies(uint64_t lba, const struct lba_cache_line_t *keep)
+{
+    for (uint32_t i = 0; i < TFM_GPT_CACHE_NUM_LBAS; ++i) {
+        if (&lba_cache[i] != keep && lba_cache[i].lba == lba) {
+            lba_cache[i].lba = 0;
+            lba_cache[i].dirty = false;
+        }
+    }
+}
+
+/* Forgets any cached copies of a range of LBAs */
+static void cache_drop_range(uint64_t lba, uint64_t num_blocks)
+{
+    for (uint32_t i = 0; i < TFM_GPT_CACHE_NUM_LBAS; ++i) {
+        if (lba_cache[i].lba >= lba && lba_cache[i].lba - lba < num_blocks) {
+            lba_cache[i].lba = 0;
+            lba_cache[i].dirty = false;
+        }
+    }
+}
+
+/* Takes a line out of the cache so that its buffer can be used for other I/O.
+ * The line is free for reuse by the cache on the next read.
+ */
+static psa_status_t cache_claim_line(struct lba_cache_line_t **line)
+{
+    struct lba_cache_line_t *victim = cache_victim();
+    if (victim->dirty) {
+        const psa_status_t ret = flush_lba_buf();
+        if (ret != PSA_SUCCESS) {
+            return ret;
+        }
+        victim = cache_victim();
+    }
+
+    victim->lba = 0;
+    victim->dirty = false;
+    *line = victim;
+
+    return PSA_SUCCESS;
+}
+
+/* Reads an LBA from the flash device and caches it, making it the current line.
+ * If the requested LBA is already cached, no I/O is performed
  */
 static psa_status_t read_from_flash(uint64_t required_lba)
 {
-    if (required_lba != cached_lba) {
-        if (write_buffered && cached_lba != 0) {
+    struct lba_cache_line_t *line = cache_lookup(required_lba);
+
+    if (line == NULL) {
+        line = cache_victim();
+        if (line->dirty) {
+            /* Flushing writes every modified LBA and then reads the partition
+             * array to update the header, so look again afterwards
+             */
             psa_status_t ret = flush_lba_buf();
             if (ret != PSA_SUCCESS) {
                 return ret;
             }
+            line = cache_lookup(required_lba);
+            if (line == NULL) {
+                line = cache_victim();
+            }
         }
-        write_buffered = false;
 
-        ssize_t ret = plat_flash_driver->read(required_lba, lba_buf);
-        if (ret != TFM_GPT_BLOCK_SIZE) {
-            ERROR("Unable to read from flash at block 0x%08x%08x\n",
-                    (uint32_t)(required_lba >> 32),
-                    (uint32_t)required_lba);
-            return PSA_ERROR_STORAGE_FAILURE;
+        if (line->lba != required_lba) {
+            ssize_t ret = plat_flash_driver->read(required_lba, line->buf);
+            if (ret != TFM_GPT_BLOCK_SIZE) {
+                ERROR("Unable to read from flash at block 0x%08x%08x\n",
+                        (uint32_t)(required_lba >> 32),
+                        (uint32_t)required_lba);
+                line->lba = 0;
+                return PSA_ERROR_STORAGE_FAILURE;
+            }
+            line->lba = required_lba;
+            line->dirty = false;
         }
-        cached_lba = required_lba;
     }
 
+    line->last_used = ++lba_cache_clock;
+    cur_line = line;
+
     return PSA_SUCCESS;
 }
 
@@ -1256,6 +1765,7 @@ static uint64_t inline partition_array_last_lba(const struct gpt_t *table)
 static psa_status_t count_used_partitions(const struct gpt_t *table,
                                           uint32_t *num_used)
 {
+    *num_used = 0;
     for (uint32_t i = 0; i < table->header.num_partitions; ++i) {
         struct gpt_entry_t entry = {0};
         const psa_status_t ret = read_entry_from_flash(table, i, &entry);
@@ -1267,11 +1777,25 @@ static psa_status_t count_used_partitions(const struct gpt_t *table,
         const struct efi_guid_t entry_guid = entry.partition_type;
         if (efi_guid_cmp(&null_guid, &entry_guid) == 0) {
             *num_used = i;
-            return PSA_SUCCESS;
+            break;
+        }
+
+#if TFM_GPT_INDEX_MAX_ENTRIES > 0
+        /* Index the primary array whilst it is being read anyway */
+        if (table == &primary_gpt) {
+            index_set(i, &entry);
         }
+#endif
+
+        *num_used = i + 1;
     }
 
-    *num_used = table->header.num_partitions;
+#if TFM_GPT_INDEX_MAX_ENTRIES > 0
+    if (table == &primary_gpt) {
+        entry_index_valid = (*num_used <= TFM_GPT_INDEX_MAX_ENTRIES);
+    }
+#endif
+
     return PSA_SUCCESS;
 }
 
@@ -1288,7 +1812,7 @@ static psa_status_t read_entry_from_flash(const struct gpt_t *table,
 
     memcpy(
             entry,
-            lba_buf + ((array_index % gpt_entry_per_lba_count()) * GPT_ENTRY_SIZE),
+            cur_line->buf + ((array_index % gpt_entry_per_lba_count()) * GPT_ENTRY_SIZE),
             GPT_ENTRY_SIZE);
 
     return PSA_SUCCESS;
@@ -1307,58 +1831,30 @@ static psa_status_t read_table_from_flash(struct gpt_t *table, bool is_primary)
         return ret;
     }
 
-    memcpy(&(table->header), lba_buf, GPT_HEADER_SIZE);
+    memcpy(&(table->header), cur_line->buf, GPT_HEADER_SIZE);
 
     return PSA_SUCCESS;
 }
 
-/* Writes the in-memory LBA buffer to flash, taking care of multiple writes if
- * needed.
+/* Writes every modified LBA in the cache to flash, updating the headers to
+ * match. Nothing is written if no LBA has been modified.
  */
 static psa_status_t flush_lba_buf(void)
 {
-    /* Prevent recursive calls, as the various writes below may attempt to
-     * flush, particularly those making multiple writes
-     */
-    static bool in_flush = false;
-    if (in_flush) {
+    if (!cache_is_dirty()) {
         return PSA_SUCCESS;
     }
-    in_flush = true;
-    write_buffered = false;
-    psa_status_t ret = PSA_SUCCESS;
-
-    /* Commit to flash what is in the buffer. Also update the backup table if
-     * the cached LBA was part of the primary table (or vise-versa)
-     */
-    uint64_t array_size = partition_array_last_lba(&primary_gpt) - primary_gpt.header.array_lba + 1;
 
-    if (cached_lba == PRIMARY_GPT_LBA || (backup_gpt_lba != 0 && cached_lba == backup_gpt_lba)) {
-        /* Write both backup and primary headers */
-        ret = write_headers_to_flash();
-    } else if (PRIMARY_GPT_ARRAY_LBA <= cached_lba &&
-            cached_lba <= partition_array_last_lba(&primary_gpt))
-    {
-        /* Primary array entry. Write to backup and primary array */
-        ret = write_entries_to_flash(cached_lba - PRIMARY_GPT_ARRAY_LBA, false);
-    } else if (backup_gpt_array_lba != 0 &&
-            backup_gpt_array_lba <= cached_lba &&
-            cached_lba <= backup_gpt_array_lba + array_size - 1)
-    {
-        /* Backup array entry. Write to backup and primary array */
-        ret = write_entries_to_flash(cached_lba - backup_gpt_array_lba, false);
-    } else {
-        /* Some other LBA is cached, possibly data. Write it anyway */
-        ret = write_to_flash(cached_lba);
-    }
-
-    in_flush = false;
-    return ret;
+    /* Updating the header writes the modified LBAs first */
+    return update_header(primary_gpt.num_used_partitions);
 }
 
-/* Write to the flash at the specified LBA */
-static psa_status_t write_to_flash(uint64_t lba)
+/* Write the contents of a cache line to the flash at the specified LBA */
+static psa_status_t write_line_to_flash(uint64_t lba, const struct lba_cache_line_t *line)
 {
+    /* Other copies of the LBA no longer match flash */
+    cache_drop_copies(lba, line);
+
     if (plat_flash_driver->erase(lba, 1) != 1) {
         ERROR("Unable to erase flash at LBA 0x%08x%08x\n",
                 (uint32_t)(lba >> 32),
@@ -1366,7 +1862,7 @@ static psa_status_t write_to_flash(uint64_t lba)
         return PSA_ERROR_STORAGE_FAILURE;
     }
 
-    if (plat_flash_driver->write(lba, lba_buf) != TFM_GPT_BLOCK_SIZE) {
+    if (plat_flash_driver->write(lba, line->buf) != TFM_GPT_BLOCK_SIZE) {
         ERROR("Unable to program flash at LBA 0x%08x%08x\n",
                 (uint32_t)(lba >> 32),
                 (uint32_t)lba);
@@ -1376,16 +1872,23 @@ static psa_status_t write_to_flash(uint64_t lba)
     return PSA_SUCCESS;
 }
 
-/* Writes the in-memory buffer to both the primary and backup partition arrays.
- * This should only be used when it is certain that the cached lba is part of
- * either the primary or backup partition array
+/* Write the current cache line to the flash at the specified LBA */
+static psa_status_t write_to_flash(uint64_t lba)
+{
+    return write_line_to_flash(lba, cur_line);
+}
+
+/* Writes a cached LBA of the primary partition array to both the primary and
+ * backup partition arrays
  */
-static psa_status_t write_entries_to_flash(uint32_t lbas_into_array, bool no_header_update)
+static psa_status_t write_entries_to_flash(const struct lba_cache_line_t *line,
+                                           bool no_header_update)
 {
+    const uint64_t lbas_into_array = line->lba - PRIMARY_GPT_ARRAY_LBA;
     psa_status_t ret;
 
     if (backup_gpt_array_lba != 0) {
-        ret = write_to_flash(backup_gpt_array_lba + lbas_into_array);
+        ret = write_line_to_flash(backup_gpt_array_lba + lbas_into_array, line);
         if (ret != PSA_SUCCESS) {
             ERROR("Unable to write entry to backup partition array\n");
             return ret;
@@ -1394,7 +1897,7 @@ static psa_status_t write_entries_to_flash(uint32_t lbas_into_array, bool no_hea
         WARN("Backup array LBA unknown!\n");
     }
 
-    ret = write_to_flash(PRIMARY_GPT_ARRAY_LBA + lbas_into_array);
+    ret = write_line_to_flash(PRIMARY_GPT_ARRAY_LBA + lbas_into_array, line);
     if (ret != PSA_SUCCESS) {
         ERROR("Unable to write entry to primary partition array\n");
         return ret;
@@ -1411,6 +1914,26 @@ static psa_status_t write_entries_to_flash(uint32_t lbas_into_array, bool no_hea
     return PSA_SUCCESS;
 }
 
+/* Writes every modified LBA of the primary partition array in the cache to both
+ * partition arrays, without updating the headers
+ */
+static psa_status_t write_back_lines(void)
+{
+    for (uint32_t i = 0; i < TFM_GPT_CACHE_NUM_LBAS; ++i) {
+        if (!lba_cache[i].dirty) {
+            continue;
+        }
+
+        lba_cache[i].dirty = false;
+        const psa_status_t ret = write_entries_to_flash(&lba_cache[i], true);
+        if (ret != PSA_SUCCESS) {
+            return ret;
+        }
+    }
+
+    return PSA_SUCCESS;
+}
+
 /* Writes a GPT entry to flash or the in-memory buffer. The buffer is flushed
  * to both the primary and backup partition entry arrays ocassionally. When the
  * buffer is flushed, the header is updated unless no_header_update is true.
@@ -1435,20 +1958,28 @@ static psa_status_t write_entry(uint32_t                  array_index,
 
     /* Copy into buffer */
     uint32_t index_in_lba = array_index % gpt_entry_per_lba_count();
-    memcpy(lba_buf + index_in_lba * GPT_ENTRY_SIZE, entry, GPT_ENTRY_SIZE);
+    memcpy(cur_line->buf + index_in_lba * GPT_ENTRY_SIZE, entry, GPT_ENTRY_SIZE);
+
+#if TFM_GPT_INDEX_MAX_ENTRIES > 0
+    if (array_index < TFM_GPT_INDEX_MAX_ENTRIES) {
+        index_set(array_index, entry);
+    } else {
+        entry_index_valid = false;
+    }
+#endif
 
     /* Write on every nth operation. */
     if (++num_writes == gpt_entry_per_lba_count()) {
         /* Write the buffer to flash */
         num_writes = 0;
-        write_buffered = false;
+        cur_line->dirty = false;
 
-        ret = write_entries_to_flash(cached_lba - PRIMARY_GPT_ARRAY_LBA, no_header_update);
+        ret = write_entries_to_flash(cur_line, no_header_update);
         if (ret != PSA_SUCCESS) {
             return ret;
         }
     } else {
-        write_buffered = true;
+        cur_line->dirty = true;
     }
 
     return PSA_SUCCESS;
@@ -1461,10 +1992,14 @@ static psa_status_t write_header_to_flash(const struct gpt_t *table)
      * also in memory, there is no need to read it again before writing.
      */
     uint8_t temp_buf[GPT_HEADER_SIZE];
-    memcpy(temp_buf, lba_buf, GPT_HEADER_SIZE);
-    memcpy(lba_buf, &(table->header), GPT_HEADER_SIZE);
+    memcpy(temp_buf, cur_line->buf, GPT_HEADER_SIZE);
+    memcpy(cur_line->buf, &(table->header), GPT_HEADER_SIZE);
     const psa_status_t ret = write_to_flash(table->header.current_lba);
-    memcpy(lba_buf, temp_buf, GPT_HEADER_SIZE);
+
+    /* Keep the new header if the buffer holds that LBA */
+    if (cur_line->lba != table->header.current_lba) {
+        memcpy(cur_line->buf, temp_buf, GPT_HEADER_SIZE);
+    }
 
     return ret;
 }
@@ -1713,7 +2248,9 @@ static psa_status_t restore_table(struct gpt_t *restore_from, bool is_primary)
             restore_from->header.array_lba,
             restore_to.header.array_lba,
             (restore_from->header.num_partitions +
-             gpt_entry_per_lba_count() - 1) / gpt_entry_per_lba_count());
+             gpt_entry_per_lba_count() - 1) / gpt_entry_per_lba_count(),
+            NULL,
+            0);
     if (ret != PSA_SUCCESS) {
         return ret;
     }
@@ -1729,6 +2266,14 @@ static psa_status_t restore_table(struct gpt_t *restore_from, bool is_primary)
     if (!is_primary) {
         memcpy(&(primary_gpt.header), &(restore_to.header), GPT_HEADER_SIZE);
         primary_gpt.num_used_partitions = restore_from->num_used_partitions;
+
+#if TFM_GPT_INDEX_MAX_ENTRIES > 0
+        /* Rebuild the index from the restored partition array */
+        ret = count_used_partitions(&primary_gpt, &primary_gpt.num_used_partitions);
+        if (ret != PSA_SUCCESS) {
+            return ret;
+        }
+#endif
     }
 
     INFO("Successfully restored %s GPT table\n", is_primary ? "backup" : "primary");
@@ -29,4 +29,6 @@ list(APPEND MOCK_HEADERS ${TFM_ROOT_DIR}/lib/ext/efi_soft_crc/inc/efi_soft_crc.h
 # Compile-time definitions
 list(APPEND UNIT_TEST_COMPILE_DEFS LOG_LEVEL=LOG_LEVEL_VERBOSE)
 list(APPEND UNIT_TEST_COMPILE_DEFS TFM_GPT_BLOCK_SIZE=512)
+# These tests mock reads in order, so only a single block may be cached
+list(APPEND UNIT_TEST_COMPILE_DEFS TFM_GPT_CACHE_NUM_LBAS=1)
 
@@ -0,0 +1,482 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "unity.h"
+
+#include "mock_efi_guid.h"
+#include "mock_efi_soft_crc.h"
+#include "mock_tfm_log.h"
+#include "mock_tfm_vprintf.h"
+
+#include "efi_guid_structs.h"
+#include "gpt_flash.h"
+#include "gpt.h"
+#include "psa/error.h"
+
+/* These tests check how often the library goes to flash, so they run against
+ * a RAM disk rather than a sequence of mocked reads. The build sets
+ * TFM_GPT_CACHE_NUM_LBAS to 2 and TFM_GPT_INDEX_MAX_ENTRIES to
+ * TEST_INDEX_MAX_ENTRIES.
+ */
+#define TEST_BLOCK_SIZE 512
+#define TEST_DISK_NUM_BLOCKS 128
+#define TEST_ENTRY_SIZE 128
+#define TEST_ENTRIES_PER_LBA (TEST_BLOCK_SIZE / TEST_ENTRY_SIZE)
+#define TEST_MAX_PARTITIONS 16
+#define TEST_NUM_PARTITIONS 10
+#define TEST_INDEX_MAX_ENTRIES 12
+#define TEST_ARRAY_NUM_LBAS (TEST_MAX_PARTITIONS / TEST_ENTRIES_PER_LBA)
+
+/* Disk layout */
+#define TEST_MBR_LBA 0
+#define TEST_MBR_SIG 0xAA55
+#define TEST_MBR_SIG_OFFSET 510
+#define TEST_MBR_OS_TYPE_OFFSET 450
+#define TEST_MBR_TYPE_GPT 0xEE
+#define TEST_GPT_SIG_INITIALISER {'E', 'F', 'I', ' ', 'P', 'A', 'R', 'T'}
+#define TEST_GPT_REVISION 0x00010000
+#define TEST_GPT_HEADER_SIZE 92
+#define TEST_GPT_CRC32 42
+#define TEST_GPT_PRIMARY_LBA 1
+#define TEST_GPT_BACKUP_LBA (TEST_DISK_NUM_BLOCKS - 1)
+#define TEST_GPT_ARRAY_LBA (TEST_GPT_PRIMARY_LBA + 1)
+#define TEST_GPT_BACKUP_ARRAY_LBA (TEST_GPT_BACKUP_LBA - TEST_ARRAY_NUM_LBAS)
+#define TEST_GPT_FIRST_USABLE_LBA (TEST_GPT_ARRAY_LBA + TEST_ARRAY_NUM_LBAS)
+#define TEST_GPT_LAST_USABLE_LBA (TEST_GPT_BACKUP_ARRAY_LBA - 1)
+#define TEST_GPT_DISK_GUID MAKE_EFI_GUID(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11)
+
+/* Each test partition is this many blocks long, laid out back to back */
+#define TEST_PARTITION_NUM_LBAS 4
+#define TEST_PARTITION_START(i) \
+    (TEST_GPT_FIRST_USABLE_LBA + ((i) * TEST_PARTITION_NUM_LBAS))
+
+/* A gpt partition entry */
+struct gpt_entry_t {
+    struct efi_guid_t type;             /* Partition type */
+    struct efi_guid_t guid;             /* Unique GUID */
+    uint64_t start;                     /* Starting LBA for partition */
+    uint64_t end;                       /* Ending LBA for partition */
+    uint64_t attr;                      /* Attribute bits */
+    char name[GPT_ENTRY_NAME_LENGTH];   /* Human readable name for partition */
+} __attribute__((packed));
+
+/* The gpt header */
+struct gpt_header_t {
+    char signature[8];                  /* "EFI PART" */
+    uint32_t revision;                  /* Revision number. */
+    uint32_t size;                      /* Size of this header */
+    uint32_t header_crc;                /* CRC of this header */
+    uint32_t reserved;                  /* Reserved */
+    uint64_t current_lba;               /* LBA of this header */
+    uint64_t backup_lba;                /* LBA of backup GPT header */
+    uint64_t first_lba;                 /* First usable LBA */
+    uint64_t last_lba;                  /* Last usable LBA */
+    struct efi_guid_t disk_guid;        /* Disk GUID */
+    uint64_t array_lba;                 /* First LBA of array of partition entries */
+    uint32_t num_partitions;            /* Number of partition entries in array */
+    uint32_t entry_size;                /* Size of a single partition entry */
+    uint32_t array_crc;                 /* CRC of partition entry array */
+} __attribute__((packed));
+
+static ssize_t test_driver_read(uint64_t lba, void *buf);
+static ssize_t test_driver_write(uint64_t lba, const void *buf);
+static ssize_t test_driver_erase(uint64_t lba, size_t num_blocks);
+
+/* LBA driver used in test module */
+static struct gpt_flash_driver_t ram_driver = {
+    .init = NULL,
+    .uninit = NULL,
+    .read = test_driver_read,
+    .write = test_driver_write,
+    .erase = test_driver_erase,
+};
+
+/* The disk, and how often each driver function has been called */
+static uint8_t ram_disk[TEST_DISK_NUM_BLOCKS][TEST_BLOCK_SIZE];
+static unsigned int num_reads;
+static unsigned int num_writes;
+static unsigned int num_erases;
+
+static ssize_t test_driver_read(uint64_t lba, void *buf)
+{
+    if (lba >= TEST_DISK_NUM_BLOCKS) {
+        return -1;
+    }
+
+    num_reads++;
+    memcpy(buf, ram_disk[lba], TEST_BLOCK_SIZE);
+    return TEST_BLOCK_SIZE;
+}
+
+static ssize_t test_driver_write(uint64_t lba, const void *buf)
+{
+    if (lba >= TEST_DISK_NUM_BLOCKS) {
+        return -1;
+    }
+
+    num_writes++;
+    memcpy(ram_disk[lba], buf, TEST_BLOCK_SIZE);
+    return TEST_BLOCK_SIZE;
+}
+
+static ssize_t test_driver_erase(uint64_t lba, size_t num_blocks)
+{
+    if ((lba + num_blocks) > TEST_DISK_NUM_BLOCKS) {
+        return -1;
+    }
+
+    num_erases++;
+    memset(ram_disk[lba], 0xFF, num_blocks * TEST_BLOCK_SIZE);
+    return num_blocks;
+}
+
+static void reset_counters(void)
+{
+    num_reads = 0;
+    num_writes = 0;
+    num_erases = 0;
+}
+
+/* Turn ascii string to unicode */
+static void ascii_to_unicode(const char *ascii, char *unicode)
+{
+    memset(unicode, 0, GPT_ENTRY_NAME_LENGTH);
+    for (int i = 0; i < strlen(ascii) + 1; ++i) {
+        unicode[i << 1] = ascii[i];
+        unicode[(i << 1) + 1] = '\0';
+    }
+}
+
+/* Partitions are spread over three types so that lookups by type have to skip
+ * over entries
+ */
+static struct efi_guid_t test_type(unsigned int i)
+{
+    struct efi_guid_t type = MAKE_EFI_GUID(0x100, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11);
+    type.time_low += i % 3;
+    return type;
+}
+
+static struct efi_guid_t test_guid(unsigned int i)
+{
+    struct efi_guid_t guid = MAKE_EFI_GUID(0, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11);
+    guid.time_low += i + 1;
+    return guid;
+}
+
+static void test_name(unsigned int i, char name[GPT_ENTRY_NAME_LENGTH])
+{
+    char ascii[GPT_ENTRY_NAME_LENGTH / 2];
+    snprintf(ascii, sizeof(ascii), "Partition %u", i);
+    ascii_to_unicode(ascii, name);
+}
+
+static void make_test_entry(unsigned int i, struct gpt_entry_t *entry)
+{
+    memset(entry, 0, sizeof(*entry));
+    entry->type = test_type(i);
+    entry->guid = test_guid(i);
+    entry->start = TEST_PARTITION_START(i);
+    entry->end = entry->start + TEST_PARTITION_NUM_LBAS - 1;
+    entry->attr = 0;
+    test_name(i, entry->name);
+}
+
+/* Returns the entry at the given index of the array on the disk */
+static struct gpt_entry_t *disk_entry(uint64_t array_lba, unsigned int i)
+{
+    return (struct gpt_entry_t *)
+           &ram_disk[array_lba + (i / TEST_ENTRIES_PER_LBA)]
+                    [(i % TEST_ENTRIES_PER_LBA) * TEST_ENTRY_SIZE];
+}
+
+/* Formats the disk with a protective MBR, both headers and the test entries */
+static void format_disk(void)
+{
+    struct gpt_header_t header = {
+        .signature = TEST_GPT_SIG_INITIALISER,
+        .revision = TEST_GPT_REVISION,
+        .size = TEST_GPT_HEADER_SIZE,
+        .header_crc = TEST_GPT_CRC32,
+        .reserved = 0,
+        .current_lba = TEST_GPT_PRIMARY_LBA,
+        .backup_lba = TEST_GPT_BACKUP_LBA,
+        .first_lba = TEST_GPT_FIRST_USABLE_LBA,
+        .last_lba = TEST_GPT_LAST_USABLE_LBA,
+        .disk_guid = TEST_GPT_DISK_GUID,
+        .array_lba = TEST_GPT_ARRAY_LBA,
+        .num_partitions = TEST_MAX_PARTITIONS,
+        .entry_size = TEST_ENTRY_SIZE,
+        .array_crc = TEST_GPT_CRC32
+    };
+    uint16_t mbr_sig = TEST_MBR_SIG;
+
+    memset(ram_disk, 0, sizeof(ram_disk));
+
+    ram_disk[TEST_MBR_LBA][TEST_MBR_OS_TYPE_OFFSET] = TEST_MBR_TYPE_GPT;
+    memcpy(&ram_disk[TEST_MBR_LBA][TEST_MBR_SIG_OFFSET], &mbr_sig, sizeof(mbr_sig));
+
+    memcpy(ram_disk[TEST_GPT_PRIMARY_LBA], &header, sizeof(header));
+
+    header.current_lba = TEST_GPT_BACKUP_LBA;
+    header.backup_lba = TEST_GPT_PRIMARY_LBA;
+    header.array_lba = TEST_GPT_BACKUP_ARRAY_LBA;
+    memcpy(ram_disk[TEST_GPT_BACKUP_LBA], &header, sizeof(header));
+
+    for (unsigned int i = 0; i < TEST_NUM_PARTITIONS; ++i) {
+        make_test_entry(i, disk_entry(TEST_GPT_ARRAY_LBA, i));
+        make_test_entry(i, disk_entry(TEST_GPT_BACKUP_ARRAY_LBA, i));
+    }
+}
+
+/* Checks a partition returned by the library against the test entry it came
+ * from
+ */
+static void check_partition(unsigned int i, const struct partition_entry_t *partition)
+{
+    struct gpt_entry_t expected;
+    make_test_entry(i, &expected);
+
+    TEST_ASSERT_EQUAL_MEMORY(&expected.guid, &partition->partition_guid, sizeof(expected.guid));
+    TEST_ASSERT_EQUAL_MEMORY(&expected.type, &partition->type_guid, sizeof(expected.type));
+    TEST_ASSERT_EQUAL_MEMORY(expected.name, partition->name, GPT_ENTRY_NAME_LENGTH);
+    TEST_ASSERT_EQUAL(expected.start, partition->start);
+    TEST_ASSERT_EQUAL(TEST_PARTITION_NUM_LBAS, partition->size);
+}
+
+void setUp(void)
+{
+    /* Any time this is called, return the same number and ignore the arguments */
+    efi_soft_crc32_update_IgnoreAndReturn(TEST_GPT_CRC32);
+
+    /* Ignore all logging calls */
+    tfm_log_Ignore();
+
+    format_disk();
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_init(&ram_driver, TEST_MAX_PARTITIONS));
+    reset_counters();
+}
+
+void tearDown(void)
+{
+    gpt_uninit();
+}
+
+void test_gpt_cache_entry_read_should_readAtMostOneLbaWhenIndexed(void)
+{
+    struct partition_entry_t partition;
+    struct efi_guid_t guid;
+
+    /* The index says where the entry is, so only its own LBA is read, however
+     * far into the array it is
+     */
+    for (unsigned int i = 0; i < TEST_NUM_PARTITIONS; ++i) {
+        guid = test_guid(i);
+        reset_counters();
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read(&guid, &partition));
+        TEST_ASSERT_LESS_OR_EQUAL(1, num_reads);
+        check_partition(i, &partition);
+
+        /* A repeated lookup is served from the cache */
+        reset_counters();
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read(&guid, &partition));
+        TEST_ASSERT_EQUAL(0, num_reads);
+        check_partition(i, &partition);
+    }
+}
+
+void test_gpt_cache_entry_read_should_notReadFlashWhenEntryDoesNotExist(void)
+{
+    struct partition_entry_t partition;
+    struct efi_guid_t guid = test_guid(TEST_MAX_PARTITIONS);
+    char name[GPT_ENTRY_NAME_LENGTH];
+    struct efi_guid_t type = test_type(0);
+
+    TEST_ASSERT_EQUAL(PSA_ERROR_DOES_NOT_EXIST, gpt_entry_read(&guid, &partition));
+    TEST_ASSERT_EQUAL(0, num_reads);
+
+    test_name(TEST_MAX_PARTITIONS, name);
+    TEST_ASSERT_EQUAL(PSA_ERROR_DOES_NOT_EXIST, gpt_entry_read_by_name(name, 0, &partition));
+    TEST_ASSERT_EQUAL(0, num_reads);
+
+    /* Types repeat every third partition */
+    TEST_ASSERT_EQUAL(PSA_ERROR_DOES_NOT_EXIST,
+                      gpt_entry_read_by_type(&type, (TEST_NUM_PARTITIONS + 2) / 3, &partition));
+    TEST_ASSERT_EQUAL(0, num_reads);
+}
+
+void test_gpt_cache_entry_read_by_name_should_findEntry(void)
+{
+    struct partition_entry_t partition;
+    char name[GPT_ENTRY_NAME_LENGTH];
+
+    for (unsigned int i = 0; i < TEST_NUM_PARTITIONS; ++i) {
+        test_name(i, name);
+        reset_counters();
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read_by_name(name, 0, &partition));
+        TEST_ASSERT_LESS_OR_EQUAL(1, num_reads);
+        check_partition(i, &partition);
+    }
+}
+
+void test_gpt_cache_entry_read_by_type_should_findEachMatch(void)
+{
+    struct partition_entry_t partition;
+    struct efi_guid_t type = test_type(1);
+
+    /* Partitions 1, 4 and 7 share the second type */
+    for (unsigned int n = 0; n < 3; ++n) {
+        reset_counters();
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read_by_type(&type, n, &partition));
+        TEST_ASSERT_LESS_OR_EQUAL(1, num_reads);
+        check_partition(1 + (3 * n), &partition);
+    }
+}
+
+void test_gpt_cache_entry_read_should_notRereadWhenAlternatingLbas(void)
+{
+    struct partition_entry_t partition;
+    struct efi_guid_t first = test_guid(0);
+    struct efi_guid_t last = test_guid(TEST_NUM_PARTITIONS - 1);
+
+    /* The two entries live in different LBAs which both fit in the cache */
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read(&first, &partition));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read(&last, &partition));
+    reset_counters();
+
+    for (unsigned int i = 0; i < 8; ++i) {
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read(&first, &partition));
+        check_partition(0, &partition);
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read(&last, &partition));
+        check_partition(TEST_NUM_PARTITIONS - 1, &partition);
+    }
+    TEST_ASSERT_EQUAL(0, num_reads);
+}
+
+void test_gpt_cache_attr_set_should_beVisibleBeforeAndAfterFlush(void)
+{
+    struct partition_entry_t partition;
+    struct efi_guid_t guid = test_guid(5);
+    const uint64_t attr = 0x5;
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_attr_set(&guid, attr));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read(&guid, &partition));
+    TEST_ASSERT_EQUAL(attr, partition.attr);
+
+    /* The change is held in the cache rather than written straight away */
+    TEST_ASSERT_EQUAL(0, num_writes);
+    TEST_ASSERT_EQUAL(0, num_erases);
+
+    /* Uninitialising writes back whatever is still buffered */
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_uninit());
+    TEST_ASSERT_EQUAL(attr, disk_entry(TEST_GPT_ARRAY_LBA, 5)->attr);
+    TEST_ASSERT_EQUAL(attr, disk_entry(TEST_GPT_BACKUP_ARRAY_LBA, 5)->attr);
+}
+
+void test_gpt_cache_attr_set_should_writeBackEvictedLines(void)
+{
+    /* One entry in each LBA holding partitions, which is more LBAs than there
+     * are cache lines
+     */
+    static const unsigned int modified[] = {0, TEST_ENTRIES_PER_LBA, 2 * TEST_ENTRIES_PER_LBA};
+    struct partition_entry_t partition;
+    struct efi_guid_t guid;
+
+    for (unsigned int i = 0; i < 3; ++i) {
+        guid = test_guid(modified[i]);
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_attr_set(&guid, modified[i] + 1));
+    }
+
+    for (unsigned int i = 0; i < 3; ++i) {
+        guid = test_guid(modified[i]);
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read(&guid, &partition));
+        TEST_ASSERT_EQUAL(modified[i] + 1, partition.attr);
+    }
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_uninit());
+    for (unsigned int i = 0; i < 3; ++i) {
+        TEST_ASSERT_EQUAL(modified[i] + 1, disk_entry(TEST_GPT_ARRAY_LBA, modified[i])->attr);
+        TEST_ASSERT_EQUAL(modified[i] + 1,
+                          disk_entry(TEST_GPT_BACKUP_ARRAY_LBA, modified[i])->attr);
+    }
+}
+
+void test_gpt_cache_entry_remove_should_updateIndex(void)
+{
+    struct partition_entry_t partition;
+    struct efi_guid_t guid = test_guid(2);
+    char name[GPT_ENTRY_NAME_LENGTH];
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_remove(&guid));
+
+    reset_counters();
+    TEST_ASSERT_EQUAL(PSA_ERROR_DOES_NOT_EXIST, gpt_entry_read(&guid, &partition));
+    TEST_ASSERT_EQUAL(0, num_reads);
+
+    /* Every other entry is still found, including those that moved down */
+    for (unsigned int i = 0; i < TEST_NUM_PARTITIONS; ++i) {
+        if (i == 2) {
+            continue;
+        }
+        guid = test_guid(i);
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read(&guid, &partition));
+        check_partition(i, &partition);
+
+        test_name(i, name);
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read_by_name(name, 0, &partition));
+        check_partition(i, &partition);
+    }
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_uninit());
+    for (unsigned int i = 2; i < TEST_NUM_PARTITIONS - 1; ++i) {
+        guid = test_guid(i + 1);
+        TEST_ASSERT_EQUAL_MEMORY(&guid, &disk_entry(TEST_GPT_ARRAY_LBA, i)->guid, sizeof(guid));
+        TEST_ASSERT_EQUAL_MEMORY(&guid, &disk_entry(TEST_GPT_BACKUP_ARRAY_LBA, i)->guid,
+                                 sizeof(guid));
+    }
+}
+
+void test_gpt_cache_entry_create_should_fallBackToScanWhenIndexFull(void)
+{
+    struct partition_entry_t partition;
+    struct efi_guid_t type;
+    struct efi_guid_t guid;
+    struct efi_guid_t new_guid;
+    char name[GPT_ENTRY_NAME_LENGTH];
+    unsigned int i;
+
+    /* Fill the array past what the index can hold */
+    for (i = TEST_NUM_PARTITIONS; i <= TEST_INDEX_MAX_ENTRIES; ++i) {
+        type = test_type(i);
+        guid = test_guid(i);
+        test_name(i, name);
+
+        efi_guid_generate_random_ExpectAnyArgsAndReturn(PSA_SUCCESS);
+        efi_guid_generate_random_ReturnThruPtr_guid(&guid);
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_create(&type,
+                                                        TEST_PARTITION_START(i),
+                                                        TEST_PARTITION_NUM_LBAS,
+                                                        0,
+                                                        name,
+                                                        &new_guid));
+        TEST_ASSERT_EQUAL_MEMORY(&guid, &new_guid, sizeof(guid));
+    }
+
+    /* Lookups still find every entry, only by scanning the array instead */
+    for (i = 0; i <= TEST_INDEX_MAX_ENTRIES; ++i) {
+        guid = test_guid(i);
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read(&guid, &partition));
+        check_partition(i, &partition);
+    }
+
+    guid = test_guid(TEST_MAX_PARTITIONS);
+    TEST_ASSERT_EQUAL(PSA_ERROR_DOES_NOT_EXIST, gpt_entry_read(&guid, &partition));
+}
@@ -0,0 +1,482 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <string.h>
+#include <inttypes.h>
+
+#include "unity.h"
+
+#include "mock_efi_guid.h"
+#include "mock_efi_soft_crc.h"
+#include "mock_tfm_log.h"
+#include "mock_tfm_vprintf.h"
+
+#include "efi_guid_structs.h"
+#include "gpt_flash.h"
+#include "gpt.h"
+#include "psa/error.h"
+
+/* These tests run defragmentation against a RAM disk, checking that partition
+ * data survives and counting the driver calls made to move it
+ */
+#define TEST_BLOCK_SIZE 512
+#define TEST_DISK_NUM_BLOCKS 4096
+#define TEST_ENTRY_SIZE 128
+#define TEST_ENTRIES_PER_LBA (TEST_BLOCK_SIZE / TEST_ENTRY_SIZE)
+#define TEST_MAX_PARTITIONS 16
+#define TEST_ARRAY_NUM_LBAS (TEST_MAX_PARTITIONS / TEST_ENTRIES_PER_LBA)
+
+/* Work buffer used unless a test says otherwise */
+#define TEST_WORK_BUF_NUM_BLOCKS 64
+
+/* Disk layout */
+#define TEST_MBR_LBA 0
+#define TEST_MBR_SIG 0xAA55
+#define TEST_MBR_SIG_OFFSET 510
+#define TEST_MBR_OS_TYPE_OFFSET 450
+#define TEST_MBR_TYPE_GPT 0xEE
+#define TEST_GPT_SIG_INITIALISER {'E', 'F', 'I', ' ', 'P', 'A', 'R', 'T'}
+#define TEST_GPT_REVISION 0x00010000
+#define TEST_GPT_HEADER_SIZE 92
+#define TEST_GPT_CRC32 42
+#define TEST_GPT_PRIMARY_LBA 1
+#define TEST_GPT_BACKUP_LBA (TEST_DISK_NUM_BLOCKS - 1)
+#define TEST_GPT_ARRAY_LBA (TEST_GPT_PRIMARY_LBA + 1)
+#define TEST_GPT_BACKUP_ARRAY_LBA (TEST_GPT_BACKUP_LBA - TEST_ARRAY_NUM_LBAS)
+#define TEST_GPT_FIRST_USABLE_LBA (TEST_GPT_ARRAY_LBA + TEST_ARRAY_NUM_LBAS)
+#define TEST_GPT_LAST_USABLE_LBA (TEST_GPT_BACKUP_ARRAY_LBA - 1)
+#define TEST_GPT_DISK_GUID MAKE_EFI_GUID(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11)
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+/* A gpt partition entry */
+struct gpt_entry_t {
+    struct efi_guid_t type;             /* Partition type */
+    struct efi_guid_t guid;             /* Unique GUID */
+    uint64_t start;                     /* Starting LBA for partition */
+    uint64_t end;                       /* Ending LBA for partition */
+    uint64_t attr;                      /* Attribute bits */
+    char name[GPT_ENTRY_NAME_LENGTH];   /* Human readable name for partition */
+} __attribute__((packed));
+
+/* The gpt header */
+struct gpt_header_t {
+    char signature[8];                  /* "EFI PART" */
+    uint32_t revision;                  /* Revision number. */
+    uint32_t size;                      /* Size of this header */
+    uint32_t header_crc;                /* CRC of this header */
+    uint32_t reserved;                  /* Reserved */
+    uint64_t current_lba;               /* LBA of this header */
+    uint64_t backup_lba;                /* LBA of backup GPT header */
+    uint64_t first_lba;                 /* First usable LBA */
+    uint64_t last_lba;                  /* Last usable LBA */
+    struct efi_guid_t disk_guid;        /* Disk GUID */
+    uint64_t array_lba;                 /* First LBA of array of partition entries */
+    uint32_t num_partitions;            /* Number of partition entries in array */
+    uint32_t entry_size;                /* Size of a single partition entry */
+    uint32_t array_crc;                 /* CRC of partition entry array */
+} __attribute__((packed));
+
+/* Where a test partition starts and how many blocks it has */
+struct test_partition_t {
+    uint64_t start;
+    uint64_t size;
+};
+
+/* Driver calls made on blocks inside the usable space, i.e. partition data */
+struct test_data_ops_t {
+    unsigned int reads;
+    unsigned int writes;
+    unsigned int read_blocks;
+    unsigned int write_blocks;
+    unsigned int erases;
+    unsigned int blocks_written;
+};
+
+static ssize_t test_driver_read(uint64_t lba, void *buf);
+static ssize_t test_driver_write(uint64_t lba, const void *buf);
+static ssize_t test_driver_erase(uint64_t lba, size_t num_blocks);
+static ssize_t test_driver_read_blocks(uint64_t lba, size_t num_blocks, void *buf);
+static ssize_t test_driver_write_blocks(uint64_t lba, size_t num_blocks, const void *buf);
+
+/* LBA driver used in test module */
+static struct gpt_flash_driver_t ram_driver = {
+    .init = NULL,
+    .uninit = NULL,
+    .read = test_driver_read,
+    .write = test_driver_write,
+    .erase = test_driver_erase,
+    .read_blocks = test_driver_read_blocks,
+    .write_blocks = test_driver_write_blocks,
+};
+
+static uint8_t ram_disk[TEST_DISK_NUM_BLOCKS][TEST_BLOCK_SIZE];
+static struct test_data_ops_t data_ops;
+static uint8_t work_buf[TEST_WORK_BUF_NUM_BLOCKS * TEST_BLOCK_SIZE];
+
+static bool is_data_lba(uint64_t lba)
+{
+    return lba >= TEST_GPT_FIRST_USABLE_LBA && lba <= TEST_GPT_LAST_USABLE_LBA;
+}
+
+static ssize_t test_driver_read(uint64_t lba, void *buf)
+{
+    if (lba >= TEST_DISK_NUM_BLOCKS) {
+        return -1;
+    }
+
+    data_ops.reads += is_data_lba(lba);
+    memcpy(buf, ram_disk[lba], TEST_BLOCK_SIZE);
+    return TEST_BLOCK_SIZE;
+}
+
+static ssize_t test_driver_write(uint64_t lba, const void *buf)
+{
+    if (lba >= TEST_DISK_NUM_BLOCKS) {
+        return -1;
+    }
+
+    data_ops.writes += is_data_lba(lba);
+    data_ops.blocks_written += is_data_lba(lba);
+    memcpy(ram_disk[lba], buf, TEST_BLOCK_SIZE);
+    return TEST_BLOCK_SIZE;
+}
+
+static ssize_t test_driver_erase(uint64_t lba, size_t num_blocks)
+{
+    if ((lba + num_blocks) > TEST_DISK_NUM_BLOCKS) {
+        return -1;
+    }
+
+    data_ops.erases += is_data_lba(lba);
+    memset(ram_disk[lba], 0xFF, num_blocks * TEST_BLOCK_SIZE);
+    return num_blocks;
+}
+
+static ssize_t test_driver_read_blocks(uint64_t lba, size_t num_blocks, void *buf)
+{
+    if ((lba + num_blocks) > TEST_DISK_NUM_BLOCKS) {
+        return -1;
+    }
+
+    data_ops.read_blocks += is_data_lba(lba);
+    memcpy(buf, ram_disk[lba], num_blocks * TEST_BLOCK_SIZE);
+    return num_blocks * TEST_BLOCK_SIZE;
+}
+
+static ssize_t test_driver_write_blocks(uint64_t lba, size_t num_blocks, const void *buf)
+{
+    if ((lba + num_blocks) > TEST_DISK_NUM_BLOCKS) {
+        return -1;
+    }
+
+    data_ops.write_blocks += is_data_lba(lba);
+    data_ops.blocks_written += is_data_lba(lba) ? num_blocks : 0;
+    memcpy(ram_disk[lba], buf, num_blocks * TEST_BLOCK_SIZE);
+    return num_blocks * TEST_BLOCK_SIZE;
+}
+
+static struct efi_guid_t test_guid(unsigned int i)
+{
+    struct efi_guid_t guid = MAKE_EFI_GUID(0, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11);
+    guid.time_low += i + 1;
+    return guid;
+}
+
+/* Every block of partition data is tagged with its partition and offset */
+static uint32_t block_tag(unsigned int partition, uint64_t block)
+{
+    return ((uint32_t)partition << 16) | (uint32_t)block;
+}
+
+/* Returns the entry at the given index of the array on the disk */
+static struct gpt_entry_t *disk_entry(uint64_t array_lba, unsigned int i)
+{
+    return (struct gpt_entry_t *)
+           &ram_disk[array_lba + (i / TEST_ENTRIES_PER_LBA)]
+                    [(i % TEST_ENTRIES_PER_LBA) * TEST_ENTRY_SIZE];
+}
+
+/* Formats the disk with the given partitions, filling each with tagged data
+ * and recording them in the array in the order given, then loads the GPT
+ */
+static void setup_disk(const struct test_partition_t *partitions, unsigned int num)
+{
+    struct gpt_header_t header = {
+        .signature = TEST_GPT_SIG_INITIALISER,
+        .revision = TEST_GPT_REVISION,
+        .size = TEST_GPT_HEADER_SIZE,
+        .header_crc = TEST_GPT_CRC32,
+        .reserved = 0,
+        .current_lba = TEST_GPT_PRIMARY_LBA,
+        .backup_lba = TEST_GPT_BACKUP_LBA,
+        .first_lba = TEST_GPT_FIRST_USABLE_LBA,
+        .last_lba = TEST_GPT_LAST_USABLE_LBA,
+        .disk_guid = TEST_GPT_DISK_GUID,
+        .array_lba = TEST_GPT_ARRAY_LBA,
+        .num_partitions = TEST_MAX_PARTITIONS,
+        .entry_size = TEST_ENTRY_SIZE,
+        .array_crc = TEST_GPT_CRC32
+    };
+    uint16_t mbr_sig = TEST_MBR_SIG;
+
+    memset(ram_disk, 0, sizeof(ram_disk));
+
+    ram_disk[TEST_MBR_LBA][TEST_MBR_OS_TYPE_OFFSET] = TEST_MBR_TYPE_GPT;
+    memcpy(&ram_disk[TEST_MBR_LBA][TEST_MBR_SIG_OFFSET], &mbr_sig, sizeof(mbr_sig));
+
+    memcpy(ram_disk[TEST_GPT_PRIMARY_LBA], &header, sizeof(header));
+
+    header.current_lba = TEST_GPT_BACKUP_LBA;
+    header.backup_lba = TEST_GPT_PRIMARY_LBA;
+    header.array_lba = TEST_GPT_BACKUP_ARRAY_LBA;
+    memcpy(ram_disk[TEST_GPT_BACKUP_LBA], &header, sizeof(header));
+
+    for (unsigned int i = 0; i < num; ++i) {
+        struct gpt_entry_t entry = {
+            .type = MAKE_EFI_GUID(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11),
+            .guid = test_guid(i),
+            .start = partitions[i].start,
+            .end = partitions[i].start + partitions[i].size - 1,
+            .attr = 0,
+            .name = {'P', '\0'}
+        };
+
+        memcpy(disk_entry(TEST_GPT_ARRAY_LBA, i), &entry, sizeof(entry));
+        memcpy(disk_entry(TEST_GPT_BACKUP_ARRAY_LBA, i), &entry, sizeof(entry));
+
+        for (uint64_t block = 0; block < partitions[i].size; ++block) {
+            const uint32_t tag = block_tag(i, block);
+            memcpy(ram_disk[partitions[i].start + block], &tag, sizeof(tag));
+        }
+    }
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_init(&ram_driver, TEST_MAX_PARTITIONS));
+    memset(&data_ops, 0, sizeof(data_ops));
+}
+
+/* Returns where the library now has a partition starting, after checking its
+ * size and that its data moved with it
+ */
+static uint64_t check_partition(unsigned int i, const struct test_partition_t *partition)
+{
+    struct partition_entry_t entry;
+    struct efi_guid_t guid = test_guid(i);
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_entry_read(&guid, &entry));
+    TEST_ASSERT_EQUAL(partition->size, entry.size);
+
+    for (uint64_t block = 0; block < entry.size; ++block) {
+        uint32_t tag;
+        memcpy(&tag, ram_disk[entry.start + block], sizeof(tag));
+        TEST_ASSERT_EQUAL(block_tag(i, block), tag);
+    }
+
+    return entry.start;
+}
+
+/* Checks all data survived and the partitions leave a single free region */
+static void check_defragmented(const struct test_partition_t *partitions, unsigned int num)
+{
+    uint8_t used[TEST_DISK_NUM_BLOCKS] = {0};
+    unsigned int num_free_regions = 0;
+
+    for (unsigned int i = 0; i < num; ++i) {
+        const uint64_t start = check_partition(i, &partitions[i]);
+        for (uint64_t block = 0; block < partitions[i].size; ++block) {
+            TEST_ASSERT_EQUAL(0, used[start + block]);
+            used[start + block] = 1;
+        }
+    }
+
+    for (uint64_t lba = TEST_GPT_FIRST_USABLE_LBA; lba <= TEST_GPT_LAST_USABLE_LBA; ++lba) {
+        if (!used[lba] && (lba == TEST_GPT_FIRST_USABLE_LBA || used[lba - 1])) {
+            num_free_regions++;
+        }
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(1, num_free_regions);
+}
+
+void setUp(void)
+{
+    /* Any time this is called, return the same number and ignore the arguments */
+    efi_soft_crc32_update_IgnoreAndReturn(TEST_GPT_CRC32);
+
+    /* Ignore all logging calls */
+    tfm_log_Ignore();
+
+    ram_driver.read_blocks = test_driver_read_blocks;
+    ram_driver.write_blocks = test_driver_write_blocks;
+}
+
+void tearDown(void)
+{
+    gpt_uninit();
+}
+
+void test_gpt_defragment_should_packTowardsStart(void)
+{
+    /* Listed out of order, with free space at the end of the disk */
+    const struct test_partition_t partitions[] = {
+        {TEST_GPT_FIRST_USABLE_LBA + 135, 50},
+        {TEST_GPT_FIRST_USABLE_LBA, 10},
+        {TEST_GPT_FIRST_USABLE_LBA + 30, 100},
+    };
+    setup_disk(partitions, ARRAY_SIZE(partitions));
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_defragment_with_buffer(work_buf, sizeof(work_buf)));
+    check_defragmented(partitions, ARRAY_SIZE(partitions));
+
+    TEST_ASSERT_EQUAL(TEST_GPT_FIRST_USABLE_LBA, check_partition(1, &partitions[1]));
+    TEST_ASSERT_EQUAL(TEST_GPT_FIRST_USABLE_LBA + 10, check_partition(2, &partitions[2]));
+    TEST_ASSERT_EQUAL(TEST_GPT_FIRST_USABLE_LBA + 110, check_partition(0, &partitions[0]));
+
+    /* 100 blocks take two buffers' worth, 50 blocks one */
+    TEST_ASSERT_EQUAL(3, data_ops.read_blocks);
+    TEST_ASSERT_EQUAL(3, data_ops.write_blocks);
+    TEST_ASSERT_EQUAL(3, data_ops.erases);
+    TEST_ASSERT_EQUAL(0, data_ops.reads);
+    TEST_ASSERT_EQUAL(0, data_ops.writes);
+    TEST_ASSERT_EQUAL(150, data_ops.blocks_written);
+}
+
+void test_gpt_defragment_should_notMovePartitionsPackedAtEitherEnd(void)
+{
+    const struct test_partition_t partitions[] = {
+        {TEST_GPT_FIRST_USABLE_LBA, 10},
+        {TEST_GPT_FIRST_USABLE_LBA + 10, 20},
+        {TEST_GPT_LAST_USABLE_LBA - 29, 30},
+    };
+    setup_disk(partitions, ARRAY_SIZE(partitions));
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_defragment_with_buffer(work_buf, sizeof(work_buf)));
+    check_defragmented(partitions, ARRAY_SIZE(partitions));
+
+    TEST_ASSERT_EQUAL(TEST_GPT_LAST_USABLE_LBA - 29, check_partition(2, &partitions[2]));
+    TEST_ASSERT_EQUAL(0, data_ops.erases);
+    TEST_ASSERT_EQUAL(0, data_ops.blocks_written);
+}
+
+void test_gpt_defragment_should_moveFewestBlocks(void)
+{
+    /* Packing everything towards the start would move the large partition at
+     * the end. Only the small one in the middle needs to move.
+     */
+    const struct test_partition_t partitions[] = {
+        {TEST_GPT_FIRST_USABLE_LBA, 10},
+        {TEST_GPT_FIRST_USABLE_LBA + 100, 5},
+        {TEST_GPT_LAST_USABLE_LBA - 499, 500},
+    };
+    setup_disk(partitions, ARRAY_SIZE(partitions));
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_defragment_with_buffer(work_buf, sizeof(work_buf)));
+    check_defragmented(partitions, ARRAY_SIZE(partitions));
+
+    TEST_ASSERT_EQUAL(TEST_GPT_LAST_USABLE_LBA - 499, check_partition(2, &partitions[2]));
+    TEST_ASSERT_EQUAL(5, data_ops.blocks_written);
+}
+
+void test_gpt_defragment_should_moveOverlappingPartition(void)
+{
+    /* The partition moves by less than the size of the work buffer, so each
+     * chunk written overlaps the one read
+     */
+    const struct test_partition_t partitions[] = {
+        {TEST_GPT_FIRST_USABLE_LBA + 2, 200},
+    };
+    setup_disk(partitions, ARRAY_SIZE(partitions));
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_defragment_with_buffer(work_buf, sizeof(work_buf)));
+    check_defragmented(partitions, ARRAY_SIZE(partitions));
+    TEST_ASSERT_EQUAL(TEST_GPT_FIRST_USABLE_LBA, check_partition(0, &partitions[0]));
+}
+
+void test_gpt_defragment_should_moveOneBlockPerCallWithoutBuffer(void)
+{
+    const struct test_partition_t partitions[] = {
+        {TEST_GPT_FIRST_USABLE_LBA, 10},
+        {TEST_GPT_FIRST_USABLE_LBA + 30, 100},
+    };
+    setup_disk(partitions, ARRAY_SIZE(partitions));
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_defragment());
+    check_defragmented(partitions, ARRAY_SIZE(partitions));
+
+    TEST_ASSERT_EQUAL(100, data_ops.read_blocks);
+    TEST_ASSERT_EQUAL(100, data_ops.write_blocks);
+    TEST_ASSERT_EQUAL(100, data_ops.erases);
+}
+
+void test_gpt_defragment_should_fallBackToSingleBlockDriverCalls(void)
+{
+    const struct test_partition_t partitions[] = {
+        {TEST_GPT_FIRST_USABLE_LBA, 10},
+        {TEST_GPT_FIRST_USABLE_LBA + 30, 100},
+    };
+    ram_driver.read_blocks = NULL;
+    ram_driver.write_blocks = NULL;
+    setup_disk(partitions, ARRAY_SIZE(partitions));
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_defragment_with_buffer(work_buf, sizeof(work_buf)));
+    check_defragmented(partitions, ARRAY_SIZE(partitions));
+
+    /* Each chunk is still erased in one go */
+    TEST_ASSERT_EQUAL(100, data_ops.reads);
+    TEST_ASSERT_EQUAL(100, data_ops.writes);
+    TEST_ASSERT_EQUAL(2, data_ops.erases);
+}
+
+void test_gpt_defragment_should_doNothingWithoutPartitions(void)
+{
+    setup_disk(NULL, 0);
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_defragment_with_buffer(work_buf, sizeof(work_buf)));
+    TEST_ASSERT_EQUAL(0, data_ops.erases);
+    TEST_ASSERT_EQUAL(0, data_ops.writes);
+    TEST_ASSERT_EQUAL(0, data_ops.blocks_written);
+}
+
+void test_gpt_defragment_with_buffer_should_failWhenBufferTooSmall(void)
+{
+    const struct test_partition_t partitions[] = {
+        {TEST_GPT_FIRST_USABLE_LBA + 30, 100},
+    };
+    setup_disk(partitions, ARRAY_SIZE(partitions));
+
+    TEST_ASSERT_EQUAL(PSA_ERROR_INVALID_ARGUMENT,
+                      gpt_defragment_with_buffer(work_buf, TEST_BLOCK_SIZE - 1));
+    TEST_ASSERT_EQUAL(0, data_ops.blocks_written);
+}
+
+void test_gpt_defragment_with_buffer_should_moveInBufferSizedChunks(void)
+{
+    /* A 1 MiB partition moved with and without a 32 KiB work buffer */
+    const struct test_partition_t partitions[] = {
+        {TEST_GPT_FIRST_USABLE_LBA, 10},
+        {TEST_GPT_FIRST_USABLE_LBA + 100, 2048},
+    };
+    struct test_data_ops_t per_block;
+
+    setup_disk(partitions, ARRAY_SIZE(partitions));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_defragment());
+    check_defragmented(partitions, ARRAY_SIZE(partitions));
+    per_block = data_ops;
+    gpt_uninit();
+
+    /* Without a buffer every block costs one read, one write and one erase */
+    TEST_ASSERT_EQUAL(2048, per_block.read_blocks);
+    TEST_ASSERT_EQUAL(2048, per_block.write_blocks);
+    TEST_ASSERT_EQUAL(2048, per_block.erases);
+
+    setup_disk(partitions, ARRAY_SIZE(partitions));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, gpt_defragment_with_buffer(work_buf, sizeof(work_buf)));
+    check_defragmented(partitions, ARRAY_SIZE(partitions));
+
+    TEST_ASSERT_EQUAL(2048 / TEST_WORK_BUF_NUM_BLOCKS, data_ops.read_blocks);
+    TEST_ASSERT_EQUAL(2048 / TEST_WORK_BUF_NUM_BLOCKS, data_ops.write_blocks);
+    TEST_ASSERT_EQUAL(2048 / TEST_WORK_BUF_NUM_BLOCKS, data_ops.erases);
+}
@@ -29,41 +29,119 @@
 #error "LOG_LEVEL not defined!"
 #endif
 
+/*
+ * Size in bytes of the RAM ring buffer tfm_log() formats into. When 0, output
+ * is written straight to the UART instead.
+ */
+#ifndef TFM_LOG_BUFFER_SIZE
+#define TFM_LOG_BUFFER_SIZE 0
+#endif
+
+#ifdef TFM_LOG_TOKENIZED
+/*
+ * In tokenized mode the format string is placed in the .tfm_log_fmt section,
+ * which the linker keeps out of the loaded image, and only its address is
+ * logged as a token along with the raw arguments. tools/tfm_log_decode.py
+ * rebuilds the text from the ELF.
+ */
+#define TFM_LOG_FMT_SECTION __attribute__((used, section(".tfm_log_fmt")))
+
+/* Maximum number of arguments of a tokenized log call */
+#define TFM_LOG_TOKENIZED_MAX_ARGS 12
+
+/* Argument descriptor: bits [3:0] hold the number of arguments and bit
+ * (4 + n) is set when argument n is a string, which is logged by value. It is
+ * picked from the type of each argument, and written into the record so that
+ * tools/tfm_log_decode.py can check it against the conversions of the format.
+ */
+#define TFM_LOG_ARG_IS_STR(x) _Generic((x),                                 \
+    char *: 1u, const char *: 1u,                                           \
+    signed char *: 1u, const signed char *: 1u,                             \
+    unsigned char *: 1u, const unsigned char *: 1u,                         \
+    default: 0u)
+
+#define TFM_LOG_CAT(a, b)  TFM_LOG_CAT_(a, b)
+#define TFM_LOG_CAT_(a, b) a##b
+
+/* Both take the format followed by the arguments, so the list is never empty */
+#define TFM_LOG_NARGS(...) \
+    TFM_LOG_NARGS_(__VA_ARGS__, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, ~)
+#define TFM_LOG_NARGS_(f, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, n, ...) n
+#define TFM_LOG_HAS_ARGS(...) \
+    TFM_LOG_NARGS_(__VA_ARGS__, N, N, N, N, N, N, N, N, N, N, N, N, 0, ~)
+#define TFM_LOG_FMT(...)          TFM_LOG_FMT_(__VA_ARGS__, ~)
+#define TFM_LOG_FMT_(f, ...)      f
+
+#define TFM_LOG_STR_MASK_0(f)          0u
+#define TFM_LOG_STR_MASK_1(f, a)       TFM_LOG_ARG_IS_STR(a)
+#define TFM_LOG_STR_MASK_2(f, a, ...)  (TFM_LOG_ARG_IS_STR(a) | (TFM_LOG_STR_MASK_1(f, __VA_ARGS__) << 1))
+#define TFM_LOG_STR_MASK_3(f, a, ...)  (TFM_LOG_ARG_IS_STR(a) | (TFM_LOG_STR_MASK_2(f, __VA_ARGS__) << 1))
+#define TFM_LOG_STR_MASK_4(f, a, ...)  (TFM_LOG_ARG_IS_STR(a) | (TFM_LOG_STR_MASK_3(f, __VA_ARGS__) << 1))
+#define TFM_LOG_STR_MASK_5(f, a, ...)  (TFM_LOG_ARG_IS_STR(a) | (TFM_LOG_STR_MASK_4(f, __VA_ARGS__) << 1))
+#define TFM_LOG_STR_MASK_6(f, a, ...)  (TFM_LOG_ARG_IS_STR(a) | (TFM_LOG_STR_MASK_5(f, __VA_ARGS__) << 1))
+#define TFM_LOG_STR_MASK_7(f, a, ...)  (TFM_LOG_ARG_IS_STR(a) | (TFM_LOG_STR_MASK_6(f, __VA_ARGS__) << 1))
+#define TFM_LOG_STR_MASK_8(f, a, ...)  (TFM_LOG_ARG_IS_STR(a) | (TFM_LOG_STR_MASK_7(f, __VA_ARGS__) << 1))
+#define TFM_LOG_STR_MASK_9(f, a, ...)  (TFM_LOG_ARG_IS_STR(a) | (TFM_LOG_STR_MASK_8(f, __VA_ARGS__) << 1))
+#define TFM_LOG_STR_MASK_10(f, a, ...) (TFM_LOG_ARG_IS_STR(a) | (TFM_LOG_STR_MASK_9(f, __VA_ARGS__) << 1))
+#define TFM_LOG_STR_MASK_11(f, a, ...) (TFM_LOG_ARG_IS_STR(a) | (TFM_LOG_STR_MASK_10(f, __VA_ARGS__) << 1))
+#define TFM_LOG_STR_MASK_12(f, a, ...) (TFM_LOG_ARG_IS_STR(a) | (TFM_LOG_STR_MASK_11(f, __VA_ARGS__) << 1))
+
+#define TFM_LOG_ARG_DESC(...)                                               \
+    ((uint32_t)TFM_LOG_NARGS(__VA_ARGS__) |                                 \
+     ((uint32_t)TFM_LOG_CAT(TFM_LOG_STR_MASK_, TFM_LOG_NARGS(__VA_ARGS__))(__VA_ARGS__) << 4))
+
+#define TFM_LOG_CALL_0(token, desc, f)      tfm_log_tokenized(token, desc)
+#define TFM_LOG_CALL_N(token, desc, f, ...) tfm_log_tokenized(token, desc, __VA_ARGS__)
+
+#define do_tfm_log(...)                                                     \
+    do {                                                                    \
+        static const char tfm_log_fmt[] TFM_LOG_FMT_SECTION =               \
+            TFM_LOG_FMT(__VA_ARGS__);                                       \
+                                                                            \
+        TFM_LOG_CAT(TFM_LOG_CALL_, TFM_LOG_HAS_ARGS(__VA_ARGS__))(          \
+            (uint32_t)(uintptr_t)tfm_log_fmt, TFM_LOG_ARG_DESC(__VA_ARGS__), \
+            __VA_ARGS__);                                                   \
+        no_tfm_log(__VA_ARGS__);                                            \
+    } while (false)
+#else
+#define do_tfm_log(...) tfm_log(__VA_ARGS__)
+#endif /* TFM_LOG_TOKENIZED */
+
 #if LOG_LEVEL >= LOG_LEVEL_ERROR
-# define ERROR(...)         tfm_log(LOG_MARKER_ERROR __VA_ARGS__)
-# define ERROR_RAW(...)     tfm_log(LOG_MARKER_RAW __VA_ARGS__)
+# define ERROR(...)         do_tfm_log(LOG_MARKER_ERROR __VA_ARGS__)
+# define ERROR_RAW(...)     do_tfm_log(LOG_MARKER_RAW __VA_ARGS__)
 #else
 # define ERROR(...)         no_tfm_log(LOG_MARKER_ERROR __VA_ARGS__)
 # define ERROR_RAW(...)     no_tfm_log(LOG_MARKER_RAW __VA_ARGS__)
 #endif
 
 #if LOG_LEVEL >= LOG_LEVEL_NOTICE
-# define NOTICE(...)        tfm_log(LOG_MARKER_NOTICE __VA_ARGS__)
-# define NOTICE_RAW(...)    tfm_log(LOG_MARKER_RAW __VA_ARGS__)
+# define NOTICE(...)        do_tfm_log(LOG_MARKER_NOTICE __VA_ARGS__)
+# define NOTICE_RAW(...)    do_tfm_log(LOG_MARKER_RAW __VA_ARGS__)
 #else
 # define NOTICE(...)        no_tfm_log(LOG_MARKER_NOTICE __VA_ARGS__)
 # define NOTICE_RAW(...)    no_tfm_log(LOG_MARKER_RAW __VA_ARGS__)
 #endif
 
 #if LOG_LEVEL >= LOG_LEVEL_WARNING
-# define WARN(...)      tfm_log(LOG_MARKER_WARNING __VA_ARGS__)
-# define WARN_RAW(...)  tfm_log(LOG_MARKER_RAW __VA_ARGS__)
+# define WARN(...)      do_tfm_log(LOG_MARKER_WARNING __VA_ARGS__)
+# define WARN_RAW(...)  do_tfm_log(LOG_MARKER_RAW __VA_ARGS__)
 #else
 # define WARN(...)      no_tfm_log(LOG_MARKER_WARNING __VA_ARGS__)
 # define WARN_RAW(...)  no_tfm_log(LOG_MARKER_RAW __VA_ARGS__)
 #endif
 
 #if LOG_LEVEL >= LOG_LEVEL_INFO
-# define INFO(...)      tfm_log(LOG_MARKER_INFO __VA_ARGS__)
-# define INFO_RAW(...)  tfm_log(LOG_MARKER_RAW __VA_ARGS__)
+# define INFO(...)      do_tfm_log(LOG_MARKER_INFO __VA_ARGS__)
+# define INFO_RAW(...)  do_tfm_log(LOG_MARKER_RAW __VA_ARGS__)
 #else
 # define INFO(...)      no_tfm_log(LOG_MARKER_INFO __VA_ARGS__)
 # define INFO_RAW(...)  no_tfm_log(LOG_MARKER_RAW __VA_ARGS__)
 #endif
 
 #if LOG_LEVEL >= LOG_LEVEL_VERBOSE
-# define VERBOSE(...)       tfm_log(LOG_MARKER_VERBOSE __VA_ARGS__)
-# define VERBOSE_RAW(...)   tfm_log(LOG_MARKER_RAW __VA_ARGS__)
+# define VERBOSE(...)       do_tfm_log(LOG_MARKER_VERBOSE __VA_ARGS__)
+# define VERBOSE_RAW(...)   do_tfm_log(LOG_MARKER_RAW __VA_ARGS__)
 #else
 # define VERBOSE(...)       no_tfm_log(LOG_MARKER_VERBOSE __VA_ARGS__)
 # define VERBOSE_RAW(...)   no_tfm_log(LOG_MARKER_RAW __VA_ARGS__)
@@ -77,4 +155,52 @@ __attribute__((format(printf, 1, 2)))
 void tfm_log(const char *fmt, ...);
 #endif
 
+#ifdef TFM_LOG_TOKENIZED
+/**
+ * \brief Logs a tokenized record. Called by the log macros in tokenized mode.
+ *
+ * \param[in] token     Address of the format string in .tfm_log_fmt
+ * \param[in] arg_desc  Number of arguments and which of them are strings
+ * \param[in] ...       Arguments of the format string
+ */
+void tfm_log_tokenized(uint32_t token, uint32_t arg_desc, ...);
+#endif
+
+#if TFM_LOG_BUFFER_SIZE > 0
+/* What to do with a message which does not fit in the ring buffer */
+#define TFM_LOG_BUFFER_OVERFLOW_FLUSH       0   /* Drain the buffer synchronously */
+#define TFM_LOG_BUFFER_OVERFLOW_DROP_NEW    1   /* Discard the new message */
+#define TFM_LOG_BUFFER_OVERFLOW_DROP_OLD    2   /* Discard the oldest whole lines */
+
+/**
+ * \brief Copies already formatted output into the log ring buffer.
+ *
+ * \param[in] str  Output to buffer
+ * \param[in] len  Length of the output in bytes
+ *
+ * \return Number of bytes buffered, which is less than len if the buffer
+ *         overflowed and the overflow policy discarded the message.
+ */
+int32_t tfm_log_buffer_write(const char *str, uint32_t len);
+
+/**
+ * \brief Writes everything in the log ring buffer out to the UART.
+ *
+ * \note Called from low priority contexts such as the idle partition, as well
+ *       as before the system is halted or reset. Returns straight away if
+ *       a drain is already in progress.
+ */
+void tfm_log_flush(void);
+
+/**
+ * \brief Returns the number of messages discarded since the buffer was last
+ *        drained.
+ */
+uint32_t tfm_log_buffer_dropped(void);
+#else
+static inline void tfm_log_flush(void)
+{
+}
+#endif /* TFM_LOG_BUFFER_SIZE > 0 */
+
 #endif /* __TF_M_LOG_H__ */
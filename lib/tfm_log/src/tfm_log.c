@@ -8,11 +8,279 @@
 #include <stdarg.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "tfm_vprintf_priv.h"
 #include "tfm_log.h"
 #include "uart_stdout.h"
 
+#if TFM_LOG_BUFFER_SIZE > 0
+
+#ifndef TFM_LOG_BUFFER_OVERFLOW
+#define TFM_LOG_BUFFER_OVERFLOW TFM_LOG_BUFFER_OVERFLOW_FLUSH
+#endif
+
+#if TFM_LOG_BUFFER_OVERFLOW != TFM_LOG_BUFFER_OVERFLOW_FLUSH && \
+    TFM_LOG_BUFFER_OVERFLOW != TFM_LOG_BUFFER_OVERFLOW_DROP_NEW && \
+    TFM_LOG_BUFFER_OVERFLOW != TFM_LOG_BUFFER_OVERFLOW_DROP_OLD
+#error "TFM_LOG_BUFFER_OVERFLOW must be FLUSH, DROP_NEW or DROP_OLD!"
+#endif
+
+/* Count discarded messages and report them when the buffer is next drained */
+#ifndef TFM_LOG_BUFFER_DROP_COUNTER
+#define TFM_LOG_BUFFER_DROP_COUNTER 1
+#endif
+
+/* Size of the on-stack buffer tfm_log() formats a line into before it is
+ * copied to the ring buffer. Longer lines are copied in several pieces.
+ */
+#ifndef TFM_LOG_LINE_SIZE
+#define TFM_LOG_LINE_SIZE 64
+#endif
+
+/* The ring buffer is shared by thread mode and exception handlers, so its
+ * indices are only updated with interrupts masked. Copying a message in is
+ * short, but the UART is always written with interrupts enabled.
+ */
+#ifndef TFM_LOG_BUFFER_CRITICAL_ENTER
+#include "tfm_hal_device_header.h"
+
+#define TFM_LOG_BUFFER_CRITICAL_ENTER(state) \
+    do {                                     \
+        (state) = __get_PRIMASK();           \
+        __disable_irq();                     \
+    } while (0)
+#define TFM_LOG_BUFFER_CRITICAL_LEAVE(state) __set_PRIMASK(state)
+#endif
+
+struct tfm_log_ring {
+    uint32_t head;          /* Where the next message is copied to */
+    uint32_t tail;          /* Oldest byte not yet written out */
+    uint32_t used;          /* Bytes between tail and head */
+    bool flushing;          /* A drain is writing out the tail */
+#if TFM_LOG_BUFFER_DROP_COUNTER
+    uint32_t dropped;       /* Messages discarded since the last report */
+#endif
+    char buf[TFM_LOG_BUFFER_SIZE];
+};
+
+struct tfm_log_line {
+    uint32_t len;
+    char buf[TFM_LOG_LINE_SIZE];
+};
+
+static struct tfm_log_ring log_ring;
+
+static void ring_copy_in(const char *str, uint32_t len)
+{
+    const uint32_t first = (len < (TFM_LOG_BUFFER_SIZE - log_ring.head)) ?
+                           len : (TFM_LOG_BUFFER_SIZE - log_ring.head);
+
+    memcpy(&log_ring.buf[log_ring.head], str, first);
+    memcpy(log_ring.buf, str + first, len - first);
+
+    log_ring.head = (log_ring.head + len) % TFM_LOG_BUFFER_SIZE;
+    log_ring.used += len;
+}
+
+static void ring_drop(void)
+{
+#if TFM_LOG_BUFFER_DROP_COUNTER
+    log_ring.dropped++;
+#endif
+}
+
+#if TFM_LOG_BUFFER_OVERFLOW == TFM_LOG_BUFFER_OVERFLOW_DROP_OLD
+/* Discards whole lines from the tail until len bytes are free. Must not be
+ * called whilst a drain is writing out the tail.
+ */
+static void ring_evict(uint32_t len)
+{
+    char c;
+
+    while ((TFM_LOG_BUFFER_SIZE - log_ring.used) < len) {
+        do {
+            c = log_ring.buf[log_ring.tail];
+            log_ring.tail = (log_ring.tail + 1) % TFM_LOG_BUFFER_SIZE;
+            log_ring.used--;
+        } while ((c != '\n') && (log_ring.used > 0));
+
+        ring_drop();
+    }
+}
+#endif
+
+static uint32_t ring_write(const char *str, uint32_t len)
+{
+    uint32_t state;
+
+    TFM_LOG_BUFFER_CRITICAL_ENTER(state);
+
+    if ((TFM_LOG_BUFFER_SIZE - log_ring.used) < len) {
+#if TFM_LOG_BUFFER_OVERFLOW == TFM_LOG_BUFFER_OVERFLOW_FLUSH
+        /* A drain interrupted by this message cannot make room for it */
+        if (!log_ring.flushing) {
+            TFM_LOG_BUFFER_CRITICAL_LEAVE(state);
+            tfm_log_flush();
+            TFM_LOG_BUFFER_CRITICAL_ENTER(state);
+        }
+#elif TFM_LOG_BUFFER_OVERFLOW == TFM_LOG_BUFFER_OVERFLOW_DROP_OLD
+        if (!log_ring.flushing) {
+            ring_evict(len);
+        }
+#endif
+        if ((TFM_LOG_BUFFER_SIZE - log_ring.used) < len) {
+            ring_drop();
+            TFM_LOG_BUFFER_CRITICAL_LEAVE(state);
+            return 0;
+        }
+    }
+
+    ring_copy_in(str, len);
+
+    TFM_LOG_BUFFER_CRITICAL_LEAVE(state);
+
+    return len;
+}
+
+int32_t tfm_log_buffer_write(const char *str, uint32_t len)
+{
+    uint32_t written = 0;
+    uint32_t chunk;
+
+    /* Messages larger than the whole buffer can only be taken in pieces */
+    while (len > 0) {
+        chunk = (len < TFM_LOG_BUFFER_SIZE) ? len : TFM_LOG_BUFFER_SIZE;
+        written += ring_write(str, chunk);
+        str += chunk;
+        len -= chunk;
+    }
+
+    return (int32_t)written;
+}
+
+#if TFM_LOG_BUFFER_DROP_COUNTER
+static void output_direct(void *priv, const char *str, uint32_t len)
+{
+    (void)priv;
+
+    stdio_output_string(str, len);
+}
+
+static void report_dropped(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    tfm_vprintf(output_direct, NULL, fmt, args, true);
+    va_end(args);
+}
+#endif
+
+void tfm_log_flush(void)
+{
+    uint32_t state;
+    uint32_t len;
+#if TFM_LOG_BUFFER_DROP_COUNTER
+    uint32_t dropped;
+#endif
+
+    TFM_LOG_BUFFER_CRITICAL_ENTER(state);
+
+    /* Only one drain at a time. Anything logged meanwhile is written out by
+     * the drain already in progress.
+     */
+    if (log_ring.flushing) {
+        TFM_LOG_BUFFER_CRITICAL_LEAVE(state);
+        return;
+    }
+    log_ring.flushing = true;
+
+    while (log_ring.used > 0) {
+        /* Write out the contiguous part from the tail */
+        len = (log_ring.used < (TFM_LOG_BUFFER_SIZE - log_ring.tail)) ?
+              log_ring.used : (TFM_LOG_BUFFER_SIZE - log_ring.tail);
+
+        TFM_LOG_BUFFER_CRITICAL_LEAVE(state);
+        stdio_output_string(&log_ring.buf[log_ring.tail], len);
+        TFM_LOG_BUFFER_CRITICAL_ENTER(state);
+
+        log_ring.tail = (log_ring.tail + len) % TFM_LOG_BUFFER_SIZE;
+        log_ring.used -= len;
+    }
+
+#if TFM_LOG_BUFFER_DROP_COUNTER
+    dropped = log_ring.dropped;
+    log_ring.dropped = 0;
+#endif
+
+    log_ring.flushing = false;
+
+    TFM_LOG_BUFFER_CRITICAL_LEAVE(state);
+
+#if TFM_LOG_BUFFER_DROP_COUNTER
+    if (dropped > 0) {
+        report_dropped(LOG_MARKER_WARNING "%u log messages dropped\n", dropped);
+    }
+#endif
+}
+
+uint32_t tfm_log_buffer_dropped(void)
+{
+#if TFM_LOG_BUFFER_DROP_COUNTER
+    return log_ring.dropped;
+#else
+    return 0;
+#endif
+}
+
+static void output_line(struct tfm_log_line *line)
+{
+    (void)tfm_log_buffer_write(line->buf, line->len);
+    line->len = 0;
+}
+
+/* Collects output into whole lines, so that each line reaches the ring buffer
+ * in one piece and cannot be interleaved with a message logged by an
+ * exception handler.
+ */
+static void output_log(void *priv, const char *str, uint32_t len)
+{
+    struct tfm_log_line *line = (struct tfm_log_line *)priv;
+    uint32_t chunk;
+
+    while (len > 0) {
+        chunk = (len < (TFM_LOG_LINE_SIZE - line->len)) ?
+                len : (TFM_LOG_LINE_SIZE - line->len);
+        memcpy(&line->buf[line->len], str, chunk);
+        line->len += chunk;
+        str += chunk;
+        len -= chunk;
+
+        if ((line->len == TFM_LOG_LINE_SIZE) || (line->buf[line->len - 1] == '\n')) {
+            output_line(line);
+        }
+    }
+}
+
+void tfm_log(const char *fmt, ...)
+{
+    struct tfm_log_line line;
+    va_list args;
+
+    line.len = 0;
+
+    va_start(args, fmt);
+    tfm_vprintf(output_log, &line, fmt, args, true);
+    va_end(args);
+
+    if (line.len > 0) {
+        output_line(&line);
+    }
+}
+
+#else /* TFM_LOG_BUFFER_SIZE > 0 */
+
 static void output_log(void *priv, const char *str, uint32_t len)
 {
     stdio_output_string(str, len);
@@ -26,3 +294,5 @@ void tfm_log(const char *fmt, ...)
     tfm_vprintf(output_log, NULL, fmt, args, true);
     va_end(args);
 }
+
+#endif /* TFM_LOG_BUFFER_SIZE > 0 */
@@ -0,0 +1,154 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "tfm_log.h"
+#include "uart_stdout.h"
+
+/*
+ * A tokenized record is the format string token and the argument descriptor,
+ * both as LEB128 varints, followed by each argument: integers as varints and
+ * strings as a one byte length and the characters. It is written out as a line of the form "$<base64>\r\n", so that
+ * it survives a text console and can be interleaved with plain text output.
+ */
+
+/* Maximum size in bytes of a record before base64 encoding. Strings which do
+ * not fit are truncated, and arguments which do not fit are left out.
+ */
+#ifndef TFM_LOG_TOKENIZED_RECORD_SIZE
+#define TFM_LOG_TOKENIZED_RECORD_SIZE 64
+#endif
+
+/* The token and the argument descriptor take up to 8 bytes */
+#if TFM_LOG_TOKENIZED_RECORD_SIZE < 8
+#error "TFM_LOG_TOKENIZED_RECORD_SIZE must be at least 8"
+#endif
+
+#define TOKENIZED_PREFIX        '$'
+#define TOKENIZED_MAX_STR_LEN   (127u)
+
+#define BASE64_LEN(n)           ((((n) + 2u) / 3u) * 4u)
+
+static const char base64_chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static size_t varint_len(uint32_t val)
+{
+    size_t len = 1;
+
+    while (val >= 0x80u) {
+        val >>= 7;
+        len++;
+    }
+
+    return len;
+}
+
+static size_t put_varint(uint8_t *buf, uint32_t val)
+{
+    size_t len = 0;
+
+    while (val >= 0x80u) {
+        buf[len++] = (uint8_t)(val | 0x80u);
+        val >>= 7;
+    }
+    buf[len++] = (uint8_t)val;
+
+    return len;
+}
+
+static size_t base64_encode(char *out, const uint8_t *in, size_t len)
+{
+    size_t out_len = 0;
+    uint32_t triple;
+    size_t i;
+
+    for (i = 0; i < len; i += 3) {
+        triple = (uint32_t)in[i] << 16;
+        if ((i + 1) < len) {
+            triple |= (uint32_t)in[i + 1] << 8;
+        }
+        if ((i + 2) < len) {
+            triple |= in[i + 2];
+        }
+
+        out[out_len++] = base64_chars[(triple >> 18) & 0x3Fu];
+        out[out_len++] = base64_chars[(triple >> 12) & 0x3Fu];
+        out[out_len++] = ((i + 1) < len) ? base64_chars[(triple >> 6) & 0x3Fu] : '=';
+        out[out_len++] = ((i + 2) < len) ? base64_chars[triple & 0x3Fu] : '=';
+    }
+
+    return out_len;
+}
+
+static void output_record(const char *str, uint32_t len)
+{
+#if TFM_LOG_BUFFER_SIZE > 0
+    (void)tfm_log_buffer_write(str, len);
+#else
+    stdio_output_string(str, len);
+#endif
+}
+
+void tfm_log_tokenized(uint32_t token, uint32_t arg_desc, ...)
+{
+    uint8_t record[TFM_LOG_TOKENIZED_RECORD_SIZE];
+    char line[1 + BASE64_LEN(TFM_LOG_TOKENIZED_RECORD_SIZE) + 2];
+    const uint32_t num_args = arg_desc & 0xFu;
+    uint32_t str_mask = arg_desc >> 4;
+    size_t len;
+    size_t line_len;
+    const char *str;
+    size_t str_len;
+    uint32_t val;
+    va_list args;
+
+    len = put_varint(record, token);
+    len += put_varint(&record[len], arg_desc);
+
+    va_start(args, arg_desc);
+    for (uint32_t i = 0; i < num_args; i++, str_mask >>= 1) {
+        if (str_mask & 1u) {
+            str = va_arg(args, const char *);
+            if ((TFM_LOG_TOKENIZED_RECORD_SIZE - len) < 1) {
+                break;
+            }
+
+            str_len = (str != NULL) ? strlen(str) : 0;
+            if (str_len > TOKENIZED_MAX_STR_LEN) {
+                str_len = TOKENIZED_MAX_STR_LEN;
+            }
+            if (str_len > (TFM_LOG_TOKENIZED_RECORD_SIZE - len - 1)) {
+                str_len = TFM_LOG_TOKENIZED_RECORD_SIZE - len - 1;
+            }
+
+            record[len++] = (uint8_t)str_len;
+            if (str_len > 0) {
+                memcpy(&record[len], str, str_len);
+                len += str_len;
+            }
+        } else {
+            val = va_arg(args, uint32_t);
+            if ((TFM_LOG_TOKENIZED_RECORD_SIZE - len) < varint_len(val)) {
+                break;
+            }
+
+            len += put_varint(&record[len], val);
+        }
+    }
+    va_end(args);
+
+    line[0] = TOKENIZED_PREFIX;
+    line_len = 1 + base64_encode(&line[1], record, len);
+    line[line_len++] = '\r';
+    line[line_len++] = '\n';
+
+    output_record(line, (uint32_t)line_len);
+}
@@ -0,0 +1,28 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_HAL_DEVICE_HEADER_H__
+#define __TFM_HAL_DEVICE_HEADER_H__
+
+#include <stdint.h>
+
+/* There are no interrupts to mask on the host */
+static inline uint32_t __get_PRIMASK(void)
+{
+    return 0;
+}
+
+static inline void __disable_irq(void)
+{
+}
+
+static inline void __set_PRIMASK(uint32_t primask)
+{
+    (void)primask;
+}
+
+#endif /* __TFM_HAL_DEVICE_HEADER_H__ */
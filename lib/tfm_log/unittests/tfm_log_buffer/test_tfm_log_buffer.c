@@ -0,0 +1,184 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "tfm_log.h"
+#include "uart_stdout.h"
+
+/* Captures everything written to the UART */
+#define UART_CAPTURE_SIZE   (1024u)
+
+static char uart_buf[UART_CAPTURE_SIZE];
+static uint32_t uart_len;
+static unsigned int uart_calls;
+
+/* Message logged from within the UART driver, as an exception handler
+ * preempting a drain would
+ */
+static const char *nested_msg;
+
+int stdio_output_string(const char *str, uint32_t len)
+{
+    const char *msg = nested_msg;
+
+    TEST_ASSERT_LESS_OR_EQUAL(UART_CAPTURE_SIZE - uart_len, len);
+
+    memcpy(&uart_buf[uart_len], str, len);
+    uart_len += len;
+    uart_calls++;
+
+    if (msg != NULL) {
+        nested_msg = NULL;
+        tfm_log(LOG_MARKER_RAW "%s", msg);
+    }
+
+    return len;
+}
+
+static void assert_uart(const char *expected)
+{
+    TEST_ASSERT_EQUAL(strlen(expected), uart_len);
+    TEST_ASSERT_EQUAL_MEMORY(expected, uart_buf, uart_len);
+}
+
+static void reset_uart(void)
+{
+    uart_len = 0;
+    uart_calls = 0;
+}
+
+void setUp(void)
+{
+    /* Leave the buffer empty and the drop counter clear */
+    tfm_log_flush();
+    reset_uart();
+    nested_msg = NULL;
+}
+
+void tearDown(void)
+{
+}
+
+void test_tfm_log_should_bufferUntilFlushed(void)
+{
+    INFO("Booting %u partitions\n", 12);
+
+    TEST_ASSERT_EQUAL(0, uart_calls);
+
+    tfm_log_flush();
+
+    assert_uart("[INF] Booting 12 partitions\r\n");
+    TEST_ASSERT_EQUAL(1, uart_calls);
+}
+
+void test_tfm_log_should_padInRuns(void)
+{
+    tfm_log(LOG_MARKER_RAW "%8u|%-6s|%04x|%20s|\n", 42, "ab", 0xab, "x");
+    tfm_log_flush();
+
+    assert_uart("      42|ab    |00ab|                   x|\r\n");
+}
+
+void test_tfm_log_should_keepWholeLinesAcrossWrap(void)
+{
+    /* Each line is 19 bytes, so the fifth one wraps the 64 byte buffer */
+    for (uint32_t i = 0; i < 2; i++) {
+        tfm_log(LOG_MARKER_RAW "line %u of the log\n", i);
+    }
+    tfm_log_flush();
+    reset_uart();
+
+    for (uint32_t i = 2; i < 5; i++) {
+        tfm_log(LOG_MARKER_RAW "line %u of the log\n", i);
+    }
+    tfm_log_flush();
+
+    TEST_ASSERT_EQUAL(0, tfm_log_buffer_dropped());
+    assert_uart("line 2 of the log\r\n" "line 3 of the log\r\n" "line 4 of the log\r\n");
+    TEST_ASSERT_EQUAL(2, uart_calls);
+}
+
+void test_tfm_log_should_splitLinesLongerThanLineBuffer(void)
+{
+    const char *long_str = "0123456789abcdef0123456789abcdef0123456789";
+
+    tfm_log(LOG_MARKER_RAW "%s\n", long_str);
+    tfm_log_flush();
+
+    TEST_ASSERT_EQUAL(strlen(long_str) + 2, uart_len);
+    TEST_ASSERT_EQUAL_MEMORY(long_str, uart_buf, strlen(long_str));
+}
+
+void test_tfm_log_buffer_write_should_interleaveInOrder(void)
+{
+    /* Output from partitions arrives already formatted */
+    TEST_ASSERT_EQUAL(4, tfm_log_buffer_write("sp1\n", 4));
+    NOTICE("spm\n");
+    TEST_ASSERT_EQUAL(4, tfm_log_buffer_write("sp2\n", 4));
+    tfm_log_flush();
+
+    assert_uart("sp1\n" "[NOT] spm\r\n" "sp2\n");
+}
+
+void test_tfm_log_flush_should_drainMessagesLoggedDuringDrain(void)
+{
+    tfm_log(LOG_MARKER_RAW "first\n");
+    nested_msg = "nested\n";
+    tfm_log_flush();
+
+    assert_uart("first\r\n" "nested\n");
+    TEST_ASSERT_EQUAL(2, uart_calls);
+}
+
+void test_tfm_log_flush_should_doNothingWhenEmpty(void)
+{
+    tfm_log_flush();
+
+    TEST_ASSERT_EQUAL(0, uart_calls);
+}
+
+void test_tfm_log_should_applyOverflowPolicy(void)
+{
+    /* Five 16 byte lines do not fit in the 64 byte buffer */
+    for (uint32_t i = 0; i < 5; i++) {
+        tfm_log(LOG_MARKER_RAW "message %u ....\n", i);
+    }
+
+#if TFM_LOG_BUFFER_OVERFLOW == TFM_LOG_BUFFER_OVERFLOW_FLUSH
+    /* The first four were written out to make room for the fifth */
+    assert_uart("message 0 ....\r\n" "message 1 ....\r\n"
+                "message 2 ....\r\n" "message 3 ....\r\n");
+    TEST_ASSERT_EQUAL(0, tfm_log_buffer_dropped());
+
+    reset_uart();
+    tfm_log_flush();
+    assert_uart("message 4 ....\r\n");
+#elif TFM_LOG_BUFFER_OVERFLOW == TFM_LOG_BUFFER_OVERFLOW_DROP_NEW
+    TEST_ASSERT_EQUAL(0, uart_calls);
+    TEST_ASSERT_EQUAL(1, tfm_log_buffer_dropped());
+
+    tfm_log_flush();
+    assert_uart("message 0 ....\r\n" "message 1 ....\r\n"
+                "message 2 ....\r\n" "message 3 ....\r\n"
+                "[WRN] 1 log messages dropped\r\n");
+#elif TFM_LOG_BUFFER_OVERFLOW == TFM_LOG_BUFFER_OVERFLOW_DROP_OLD
+    TEST_ASSERT_EQUAL(0, uart_calls);
+    TEST_ASSERT_EQUAL(1, tfm_log_buffer_dropped());
+
+    tfm_log_flush();
+    assert_uart("message 1 ....\r\n" "message 2 ....\r\n"
+                "message 3 ....\r\n" "message 4 ....\r\n"
+                "[WRN] 1 log messages dropped\r\n");
+#endif
+    TEST_ASSERT_EQUAL(0, tfm_log_buffer_dropped());
+}
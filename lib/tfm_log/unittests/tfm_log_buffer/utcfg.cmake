@@ -0,0 +1,28 @@
+#-------------------------------------------------------------------------------
+# SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+#-------------------------------------------------------------------------------
+
+# Define what is being unit tested and by what
+set(UNIT_UNDER_TEST ${TFM_ROOT_DIR}/lib/tfm_log/src/tfm_log.c)
+set(UNIT_TEST_SUITE ${CMAKE_CURRENT_LIST_DIR}/test_tfm_log_buffer.c)
+
+# Dependencies for the UUT, that get linked into the executable
+set(UNIT_TEST_DEPS ${TFM_ROOT_DIR}/lib/tfm_vprintf/src/tfm_vprintf.c)
+
+# Include directories for compilation
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/tfm_log/inc)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/tfm_vprintf/inc)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/platform/ext/common)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/tfm_log/unittests/include)
+
+# Headers to be mocked
+
+# Compile-time definitions
+list(APPEND UNIT_TEST_COMPILE_DEFS LOG_LEVEL=LOG_LEVEL_VERBOSE)
+list(APPEND UNIT_TEST_COMPILE_DEFS TFM_LOG_BUFFER_SIZE=64)
+list(APPEND UNIT_TEST_COMPILE_DEFS TFM_LOG_LINE_SIZE=32)
+list(APPEND UNIT_TEST_COMPILE_DEFS TFM_LOG_BUFFER_OVERFLOW=TFM_LOG_BUFFER_OVERFLOW_FLUSH)
+list(APPEND UNIT_TEST_COMPILE_DEFS TFM_LOG_BUFFER_DROP_COUNTER=1)
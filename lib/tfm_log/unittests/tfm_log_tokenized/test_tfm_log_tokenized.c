@@ -0,0 +1,182 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "tfm_log.h"
+#include "uart_stdout.h"
+
+/* Captures the last line written to the UART */
+static char uart_buf[128];
+static uint32_t uart_len;
+static unsigned int uart_calls;
+
+/* Record decoded from uart_buf */
+static uint8_t record[64];
+static size_t record_len;
+
+int stdio_output_string(const char *str, uint32_t len)
+{
+    TEST_ASSERT_LESS_OR_EQUAL(sizeof(uart_buf), len);
+
+    memcpy(uart_buf, str, len);
+    uart_len = len;
+    uart_calls++;
+
+    return len;
+}
+
+static int base64_value(char c)
+{
+    const char *chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const char *pos = strchr(chars, c);
+
+    return (c != '\0' && pos != NULL) ? (int)(pos - chars) : -1;
+}
+
+/* Checks the framing of the captured line and decodes the record in it */
+static void decode_line(void)
+{
+    uint32_t bits = 0;
+    int num_bits = 0;
+    int val;
+
+    TEST_ASSERT_EQUAL(1, uart_calls);
+    TEST_ASSERT_TRUE(uart_len >= 3);
+    TEST_ASSERT_EQUAL('$', uart_buf[0]);
+    TEST_ASSERT_EQUAL_MEMORY("\r\n", &uart_buf[uart_len - 2], 2);
+    TEST_ASSERT_EQUAL(0, (uart_len - 3) % 4);
+
+    record_len = 0;
+    for (uint32_t i = 1; i < uart_len - 2; i++) {
+        if (uart_buf[i] == '=') {
+            break;
+        }
+
+        val = base64_value(uart_buf[i]);
+        TEST_ASSERT_TRUE(val >= 0);
+
+        bits = (bits << 6) | (uint32_t)val;
+        num_bits += 6;
+        if (num_bits >= 8) {
+            num_bits -= 8;
+            record[record_len++] = (uint8_t)(bits >> num_bits);
+        }
+    }
+}
+
+void setUp(void)
+{
+    uart_len = 0;
+    uart_calls = 0;
+    record_len = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void test_tfm_log_arg_desc_should_countArgsAndMarkStrings(void)
+{
+    const char *str = "str";
+    char buf[4] = "buf";
+    const uint8_t byte = 1;
+
+    TEST_ASSERT_EQUAL_HEX32(0, TFM_LOG_ARG_DESC("fmt"));
+    TEST_ASSERT_EQUAL_HEX32(0x1, TFM_LOG_ARG_DESC("fmt %u", 1u));
+    TEST_ASSERT_EQUAL_HEX32(0x4 | (0xA << 4),
+                            TFM_LOG_ARG_DESC("fmt %d %s %x %s", -1, str, byte, buf));
+    TEST_ASSERT_EQUAL_HEX32(12 | (0x800 << 4),
+                            TFM_LOG_ARG_DESC("fmt", 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, "12"));
+}
+
+void test_tfm_log_arg_desc_should_markAllCharPointers(void)
+{
+    uint8_t bytes[4] = "u8";
+    const unsigned char *ustr = bytes;
+    signed char sbuf[4] = "s8";
+    const signed char *sstr = sbuf;
+    const uint8_t *not_str[1] = { bytes };
+
+    TEST_ASSERT_EQUAL_HEX32(5 | (0xF << 4),
+                            TFM_LOG_ARG_DESC("fmt %s %s %s %s %p", bytes, ustr, sbuf, sstr, not_str));
+}
+
+void test_tfm_log_tokenized_should_encodeTokenOnly(void)
+{
+    tfm_log_tokenized(0x7F, 0);
+
+    decode_line();
+    TEST_ASSERT_EQUAL(7, uart_len);
+    TEST_ASSERT_EQUAL_MEMORY("$fwA=\r\n", uart_buf, uart_len);
+}
+
+void test_tfm_log_tokenized_should_encodeIntegersAndStrings(void)
+{
+    const uint8_t expected[] = { 0xAC, 0x02, 0x23, 0x01, 0x02, 'a', 'b', 0xFF, 0xFF, 0xFF, 0xFF,
+                                 0x0F };
+
+    tfm_log_tokenized(300, 3 | (0x2 << 4), 1, "ab", -1);
+
+    decode_line();
+    TEST_ASSERT_EQUAL_MEMORY("$rAIjAQJhYv////8P\r\n", uart_buf, uart_len);
+    TEST_ASSERT_EQUAL(sizeof(expected), record_len);
+    TEST_ASSERT_EQUAL_MEMORY(expected, record, record_len);
+}
+
+void test_tfm_log_tokenized_should_encodeNullStringAsEmpty(void)
+{
+    const uint8_t expected[] = { 0x01, 0x12, 0x00, 0x05 };
+
+    tfm_log_tokenized(1, 2 | (0x1 << 4), NULL, 5);
+
+    decode_line();
+    TEST_ASSERT_EQUAL(sizeof(expected), record_len);
+    TEST_ASSERT_EQUAL_MEMORY(expected, record, record_len);
+}
+
+void test_tfm_log_tokenized_should_truncateToRecordSize(void)
+{
+    /* The 16 byte record holds the token, the descriptor, the first integer
+     * and 12 bytes of the string, but no room is left for the last integer
+     */
+    const uint8_t expected[] = { 0x01, 0x23, 0x02, 0x0C, '0', '1', '2', '3', '4', '5', '6',
+                                 '7', '8', '9', 'a', 'b' };
+
+    tfm_log_tokenized(1, 3 | (0x2 << 4), 2, "0123456789abcdef", 3);
+
+    decode_line();
+    TEST_ASSERT_EQUAL(TFM_LOG_TOKENIZED_RECORD_SIZE, record_len);
+    TEST_ASSERT_EQUAL_MEMORY(expected, record, record_len);
+}
+
+void test_tfm_log_macros_should_emitRecordWithArguments(void)
+{
+    uint32_t pos = 0;
+
+    INFO("Booting %s v%u\n", "TF-M", 2);
+
+    decode_line();
+
+    /* Skip the token, which is the address of the format string */
+    while (record[pos] & 0x80) {
+        pos++;
+    }
+    pos++;
+
+    /* Two arguments, the first of which is a string */
+    TEST_ASSERT_EQUAL_HEX8(2 | (0x1 << 4), record[pos]);
+    pos++;
+
+    TEST_ASSERT_EQUAL(6, record_len - pos);
+    TEST_ASSERT_EQUAL_MEMORY("\x04" "TF-M" "\x02", &record[pos], 6);
+}
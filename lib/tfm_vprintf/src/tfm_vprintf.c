@@ -43,13 +43,21 @@ static void output_char(tfm_log_output_str output_func, void *priv, char c)
     output_func(priv, &c, 1);
 }
 
+/* Padding is emitted in runs of up to this many characters per call */
+#define PADDING_RUN_LEN (8)
+
 static inline void output_padding_chars(tfm_log_output_str output_func, void *priv,
                                         uint16_t num_padding, char pad_char)
 {
-    uint16_t i;
+    static const char spaces[PADDING_RUN_LEN] = { ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ' };
+    static const char zeros[PADDING_RUN_LEN] = { '0', '0', '0', '0', '0', '0', '0', '0' };
+    const char *run = (pad_char == '0') ? zeros : spaces;
+    uint16_t len;
 
-    for (i = 0; i < num_padding; i++) {
-        output_char(output_func, priv, pad_char);
+    while (num_padding > 0) {
+        len = (num_padding > PADDING_RUN_LEN) ? PADDING_RUN_LEN : num_padding;
+        output_func(priv, run, len);
+        num_padding -= len;
     }
 }
 
@@ -147,6 +155,7 @@ static void output_val(tfm_log_output_str output_func, void *priv, uint32_t val,
 static void tfm_vprintf_internal(tfm_log_output_str output_func,
                                 void *priv, const char *fmt, va_list args)
 {
+    const char *run;
     char c;
     bool formatting = false;
     uint16_t num_padding = 0;
@@ -160,11 +169,17 @@ static void tfm_vprintf_internal(tfm_log_output_str output_func,
                 num_padding = 0;
                 left_aligned = false;
                 formatting = true;
+            } else if (c == '\n') {
+                output_func(priv, "\r\n", 2);
             } else {
-                if (c == '\n') {
-                    output_char(output_func, priv, '\r');
+                /* Emit the literal text up to the next conversion or newline
+                 * in a single call rather than character by character
+                 */
+                run = fmt - 1;
+                while ((*fmt != '\0') && (*fmt != '%') && (*fmt != '\n')) {
+                    fmt++;
                 }
-                output_char(output_func, priv, c);
+                output_func(priv, run, (uint32_t)(fmt - run));
             }
             continue;
         }
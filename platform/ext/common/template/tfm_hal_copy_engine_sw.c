@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Reference copy engine, done in software. It behaves as a simple DMA
+ * channel would: transfers are split in blocks of a bounded number of
+ * elements, the element width follows the common alignment of the buffers,
+ * and overlapping buffers are refused. It lets the SPM copy engine path be
+ * exercised on platforms, or hosts, without a DMA controller.
+ */
+
+#include <stdint.h>
+
+#include "tfm_hal_copy_engine.h"
+
+/* The maximum number of elements moved by a single block transfer */
+#ifndef TFM_HAL_COPY_ENGINE_SW_MAX_BLOCK_ELEMS
+#define TFM_HAL_COPY_ENGINE_SW_MAX_BLOCK_ELEMS    (0xFFFFu)
+#endif
+
+static void copy_block(uintptr_t dst, uintptr_t src, size_t elems,
+                       size_t width)
+{
+    size_t i;
+
+    for (i = 0; i < elems; i++) {
+        switch (width) {
+        case sizeof(uint32_t):
+            ((volatile uint32_t *)dst)[i] = ((const volatile uint32_t *)src)[i];
+            break;
+        case sizeof(uint16_t):
+            ((volatile uint16_t *)dst)[i] = ((const volatile uint16_t *)src)[i];
+            break;
+        default:
+            ((volatile uint8_t *)dst)[i] = ((const volatile uint8_t *)src)[i];
+            break;
+        }
+    }
+}
+
+enum tfm_hal_status_t tfm_hal_copy_engine_copy(void *dst, const void *src,
+                                               size_t size)
+{
+    uintptr_t dst_addr = (uintptr_t)dst;
+    uintptr_t src_addr = (uintptr_t)src;
+    uintptr_t common = dst_addr | src_addr | (uintptr_t)size;
+    size_t width, elems, block;
+
+    if (size == 0) {
+        return TFM_HAL_SUCCESS;
+    }
+
+    if ((dst == NULL) || (src == NULL) ||
+        (dst_addr > (UINTPTR_MAX - size)) || (src_addr > (UINTPTR_MAX - size))) {
+        return TFM_HAL_ERROR_INVALID_INPUT;
+    }
+
+    /* A DMA channel does not handle overlapping buffers */
+    if ((dst_addr < (src_addr + size)) && (src_addr < (dst_addr + size))) {
+        return TFM_HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    if ((common & (sizeof(uint32_t) - 1)) == 0) {
+        width = sizeof(uint32_t);
+    } else if ((common & (sizeof(uint16_t) - 1)) == 0) {
+        width = sizeof(uint16_t);
+    } else {
+        width = sizeof(uint8_t);
+    }
+
+    elems = size / width;
+    while (elems > 0) {
+        block = (elems < TFM_HAL_COPY_ENGINE_SW_MAX_BLOCK_ELEMS) ?
+                elems : TFM_HAL_COPY_ENGINE_SW_MAX_BLOCK_ELEMS;
+
+        copy_block(dst_addr, src_addr, block, width);
+
+        dst_addr += block * width;
+        src_addr += block * width;
+        elems -= block;
+    }
+
+    return TFM_HAL_SUCCESS;
+}
@@ -0,0 +1,22 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "tfm_hal_copy_engine.h"
+
+#include "cmsis_compiler.h"
+
+/* Platforms without a copy engine leave every copy to the CPU */
+__WEAK enum tfm_hal_status_t tfm_hal_copy_engine_copy(void *dst,
+                                                      const void *src,
+                                                      size_t size)
+{
+    (void)dst;
+    (void)src;
+    (void)size;
+
+    return TFM_HAL_ERROR_NOT_SUPPORTED;
+}
@@ -52,6 +52,42 @@
 
 static uint32_t idx_boundary_handle = 0;
 
+#ifdef CONFIG_TFM_ENABLE_MEMORY_PROTECT
+/*
+ * The dynamic MPU regions of each unprivileged partition are assembled once
+ * when its boundary is bound and stored in a shared pool. Platforms with more
+ * partitions or MMIO regions can enlarge the pool in tfm_peripherals_def.h.
+ */
+#ifndef TFM_ISOLATION_L3_MAX_BOUNDARIES
+#define TFM_ISOLATION_L3_MAX_BOUNDARIES         32U
+#endif
+#ifndef TFM_ISOLATION_L3_MPU_REGION_POOL_SIZE
+#define TFM_ISOLATION_L3_MPU_REGION_POOL_SIZE   64U
+#endif
+
+#if TFM_ISOLATION_L3_MAX_BOUNDARIES > (1UL << HANDLE_INDEX_BITS)
+#error "TFM_ISOLATION_L3_MAX_BOUNDARIES exceeds the number of unique handles"
+#endif
+#if TFM_ISOLATION_L3_MPU_REGION_POOL_SIZE > UINT8_MAX
+#error "TFM_ISOLATION_L3_MPU_REGION_POOL_SIZE shall not exceed 255"
+#endif
+
+/* Location of the precomputed MPU regions of a boundary in the pool */
+struct boundary_regions_t {
+    uint8_t base;
+    uint8_t count;
+};
+
+static ARM_MPU_Region_t boundary_region_pool[TFM_ISOLATION_L3_MPU_REGION_POOL_SIZE];
+static uint32_t n_pool_regions;
+static struct boundary_regions_t boundary_regions[TFM_ISOLATION_L3_MAX_BOUNDARIES];
+
+/* Boundary whose regions are currently loaded into the MPU, if any */
+static bool loaded_boundary_valid;
+static uintptr_t loaded_boundary;
+static uint32_t n_loaded_regions;
+#endif /* CONFIG_TFM_ENABLE_MEMORY_PROTECT */
+
 #else /* TFM_ISOLATION_LEVEL == 3 */
 #define PROT_BOUNDARY_VAL \
     ((1U << HANDLE_ATTR_PRIV_POS) & HANDLE_ATTR_PRIV_MASK)
@@ -359,6 +395,10 @@ const ARM_MPU_Region_t mpu_region_attributes[] = {
     while (i < mpu_region_num) {
         ARM_MPU_ClrRegion(i++);
     }
+#if TFM_ISOLATION_LEVEL == 3
+    loaded_boundary_valid = false;
+    n_loaded_regions = 0;
+#endif
 
     /* Enable MPU with the above configurations. Allow default memory map for
      * privileged software and enable MPU during HardFault and NMI handlers.
@@ -371,6 +411,126 @@ const ARM_MPU_Region_t mpu_region_attributes[] = {
     FIH_RET(TFM_HAL_SUCCESS);
 }
 
+#if (TFM_ISOLATION_LEVEL == 3) && defined(CONFIG_TFM_ENABLE_MEMORY_PROTECT)
+/*
+ * Assemble the runtime memory and named MMIO regions of an unprivileged
+ * partition into the region pool, so that tfm_hal_activate_boundary() only
+ * needs to load them into the MPU.
+ */
+static enum tfm_hal_status_t prepare_boundary_regions(
+                                    const struct partition_load_info_t *p_ldinf,
+                                    uint32_t handle)
+{
+    const uint32_t mpu_region_num =
+        (MPU->TYPE & MPU_TYPE_DREGION_Msk) >> MPU_TYPE_DREGION_Pos;
+    uint32_t idx = (handle & HANDLE_INDEX_MASK) >> 24;
+    uint32_t max_regions;
+    ARM_MPU_Region_t *regions;
+    uint32_t i, n = 0;
+    const struct asset_desc_t *rt_mem;
+#if CONFIG_TFM_MMIO_REGION_ENABLE == 1
+    uint32_t mmio_index;
+    struct platform_data_t *plat_data_ptr;
+    const uintptr_t *mmio_list;
+    size_t mmio_list_length;
+#endif /* CONFIG_TFM_MMIO_REGION_ENABLE == 1 */
+
+    if ((idx >= TFM_ISOLATION_L3_MAX_BOUNDARIES) ||
+        (n_static_regions >= mpu_region_num)) {
+        return TFM_HAL_ERROR_GENERIC;
+    }
+
+    max_regions = mpu_region_num - n_static_regions;
+    if (max_regions > TFM_ISOLATION_L3_MPU_REGION_POOL_SIZE - n_pool_regions) {
+        max_regions = TFM_ISOLATION_L3_MPU_REGION_POOL_SIZE - n_pool_regions;
+    }
+    regions = &boundary_region_pool[n_pool_regions];
+
+    /* Setup runtime memory first */
+    rt_mem = LOAD_INFO_ASSET(p_ldinf);
+    /*
+     * NOTE: This implementation relies on the partition load info template
+     * ordering the runtime memory asset(s) before the MMIO assets. If more
+     * memory assets or numbered MMIO assets with memory regions are added then
+     * it needs to be revisited.
+     */
+    for (i = 0;
+         i < p_ldinf->nassets && !(rt_mem[i].attr & ASSET_ATTR_MMIO);
+         i++) {
+        if ((n >= max_regions) ||
+            ((rt_mem[i].mem.start & ~MPU_RBAR_BASE_Msk) != 0) ||
+            (((rt_mem[i].mem.limit - 1) & ~MPU_RLAR_LIMIT_Msk) != 0x1F)) {
+            return TFM_HAL_ERROR_GENERIC;
+        }
+        /* Assemble region base and limit address register contents. */
+        regions[n].RBAR = ARM_MPU_RBAR(rt_mem[i].mem.start,
+                                       ARM_MPU_SH_NON,
+                                       ARM_MPU_READ_WRITE,
+                                       ARM_MPU_UNPRIVILEGED,
+                                       ARM_MPU_EXECUTE_NEVER);
+        /* Attr1 contains required attribute set for data regions */
+        #ifdef TFM_PXN_ENABLE
+        regions[n].RLAR = ARM_MPU_RLAR_PXN(rt_mem[i].mem.limit - 1,
+                                           ARM_MPU_PRIVILEGE_EXECUTE_NEVER,
+                                           1);
+        #else
+        regions[n].RLAR = ARM_MPU_RLAR(rt_mem[i].mem.limit - 1,
+                                       1);
+        #endif
+        n++;
+    }
+
+#if CONFIG_TFM_MMIO_REGION_ENABLE == 1
+    /* Named MMIO part */
+    handle &= ~HANDLE_INDEX_MASK;
+    handle >>= HANDLE_PER_ATTR_BITS;
+    mmio_index = handle & HANDLE_ATTR_INDEX_MASK;
+
+    get_partition_named_mmio_list(&mmio_list, &mmio_list_length);
+
+    while (mmio_index) {
+        if ((n >= max_regions) || (mmio_index > mmio_list_length)) {
+            return TFM_HAL_ERROR_GENERIC;
+        }
+
+        plat_data_ptr = (struct platform_data_t *)mmio_list[mmio_index - 1];
+
+        if (((plat_data_ptr->periph_start & ~MPU_RBAR_BASE_Msk) != 0) ||
+            ((plat_data_ptr->periph_limit & ~MPU_RLAR_LIMIT_Msk) != 0x1F)) {
+            return TFM_HAL_ERROR_GENERIC;
+        }
+
+        /* Assemble region base and limit address register contents. */
+        regions[n].RBAR = ARM_MPU_RBAR(plat_data_ptr->periph_start,
+                                       ARM_MPU_SH_NON,
+                                       (handle & HANDLE_ATTR_RW_POS) ?
+                                       ARM_MPU_READ_WRITE : ARM_MPU_READ_ONLY,
+                                       ARM_MPU_UNPRIVILEGED,
+                                       ARM_MPU_EXECUTE_NEVER);
+        /* Attr2 contains required attribute set for device regions */
+        #ifdef TFM_PXN_ENABLE
+        regions[n].RLAR = ARM_MPU_RLAR_PXN(plat_data_ptr->periph_limit,
+                                           ARM_MPU_PRIVILEGE_EXECUTE_NEVER,
+                                           2);
+        #else
+        regions[n].RLAR = ARM_MPU_RLAR(plat_data_ptr->periph_limit,
+                                       2);
+        #endif
+        n++;
+
+        handle >>= HANDLE_PER_ATTR_BITS;
+        mmio_index = handle & HANDLE_ATTR_INDEX_MASK;
+    }
+#endif /* CONFIG_TFM_MMIO_REGION_ENABLE == 1 */
+
+    boundary_regions[idx].base = (uint8_t)n_pool_regions;
+    boundary_regions[idx].count = (uint8_t)n;
+    n_pool_regions += n;
+
+    return TFM_HAL_SUCCESS;
+}
+#endif /* (TFM_ISOLATION_LEVEL == 3) && CONFIG_TFM_ENABLE_MEMORY_PROTECT */
+
 /*
  * Implementation of tfm_hal_bind_boundary():
  *
@@ -408,6 +568,9 @@ const ARM_MPU_Region_t mpu_region_attributes[] = {
  * 2. The valid range of values for MMIO Index is 1 to 7.
  * 3. Highest 8 bits are for index. It supports 256 unique handles at most.
  * 4. Only named MMIO regions are supported. Numbered MMIO regions are ignored.
+ * 5. Under isolation level 3, the MPU regions of unprivileged partitions are
+ *    precomputed here. At most TFM_ISOLATION_L3_MAX_BOUNDARIES boundaries and
+ *    TFM_ISOLATION_L3_MPU_REGION_POOL_SIZE regions in total are supported.
  */
 FIH_RET_TYPE(enum tfm_hal_status_t) tfm_hal_bind_boundary(const struct partition_load_info_t *p_ldinf,
                                                           uintptr_t *p_boundary)
@@ -558,6 +721,14 @@ FIH_RET_TYPE(enum tfm_hal_status_t) tfm_hal_bind_boundary(const struct partition
                         HANDLE_ATTR_PRIV_MASK;
     partition_attrs |= ((uint32_t)ns_agent_tz << HANDLE_ATTR_NS_POS) &
                         HANDLE_ATTR_NS_MASK;
+
+#if (TFM_ISOLATION_LEVEL == 3) && defined(CONFIG_TFM_ENABLE_MEMORY_PROTECT)
+    if (!privileged &&
+        prepare_boundary_regions(p_ldinf, partition_attrs) != TFM_HAL_SUCCESS) {
+        FIH_RET(TFM_HAL_ERROR_GENERIC);
+    }
+#endif
+
     *p_boundary = (uintptr_t)partition_attrs;
 
     FIH_RET(TFM_HAL_SUCCESS);
@@ -571,18 +742,8 @@ FIH_RET_TYPE(enum tfm_hal_status_t) tfm_hal_activate_boundary(const struct parti
     bool privileged = !!(local_handle & HANDLE_ATTR_PRIV_MASK);
 #if TFM_ISOLATION_LEVEL == 3
     bool is_spm = !!(local_handle & HANDLE_ATTR_SPM_MASK);
-    ARM_MPU_Region_t local_mpu_region;
-    const uint32_t mpu_region_num =
-        (MPU->TYPE & MPU_TYPE_DREGION_Msk) >> MPU_TYPE_DREGION_Pos;
-    uint32_t i;
-    const struct asset_desc_t *rt_mem;
-    enum tfm_hal_status_t status = TFM_HAL_SUCCESS;
-#if CONFIG_TFM_MMIO_REGION_ENABLE == 1
-    uint32_t mmio_index;
-    struct platform_data_t *plat_data_ptr;
-    const uintptr_t *mmio_list;
-    size_t mmio_list_length;
-#endif /* CONFIG_TFM_MMIO_REGION_ENABLE == 1 */
+    const struct boundary_regions_t *p_regions;
+    uint32_t idx, i;
 #endif /* TFM_ISOLATION_LEVEL == 3 */
 
     /* Privileged level is required to be set always */
@@ -604,110 +765,44 @@ FIH_RET_TYPE(enum tfm_hal_status_t) tfm_hal_activate_boundary(const struct parti
         FIH_RET(TFM_HAL_SUCCESS);
     }
 
-    /* Turn off MPU during configuration */
-    ARM_MPU_Disable();
-
-    /* Setup runtime memory first */
-    rt_mem = LOAD_INFO_ASSET(p_ldinf);
     /*
-     * NOTE: This implementation relies on the partition load info template
-     * ordering the runtime memory asset(s) before the MMIO assets. If more
-     * memory assets or numbered MMIO assets with memory regions are added then
-     * it needs to be revisited.
+     * Privileged partitions leave the MPU untouched, so the regions of the
+     * last unprivileged partition may still be loaded.
      */
-    for (i = 0;
-         i < p_ldinf->nassets && !(rt_mem[i].attr & ASSET_ATTR_MMIO);
-         i++) {
-        if ((n_static_regions + i >= mpu_region_num) ||
-            ((rt_mem[i].mem.start & ~MPU_RBAR_BASE_Msk) != 0) ||
-            (((rt_mem[i].mem.limit - 1) & ~MPU_RLAR_LIMIT_Msk) != 0x1F)) {
-            status = TFM_HAL_ERROR_GENERIC;
-            goto out;
-        }
-        /* Assemble region base and limit address register contents. */
-        local_mpu_region.RBAR = ARM_MPU_RBAR(rt_mem[i].mem.start,
-                                             ARM_MPU_SH_NON,
-                                             ARM_MPU_READ_WRITE,
-                                             ARM_MPU_UNPRIVILEGED,
-                                             ARM_MPU_EXECUTE_NEVER);
-        /* Attr1 contains required attribute set for data regions */
-        #ifdef TFM_PXN_ENABLE
-        local_mpu_region.RLAR = ARM_MPU_RLAR_PXN(rt_mem[i].mem.limit - 1,
-                                                 ARM_MPU_PRIVILEGE_EXECUTE_NEVER,
-                                                 1);
-        #else
-        local_mpu_region.RLAR = ARM_MPU_RLAR(rt_mem[i].mem.limit - 1,
-                                             1);
-        #endif
-
-        /* Configure device MPU region */
-        ARM_MPU_SetRegion(n_static_regions + i,
-                          local_mpu_region.RBAR,
-                          local_mpu_region.RLAR);
+    if (loaded_boundary_valid && (loaded_boundary == boundary)) {
+        FIH_RET(TFM_HAL_SUCCESS);
     }
 
-    i += n_static_regions;
-
-#if CONFIG_TFM_MMIO_REGION_ENABLE == 1
-    /* Named MMIO part */
-    local_handle &= ~HANDLE_INDEX_MASK;
-    local_handle >>= HANDLE_PER_ATTR_BITS;
-    mmio_index = local_handle & HANDLE_ATTR_INDEX_MASK;
-
-    get_partition_named_mmio_list(&mmio_list, &mmio_list_length);
-
-    while (mmio_index) {
-        if ((i >= mpu_region_num) || (mmio_index > mmio_list_length)) {
-            status = TFM_HAL_ERROR_GENERIC;
-            goto out;
-        }
-
-        plat_data_ptr = (struct platform_data_t *)mmio_list[mmio_index - 1];
-
-        if (((plat_data_ptr->periph_start & ~MPU_RBAR_BASE_Msk) != 0) ||
-            ((plat_data_ptr->periph_limit & ~MPU_RLAR_LIMIT_Msk) != 0x1F)) {
-            status = TFM_HAL_ERROR_GENERIC;
-            goto out;
-        }
-
-        /* Assemble region base and limit address register contents. */
-        local_mpu_region.RBAR = ARM_MPU_RBAR(plat_data_ptr->periph_start,
-                                             ARM_MPU_SH_NON,
-                                             (local_handle & HANDLE_ATTR_RW_POS) ?
-                                             ARM_MPU_READ_WRITE : ARM_MPU_READ_ONLY,
-                                             ARM_MPU_UNPRIVILEGED,
-                                             ARM_MPU_EXECUTE_NEVER);
-        /* Attr2 contains required attribute set for device regions */
-        #ifdef TFM_PXN_ENABLE
-        local_mpu_region.RLAR = ARM_MPU_RLAR_PXN(plat_data_ptr->periph_limit,
-                                                 ARM_MPU_PRIVILEGE_EXECUTE_NEVER,
-                                                 2);
-        #else
-        local_mpu_region.RLAR = ARM_MPU_RLAR(plat_data_ptr->periph_limit,
-                                             2);
-        #endif
+    idx = (local_handle & HANDLE_INDEX_MASK) >> 24;
+    if (idx >= TFM_ISOLATION_L3_MAX_BOUNDARIES) {
+        FIH_RET(TFM_HAL_ERROR_GENERIC);
+    }
+    p_regions = &boundary_regions[idx];
 
-        /* Configure device MPU region */
-        ARM_MPU_SetRegion(i++, local_mpu_region.RBAR, local_mpu_region.RLAR);
+    /* Turn off MPU during configuration */
+    ARM_MPU_Disable();
 
-        local_handle >>= HANDLE_PER_ATTR_BITS;
-        mmio_index = local_handle & HANDLE_ATTR_INDEX_MASK;
+    /* The regions were validated and assembled when binding the boundary */
+    if (p_regions->count > 0) {
+        ARM_MPU_Load(n_static_regions,
+                     &boundary_region_pool[p_regions->base],
+                     p_regions->count);
     }
-#endif /* CONFIG_TFM_MMIO_REGION_ENABLE == 1 */
 
-    /* Disable unused regions */
-    while (i < mpu_region_num) {
-        ARM_MPU_ClrRegion(i++);
+    /* Disable the regions left over from the previous boundary */
+    for (i = p_regions->count; i < n_loaded_regions; i++) {
+        ARM_MPU_ClrRegion(n_static_regions + i);
     }
 
-out:
+    loaded_boundary = boundary;
+    loaded_boundary_valid = true;
+    n_loaded_regions = p_regions->count;
+
     /* Enable MPU with the new regions added */
     ARM_MPU_Enable(MPU_CTRL_PRIVDEFENA_Msk | MPU_CTRL_HFNMIENA_Msk);
+#endif /* TFM_ISOLATION_LEVEL == 3 */
 
-    FIH_RET(status);
-#else /* TFM_ISOLATION_LEVEL == 3 */
     FIH_RET(TFM_HAL_SUCCESS);
-#endif /* TFM_ISOLATION_LEVEL == 3 */
 }
 
 FIH_RET_TYPE(enum tfm_hal_status_t) tfm_hal_memory_check(uintptr_t boundary, uintptr_t base,
@@ -8,8 +8,17 @@
 #include "tfm_hal_spm_logdev.h"
 #include "uart_stdout.h"
 
+#if defined(TFM_LOG_BUFFER_SIZE) && (TFM_LOG_BUFFER_SIZE > 0)
+#include "tfm_log.h"
+#endif
+
 int32_t tfm_hal_output_spm_log(const char *str, uint32_t len)
 {
+#if defined(TFM_LOG_BUFFER_SIZE) && (TFM_LOG_BUFFER_SIZE > 0)
+    /* Share the SPM log buffer, so partition output is drained in order */
+    return tfm_log_buffer_write(str, len);
+#else
     /* Peripheral based log function call the stdio_output_string directly */
     return stdio_output_string(str, len);
+#endif
 }
@@ -69,6 +69,7 @@ set(FWU_SUPPORT_TRIAL_STATE               ON         CACHE BOOL      "Device sup
 set(PLATFORM_GPT_LIBRARY                  ON         CACHE BOOL      "Build the GPT library")
 set(TFM_GPT_BLOCK_SIZE                    512        CACHE STRING    "The block size of a device formatted as a GUID Partition Table.")
 set(PLAT_MAX_PARTITION_ENTRIES            16         CACHE STRING    "The maximum number of GPT partition entries.")
+set(EFI_SOFT_CRC32_SLICES                 0          CACHE STRING    "Keep the table-free CRC32, as the library is also linked into BL1_1 ROM")
 
 if (${CMAKE_BUILD_TYPE} STREQUAL Debug OR ${CMAKE_BUILD_TYPE} STREQUAL RelWithDebInfo)
   set(ENABLE_FWU_AGENT_DEBUG_LOGS     TRUE          CACHE BOOL      "Enable Firmware update agent debug logs.")
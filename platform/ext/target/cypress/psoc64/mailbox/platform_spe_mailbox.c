@@ -47,7 +47,11 @@ static void mailbox_ipc_config(void)
 
 int32_t tfm_mailbox_hal_init(struct secure_mailbox_queue_t *s_queue)
 {
+#if MAILBOX_RING_PROTOCOL
+    struct mailbox_init_v2_t *ns_init = NULL;
+#else
     struct mailbox_init_t *ns_init = NULL;
+#endif
 
     /* Inform NSPE that NSPE mailbox initialization can start */
     platform_mailbox_send_msg_data(NS_MAILBOX_INIT_ENABLE);
@@ -66,7 +70,11 @@ int32_t tfm_mailbox_hal_init(struct secure_mailbox_queue_t *s_queue)
         return MAILBOX_INIT_ERROR;
     }
 
+#if MAILBOX_RING_PROTOCOL
+    s_queue->ns_rings = ns_init->rings;
+#else
     s_queue->ns_status = ns_init->status;
+#endif
     s_queue->ns_slot_count = ns_init->slot_count;
     s_queue->ns_slots = ns_init->slots;
 
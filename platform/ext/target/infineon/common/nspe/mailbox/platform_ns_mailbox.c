@@ -162,8 +162,13 @@ int32_t tfm_ns_mailbox_hal_init(struct ns_mailbox_queue_t *queue)
 
     /* Send out the address */
     /* IAR can't allocate stricter aligned structure in the stack */
+#if MAILBOX_RING_PROTOCOL
+    static struct mailbox_init_v2_t ns_init;
+    ns_init.rings = &queue->rings;
+#else
     static struct mailbox_init_t ns_init;
     ns_init.status = &queue->status;
+#endif
     ns_init.slot_count = NUM_MAILBOX_QUEUE_SLOT;
     ns_init.slots = &queue->slots[0];
     MAILBOX_CLEAN_CACHE(&ns_init, sizeof(ns_init));
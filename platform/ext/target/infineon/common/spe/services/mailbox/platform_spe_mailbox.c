@@ -68,9 +68,15 @@ int32_t tfm_mailbox_hal_init(struct secure_mailbox_queue_t *s_queue)
 {
     IFX_FIH_DECLARE(enum tfm_hal_status_t, fih_rc, TFM_HAL_ERROR_GENERIC);
     const struct partition_t *partition = GET_CURRENT_COMPONENT();
+#if MAILBOX_RING_PROTOCOL
+    struct mailbox_init_v2_t *ns_init = NULL;
+    /* IAR can't allocate stricter aligned structure in the stack */
+    static struct mailbox_init_v2_t ns_init_s;
+#else
     struct mailbox_init_t *ns_init = NULL;
     /* IAR can't allocate stricter aligned structure in the stack */
     static struct mailbox_init_t ns_init_s;
+#endif
 
     /* Inform NSPE that NSPE mailbox initialization can start */
     ifx_mailbox_send_msg_data(IFX_NS_MAILBOX_INIT_ENABLE);
@@ -104,12 +110,21 @@ int32_t tfm_mailbox_hal_init(struct secure_mailbox_queue_t *s_queue)
     }
 
     TFM_COVERITY_DEVIATE_BLOCK(MISRA_C_2023_Rule_10_4, "Cannot change types due to Fault injection architecture")
+#if MAILBOX_RING_PROTOCOL
+    FIH_CALL(tfm_hal_memory_check,
+             fih_rc,
+             partition->boundary,
+             (uintptr_t)ns_init_s.rings,
+             sizeof(*ns_init_s.rings),
+             (TFM_HAL_ACCESS_READWRITE | TFM_HAL_ACCESS_NS));
+#else
     FIH_CALL(tfm_hal_memory_check,
              fih_rc,
              partition->boundary,
              (uintptr_t)ns_init_s.status,
              sizeof(*ns_init_s.status),
              (TFM_HAL_ACCESS_READWRITE | TFM_HAL_ACCESS_NS));
+#endif
     TFM_COVERITY_DEVIATE_LINE(MISRA_C_2023_Rule_10_1, "Cannot change not equal logic due to Fault injection architecture and define FIH_NOT_EQ")
     if (FIH_NOT_EQ(fih_rc, PSA_SUCCESS)) {
         tfm_core_panic();
@@ -127,8 +142,13 @@ int32_t tfm_mailbox_hal_init(struct secure_mailbox_queue_t *s_queue)
     }
     TFM_COVERITY_BLOCK_END(MISRA_C_2023_Rule_10_4)
 
+#if MAILBOX_RING_PROTOCOL
+    TFM_COVERITY_DEVIATE_LINE(MISRA_C_2023_Rule_11_5, "Conversion is safe as ns_init_s.rings has the same type as s_queue->ns_rings")
+    s_queue->ns_rings = (struct mailbox_rings_t*)tfm_hal_remap_ns_cpu_address(ns_init_s.rings);
+#else
     TFM_COVERITY_DEVIATE_LINE(MISRA_C_2023_Rule_11_5, "Conversion is safe as ns_init_s.status has the same type as s_queue->ns_status")
     s_queue->ns_status = (struct mailbox_status_t*)tfm_hal_remap_ns_cpu_address(ns_init_s.status);
+#endif
     s_queue->ns_slot_count = ns_init_s.slot_count;
     TFM_COVERITY_DEVIATE_LINE(MISRA_C_2023_Rule_11_5, "Conversion is safe as ns_init_s.slots has the same type as s_queue->ns_slots")
     s_queue->ns_slots = (struct mailbox_slot_t*)tfm_hal_remap_ns_cpu_address(ns_init_s.slots);
@@ -146,6 +166,7 @@ int32_t tfm_mailbox_hal_deinit(struct secure_mailbox_queue_t *s_queue)
     NVIC_DisableIRQ(MAILBOX_IRQ);
 
     s_queue->ns_status = NULL;
+    s_queue->ns_rings = NULL;
     s_queue->ns_slot_count = 0;
     s_queue->ns_slots = NULL;
 
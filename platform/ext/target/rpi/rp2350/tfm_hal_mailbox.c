@@ -19,11 +19,15 @@ static struct irq_t mbox_irq_info = {0};
 
 int32_t tfm_mailbox_hal_init(struct secure_mailbox_queue_t *s_queue)
 {
+#if MAILBOX_RING_PROTOCOL
+    struct mailbox_init_v2_t *ns_init = NULL;
+#else
     struct mailbox_init_t *ns_init = NULL;
+#endif
 
     multicore_ns_fifo_push_blocking_inline(NS_MAILBOX_INIT);
 
-    ns_init = (struct mailbox_init_t *) multicore_ns_fifo_pop_blocking_inline();
+    ns_init = (void *) multicore_ns_fifo_pop_blocking_inline();
 
     /*
      * FIXME
@@ -34,7 +38,11 @@ int32_t tfm_mailbox_hal_init(struct secure_mailbox_queue_t *s_queue)
         return MAILBOX_INIT_ERROR;
     }
 
+#if MAILBOX_RING_PROTOCOL
+    s_queue->ns_rings = ns_init->rings;
+#else
     s_queue->ns_status = ns_init->status;
+#endif
     s_queue->ns_slot_count = ns_init->slot_count;
     s_queue->ns_slots = ns_init->slots;
 
@@ -0,0 +1,45 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_HAL_COPY_ENGINE_H__
+#define __TFM_HAL_COPY_ENGINE_H__
+
+#include <stddef.h>
+
+#include "tfm_hal_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Copies a buffer with a copy engine, such as a DMA controller, on
+ *        behalf of the SPM. The SPM uses it for psa_read() and psa_write()
+ *        transfers of at least CONFIG_TFM_SPM_COPY_ENGINE_THRESHOLD bytes,
+ *        once both buffers have passed the access checks of the caller.
+ *
+ * \note The copy must be complete, and visible to the CPU, when the function
+ *       returns. Any failure must leave the SPM free to redo the whole copy
+ *       with the CPU.
+ *
+ * \param[out] dst   Destination buffer
+ * \param[in]  src   Source buffer
+ * \param[in]  size  Number of bytes to copy
+ *
+ * \retval TFM_HAL_SUCCESS               The buffer has been copied.
+ * \retval TFM_HAL_ERROR_NOT_SUPPORTED   The engine cannot perform this copy,
+ *                                       e.g. for alignment or address reasons.
+ * \retval Other                         The copy failed.
+ */
+enum tfm_hal_status_t tfm_hal_copy_engine_copy(void *dst, const void *src,
+                                               size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFM_HAL_COPY_ENGINE_H__ */
@@ -35,6 +35,8 @@ struct secure_mailbox_queue_t {
     uint32_t                     ns_slot_count;
     /* Pointer to struct mailbox_slot_t[slot_count] allocated by NS */
     struct mailbox_slot_t        *ns_slots;
+    /* Shared rings, used instead of ns_status by the ring protocol */
+    struct mailbox_rings_t       *ns_rings;
 };
 
 /**
@@ -13,6 +13,17 @@
 
 #define ADDR_WORD_UNALIGNED(x)        ((x) & 0x3)
 
+/* Number of words, and of bytes, moved by each burst of word accesses */
+#define CRT_BURST_WORDS               (4u)
+#define CRT_BURST_SIZE                (CRT_BURST_WORDS * sizeof(uint32_t))
+
+/* Merging misaligned words relies on the byte order of the memory accesses */
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define CRT_LITTLE_ENDIAN             0
+#else
+#define CRT_LITTLE_ENDIAN             1
+#endif
+
 union composite_addr_t {
     uintptr_t uint_addr;        /* Address as integer value  */
     uint8_t   *p_byte;          /* Address in BYTE pointer   */
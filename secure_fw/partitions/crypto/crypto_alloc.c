@@ -5,6 +5,7 @@
  *
  */
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
@@ -29,39 +30,197 @@ enum {
 #define TFM_CRYPTO_INVALID_HANDLE (0x0u)
 
 /**
- * \brief A type describing the context stored in Secure memory by the TF-M Crypto
- *        service to support multipart calls on secure side
+ * \brief Layout of an operation handle: the operation type in the top bits,
+ *        then the generation of the slot, then the index of the slot in the
+ *        pool of that type. A released handle no longer matches the
+ *        generation of its slot, so stale handles are rejected.
  */
-struct tfm_crypto_operation_s {
-    uint32_t in_use;                /*!< Indicates if the operation is in use */
-    int32_t owner;                  /*!< Indicates an ID of the owner of
-                                     *   the context
-                                     */
-    enum tfm_crypto_operation_type type; /*!< Type of the operation */
-    union {
-        psa_cipher_operation_t cipher;    /*!< Cipher operation context */
-        psa_mac_operation_t mac;          /*!< MAC operation context */
-        psa_hash_operation_t hash;        /*!< Hash operation context */
-        psa_key_derivation_operation_t key_deriv; /*!< Key derivation operation context */
-        psa_aead_operation_t aead;        /*!< AEAD operation context */
-    } operation;
+#define HANDLE_INDEX_BITS   (8u)
+#define HANDLE_GEN_BITS     (20u)
+#define HANDLE_INDEX_MASK   ((1u << HANDLE_INDEX_BITS) - 1u)
+#define HANDLE_GEN_MASK     ((1u << HANDLE_GEN_BITS) - 1u)
+#define HANDLE_TYPE_SHIFT   (HANDLE_INDEX_BITS + HANDLE_GEN_BITS)
+
+#define HANDLE_MAKE(type, gen, idx) \
+    (((uint32_t)(type) << HANDLE_TYPE_SHIFT) | \
+     (((gen) & HANDLE_GEN_MASK) << HANDLE_INDEX_BITS) | \
+     ((idx) & HANDLE_INDEX_MASK))
+#define HANDLE_TYPE(h)      ((h) >> HANDLE_TYPE_SHIFT)
+#define HANDLE_GEN(h)       (((h) >> HANDLE_INDEX_BITS) & HANDLE_GEN_MASK)
+#define HANDLE_INDEX(h)     ((h) & HANDLE_INDEX_MASK)
+
+/* Marks the end of the free list of a pool */
+#define FREE_LIST_END       (0xFFu)
+
+#if (CRYPTO_CIPHER_OPER_NUM >= FREE_LIST_END) || \
+    (CRYPTO_MAC_OPER_NUM >= FREE_LIST_END) || \
+    (CRYPTO_HASH_OPER_NUM >= FREE_LIST_END) || \
+    (CRYPTO_KEY_DERIVATION_OPER_NUM >= FREE_LIST_END) || \
+    (CRYPTO_AEAD_OPER_NUM >= FREE_LIST_END) || \
+    (CRYPTO_PAKE_OPER_NUM >= FREE_LIST_END)
+#error "A Crypto operation pool can hold at most 254 operations"
+#endif
+
+/**
+ * \brief Bookkeeping of a slot of an operation pool
+ */
+struct tfm_crypto_slot_s {
+    int32_t owner;     /*!< Indicates an ID of the owner of the context */
+    uint32_t gen;      /*!< Generation of the slot, bumped on each release */
+    uint8_t in_use;    /*!< Indicates if the slot is in use */
+    uint8_t next_free; /*!< Next slot in the free list of the pool */
 };
 
-static struct tfm_crypto_operation_s operations[CRYPTO_CONC_OPER_NUM] = {{0}};
+/**
+ * \brief A pool of operation contexts of the same type, laid out densely
+ */
+struct tfm_crypto_pool_s {
+    uint8_t *contexts;               /*!< Array of contexts of the pool */
+    size_t context_size;             /*!< Size of a context */
+    struct tfm_crypto_slot_s *slots; /*!< Bookkeeping of each context */
+    uint8_t num;                     /*!< Number of contexts in the pool */
+    uint8_t free_head;               /*!< First free slot, or FREE_LIST_END */
+};
+
+#define POOL_STORAGE(name, ctx_type, num_ctx) \
+    static ctx_type name##_contexts[num_ctx]; \
+    static struct tfm_crypto_slot_s name##_slots[num_ctx]
+
+#define POOL_INIT(name) { \
+    .contexts = (uint8_t *)name##_contexts, \
+    .context_size = sizeof(name##_contexts[0]), \
+    .slots = name##_slots, \
+    .num = (uint8_t)(sizeof(name##_slots) / sizeof(name##_slots[0])), \
+    .free_head = FREE_LIST_END, \
+}
+
+#if CRYPTO_CIPHER_MODULE_ENABLED && (CRYPTO_CIPHER_OPER_NUM > 0)
+#define CIPHER_POOL_ENABLED
+POOL_STORAGE(cipher, psa_cipher_operation_t, CRYPTO_CIPHER_OPER_NUM);
+#endif
+#if CRYPTO_MAC_MODULE_ENABLED && (CRYPTO_MAC_OPER_NUM > 0)
+#define MAC_POOL_ENABLED
+POOL_STORAGE(mac, psa_mac_operation_t, CRYPTO_MAC_OPER_NUM);
+#endif
+#if CRYPTO_HASH_MODULE_ENABLED && (CRYPTO_HASH_OPER_NUM > 0)
+#define HASH_POOL_ENABLED
+POOL_STORAGE(hash, psa_hash_operation_t, CRYPTO_HASH_OPER_NUM);
+#endif
+#if CRYPTO_KEY_DERIVATION_MODULE_ENABLED && (CRYPTO_KEY_DERIVATION_OPER_NUM > 0)
+#define KEY_DERIV_POOL_ENABLED
+POOL_STORAGE(key_deriv, psa_key_derivation_operation_t,
+             CRYPTO_KEY_DERIVATION_OPER_NUM);
+#endif
+#if CRYPTO_AEAD_MODULE_ENABLED && (CRYPTO_AEAD_OPER_NUM > 0)
+#define AEAD_POOL_ENABLED
+POOL_STORAGE(aead, psa_aead_operation_t, CRYPTO_AEAD_OPER_NUM);
+#endif
+#if CRYPTO_PAKE_MODULE_ENABLED && (CRYPTO_PAKE_OPER_NUM > 0)
+#define PAKE_POOL_ENABLED
+POOL_STORAGE(pake, psa_pake_operation_t, CRYPTO_PAKE_OPER_NUM);
+#endif
+
+/* Indexed by \ref tfm_crypto_operation_type, pools left out are empty */
+static struct tfm_crypto_pool_s pools[TFM_CRYPTO_PAKE_OPERATION + 1] = {
+#ifdef CIPHER_POOL_ENABLED
+    [TFM_CRYPTO_CIPHER_OPERATION] = POOL_INIT(cipher),
+#endif
+#ifdef MAC_POOL_ENABLED
+    [TFM_CRYPTO_MAC_OPERATION] = POOL_INIT(mac),
+#endif
+#ifdef HASH_POOL_ENABLED
+    [TFM_CRYPTO_HASH_OPERATION] = POOL_INIT(hash),
+#endif
+#ifdef KEY_DERIV_POOL_ENABLED
+    [TFM_CRYPTO_KEY_DERIVATION_OPERATION] = POOL_INIT(key_deriv),
+#endif
+#ifdef AEAD_POOL_ENABLED
+    [TFM_CRYPTO_AEAD_OPERATION] = POOL_INIT(aead),
+#endif
+#ifdef PAKE_POOL_ENABLED
+    [TFM_CRYPTO_PAKE_OPERATION] = POOL_INIT(pake),
+#endif
+};
+
+#define NUM_POOLS (sizeof(pools) / sizeof(pools[0]))
+
+/* Total number of operations of all types */
+#define TOTAL_OPER_NUM (CRYPTO_CIPHER_OPER_NUM + CRYPTO_MAC_OPER_NUM + \
+                        CRYPTO_HASH_OPER_NUM + \
+                        CRYPTO_KEY_DERIVATION_OPER_NUM + \
+                        CRYPTO_AEAD_OPER_NUM + CRYPTO_PAKE_OPER_NUM + 1)
+
+/**
+ * \brief Number of operations held by a client, to enforce
+ *        CRYPTO_CONC_OPER_NUM. Each operation has one owner, so there are at
+ *        most as many owners as operations.
+ */
+struct tfm_crypto_owner_s {
+    int32_t id;     /*!< Client ID of the owner */
+    uint32_t count; /*!< Number of operations held, 0 if the entry is free */
+};
+
+static struct tfm_crypto_owner_s owners[TOTAL_OPER_NUM];
 
 /*
- * \brief Function used to clear the memory associated to a backend context
+ * \brief Finds the owner entry of a client
  *
- * \param[in] index Numerical index in the database of the backend contexts
+ * \param[in] id      Client ID
+ * \param[in] create  Whether to take a free entry if the client has none
  *
- * \return None
+ * \return Pointer to the entry, or NULL if not found
+ */
+static struct tfm_crypto_owner_s *find_owner(int32_t id, bool create)
+{
+    struct tfm_crypto_owner_s *free_entry = NULL;
+    uint32_t i;
+
+    for (i = 0; i < TOTAL_OPER_NUM; i++) {
+        if (owners[i].count == 0) {
+            if (free_entry == NULL) {
+                free_entry = &owners[i];
+            }
+        } else if (owners[i].id == id) {
+            return &owners[i];
+        }
+    }
+
+    if (create && free_entry != NULL) {
+        free_entry->id = id;
+    }
+
+    return create ? free_entry : NULL;
+}
+
+/*
+ * \brief Gets the slot referenced by a handle, if the handle is still valid
  *
+ * \param[in]  handle  Handle of the operation
+ * \param[out] pool    Pool the slot belongs to
+ *
+ * \return Pointer to the slot, or NULL if the handle is invalid or stale
  */
-static void memset_operation_context(uint32_t index)
+static struct tfm_crypto_slot_s *handle_to_slot(uint32_t handle,
+                                                struct tfm_crypto_pool_s **pool)
 {
-    /* Clear the contents of the backend context */
-    (void)memset((uint8_t *)&(operations[index].operation), 0,
-                 sizeof(operations[index].operation));
+    uint32_t type = HANDLE_TYPE(handle);
+    uint32_t idx = HANDLE_INDEX(handle);
+    struct tfm_crypto_slot_s *slot;
+
+    if ((handle == TFM_CRYPTO_INVALID_HANDLE) || (type >= NUM_POOLS) ||
+        (idx >= pools[type].num)) {
+        return NULL;
+    }
+
+    slot = &pools[type].slots[idx];
+    if ((slot->in_use != TFM_CRYPTO_IN_USE) ||
+        ((slot->gen & HANDLE_GEN_MASK) != HANDLE_GEN(handle))) {
+        return NULL;
+    }
+
+    *pool = &pools[type];
+
+    return slot;
 }
 
 /*!
@@ -73,8 +232,30 @@ static void memset_operation_context(uint32_t index)
 /*!@{*/
 psa_status_t tfm_crypto_init_alloc(void)
 {
-    /* Clear the contents of the local contexts */
-    (void)memset(operations, 0, sizeof(operations));
+    struct tfm_crypto_pool_s *pool;
+    uint32_t type;
+    uint8_t i;
+
+    for (type = 0; type < NUM_POOLS; type++) {
+        pool = &pools[type];
+        if (pool->num == 0) {
+            continue;
+        }
+
+        /* Clear the contents of the local contexts */
+        (void)memset(pool->contexts, 0, pool->num * pool->context_size);
+        (void)memset(pool->slots, 0, pool->num * sizeof(pool->slots[0]));
+
+        /* Chain all the slots in the free list */
+        for (i = 0; i < pool->num; i++) {
+            pool->slots[i].next_free = (i + 1u < pool->num) ? (uint8_t)(i + 1u)
+                                                            : FREE_LIST_END;
+        }
+        pool->free_head = 0;
+    }
+
+    (void)memset(owners, 0, sizeof(owners));
+
     return PSA_SUCCESS;
 }
 
@@ -82,9 +263,12 @@ psa_status_t tfm_crypto_operation_alloc(enum tfm_crypto_operation_type type,
                                         uint32_t *handle,
                                         void **ctx)
 {
-    uint32_t i = 0;
     int32_t partition_id = 0;
     psa_status_t status;
+    struct tfm_crypto_pool_s *pool;
+    struct tfm_crypto_slot_s *slot;
+    struct tfm_crypto_owner_s *owner;
+    uint8_t idx;
 
     /* Handle must be initialised before calling a setup function */
     if (*handle != TFM_CRYPTO_INVALID_HANDLE) {
@@ -97,23 +281,38 @@ psa_status_t tfm_crypto_operation_alloc(enum tfm_crypto_operation_type type,
     }
     *ctx = NULL;
 
+    if (((uint32_t)type >= NUM_POOLS) || (pools[type].num == 0)) {
+        return PSA_ERROR_NOT_PERMITTED;
+    }
+    pool = &pools[type];
+
     status = tfm_crypto_get_caller_id(&partition_id);
     if (status != PSA_SUCCESS) {
         return status;
     }
 
-    for (i = 0; i < CRYPTO_CONC_OPER_NUM; i++) {
-        if (operations[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
-            operations[i].in_use = TFM_CRYPTO_IN_USE;
-            operations[i].owner = partition_id;
-            operations[i].type = type;
-            *handle = i + 1;
-            *ctx = (void *) &(operations[i].operation);
-            return PSA_SUCCESS;
-        }
+    if (pool->free_head == FREE_LIST_END) {
+        return PSA_ERROR_NOT_PERMITTED;
+    }
+
+    /* A single client can not hold more than CRYPTO_CONC_OPER_NUM operations */
+    owner = find_owner(partition_id, true);
+    if ((owner == NULL) || (owner->count >= CRYPTO_CONC_OPER_NUM)) {
+        return PSA_ERROR_NOT_PERMITTED;
     }
 
-    return PSA_ERROR_NOT_PERMITTED;
+    idx = pool->free_head;
+    slot = &pool->slots[idx];
+    pool->free_head = slot->next_free;
+
+    slot->in_use = TFM_CRYPTO_IN_USE;
+    slot->owner = partition_id;
+    owner->count++;
+
+    *handle = HANDLE_MAKE(type, slot->gen, idx);
+    *ctx = (void *)(pool->contexts + (idx * pool->context_size));
+
+    return PSA_SUCCESS;
 }
 
 psa_status_t tfm_crypto_operation_release(uint32_t *handle)
@@ -121,12 +320,16 @@ psa_status_t tfm_crypto_operation_release(uint32_t *handle)
     uint32_t h_val = *handle;
     int32_t partition_id = 0;
     psa_status_t status;
+    struct tfm_crypto_pool_s *pool = NULL;
+    struct tfm_crypto_slot_s *slot;
+    struct tfm_crypto_owner_s *owner;
+    uint8_t idx;
 
     /* Handle shall be cleaned up always at first */
     *handle = TFM_CRYPTO_INVALID_HANDLE;
 
-    if ((h_val == TFM_CRYPTO_INVALID_HANDLE) ||
-        (h_val > CRYPTO_CONC_OPER_NUM)) {
+    slot = handle_to_slot(h_val, &pool);
+    if (slot == NULL) {
         return PSA_ERROR_INVALID_ARGUMENT;
     }
 
@@ -135,18 +338,28 @@ psa_status_t tfm_crypto_operation_release(uint32_t *handle)
         return status;
     }
 
-    if ((operations[h_val - 1].in_use == TFM_CRYPTO_IN_USE) &&
-        (operations[h_val - 1].owner == partition_id)) {
+    if (slot->owner != partition_id) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
 
-        memset_operation_context(h_val - 1);
-        operations[h_val - 1].in_use = TFM_CRYPTO_NOT_IN_USE;
-        operations[h_val - 1].type = TFM_CRYPTO_OPERATION_NONE;
-        operations[h_val - 1].owner = 0;
+    idx = (uint8_t)HANDLE_INDEX(h_val);
 
-        return PSA_SUCCESS;
+    /* Clear the contents of the backend context */
+    (void)memset(pool->contexts + (idx * pool->context_size), 0,
+                 pool->context_size);
+
+    owner = find_owner(partition_id, false);
+    if (owner != NULL) {
+        owner->count--;
     }
 
-    return PSA_ERROR_INVALID_ARGUMENT;
+    slot->in_use = TFM_CRYPTO_NOT_IN_USE;
+    slot->owner = 0;
+    slot->gen++;
+    slot->next_free = pool->free_head;
+    pool->free_head = idx;
+
+    return PSA_SUCCESS;
 }
 
 psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
@@ -155,9 +368,11 @@ psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
 {
     int32_t partition_id = 0;
     psa_status_t status;
+    struct tfm_crypto_pool_s *pool = NULL;
+    struct tfm_crypto_slot_s *slot;
 
-    if ((handle == TFM_CRYPTO_INVALID_HANDLE) ||
-        (handle > CRYPTO_CONC_OPER_NUM)) {
+    slot = handle_to_slot(handle, &pool);
+    if ((slot == NULL) || (HANDLE_TYPE(handle) != (uint32_t)type)) {
         return PSA_ERROR_BAD_STATE;
     }
 
@@ -170,10 +385,9 @@ psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
         return status;
     }
 
-    if ((operations[handle - 1].in_use == TFM_CRYPTO_IN_USE) &&
-        (operations[handle - 1].type == type) &&
-        (operations[handle - 1].owner == partition_id)) {
-        *ctx = (void *) &(operations[handle - 1].operation);
+    if (slot->owner == partition_id) {
+        *ctx = (void *)(pool->contexts +
+                        (HANDLE_INDEX(handle) * pool->context_size));
         return PSA_SUCCESS;
     }
 
@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config_tfm.h"
+#include "coverity_check.h"
+#include "tfm_mbedcrypto_include.h"
+
+#include "tfm_crypto_api.h"
+#include "tfm_crypto_key.h"
+#include "tfm_crypto_defs.h"
+
+TFM_COVERITY_DEVIATE_BLOCK(MISRA_C_2023_Rule_11_5, "It's PSA API design to use pointer to void")
+/*!
+ * \addtogroup tfm_crypto_api_shim_layer
+ *
+ */
+
+/*!@{*/
+#if CRYPTO_BATCH_MODULE_ENABLED
+/**
+ * \brief Only independent single-part operations can be batched, as they
+ *        neither allocate nor release operation contexts.
+ */
+static bool tfm_crypto_batch_is_allowed(enum tfm_crypto_func_sid_t sid)
+{
+    switch (sid) {
+    case TFM_CRYPTO_HASH_COMPUTE_SID:
+    case TFM_CRYPTO_HASH_COMPARE_SID:
+    case TFM_CRYPTO_MAC_COMPUTE_SID:
+    case TFM_CRYPTO_MAC_VERIFY_SID:
+    case TFM_CRYPTO_CIPHER_ENCRYPT_SID:
+    case TFM_CRYPTO_CIPHER_DECRYPT_SID:
+    case TFM_CRYPTO_AEAD_ENCRYPT_SID:
+    case TFM_CRYPTO_AEAD_DECRYPT_SID:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * \brief Checks that a slice of an item lies in the buffer shared by all the
+ *        items
+ */
+static bool tfm_crypto_batch_slice_is_valid(
+                                    const struct tfm_crypto_batch_slice *slice,
+                                    size_t buf_len)
+{
+    return (slice->offset <= buf_len) &&
+           (slice->len <= (buf_len - slice->offset));
+}
+
+/**
+ * \brief Runs a single item of a batch through the interface of its group
+ */
+static psa_status_t tfm_crypto_batch_run_item(
+                                        const struct tfm_crypto_batch_item *item,
+                                        psa_invec *input, psa_outvec *output,
+                                        size_t *out_len)
+{
+    psa_invec in_vec[PSA_MAX_IOVEC] = { {NULL, 0} };
+    psa_outvec out_vec[PSA_MAX_IOVEC] = { {NULL, 0} };
+    struct tfm_crypto_key_id_s encoded_key = TFM_CRYPTO_KEY_ID_S_INIT;
+    enum tfm_crypto_func_sid_t sid =
+                            (enum tfm_crypto_func_sid_t)item->iov.function_id;
+    psa_status_t status;
+    int32_t caller_id = 0;
+    uint32_t i;
+
+    *out_len = 0;
+
+    if (!tfm_crypto_batch_is_allowed(sid)) {
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+
+    if ((TFM_CRYPTO_GET_GROUP_ID(sid) == TFM_CRYPTO_GROUP_ID_AEAD) &&
+        (item->iov.aead_in.nonce_length > TFM_CRYPTO_MAX_NONCE_LENGTH)) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    in_vec[0].base = &item->iov;
+    in_vec[0].len = sizeof(struct tfm_crypto_pack_iovec);
+
+    for (i = 0; i < TFM_CRYPTO_BATCH_MAX_INPUTS; i++) {
+        if (!tfm_crypto_batch_slice_is_valid(&item->in[i], input->len)) {
+            return PSA_ERROR_PROGRAMMER_ERROR;
+        }
+        if (item->in[i].len != 0) {
+            in_vec[i + 1].base = (const uint8_t *)input->base +
+                                 item->in[i].offset;
+            in_vec[i + 1].len = item->in[i].len;
+        }
+    }
+
+    if (!tfm_crypto_batch_slice_is_valid(&item->out, output->len)) {
+        return PSA_ERROR_PROGRAMMER_ERROR;
+    }
+    if (item->out.len != 0) {
+        out_vec[0].base = (uint8_t *)output->base + item->out.offset;
+        out_vec[0].len = item->out.len;
+    }
+
+    status = tfm_crypto_get_caller_id(&caller_id);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+    encoded_key.key_id = item->iov.key_id;
+    encoded_key.owner = caller_id;
+
+    switch (TFM_CRYPTO_GET_GROUP_ID(sid)) {
+    case TFM_CRYPTO_GROUP_ID_HASH:
+        status = tfm_crypto_hash_interface(in_vec, out_vec);
+        break;
+    case TFM_CRYPTO_GROUP_ID_MAC:
+        status = tfm_crypto_mac_interface(in_vec, out_vec, &encoded_key);
+        break;
+    case TFM_CRYPTO_GROUP_ID_CIPHER:
+        status = tfm_crypto_cipher_interface(in_vec, out_vec, &encoded_key);
+        break;
+    case TFM_CRYPTO_GROUP_ID_AEAD:
+        status = tfm_crypto_aead_interface(in_vec, out_vec, &encoded_key);
+        break;
+    default:
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+
+    if ((status == PSA_SUCCESS) && (out_vec[0].base != NULL)) {
+        *out_len = out_vec[0].len;
+    }
+
+    return status;
+}
+
+psa_status_t tfm_crypto_batch_interface(psa_invec in_vec[],
+                                        psa_outvec out_vec[])
+{
+    struct tfm_crypto_batch_result *results = out_vec[0].base;
+    struct tfm_crypto_batch_item item;
+    struct tfm_crypto_batch_result result;
+    size_t item_count = in_vec[1].len / sizeof(struct tfm_crypto_batch_item);
+    size_t out_len;
+    size_t out_end = 0;
+    size_t i;
+
+    if ((item_count == 0) ||
+        ((in_vec[1].len % sizeof(struct tfm_crypto_batch_item)) != 0) ||
+        (out_vec[0].len < (item_count * sizeof(struct tfm_crypto_batch_result)))) {
+        return PSA_ERROR_PROGRAMMER_ERROR;
+    }
+
+    for (i = 0; i < item_count; i++) {
+        /* Copy the item, as the client might still modify it in place */
+        (void)memcpy(&item,
+                     (const uint8_t *)in_vec[1].base +
+                     (i * sizeof(struct tfm_crypto_batch_item)),
+                     sizeof(item));
+
+        result.status = tfm_crypto_batch_run_item(&item, &in_vec[2],
+                                                  &out_vec[1], &out_len);
+        result.out_len = (uint32_t)out_len;
+
+        if ((out_len != 0) && ((item.out.offset + out_len) > out_end)) {
+            out_end = item.out.offset + out_len;
+        }
+
+        (void)memcpy(&results[i], &result, sizeof(result));
+    }
+
+    /* Only write back what the items produced */
+    out_vec[0].len = item_count * sizeof(struct tfm_crypto_batch_result);
+    out_vec[1].len = out_end;
+
+    return PSA_SUCCESS;
+}
+#else /* CRYPTO_BATCH_MODULE_ENABLED */
+psa_status_t tfm_crypto_batch_interface(psa_invec in_vec[],
+                                        psa_outvec out_vec[])
+{
+    (void)in_vec;
+    (void)out_vec;
+
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+#endif /* CRYPTO_BATCH_MODULE_ENABLED */
+/*!@}*/
+TFM_COVERITY_BLOCK_END(MISRA_C_2023_Rule_11_5)
@@ -213,7 +213,8 @@ static psa_status_t tfm_crypto_api_dispatcher(psa_invec in_vec[],
     group_id = TFM_CRYPTO_GET_GROUP_ID(iov->function_id);
 
     is_key_required = !((group_id == TFM_CRYPTO_GROUP_ID_HASH) ||
-                        (group_id == TFM_CRYPTO_GROUP_ID_RANDOM));
+                        (group_id == TFM_CRYPTO_GROUP_ID_RANDOM) ||
+                        (group_id == TFM_CRYPTO_GROUP_ID_BATCH));
 
     if (is_key_required) {
         status = tfm_crypto_get_caller_id(&caller_id);
@@ -255,6 +256,8 @@ static psa_status_t tfm_crypto_api_dispatcher(psa_invec in_vec[],
         return tfm_crypto_pake_interface(in_vec, out_vec, &encoded_key);
     case TFM_CRYPTO_GROUP_ID_KEY_WRAPPING:
         return tfm_crypto_key_wrapping_interface(in_vec, out_vec, &encoded_key);
+    case TFM_CRYPTO_GROUP_ID_BATCH:
+        return tfm_crypto_batch_interface(in_vec, out_vec);
     default:
         ERROR("[Crypto] Unsupported request!\n");
         return PSA_ERROR_NOT_SUPPORTED;
@@ -227,6 +227,18 @@ psa_status_t tfm_crypto_key_wrapping_interface(psa_invec in_vec[],
                                                psa_outvec out_vec[],
                                                struct tfm_crypto_key_id_s *encoded_key);
 
+/**
+ * \brief This function acts as interface for the Batch module, which runs
+ *        each item of a batch request through the interface of its module
+ *
+ * \param[in]  in_vec   Array of invec parameters
+ * \param[out] out_vec  Array of outvec parameters
+ *
+ * \return Return values as described in \ref psa_status_t
+ */
+psa_status_t tfm_crypto_batch_interface(psa_invec in_vec[],
+                                        psa_outvec out_vec[]);
+
 #ifdef __cplusplus
 }
 #endif
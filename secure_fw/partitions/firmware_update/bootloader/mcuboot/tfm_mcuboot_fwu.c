@@ -5,6 +5,7 @@
  *
  */
 #include <string.h>
+#include "config_tfm.h"
 #include "psa/crypto.h"
 #include "psa/error.h"
 #include "tfm_log_unpriv.h"
@@ -44,11 +45,91 @@ typedef struct tfm_fwu_mcuboot_ctx_s {
 
     /* The size of the downloaded data in the FWU process. */
     size_t loaded_size;
+
+#if TFM_FWU_STREAMING_HASH
+    /* Hash of the image, updated as each block is written. */
+    psa_hash_operation_t hash_op;
+
+    /* The size of the data covered by hash_op or digest. */
+    size_t hashed_size;
+
+    /* True while hash_op covers exactly the first hashed_size bytes. */
+    bool hash_active;
+
+    /* True once hash_op has been finished into digest. */
+    bool digest_valid;
+    uint8_t digest[TFM_FWU_MAX_DIGEST_SIZE];
+    size_t digest_size;
+#endif
 } tfm_fwu_mcuboot_ctx_t;
 
 static tfm_fwu_mcuboot_ctx_t mcuboot_ctx[FWU_COMPONENT_NUMBER];
 static fwu_image_info_data_t __attribute__((aligned(4))) boot_shared_data;
 
+#if TFM_FWU_STREAMING_HASH
+static void stream_hash_reset(tfm_fwu_mcuboot_ctx_t *ctx)
+{
+    if (ctx->hash_active) {
+        (void)psa_hash_abort(&ctx->hash_op);
+    }
+    ctx->hash_active = false;
+    ctx->digest_valid = false;
+    ctx->hashed_size = 0;
+}
+
+static void stream_hash_start(tfm_fwu_mcuboot_ctx_t *ctx)
+{
+    stream_hash_reset(ctx);
+
+    ctx->hash_op = psa_hash_operation_init();
+    /* If no hash operation is available, the digest is computed from flash
+     * when it is queried.
+     */
+    ctx->hash_active = (psa_hash_setup(&ctx->hash_op, PSA_ALG_SHA_256) ==
+                        PSA_SUCCESS);
+}
+
+static void stream_hash_update(tfm_fwu_mcuboot_ctx_t *ctx,
+                               size_t image_offset,
+                               const void *block,
+                               size_t block_size)
+{
+    /* A cached digest no longer matches the staged image. */
+    ctx->digest_valid = false;
+
+    if (!ctx->hash_active) {
+        return;
+    }
+
+    /* Only blocks written in order extend the hash. Anything else makes the
+     * digest be computed from flash when it is queried.
+     */
+    if ((image_offset != ctx->hashed_size) ||
+        (psa_hash_update(&ctx->hash_op, block, block_size) != PSA_SUCCESS)) {
+        stream_hash_reset(ctx);
+        return;
+    }
+
+    ctx->hashed_size += block_size;
+}
+
+/* Returns true if the digest of the first data_size bytes is cached. */
+static bool stream_hash_digest(tfm_fwu_mcuboot_ctx_t *ctx, size_t data_size)
+{
+    if (ctx->hash_active) {
+        ctx->hash_active = false;
+        ctx->digest_valid = (psa_hash_finish(&ctx->hash_op, ctx->digest,
+                                             sizeof(ctx->digest),
+                                             &ctx->digest_size) == PSA_SUCCESS);
+        if (!ctx->digest_valid) {
+            (void)psa_hash_abort(&ctx->hash_op);
+        }
+    }
+
+    return ctx->digest_valid && (ctx->hashed_size == data_size);
+}
+#endif /* TFM_FWU_STREAMING_HASH */
+
 static psa_status_t get_active_image_version(psa_fwu_component_t component,
                                              struct image_version *image_ver)
 {
@@ -130,6 +211,10 @@ psa_status_t fwu_bootloader_staging_area_init(psa_fwu_component_t component,
     /* Reset the loaded_size. */
     mcuboot_ctx[component].loaded_size = 0;
 
+#if TFM_FWU_STREAMING_HASH
+    stream_hash_start(&mcuboot_ctx[component]);
+#endif
+
     return PSA_SUCCESS;
 }
 
@@ -156,6 +241,11 @@ psa_status_t fwu_bootloader_load_image(psa_fwu_component_t component,
         return PSA_ERROR_STORAGE_FAILURE;
     }
 
+#if TFM_FWU_STREAMING_HASH
+    stream_hash_update(&mcuboot_ctx[component], image_offset, block,
+                       block_size);
+#endif
+
     /* The overflow check has been done in flash_area_write. */
     mcuboot_ctx[component].loaded_size += block_size;
     return PSA_SUCCESS;
@@ -499,6 +589,9 @@ psa_status_t fwu_bootloader_abort(psa_fwu_component_t component)
 
     flash_area_erase(fap, 0, fap->fa_size);
     flash_area_close(fap);
+#if TFM_FWU_STREAMING_HASH
+    stream_hash_reset(&mcuboot_ctx[component]);
+#endif
     mcuboot_ctx[component].fap = NULL;
     mcuboot_ctx[component].loaded_size = 0;
     return PSA_SUCCESS;
@@ -564,6 +657,18 @@ static psa_status_t get_second_image_digest(psa_fwu_component_t component,
     } else {
         return PSA_ERROR_INVALID_ARGUMENT;
     }
+
+#if TFM_FWU_STREAMING_HASH
+    /* Reuse the hash computed while the image was written, if it covers all
+     * the downloaded data, instead of reading the staging area back.
+     */
+    if (stream_hash_digest(&mcuboot_ctx[component], data_size)) {
+        memcpy(info->impl.candidate_digest, mcuboot_ctx[component].digest,
+               mcuboot_ctx[component].digest_size);
+        return PSA_SUCCESS;
+    }
+#endif
+
     if ((flash_area_open(FLASH_AREA_IMAGE_SECONDARY(component),
                             &fap)) != 0) {
         ERROR_UNPRIV_RAW("TFM FWU: opening flash failed.\n");
@@ -668,6 +773,9 @@ psa_status_t fwu_bootloader_clean_component(psa_fwu_component_t component)
         if (flash_area_erase(fap, 0, fap->fa_size) != 0) {
             return PSA_ERROR_STORAGE_FAILURE;
         }
+#if TFM_FWU_STREAMING_HASH
+        stream_hash_reset(&mcuboot_ctx[component]);
+#endif
         mcuboot_ctx[component].fap = NULL;
     } else {
         return PSA_ERROR_DOES_NOT_EXIST;
@@ -0,0 +1,393 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "psa/crypto.h"
+#include "bootutil_priv.h"
+#include "sysflash/sysflash.h"
+#include "service_api.h"
+#include "tfm_boot_status.h"
+#include "tfm_bootloader_fwu_abstraction.h"
+
+#define AREA_SIZE           4096
+#define NUM_AREAS           4
+#define IMAGE_SIZE          1000
+#define BLOCK_SIZE          100
+
+/* Stand-in for CRYPTO_HASH_OPER_NUM, the number of hash operations that can
+ * be active at the same time.
+ */
+#define MAX_HASH_OPS        4
+
+/* Defined by tfm_mcuboot_fwu.c, not declared by the abstraction header */
+psa_status_t fwu_bootloader_abort(psa_fwu_component_t component);
+
+static uint8_t area_data[NUM_AREAS][AREA_SIZE];
+static struct flash_area areas[NUM_AREAS];
+
+static uint8_t image[IMAGE_SIZE];
+
+/* Number of reads of a staging area */
+static uint32_t staging_reads;
+
+/* Hash operations that are set up and not finished or aborted yet */
+static uint32_t active_hash_ops;
+static uint32_t max_hash_ops;
+
+/*
+ * The digest is an FNV-1a hash of the data followed by its length. It is not
+ * a cryptographic hash, but like one it depends on the order of the data.
+ */
+#define FNV_OFFSET_BASIS    0xcbf29ce484222325ULL
+#define FNV_PRIME           0x00000100000001b3ULL
+
+static uint64_t fnv_update(uint64_t state, const uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        state = (state ^ data[i]) * FNV_PRIME;
+    }
+
+    return state;
+}
+
+static void fnv_digest(uint64_t state, size_t length, uint8_t *digest)
+{
+    uint64_t len = length;
+
+    memset(digest, 0, TFM_FWU_MAX_DIGEST_SIZE);
+    memcpy(digest, &state, sizeof(state));
+    memcpy(&digest[sizeof(state)], &len, sizeof(len));
+}
+
+psa_status_t psa_hash_setup(psa_hash_operation_t *operation,
+                            psa_algorithm_t alg)
+{
+    TEST_ASSERT_EQUAL(PSA_ALG_SHA_256, alg);
+    TEST_ASSERT_EQUAL(0, operation->id);
+
+    if (active_hash_ops == max_hash_ops) {
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+
+    active_hash_ops++;
+    operation->id = 1;
+    operation->state = FNV_OFFSET_BASIS;
+    operation->length = 0;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_hash_update(psa_hash_operation_t *operation,
+                             const uint8_t *input,
+                             size_t input_length)
+{
+    TEST_ASSERT_EQUAL(1, operation->id);
+
+    operation->state = fnv_update(operation->state, input, input_length);
+    operation->length += input_length;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_hash_finish(psa_hash_operation_t *operation,
+                             uint8_t *hash,
+                             size_t hash_size,
+                             size_t *hash_length)
+{
+    TEST_ASSERT_EQUAL(1, operation->id);
+    TEST_ASSERT_EQUAL(TFM_FWU_MAX_DIGEST_SIZE, hash_size);
+
+    fnv_digest(operation->state, operation->length, hash);
+    *hash_length = TFM_FWU_MAX_DIGEST_SIZE;
+
+    operation->id = 0;
+    active_hash_ops--;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_hash_abort(psa_hash_operation_t *operation)
+{
+    if (operation->id != 0) {
+        operation->id = 0;
+        active_hash_ops--;
+    }
+
+    return PSA_SUCCESS;
+}
+
+/* Flash areas in RAM, indexed by their ID */
+static struct flash_area *get_area(uint8_t id)
+{
+    TEST_ASSERT_TRUE((id >= FLASH_AREA_0_ID) && (id <= FLASH_AREA_3_ID));
+
+    return &areas[id - FLASH_AREA_0_ID];
+}
+
+static bool is_staging_area(const struct flash_area *area)
+{
+    return (area->fa_id == FLASH_AREA_IMAGE_SECONDARY(0)) ||
+           (area->fa_id == FLASH_AREA_IMAGE_SECONDARY(1));
+}
+
+int flash_area_driver_init(void)
+{
+    return 0;
+}
+
+int flash_area_open(uint8_t id, const struct flash_area **area)
+{
+    *area = get_area(id);
+
+    return 0;
+}
+
+void flash_area_close(const struct flash_area *area)
+{
+}
+
+int flash_area_read(const struct flash_area *area, uint32_t off, void *dst,
+                    uint32_t len)
+{
+    TEST_ASSERT_LESS_OR_EQUAL(area->fa_size, off + len);
+
+    if (is_staging_area(area)) {
+        staging_reads++;
+    }
+
+    memcpy(dst, &area_data[area->fa_id - FLASH_AREA_0_ID][off], len);
+
+    return 0;
+}
+
+int flash_area_write(const struct flash_area *area, uint32_t off,
+                     const void *src, uint32_t len)
+{
+    TEST_ASSERT_LESS_OR_EQUAL(area->fa_size, off + len);
+
+    memcpy(&area_data[area->fa_id - FLASH_AREA_0_ID][off], src, len);
+
+    return 0;
+}
+
+int flash_area_erase(const struct flash_area *area, uint32_t off, uint32_t len)
+{
+    TEST_ASSERT_LESS_OR_EQUAL(area->fa_size, off + len);
+
+    memset(&area_data[area->fa_id - FLASH_AREA_0_ID][off], 0xFF, len);
+
+    return 0;
+}
+
+uint32_t flash_area_align(const struct flash_area *area)
+{
+    return 1;
+}
+
+uint8_t flash_area_erased_val(const struct flash_area *fap)
+{
+    return 0xFF;
+}
+
+/* Stubs of the MCUboot parts not under test */
+int boot_read_image_ok(const struct flash_area *fap, uint8_t *image_ok)
+{
+    *image_ok = BOOT_FLAG_SET;
+
+    return 0;
+}
+
+int boot_set_pending_multi(int image_index, int permanent)
+{
+    return 0;
+}
+
+int boot_set_confirmed_multi(int image_index)
+{
+    return 0;
+}
+
+int bootutil_tlv_iter_begin(struct image_tlv_iter *it,
+                            const struct image_header *hdr,
+                            const struct flash_area *fap, uint16_t type,
+                            bool prot)
+{
+    return 0;
+}
+
+int bootutil_tlv_iter_next(struct image_tlv_iter *it, uint32_t *off,
+                           uint16_t *len, uint16_t *type)
+{
+    return 1;
+}
+
+/* Shares the version of both active images, as the bootloader does */
+psa_status_t tfm_core_get_boot_data(uint8_t major_type,
+                                    struct tfm_boot_data *boot_data,
+                                    uint32_t len)
+{
+    const struct image_version version = {.iv_major = 1};
+    struct shared_data_tlv_entry entry = {
+        .tlv_len = sizeof(version),
+    };
+    uint8_t *p = boot_data->data;
+
+    TEST_ASSERT_EQUAL(TLV_MAJOR_FWU, major_type);
+    TEST_ASSERT_LESS_OR_EQUAL(len, SHARED_DATA_HEADER_SIZE +
+                              (FWU_COMPONENT_NUMBER *
+                               SHARED_DATA_ENTRY_SIZE(sizeof(version))));
+
+    for (uint8_t module = 0; module < FWU_COMPONENT_NUMBER; module++) {
+        entry.tlv_type = SET_TLV_TYPE(TLV_MAJOR_FWU,
+                                      SET_FWU_MINOR(module, SW_VERSION));
+        memcpy(p, &entry, sizeof(entry));
+        memcpy(p + sizeof(entry), &version, sizeof(version));
+        p += SHARED_DATA_ENTRY_SIZE(sizeof(version));
+    }
+
+    boot_data->header.tlv_magic = SHARED_DATA_TLV_INFO_MAGIC;
+    boot_data->header.tlv_tot_len = (uint16_t)(p - (uint8_t *)boot_data);
+
+    return PSA_SUCCESS;
+}
+
+static void load_blocks(psa_fwu_component_t component, size_t offset,
+                        size_t size)
+{
+    for (size_t off = offset; off < offset + size; off += BLOCK_SIZE) {
+        TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                          fwu_bootloader_load_image(component, off,
+                                                    &image[off], BLOCK_SIZE));
+    }
+}
+
+/* Checks the digest of the first size bytes of the image, and returns
+ * whether it took reading the staging area back.
+ */
+static bool assert_digest(psa_fwu_component_t component, size_t size)
+{
+    psa_fwu_component_info_t info;
+    uint8_t expected[TFM_FWU_MAX_DIGEST_SIZE];
+    uint32_t reads = staging_reads;
+
+    fnv_digest(fnv_update(FNV_OFFSET_BASIS, image, size), size, expected);
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      fwu_bootloader_get_image_info(component, false, true,
+                                                    &info));
+    TEST_ASSERT_EQUAL_MEMORY(expected, info.impl.candidate_digest,
+                             TFM_FWU_MAX_DIGEST_SIZE);
+
+    return staging_reads != reads;
+}
+
+void setUp(void)
+{
+    for (uint8_t i = 0; i < NUM_AREAS; i++) {
+        areas[i].fa_id = FLASH_AREA_0_ID + i;
+        areas[i].fa_size = AREA_SIZE;
+    }
+    memset(area_data, 0xFF, sizeof(area_data));
+
+    for (size_t i = 0; i < IMAGE_SIZE; i++) {
+        image[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    staging_reads = 0;
+    active_hash_ops = 0;
+    max_hash_ops = MAX_HASH_OPS;
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, fwu_bootloader_init());
+}
+
+void tearDown(void)
+{
+    for (psa_fwu_component_t c = 0; c < FWU_COMPONENT_NUMBER; c++) {
+        (void)fwu_bootloader_clean_component(c);
+    }
+}
+
+void test_fwu_mcuboot_should_hashSequentialWritesWithoutReadBack(void)
+{
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      fwu_bootloader_staging_area_init(0, NULL, 0));
+    load_blocks(0, 0, IMAGE_SIZE);
+
+    TEST_ASSERT_FALSE(assert_digest(0, IMAGE_SIZE));
+    TEST_ASSERT_EQUAL(0, active_hash_ops);
+
+    /* The cached digest answers later queries */
+    TEST_ASSERT_FALSE(assert_digest(0, IMAGE_SIZE));
+}
+
+void test_fwu_mcuboot_should_readBackOutOfOrderWrites(void)
+{
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      fwu_bootloader_staging_area_init(0, NULL, 0));
+    load_blocks(0, BLOCK_SIZE, BLOCK_SIZE);
+    load_blocks(0, 0, BLOCK_SIZE);
+
+    /* The hash operation is released as soon as the order breaks */
+    TEST_ASSERT_EQUAL(0, active_hash_ops);
+    TEST_ASSERT_TRUE(assert_digest(0, 2 * BLOCK_SIZE));
+}
+
+void test_fwu_mcuboot_should_readBackWritesAfterDigest(void)
+{
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      fwu_bootloader_staging_area_init(0, NULL, 0));
+    load_blocks(0, 0, BLOCK_SIZE);
+    TEST_ASSERT_FALSE(assert_digest(0, BLOCK_SIZE));
+
+    /* The finished hash cannot be extended */
+    load_blocks(0, BLOCK_SIZE, BLOCK_SIZE);
+    TEST_ASSERT_TRUE(assert_digest(0, 2 * BLOCK_SIZE));
+}
+
+void test_fwu_mcuboot_should_holdOneHashOperationPerComponent(void)
+{
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      fwu_bootloader_staging_area_init(0, NULL, 0));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      fwu_bootloader_staging_area_init(1, NULL, 0));
+    TEST_ASSERT_EQUAL(FWU_COMPONENT_NUMBER, active_hash_ops);
+
+    /* Starting the download again does not take another operation */
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      fwu_bootloader_staging_area_init(1, NULL, 0));
+    TEST_ASSERT_EQUAL(FWU_COMPONENT_NUMBER, active_hash_ops);
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, fwu_bootloader_abort(0));
+    TEST_ASSERT_EQUAL(1, active_hash_ops);
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, fwu_bootloader_clean_component(1));
+    TEST_ASSERT_EQUAL(0, active_hash_ops);
+}
+
+void test_fwu_mcuboot_should_readBackWithoutFreeHashOperation(void)
+{
+    /* The crypto service has a single hash operation to spare */
+    max_hash_ops = 1;
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      fwu_bootloader_staging_area_init(0, NULL, 0));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      fwu_bootloader_staging_area_init(1, NULL, 0));
+    TEST_ASSERT_EQUAL(1, active_hash_ops);
+
+    load_blocks(0, 0, IMAGE_SIZE);
+    load_blocks(1, 0, IMAGE_SIZE);
+
+    /* Component 1 is hashed from flash once component 0 is done */
+    TEST_ASSERT_FALSE(assert_digest(0, IMAGE_SIZE));
+    TEST_ASSERT_TRUE(assert_digest(1, IMAGE_SIZE));
+    TEST_ASSERT_EQUAL(0, active_hash_ops);
+}
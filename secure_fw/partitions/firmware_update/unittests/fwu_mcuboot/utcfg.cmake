@@ -0,0 +1,36 @@
+#-------------------------------------------------------------------------------
+# SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+#-------------------------------------------------------------------------------
+
+set(FWU_SOURCE_DIR ${TFM_ROOT_DIR}/secure_fw/partitions/firmware_update)
+
+# Define what is being unit tested and by what
+set(UNIT_UNDER_TEST ${FWU_SOURCE_DIR}/bootloader/mcuboot/tfm_mcuboot_fwu.c)
+set(UNIT_TEST_SUITE ${CMAKE_CURRENT_LIST_DIR}/test_fwu_mcuboot.c)
+
+# Dependencies for the UUT, that get linked into the executable
+set(UNIT_TEST_DEPS)
+
+# Include directories for compilation
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${FWU_SOURCE_DIR}/unittests/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${FWU_SOURCE_DIR}/bootloader)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/bl2/ext/mcuboot/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/partitions/lib/runtime/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/spm/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/spm/include/boot)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/interface/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/platform/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/config)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/tfm_log_unpriv/inc)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/tfm_vprintf/inc)
+
+# Headers to be mocked
+
+# Compile-time definitions
+list(APPEND UNIT_TEST_COMPILE_DEFS LOG_LEVEL_UNPRIV=LOG_LEVEL_NONE)
+list(APPEND UNIT_TEST_COMPILE_DEFS MCUBOOT_IMAGE_NUMBER=2)
+list(APPEND UNIT_TEST_COMPILE_DEFS TFM_FWU_STREAMING_HASH=1)
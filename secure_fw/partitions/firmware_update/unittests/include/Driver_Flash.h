@@ -0,0 +1,18 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __DRIVER_FLASH_H
+#define __DRIVER_FLASH_H
+
+/* Host stand-in for the CMSIS flash driver. The test suite implements the
+ * flash areas in RAM, so the driver is never called.
+ */
+typedef struct _ARM_DRIVER_FLASH {
+    int unused;
+} const ARM_DRIVER_FLASH;
+
+#endif /* __DRIVER_FLASH_H */
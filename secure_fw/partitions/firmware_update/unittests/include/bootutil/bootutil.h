@@ -0,0 +1,19 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef H_BOOTUTIL_
+#define H_BOOTUTIL_
+
+/* Host stand-in for the MCUboot public API used by the FWU partition */
+
+#include <stdbool.h>
+
+int boot_set_pending_multi(int image_index, int permanent);
+
+int boot_set_confirmed_multi(int image_index);
+
+#endif /* H_BOOTUTIL_ */
@@ -0,0 +1,34 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef H_BOOTUTIL_PRIV_
+#define H_BOOTUTIL_PRIV_
+
+/* Host stand-in for the MCUboot private definitions used by the FWU partition */
+
+#include <stdint.h>
+
+#include "bootutil/bootutil.h"
+#include "bootutil/image.h"
+#include "flash_map_backend/flash_map_backend.h"
+
+#define BOOT_FLAG_SET       1
+#define BOOT_FLAG_UNSET     3
+
+#define BOOT_MAX_ALIGN      8
+#define BOOT_MAGIC_SZ       16
+#define BOOT_MAGIC_ALIGN_SIZE \
+    ((((BOOT_MAGIC_SZ - 1) / BOOT_MAX_ALIGN) + 1) * BOOT_MAX_ALIGN)
+
+#define BOOT_TMPBUF_SZ      256
+
+#define ALIGN_UP(num, align)    (((num) + ((align) - 1)) & ~((align) - 1))
+#define ALIGN_DOWN(num, align)  ((num) & ~((align) - 1))
+
+int boot_read_image_ok(const struct flash_area *fap, uint8_t *image_ok);
+
+#endif /* H_BOOTUTIL_PRIV_ */
@@ -0,0 +1,22 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __FLASH_LAYOUT_H__
+#define __FLASH_LAYOUT_H__
+
+/* Host stand-in for the target flash layout, with two images */
+
+#define DEFAULT_MCUBOOT_FLASH_MAP
+
+#define FLASH_BASE_ADDRESS      0x0
+#define FLASH_AREA_0_ID         1
+#define FLASH_AREA_1_ID         2
+#define FLASH_AREA_2_ID         3
+#define FLASH_AREA_3_ID         4
+#define FLASH_AREA_SCRATCH_ID   5
+
+#endif /* __FLASH_LAYOUT_H__ */
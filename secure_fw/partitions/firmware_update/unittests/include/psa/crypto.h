@@ -0,0 +1,52 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef PSA_CRYPTO_H
+#define PSA_CRYPTO_H
+
+/*
+ * Host stand-in for the PSA Crypto API, limited to the hash operations used
+ * by the FWU partition. The test suite implements them.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "psa/error.h"
+
+typedef uint32_t psa_algorithm_t;
+
+#define PSA_ALG_SHA_256 ((psa_algorithm_t)0x02000009)
+
+typedef struct psa_hash_operation_s {
+    uint32_t id;
+    uint64_t state;
+    size_t length;
+} psa_hash_operation_t;
+
+static inline psa_hash_operation_t psa_hash_operation_init(void)
+{
+    const psa_hash_operation_t v = {0};
+
+    return v;
+}
+
+psa_status_t psa_hash_setup(psa_hash_operation_t *operation,
+                            psa_algorithm_t alg);
+
+psa_status_t psa_hash_update(psa_hash_operation_t *operation,
+                             const uint8_t *input,
+                             size_t input_length);
+
+psa_status_t psa_hash_finish(psa_hash_operation_t *operation,
+                             uint8_t *hash,
+                             size_t hash_size,
+                             size_t *hash_length);
+
+psa_status_t psa_hash_abort(psa_hash_operation_t *operation);
+
+#endif /* PSA_CRYPTO_H */
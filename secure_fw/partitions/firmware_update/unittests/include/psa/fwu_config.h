@@ -0,0 +1,24 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __FWU_CONFIG_H__
+#define __FWU_CONFIG_H__
+
+/* Host stand-in for the generated FWU configuration, with two images */
+
+#define FWU_COMPONENT_NUMBER              MCUBOOT_IMAGE_NUMBER
+
+#define FWU_COMPONENT_ID_SECURE           0x00U
+#define FWU_COMPONENT_ID_NONSECURE        0x01U
+
+#define TFM_FWU_MAX_DIGEST_SIZE           32
+
+#define TFM_CONFIG_FWU_MAX_WRITE_SIZE     1024
+
+#define TFM_CONFIG_FWU_MAX_MANIFEST_SIZE  0
+
+#endif /* __FWU_CONFIG_H__ */
@@ -11,10 +11,14 @@
 #include "tfm_hal_device_header.h"
 #include "fih.h"
 #include "psa/service.h"
+#include "tfm_log.h"
 
 void tfm_idle_thread(void)
 {
     while (1) {
+        /* Nothing else is runnable, so write out any buffered log output */
+        tfm_log_flush();
+
         /*
          * There could be other Partitions becoming RUNNABLE after wake up.
          * This is a dummy psa_wait to let SPM check possible scheduling.
@@ -36,6 +40,9 @@ void tfm_idle_thread(void)
     (void)fih_delay();
 
     while (1) {
+        /* Nothing else is runnable, so write out any buffered log output */
+        tfm_log_flush();
+
         /*
          * There could be other Partitions becoming RUNNABLE after wake up.
          * This is a dummy psa_wait to let SPM check possible scheduling.
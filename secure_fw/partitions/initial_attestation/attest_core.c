@@ -5,6 +5,7 @@
  *
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 #include <stddef.h>
@@ -563,15 +564,29 @@ static enum psa_attest_err_t attest_get_t_cose_algorithm(
     return PSA_ATTEST_ERR_SUCCESS;
 }
 
+/* The claims which can differ from one token to the next are encoded for each
+ * token. The other claims are fixed while the system is up, they are encoded
+ * once and their encoded values are copied into each token.
+ */
 #if ATTEST_TOKEN_PROFILE_PSA_IOT_1 || ATTEST_TOKEN_PROFILE_PSA_2_0_0
     static enum psa_attest_err_t
     (*claim_query_funcs[])(struct attest_token_encode_ctx *) = {
+        &attest_add_caller_id_claim,
+        &attest_add_security_lifecycle_claim,
+#ifdef TFM_PARTITION_MEASURED_BOOT
+        /* Measurements can be extended at runtime */
+        &attest_add_all_sw_components,
+#endif
+    };
+
+    static enum psa_attest_err_t
+    (*static_claim_funcs[])(struct attest_token_encode_ctx *) = {
         &attest_add_boot_seed_claim,
         &attest_add_instance_id_claim,
         &attest_add_implementation_id_claim,
-        &attest_add_caller_id_claim,
-        &attest_add_security_lifecycle_claim,
+#ifndef TFM_PARTITION_MEASURED_BOOT
         &attest_add_all_sw_components,
+#endif
         &attest_add_profile_definition,
 #if ATTEST_INCLUDE_OPTIONAL_CLAIMS
         &attest_add_verification_service,
@@ -582,10 +597,20 @@ static enum psa_attest_err_t attest_get_t_cose_algorithm(
 
     static enum psa_attest_err_t
     (*claim_query_funcs[])(struct attest_token_encode_ctx *) = {
+        &attest_add_security_lifecycle_claim,
+#ifdef TFM_PARTITION_MEASURED_BOOT
+        /* Measurements can be extended at runtime */
+        &attest_add_all_sw_components,
+#endif
+    };
+
+    static enum psa_attest_err_t
+    (*static_claim_funcs[])(struct attest_token_encode_ctx *) = {
         &attest_add_instance_id_claim,
         &attest_add_implementation_id_claim,
-        &attest_add_security_lifecycle_claim,
+#ifndef TFM_PARTITION_MEASURED_BOOT
         &attest_add_all_sw_components,
+#endif
         &attest_add_profile_definition,
         &attest_add_hash_algo_claim,
         &attest_add_platform_config_claim,
@@ -595,6 +620,211 @@ static enum psa_attest_err_t attest_get_t_cose_algorithm(
     };
 #endif
 
+/* CBOR initial bytes and major types, as defined in RFC 8949 */
+#define CBOR_MAP_OF_ONE_PAIR        0xA1U
+#define CBOR_MAJOR_TYPE_UINT        0U
+#define CBOR_MAJOR_TYPE_NINT        1U
+#define CBOR_ARG_ONE_BYTE           24U
+#define CBOR_ARG_FOUR_BYTES         26U
+
+/*!
+ * \struct attest_static_claim_t
+ *
+ * \brief A claim encoded once and copied into each token.
+ */
+struct attest_static_claim_t {
+    int32_t label;               /*!< Label of the claim */
+    struct q_useful_buf_c value; /*!< Encoded value of the claim */
+};
+
+/* The static claims can not be larger than the token they are part of */
+static uint8_t static_claims_buf[PSA_INITIAL_ATTEST_MAX_TOKEN_SIZE];
+static struct attest_static_claim_t static_claims[ARRAY_SIZE(static_claim_funcs)];
+static bool static_claims_encoded;
+
+/* Size of a token less its payload and the byte string head of the payload.
+ * Zero if not yet computed.
+ */
+static size_t token_overhead_size;
+
+/*!
+ * \brief Static function to get the size of the head of a CBOR data item.
+ *
+ * \param[in]  arg  Argument of the data item: the value of an integer or the
+ *                  length of a string
+ *
+ * \return Returns the size of the head in bytes
+ */
+static size_t attest_cbor_head_size(uint64_t arg)
+{
+    if (arg < CBOR_ARG_ONE_BYTE) {
+        return 1;
+    } else if (arg <= UINT8_MAX) {
+        return 2;
+    } else if (arg <= UINT16_MAX) {
+        return 3;
+    } else if (arg <= UINT32_MAX) {
+        return 5;
+    }
+
+    return 9;
+}
+
+/*!
+ * \brief Static function to split an encoded map holding a single claim into
+ *        the label and the encoded value of the claim.
+ *
+ * \param[in]  encoded_map  The encoded map
+ * \param[out] claim        The label and encoded value of the claim, which
+ *                          points into \p encoded_map
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_split_claim(struct q_useful_buf_c encoded_map,
+                   struct attest_static_claim_t *claim)
+{
+    const uint8_t *encoded = encoded_map.ptr;
+    uint8_t major_type;
+    uint8_t info;
+    uint32_t arg;
+    size_t head_size;
+    size_t i;
+
+    if (encoded_map.len < 3 || encoded[0] != CBOR_MAP_OF_ONE_PAIR) {
+        return PSA_ATTEST_ERR_GENERAL;
+    }
+
+    /* The label of a claim is an integer of at most 32 bits */
+    major_type = encoded[1] >> 5;
+    info = encoded[1] & 0x1FU;
+    if ((major_type != CBOR_MAJOR_TYPE_UINT &&
+         major_type != CBOR_MAJOR_TYPE_NINT) || info > CBOR_ARG_FOUR_BYTES) {
+        return PSA_ATTEST_ERR_GENERAL;
+    }
+
+    if (info < CBOR_ARG_ONE_BYTE) {
+        arg = info;
+        head_size = 1;
+    } else {
+        head_size = 1 + (1U << (info - CBOR_ARG_ONE_BYTE));
+        if (encoded_map.len < 2 + head_size) {
+            return PSA_ATTEST_ERR_GENERAL;
+        }
+        arg = 0;
+        for (i = 1; i < head_size; i++) {
+            arg = (arg << 8) | encoded[1 + i];
+        }
+    }
+
+    if (arg > INT32_MAX || encoded_map.len <= 1 + head_size) {
+        return PSA_ATTEST_ERR_GENERAL;
+    }
+
+    claim->label = (major_type == CBOR_MAJOR_TYPE_UINT) ? (int32_t)arg
+                                                        : -1 - (int32_t)arg;
+    claim->value.ptr = encoded + 1 + head_size;
+    claim->value.len = encoded_map.len - 1 - head_size;
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to encode the static claims, if not yet done.
+ *
+ * Each claim is encoded alone in a map, from which its label and encoded value
+ * are taken.
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t attest_encode_static_claims(void)
+{
+    struct attest_token_encode_ctx claim_ctx;
+    QCBOREncodeContext *cbor_encode_ctx;
+    struct q_useful_buf buf;
+    struct q_useful_buf_c encoded_map;
+    enum psa_attest_err_t attest_err;
+    QCBORError qcbor_err;
+    int i;
+
+    if (static_claims_encoded) {
+        return PSA_ATTEST_ERR_SUCCESS;
+    }
+
+    cbor_encode_ctx = attest_token_encode_borrow_cbor_cntxt(&claim_ctx);
+    buf.ptr = static_claims_buf;
+    buf.len = sizeof(static_claims_buf);
+
+    for (i = 0; i < ARRAY_SIZE(static_claim_funcs); ++i) {
+        QCBOREncode_Init(cbor_encode_ctx, buf);
+        QCBOREncode_OpenMap(cbor_encode_ctx);
+
+        /* Calling the attest_add_XXX_claim functions */
+        attest_err = static_claim_funcs[i](&claim_ctx);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            return attest_err;
+        }
+
+        QCBOREncode_CloseMap(cbor_encode_ctx);
+        qcbor_err = QCBOREncode_Finish(cbor_encode_ctx, &encoded_map);
+        if (qcbor_err == QCBOR_ERR_BUFFER_TOO_SMALL) {
+            return PSA_ATTEST_ERR_BUFFER_OVERFLOW;
+        } else if (qcbor_err != QCBOR_SUCCESS) {
+            return PSA_ATTEST_ERR_GENERAL;
+        }
+
+        attest_err = attest_split_claim(encoded_map, &static_claims[i]);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            return attest_err;
+        }
+
+        buf.ptr = (uint8_t *)buf.ptr + encoded_map.len;
+        buf.len -= encoded_map.len;
+    }
+
+    static_claims_encoded = true;
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to add all the claims to the attestation token.
+ *
+ * \param[in]  token_ctx  Token encoding context
+ * \param[in]  challenge  Structure to carry the challenge value:
+ *                        pointer + challenge's length
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_add_claims(struct attest_token_encode_ctx *token_ctx,
+                  struct q_useful_buf_c *challenge)
+{
+    enum psa_attest_err_t attest_err;
+    int i;
+
+    attest_err = attest_add_nonce_claim(token_ctx, challenge);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(claim_query_funcs); ++i) {
+        /* Calling the attest_add_XXX_claim functions */
+        attest_err = claim_query_funcs[i](token_ctx);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            return attest_err;
+        }
+    }
+
+    for (i = 0; i < ARRAY_SIZE(static_claims); ++i) {
+        attest_token_encode_add_cbor(token_ctx,
+                                     static_claims[i].label,
+                                     &static_claims[i].value);
+    }
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
 /*!
  * \brief Static function to create the initial attestation token
  *
@@ -616,7 +846,6 @@ attest_create_token(struct q_useful_buf_c *challenge,
     enum attest_token_err_t token_err;
     struct attest_token_encode_ctx attest_token_ctx;
     int32_t key_select = 0;
-    int i;
     int32_t cose_algorithm_id;
 
     attest_err = attest_get_t_cose_algorithm(&cose_algorithm_id);
@@ -637,20 +866,11 @@ attest_create_token(struct q_useful_buf_c *challenge,
         goto error;
     }
 
-    attest_err = attest_add_nonce_claim(&attest_token_ctx,
-                                        challenge);
+    attest_err = attest_add_claims(&attest_token_ctx, challenge);
     if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
         goto error;
     }
 
-    for (i = 0; i < ARRAY_SIZE(claim_query_funcs); ++i) {
-        /* Calling the attest_add_XXX_claim functions */
-        attest_err = claim_query_funcs[i](&attest_token_ctx);
-        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-            goto error;
-        }
-    }
-
     /* Finish up creating the token. This is where the actual signature
      * is generated. This finishes up the CBOR encoding too.
      */
@@ -661,6 +881,59 @@ error:
     return attest_err;
 }
 
+/*!
+ * \brief Static function to get the size of a token less its payload and the
+ *        byte string head of the payload.
+ *
+ * It only depends on the attestation key, so it is computed once by creating
+ * a token with an empty payload, in which case no token is actually created.
+ *
+ * \param[out] overhead_size  Size of the token less its payload
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t attest_get_token_overhead_size(size_t *overhead_size)
+{
+    enum psa_attest_err_t attest_err;
+    enum attest_token_err_t token_err;
+    struct attest_token_encode_ctx attest_token_ctx;
+    struct q_useful_buf token;
+    struct q_useful_buf_c completed_token;
+    int32_t cose_algorithm_id;
+
+    if (token_overhead_size == 0) {
+        attest_err = attest_get_t_cose_algorithm(&cose_algorithm_id);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            return attest_err;
+        }
+
+        /* Special value to get the size of the token, but token is not
+         * created
+         */
+        token.ptr = NULL;
+        token.len = INT32_MAX;
+
+        token_err = attest_token_encode_start(&attest_token_ctx, 0,
+                                              cose_algorithm_id, &token);
+        if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+            return error_mapping_to_psa_attest_err_t(token_err);
+        }
+
+        token_err = attest_token_encode_finish(&attest_token_ctx,
+                                               &completed_token);
+        if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+            return error_mapping_to_psa_attest_err_t(token_err);
+        }
+
+        /* Less the empty map payload and its single byte head */
+        token_overhead_size = completed_token.len - 2;
+    }
+
+    *overhead_size = token_overhead_size;
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
 psa_status_t
 initial_attest_get_token(const void *challenge_buf, size_t challenge_size,
                          void *token_buf, size_t token_buf_size,
@@ -686,6 +959,11 @@ initial_attest_get_token(const void *challenge_buf, size_t challenge_size,
         goto error;
     }
 
+    attest_err = attest_encode_static_claims();
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
     attest_err = attest_create_token(&challenge, &token, &completed_token);
     if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
         goto error;
@@ -702,28 +980,56 @@ initial_attest_get_token_size(size_t challenge_size, size_t *token_size)
 {
     enum psa_attest_err_t attest_err = PSA_ATTEST_ERR_SUCCESS;
     struct q_useful_buf_c challenge;
-    struct q_useful_buf token;
-    struct q_useful_buf_c completed_token;
+    struct q_useful_buf payload;
+    struct attest_token_encode_ctx payload_ctx;
+    QCBOREncodeContext *cbor_encode_ctx;
+    size_t overhead_size;
+    size_t payload_size;
 
     /* Only the size of the challenge is needed */
     challenge.ptr = NULL;
     challenge.len = challenge_size;
 
-    /* Special value to get the size of the token, but token is not created */
-    token.ptr = NULL;
-    token.len = INT32_MAX;
+    /* Special value to get the size of the payload, but it is not encoded */
+    payload.ptr = NULL;
+    payload.len = INT32_MAX;
 
     attest_err = attest_verify_challenge_size(challenge_size);
     if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
         goto error;
     }
 
-    attest_err = attest_create_token(&challenge, &token, &completed_token);
+    attest_err = attest_encode_static_claims();
     if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
         goto error;
     }
 
-    *token_size = completed_token.len;
+    attest_err = attest_get_token_overhead_size(&overhead_size);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
+    /* Only the payload is sized, the COSE structure around it has a fixed
+     * size apart from the head of the byte string holding the payload.
+     */
+    cbor_encode_ctx = attest_token_encode_borrow_cbor_cntxt(&payload_ctx);
+    QCBOREncode_Init(cbor_encode_ctx, payload);
+    QCBOREncode_OpenMap(cbor_encode_ctx);
+
+    attest_err = attest_add_claims(&payload_ctx, &challenge);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
+    QCBOREncode_CloseMap(cbor_encode_ctx);
+    if (QCBOREncode_FinishGetSize(cbor_encode_ctx, &payload_size) !=
+        QCBOR_SUCCESS) {
+        attest_err = PSA_ATTEST_ERR_GENERAL;
+        goto error;
+    }
+
+    *token_size = overhead_size + attest_cbor_head_size(payload_size) +
+                  payload_size;
 
 error:
     return error_mapping_to_psa_status_t(attest_err);
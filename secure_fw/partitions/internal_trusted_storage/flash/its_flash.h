@@ -31,6 +31,9 @@ extern uint8_t its_block_data[ITS_RAM_FS_SIZE];
 /* NAND flash: each filesystem block is buffered and then programmed in one
  * shot, so no filesystem data alignment is required.
  */
+#if ITS_LOG_MODE
+#error "ITS_LOG_MODE requires a flash device that can program erased bytes in place"
+#endif
 #include "its_flash_nand.h"
 extern struct its_flash_nand_dev_t its_flash_nand_dev;
 #define ITS_FLASH_DEV its_flash_nand_dev
@@ -61,6 +64,9 @@ extern uint8_t ps_block_data[];
 /* NAND flash: each filesystem block is buffered and then programmed in one
  * shot, so no filesystem data alignment is required.
  */
+#if ITS_LOG_MODE
+#error "ITS_LOG_MODE requires a flash device that can program erased bytes in place"
+#endif
 #include "its_flash_nand.h"
 extern struct its_flash_nand_dev_t ps_flash_nand_dev;
 #define PS_FLASH_DEV ps_flash_nand_dev
@@ -19,6 +19,54 @@
 #define ITS_FLASH_FS_INTERNAL_FLAGS_MASK  (UINT32_MAX - ((1U << 24) - 1))
 /* Flag that indicates the file is to be deleted in the next block update */
 #define ITS_FLASH_FS_FLAG_DELETE          (1U << 24)
+/* Flag that indicates the file data is stored as a log of records */
+#define ITS_FLASH_FS_FLAG_LOG             (1U << 25)
+
+#if ITS_LOG_MODE
+#ifdef ITS_ENCRYPTION
+#error "ITS_LOG_MODE cannot be used with ITS_ENCRYPTION"
+#endif
+
+/**
+ * \struct its_log_record_hdr_t
+ *
+ * \brief Header of a record in a log file.
+ *
+ * \details A log file is allocated ITS_LOG_NUM_RECORDS record slots. Each
+ *          update of the file programs the next erased slot in place, and the
+ *          valid record with the highest sequence number holds the file data.
+ *          When no erased slot is left, the file is rewritten through the
+ *          block update path with a single record.
+ */
+struct its_log_record_hdr_t {
+    uint32_t seq;   /*!< Sequence number of the record, never 0 */
+    uint32_t check; /*!< Check value over seq and the record data */
+};
+
+#define ITS_LOG_RECORD_HDR_SIZE  sizeof(struct its_log_record_hdr_t)
+
+/* Invalid log record slot */
+#define ITS_LOG_INVALID_SLOT     UINT32_MAX
+
+/**
+ * \struct its_log_state_t
+ *
+ * \brief Result of a log file scan.
+ */
+struct its_log_state_t {
+    uint32_t phys_block; /*!< Physical block holding the file data */
+    size_t slot_size;    /*!< Size of a record slot */
+    uint32_t latest;     /*!< Slot of the valid record with highest seq */
+    uint32_t seq;        /*!< Sequence number of the latest record */
+    uint32_t free;       /*!< First erased slot */
+};
+
+/* Buffer of one record slot, padded to the flash program unit */
+static uint8_t __attribute__((aligned(4)))
+    log_record_buf[ITS_UTILS_ALIGN(ITS_LOG_RECORD_HDR_SIZE +
+                                   ITS_LOG_MAX_RECORD_SIZE,
+                                   ITS_FLASH_MAX_ALIGNMENT)];
+#endif /* ITS_LOG_MODE */
 
 static psa_status_t its_flash_fs_delete_idx(struct its_flash_fs_ctx_t *fs_ctx,
                                             uint32_t del_file_idx);
@@ -181,7 +229,11 @@ psa_status_t its_flash_fs_prepare(struct its_flash_fs_ctx_t *fs_ctx)
     err = its_flash_fs_mblock_get_file_idx_flag(fs_ctx,
                                                 ITS_FLASH_FS_FLAG_DELETE, &idx);
     if (err == PSA_SUCCESS) {
-        return its_flash_fs_delete_idx(fs_ctx, idx);
+        err = its_flash_fs_delete_idx(fs_ctx, idx);
+        if (err != PSA_SUCCESS) {
+            its_flash_fs_mblock_meta_update_abort(fs_ctx);
+        }
+        return err;
     } else if (err != PSA_ERROR_DOES_NOT_EXIST) {
         return err;
     }
@@ -212,6 +264,14 @@ psa_status_t its_flash_fs_file_get_info(struct its_flash_fs_ctx_t *fs_ctx,
     info->size_current = tmp_metadata.cur_size;
     info->flags = tmp_metadata.flags & ITS_FLASH_FS_USER_FLAGS_MASK;
 
+#if ITS_LOG_MODE
+    if (tmp_metadata.flags & ITS_FLASH_FS_FLAG_LOG) {
+        /* Report the size of the record data */
+        info->size_current = tmp_metadata.cur_size - ITS_LOG_RECORD_HDR_SIZE;
+        info->size_max = info->size_current;
+    }
+#endif
+
 #ifdef ITS_ENCRYPTION
     memcpy(info->nonce, tmp_metadata.nonce, TFM_ITS_ENC_NONCE_LENGTH);
     memcpy(info->tag, tmp_metadata.tag, TFM_ITS_AUTH_TAG_LENGTH);
@@ -220,12 +280,27 @@ psa_status_t its_flash_fs_file_get_info(struct its_flash_fs_ctx_t *fs_ctx,
     return PSA_SUCCESS;
 }
 
-psa_status_t its_flash_fs_file_write(struct its_flash_fs_ctx_t *fs_ctx,
-                                     const uint8_t *fid,
-                                     struct its_flash_fs_file_info_t *finfo,
-                                     size_t data_size,
-                                     size_t offset,
-                                     const uint8_t *data)
+/**
+ * \brief Writes a file through the block update path, which copies the data
+ *        block and swaps the metadata blocks.
+ *
+ * \param[in,out] fs_ctx     Filesystem context
+ * \param[in]     fid        File ID
+ * \param[in]     finfo      Pointer to the file info, with size_max aligned
+ *                           to the flash program unit
+ * \param[in]     data_size  Size of the incoming write data
+ * \param[in]     offset     Offset in the file to write
+ * \param[in]     data       Pointer to buffer containing data to be written
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_flash_fs_file_write_block(
+                                        struct its_flash_fs_ctx_t *fs_ctx,
+                                        const uint8_t *fid,
+                                        struct its_flash_fs_file_info_t *finfo,
+                                        size_t data_size,
+                                        size_t offset,
+                                        const uint8_t *data)
 {
     struct its_block_meta_t block_meta;
     struct its_file_meta_t file_meta = {0};
@@ -236,23 +311,15 @@ psa_status_t its_flash_fs_file_write(struct its_flash_fs_ctx_t *fs_ctx,
     uint32_t new_idx = ITS_METADATA_INVALID_INDEX;
     bool use_spare;
 
-    if (finfo == NULL) {
-        return PSA_ERROR_INVALID_ARGUMENT;
-    }
-
-    /* Do not permit the user to pass filesystem-internal flags */
-    if (finfo->flags & ITS_FLASH_FS_INTERNAL_FLAGS_MASK) {
-        return PSA_ERROR_INVALID_ARGUMENT;
-    }
-
-#if (ITS_FLASH_MAX_ALIGNMENT != 1)
-    /* Set the max_size to be aligned with the flash program unit */
-    finfo->size_max = ITS_UTILS_ALIGN(finfo->size_max, fs_ctx->cfg->program_unit);
-#endif
-
     /* Check if the file already exists */
     err = its_flash_fs_mblock_get_file_idx_meta(fs_ctx, fid, &old_idx, &file_meta);
     if (err == PSA_SUCCESS) {
+        /* The records of a log file can only be replaced as a whole */
+        if ((file_meta.flags & ITS_FLASH_FS_FLAG_LOG) &&
+            !(finfo->flags & ITS_FLASH_FS_FLAG_TRUNCATE)) {
+            return PSA_ERROR_NOT_SUPPORTED;
+        }
+
         if (finfo->flags & ITS_FLASH_FS_FLAG_TRUNCATE) {
             if (file_meta.max_size == finfo->size_max) {
                 /* Truncate and reuse the existing file, which is already the
@@ -420,6 +487,331 @@ psa_status_t its_flash_fs_file_write(struct its_flash_fs_ctx_t *fs_ctx,
     return err;
 }
 
+#if ITS_LOG_MODE
+/**
+ * \brief Calculates the check value of a log record (32-bit FNV-1a).
+ *
+ * \param[in] seq        Sequence number of the record
+ * \param[in] data       Record data
+ * \param[in] data_size  Size of the record data
+ *
+ * \return Check value of the record
+ */
+static uint32_t its_flash_fs_log_check(uint32_t seq, const uint8_t *data,
+                                       size_t data_size)
+{
+    uint32_t check = 0x811C9DC5U;
+    size_t i;
+
+    for (i = 0; i < sizeof(seq); i++) {
+        check ^= (seq >> (8 * i)) & 0xFFU;
+        check *= 0x01000193U;
+    }
+
+    for (i = 0; i < data_size; i++) {
+        check ^= data[i];
+        check *= 0x01000193U;
+    }
+
+    return check;
+}
+
+/**
+ * \brief Checks whether a write can be handled as a log record.
+ *
+ * \param[in] fs_ctx     Filesystem context
+ * \param[in] finfo      Pointer to the file info
+ * \param[in] data_size  Size of the incoming write data
+ * \param[in] offset     Offset in the file to write
+ *
+ * \return true if the write replaces a small file as a whole
+ */
+static bool its_flash_fs_log_eligible(struct its_flash_fs_ctx_t *fs_ctx,
+                                const struct its_flash_fs_file_info_t *finfo,
+                                size_t data_size, size_t offset)
+{
+    size_t slot_size;
+
+    if (!(finfo->flags & ITS_FLASH_FS_FLAG_TRUNCATE) || (offset != 0) ||
+        (data_size == 0) || (data_size != finfo->size_max) ||
+        (data_size > ITS_LOG_MAX_RECORD_SIZE)) {
+        return false;
+    }
+
+    slot_size = ITS_UTILS_ALIGN(ITS_LOG_RECORD_HDR_SIZE + data_size,
+                                fs_ctx->cfg->program_unit);
+
+    return (ITS_LOG_NUM_RECORDS * slot_size) <= fs_ctx->cfg->max_file_size;
+}
+
+/**
+ * \brief Fills the record buffer with a log record.
+ *
+ * \param[in] fs_ctx     Filesystem context
+ * \param[in] seq        Sequence number of the record
+ * \param[in] data       Record data
+ * \param[in] data_size  Size of the record data
+ *
+ * \return Size of the record slot
+ */
+static size_t its_flash_fs_log_fill_record(struct its_flash_fs_ctx_t *fs_ctx,
+                                           uint32_t seq, const uint8_t *data,
+                                           size_t data_size)
+{
+    struct its_log_record_hdr_t hdr;
+    size_t slot_size = ITS_UTILS_ALIGN(ITS_LOG_RECORD_HDR_SIZE + data_size,
+                                       fs_ctx->cfg->program_unit);
+
+    hdr.seq = seq;
+    hdr.check = its_flash_fs_log_check(seq, data, data_size);
+
+    /* Keep the padding at the erase value so that it is left unprogrammed */
+    (void)memset(log_record_buf, fs_ctx->cfg->erase_val, slot_size);
+    (void)memcpy(log_record_buf, &hdr, ITS_LOG_RECORD_HDR_SIZE);
+    (void)memcpy(log_record_buf + ITS_LOG_RECORD_HDR_SIZE, data, data_size);
+
+    return slot_size;
+}
+
+/**
+ * \brief Scans the record slots of a log file.
+ *
+ * \param[in,out] fs_ctx     Filesystem context
+ * \param[in]     file_meta  Metadata of the log file
+ * \param[out]    state      Latest valid record and first erased slot
+ *
+ * \return Returns PSA_ERROR_DATA_CORRUPT if the file holds no valid record.
+ *         Otherwise, error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_flash_fs_log_scan(struct its_flash_fs_ctx_t *fs_ctx,
+                                      const struct its_file_meta_t *file_meta,
+                                      struct its_log_state_t *state)
+{
+    struct its_block_meta_t block_meta;
+    struct its_log_record_hdr_t hdr;
+    size_t data_size = file_meta->cur_size - ITS_LOG_RECORD_HDR_SIZE;
+    uint32_t num_slots;
+    uint32_t slot;
+    size_t i;
+    psa_status_t err;
+
+    err = its_flash_fs_mblock_read_block_metadata(fs_ctx, file_meta->lblock,
+                                                  &block_meta);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    state->phys_block = block_meta.phy_id;
+    state->slot_size = ITS_UTILS_ALIGN(file_meta->cur_size,
+                                       fs_ctx->cfg->program_unit);
+    state->latest = ITS_LOG_INVALID_SLOT;
+    state->seq = 0;
+    state->free = ITS_LOG_INVALID_SLOT;
+
+    num_slots = file_meta->max_size / state->slot_size;
+    for (slot = 0; slot < num_slots; slot++) {
+        err = fs_ctx->ops->read(fs_ctx->cfg, state->phys_block,
+                                log_record_buf,
+                                file_meta->data_idx + (slot * state->slot_size),
+                                state->slot_size);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        for (i = 0; i < state->slot_size; i++) {
+            if (log_record_buf[i] != fs_ctx->cfg->erase_val) {
+                break;
+            }
+        }
+
+        if (i == state->slot_size) {
+            /* Erased slot, which can be programmed with the next record */
+            if (state->free == ITS_LOG_INVALID_SLOT) {
+                state->free = slot;
+            }
+            continue;
+        }
+
+        /* A record torn by a power failure fails the check and is skipped */
+        (void)memcpy(&hdr, log_record_buf, ITS_LOG_RECORD_HDR_SIZE);
+        if ((hdr.seq != 0) && (hdr.seq > state->seq) &&
+            (hdr.check == its_flash_fs_log_check(hdr.seq,
+                                    log_record_buf + ITS_LOG_RECORD_HDR_SIZE,
+                                    data_size))) {
+            state->latest = slot;
+            state->seq = hdr.seq;
+        }
+    }
+
+    if (state->latest == ITS_LOG_INVALID_SLOT) {
+        return PSA_ERROR_DATA_CORRUPT;
+    }
+
+    return PSA_SUCCESS;
+}
+
+/**
+ * \brief Writes a small file as a log record.
+ *
+ * \details If the file is already a log file of the same size and flags, the
+ *          record is programmed in place into an erased slot, without any
+ *          block erase or metadata update. Otherwise, or once all slots are
+ *          used, the file is rewritten through the block update path with the
+ *          record in its first slot.
+ *
+ * \param[in,out] fs_ctx     Filesystem context
+ * \param[in]     fid        File ID
+ * \param[in]     finfo      Pointer to the file info
+ * \param[in]     data_size  Size of the file data
+ * \param[in]     data       Pointer to the file data
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_flash_fs_log_write(struct its_flash_fs_ctx_t *fs_ctx,
+                                        const uint8_t *fid,
+                                        struct its_flash_fs_file_info_t *finfo,
+                                        size_t data_size,
+                                        const uint8_t *data)
+{
+    struct its_flash_fs_file_info_t log_info;
+    struct its_file_meta_t file_meta;
+    struct its_log_state_t state;
+    size_t slot_size;
+    uint32_t idx;
+    uint32_t seq = 1;
+    psa_status_t err;
+
+    err = its_flash_fs_mblock_get_file_idx_meta(fs_ctx, fid, &idx, &file_meta);
+    if ((err == PSA_SUCCESS) && (file_meta.flags & ITS_FLASH_FS_FLAG_LOG) &&
+        (file_meta.cur_size == (ITS_LOG_RECORD_HDR_SIZE + data_size)) &&
+        ((file_meta.flags & ITS_FLASH_FS_USER_FLAGS_MASK) ==
+         (finfo->flags & ITS_FLASH_FS_USER_FLAGS_MASK))) {
+        err = its_flash_fs_log_scan(fs_ctx, &file_meta, &state);
+        if (err == PSA_SUCCESS) {
+            seq = state.seq + 1;
+
+            if (state.free != ITS_LOG_INVALID_SLOT) {
+                slot_size = its_flash_fs_log_fill_record(fs_ctx, seq, data,
+                                                         data_size);
+                err = fs_ctx->ops->write(fs_ctx->cfg, state.phys_block,
+                                         log_record_buf,
+                                         file_meta.data_idx +
+                                         (state.free * slot_size),
+                                         slot_size);
+                if (err == PSA_SUCCESS) {
+                    err = fs_ctx->ops->flush(fs_ctx->cfg, state.phys_block);
+                }
+                if (err == PSA_SUCCESS) {
+                    return PSA_SUCCESS;
+                }
+                /* Otherwise, the rewrite below replaces the failed record */
+            }
+        } else if (err != PSA_ERROR_DATA_CORRUPT) {
+            return err;
+        }
+    } else if ((err != PSA_SUCCESS) && (err != PSA_ERROR_DOES_NOT_EXIST)) {
+        return err;
+    }
+
+    /* Rewrite the file, compacting the log to a single record */
+    slot_size = its_flash_fs_log_fill_record(fs_ctx, seq, data, data_size);
+
+    log_info = *finfo;
+    log_info.size_max = ITS_LOG_NUM_RECORDS * slot_size;
+    log_info.flags |= ITS_FLASH_FS_FLAG_LOG;
+
+    err = its_flash_fs_file_write_block(fs_ctx, fid, &log_info,
+                                        ITS_LOG_RECORD_HDR_SIZE + data_size, 0,
+                                        log_record_buf);
+    if (err == PSA_ERROR_INSUFFICIENT_STORAGE) {
+        /* Not enough space for the record slots, store the file as is */
+#if (ITS_FLASH_MAX_ALIGNMENT != 1)
+        /* Set the max_size to be aligned with the flash program unit */
+        finfo->size_max = ITS_UTILS_ALIGN(finfo->size_max,
+                                          fs_ctx->cfg->program_unit);
+#endif
+
+        err = its_flash_fs_file_write_block(fs_ctx, fid, finfo, data_size, 0,
+                                            data);
+    }
+
+    return err;
+}
+
+/**
+ * \brief Reads data from the latest record of a log file.
+ *
+ * \param[in,out] fs_ctx     Filesystem context
+ * \param[in]     file_meta  Metadata of the log file
+ * \param[in]     size       Size to be read
+ * \param[in]     offset     Offset in the file data
+ * \param[out]    data       Pointer to buffer to store the data
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_flash_fs_log_read(struct its_flash_fs_ctx_t *fs_ctx,
+                                      const struct its_file_meta_t *file_meta,
+                                      size_t size, size_t offset,
+                                      uint8_t *data)
+{
+    struct its_log_state_t state;
+    psa_status_t err;
+
+    err = its_flash_fs_log_scan(fs_ctx, file_meta, &state);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    return fs_ctx->ops->read(fs_ctx->cfg, state.phys_block, data,
+                             file_meta->data_idx +
+                             (state.latest * state.slot_size) +
+                             ITS_LOG_RECORD_HDR_SIZE + offset,
+                             size);
+}
+#endif /* ITS_LOG_MODE */
+
+psa_status_t its_flash_fs_file_write(struct its_flash_fs_ctx_t *fs_ctx,
+                                     const uint8_t *fid,
+                                     struct its_flash_fs_file_info_t *finfo,
+                                     size_t data_size,
+                                     size_t offset,
+                                     const uint8_t *data)
+{
+    psa_status_t err;
+
+    if (finfo == NULL) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* Do not permit the user to pass filesystem-internal flags */
+    if (finfo->flags & ITS_FLASH_FS_INTERNAL_FLAGS_MASK) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+#if ITS_LOG_MODE
+    /* Small whole-file updates are appended as log records */
+    if (its_flash_fs_log_eligible(fs_ctx, finfo, data_size, offset)) {
+        err = its_flash_fs_log_write(fs_ctx, fid, finfo, data_size, data);
+    } else
+#endif
+    {
+#if (ITS_FLASH_MAX_ALIGNMENT != 1)
+        /* Set the max_size to be aligned with the flash program unit */
+        finfo->size_max = ITS_UTILS_ALIGN(finfo->size_max,
+                                          fs_ctx->cfg->program_unit);
+#endif
+
+        err = its_flash_fs_file_write_block(fs_ctx, fid, finfo, data_size,
+                                            offset, data);
+    }
+
+    if (err != PSA_SUCCESS) {
+        its_flash_fs_mblock_meta_update_abort(fs_ctx);
+    }
+
+    return err;
+}
+
 static psa_status_t its_flash_fs_delete_idx(struct its_flash_fs_ctx_t *fs_ctx,
                                             uint32_t del_file_idx)
 {
@@ -563,7 +955,12 @@ psa_status_t its_flash_fs_file_delete(struct its_flash_fs_ctx_t *fs_ctx,
         return PSA_ERROR_DOES_NOT_EXIST;
     }
 
-    return its_flash_fs_delete_idx(fs_ctx, del_file_idx);
+    err = its_flash_fs_delete_idx(fs_ctx, del_file_idx);
+    if (err != PSA_SUCCESS) {
+        its_flash_fs_mblock_meta_update_abort(fs_ctx);
+    }
+
+    return err;
 }
 
 psa_status_t its_flash_fs_file_read(struct its_flash_fs_ctx_t *fs_ctx,
@@ -582,6 +979,25 @@ psa_status_t its_flash_fs_file_read(struct its_flash_fs_ctx_t *fs_ctx,
         return PSA_ERROR_DOES_NOT_EXIST;
     }
 
+#if ITS_LOG_MODE
+    if (tmp_metadata.flags & ITS_FLASH_FS_FLAG_LOG) {
+        /* Boundary check the incoming request against the record data */
+        err = its_utils_check_contained_in(tmp_metadata.cur_size -
+                                           ITS_LOG_RECORD_HDR_SIZE,
+                                           offset, size);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        err = its_flash_fs_log_read(fs_ctx, &tmp_metadata, size, offset, data);
+        if (err != PSA_SUCCESS) {
+            return PSA_ERROR_GENERIC_ERROR;
+        }
+
+        return PSA_SUCCESS;
+    }
+#endif
+
     /* Boundary check the incoming request */
     err = its_utils_check_contained_in(tmp_metadata.cur_size, offset, size);
     if (err != PSA_SUCCESS) {
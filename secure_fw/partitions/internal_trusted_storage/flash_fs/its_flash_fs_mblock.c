@@ -435,6 +435,60 @@ static psa_status_t its_mblock_calculate_metadata_xor(
     return PSA_SUCCESS;
 }
 
+/**
+ * \brief Resets the incremental metadata XOR value of the scratch metadata
+ *        block, after the block has been erased.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ */
+static void its_mblock_scratch_xor_reset(struct its_flash_fs_ctx_t *fs_ctx)
+{
+    fs_ctx->scratch_xor = 0;
+    fs_ctx->scratch_xor_len = 0;
+    fs_ctx->scratch_xor_valid = true;
+}
+
+/**
+ * \brief Folds data written to the scratch metadata block into its
+ *        incremental metadata XOR value.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ * \param[in]     offset  Offset of the data in the scratch metadata block
+ * \param[in]     data    Data written
+ * \param[in]     size    Size of the data
+ */
+static void its_mblock_scratch_xor_update(struct its_flash_fs_ctx_t *fs_ctx,
+                                          size_t offset, const uint8_t *data,
+                                          size_t size)
+{
+    size_t meta_start = its_mblock_block_meta_offset(ITS_LOGICAL_DBLOCK0);
+    size_t meta_end = its_mblock_file_meta_offset(fs_ctx,
+                                                  fs_ctx->cfg->max_num_files);
+    size_t i;
+
+    /* Only the block and file metadata are covered, not the header nor the
+     * file data of logical block 0.
+     */
+    if (offset < meta_start) {
+        if (size <= (meta_start - offset)) {
+            return;
+        }
+        data += meta_start - offset;
+        size -= meta_start - offset;
+        offset = meta_start;
+    }
+
+    if (offset >= meta_end) {
+        return;
+    }
+
+    size = ITS_UTILS_MIN(size, meta_end - offset);
+    for (i = 0; i < size; i++) {
+        fs_ctx->scratch_xor ^= data[i];
+    }
+    fs_ctx->scratch_xor_len += size;
+}
+
 /**
  * \brief Checks the validity of metadata XOR.
  *
@@ -465,6 +519,142 @@ static psa_status_t its_mblock_validate_metadata_xor(
 }
 #endif /* ITS_VALIDATE_METADATA_FROM_FLASH */
 
+#if ITS_RAM_FILE_INDEX
+/**
+ * \brief Checks whether the file metadata table of the context fits in the
+ *        RAM file index.
+ *
+ * \param[in] fs_ctx  Filesystem context
+ *
+ * \return true if the file index can mirror the file metadata table
+ */
+__attribute__((always_inline))
+static inline bool its_file_index_fits(const struct its_flash_fs_ctx_t *fs_ctx)
+{
+    return fs_ctx->cfg->max_num_files <= ITS_RAM_FILE_INDEX_MAX_FILES;
+}
+
+/**
+ * \brief Calculates the file index hash of a file ID (32-bit FNV-1a).
+ *
+ * \param[in] fid  File ID
+ *
+ * \return Hash of the file ID
+ */
+static uint32_t its_file_index_hash(const uint8_t *fid)
+{
+    uint32_t hash = 0x811C9DC5U;
+    uint32_t i;
+
+    for (i = 0; i < ITS_FILE_ID_SIZE; i++) {
+        hash ^= fid[i];
+        hash *= 0x01000193U;
+    }
+
+    return hash;
+}
+
+/**
+ * \brief Checks whether a file slot is free in a file index.
+ *
+ * \param[in] index  File index
+ * \param[in] idx    File metadata slot
+ *
+ * \return true if the slot is free
+ */
+__attribute__((always_inline))
+static inline bool its_file_index_is_free(const struct its_file_index_t *index,
+                                          uint32_t idx)
+{
+    return (index->free_map[idx / 32] & (1UL << (idx % 32))) != 0;
+}
+
+/**
+ * \brief Records the file ID of a file slot in a file index.
+ *
+ * \param[in,out] index  File index
+ * \param[in]     idx    File metadata slot
+ * \param[in]     fid    File ID stored in the slot
+ */
+static void its_file_index_set(struct its_file_index_t *index, uint32_t idx,
+                               const uint8_t *fid)
+{
+    if (its_utils_validate_fid(fid) != PSA_SUCCESS) {
+        index->free_map[idx / 32] |= (1UL << (idx % 32));
+        index->fid_hash[idx] = 0;
+    } else {
+        index->free_map[idx / 32] &= ~(1UL << (idx % 32));
+        index->fid_hash[idx] = its_file_index_hash(fid);
+    }
+}
+
+/**
+ * \brief Builds the file index of the active metadata block from flash.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_file_index_build(struct its_flash_fs_ctx_t *fs_ctx)
+{
+    psa_status_t err;
+    uint32_t i;
+    struct its_file_meta_t tmp_metadata;
+    struct its_file_index_t *index;
+
+    fs_ctx->file_index_valid = false;
+
+    if (!its_file_index_fits(fs_ctx)) {
+        /* Lookups keep scanning the metadata in flash */
+        return PSA_SUCCESS;
+    }
+
+    index = &fs_ctx->file_index[fs_ctx->active_metablock];
+    for (i = 0; i < fs_ctx->cfg->max_num_files; i++) {
+        err = its_flash_fs_mblock_read_file_meta(fs_ctx, i, &tmp_metadata);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        its_file_index_set(index, i, tmp_metadata.id);
+    }
+
+    fs_ctx->file_index_valid = true;
+
+    return PSA_SUCCESS;
+}
+
+/**
+ * \brief Gets a free file metadata table entry from the file index.
+ *
+ * \param[in] fs_ctx     Filesystem context
+ * \param[in] use_spare  If true then the spare file index will be used,
+ *                       otherwise at least one file index will be left free
+ *
+ * \return Return index of a free file meta entry
+ */
+static uint32_t its_file_index_get_free(const struct its_flash_fs_ctx_t *fs_ctx,
+                                        bool use_spare)
+{
+    const struct its_file_index_t *index =
+                                &fs_ctx->file_index[fs_ctx->active_metablock];
+    uint32_t i;
+
+    for (i = 0; i < fs_ctx->cfg->max_num_files; i++) {
+        if (its_file_index_is_free(index, i)) {
+            if (!use_spare) {
+                /* Keep the first free file index as a spare */
+                use_spare = true;
+                continue;
+            }
+            return i;
+        }
+    }
+
+    return ITS_METADATA_INVALID_INDEX;
+}
+#endif /* ITS_RAM_FILE_INDEX */
+
 /**
  * \brief Gets a free file metadata table entry.
  *
@@ -481,6 +671,12 @@ static uint32_t its_get_free_file_index(struct its_flash_fs_ctx_t *fs_ctx,
     uint32_t i;
     struct its_file_meta_t tmp_metadata;
 
+#if ITS_RAM_FILE_INDEX
+    if (fs_ctx->file_index_valid) {
+        return its_file_index_get_free(fs_ctx, use_spare);
+    }
+#endif
+
     for (i = 0; i < fs_ctx->cfg->max_num_files; i++) {
         err = its_flash_fs_mblock_read_file_meta(fs_ctx, i, &tmp_metadata);
         if (err != PSA_SUCCESS) {
@@ -528,6 +724,10 @@ static psa_status_t its_mblock_erase_scratch_blocks(
         return err;
     }
 
+#if ITS_VALIDATE_METADATA_FROM_FLASH
+    its_mblock_scratch_xor_reset(fs_ctx);
+#endif
+
     /* If the number of blocks is bigger than 2, the code needs to erase the
      * scratch block used to process any change in the data block which contains
      * only data. Otherwise, if the number of blocks is equal to 2, it means
@@ -558,13 +758,23 @@ static psa_status_t its_mblock_update_scratch_block_meta(
                                       uint32_t lblock,
                                       const struct its_block_meta_t *block_meta)
 {
+    psa_status_t err;
     size_t pos;
 
     /* Calculate the position */
     pos = its_mblock_block_meta_offset(lblock);
-    return fs_ctx->ops->write(fs_ctx->cfg, fs_ctx->scratch_metablock,
-                              (const uint8_t *)block_meta, pos,
-                              ITS_BLOCK_METADATA_SIZE);
+    err = fs_ctx->ops->write(fs_ctx->cfg, fs_ctx->scratch_metablock,
+                             (const uint8_t *)block_meta, pos,
+                             ITS_BLOCK_METADATA_SIZE);
+
+#if ITS_VALIDATE_METADATA_FROM_FLASH
+    if (err == PSA_SUCCESS) {
+        its_mblock_scratch_xor_update(fs_ctx, pos, (const uint8_t *)block_meta,
+                                      ITS_BLOCK_METADATA_SIZE);
+    }
+#endif
+
+    return err;
 }
 
 /**
@@ -762,12 +972,22 @@ static psa_status_t its_mblock_write_scratch_meta_header(
         fs_ctx->meta_block_header.active_swap_count++;
     }
 #if ITS_VALIDATE_METADATA_FROM_FLASH
-    /* Calculate metadata XOR value. */
-    err = its_mblock_calculate_metadata_xor(fs_ctx,
+    if (fs_ctx->scratch_xor_valid &&
+        (fs_ctx->scratch_xor_len ==
+         (its_mblock_file_meta_offset(fs_ctx, fs_ctx->cfg->max_num_files) -
+          its_mblock_block_meta_offset(ITS_LOGICAL_DBLOCK0)))) {
+        /* Every metadata byte has been written once since the scratch block
+         * was erased, so the XOR of the writes is the XOR of the metadata.
+         */
+        fs_ctx->meta_block_header.metadata_xor = fs_ctx->scratch_xor;
+    } else {
+        /* Calculate metadata XOR value. */
+        err = its_mblock_calculate_metadata_xor(fs_ctx,
                                        fs_ctx->scratch_metablock,
                                        &fs_ctx->meta_block_header.metadata_xor);
-    if (err != PSA_SUCCESS) {
-        return err;
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
     }
 #else
     fs_ctx->meta_block_header.metadata_xor = 0;
@@ -979,6 +1199,25 @@ psa_status_t its_flash_fs_mblock_cp_file_meta(struct its_flash_fs_ctx_t *fs_ctx,
     size_t pos_start = its_mblock_file_meta_offset(fs_ctx, idx_start);
     size_t pos_end = its_mblock_file_meta_offset(fs_ctx, idx_end);
 
+#if ITS_RAM_FILE_INDEX
+    if (its_file_index_fits(fs_ctx)) {
+        const struct its_file_index_t *src =
+                                &fs_ctx->file_index[fs_ctx->active_metablock];
+        struct its_file_index_t *dst =
+                                &fs_ctx->file_index[fs_ctx->scratch_metablock];
+        uint32_t i;
+
+        for (i = idx_start; i < idx_end; i++) {
+            dst->fid_hash[i] = src->fid_hash[i];
+            if (its_file_index_is_free(src, i)) {
+                dst->free_map[i / 32] |= (1UL << (i % 32));
+            } else {
+                dst->free_map[i / 32] &= ~(1UL << (i % 32));
+            }
+        }
+    }
+#endif
+
     /* Copy all data between the two positions from the scratch metadata block
      * to the active metadata block.
      */
@@ -1007,6 +1246,40 @@ psa_status_t its_flash_fs_mblock_get_file_idx_meta(struct its_flash_fs_ctx_t *fs
     psa_status_t err;
     uint32_t i;
     struct its_file_meta_t tmp_metadata;
+#if ITS_RAM_FILE_INDEX
+    const struct its_file_index_t *index;
+    uint32_t hash;
+
+    if (fs_ctx->file_index_valid) {
+        index = &fs_ctx->file_index[fs_ctx->active_metablock];
+        hash = its_file_index_hash(fid);
+
+        for (i = 0; i < fs_ctx->cfg->max_num_files; i++) {
+            if (its_file_index_is_free(index, i) ||
+                (index->fid_hash[i] != hash)) {
+                continue;
+            }
+
+            /* Only the slots matching the hash are read from flash, to
+             * resolve collisions and return the metadata.
+             */
+            err = its_flash_fs_mblock_read_file_meta(fs_ctx, i, &tmp_metadata);
+            if (err != PSA_SUCCESS) {
+                return PSA_ERROR_GENERIC_ERROR;
+            }
+
+            if (!memcmp(tmp_metadata.id, fid, ITS_FILE_ID_SIZE)) {
+                *idx = i;
+                if (file_meta != NULL) {
+                    *file_meta = tmp_metadata;
+                }
+                return PSA_SUCCESS;
+            }
+        }
+
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+#endif
 
     for (i = 0; i < fs_ctx->cfg->max_num_files; i++) {
         err = its_flash_fs_mblock_read_file_meta(fs_ctx, i, &tmp_metadata);
@@ -1057,6 +1330,10 @@ psa_status_t its_flash_fs_mblock_init(struct its_flash_fs_ctx_t *fs_ctx)
 {
     psa_status_t err;
 
+#if ITS_RAM_FILE_INDEX
+    fs_ctx->file_index_valid = false;
+#endif
+
     /* Initialize Flash Interface */
     err = fs_ctx->ops->init(fs_ctx->cfg);
     if (err != PSA_SUCCESS) {
@@ -1082,7 +1359,26 @@ psa_status_t its_flash_fs_mblock_init(struct its_flash_fs_ctx_t *fs_ctx)
     }
 
     /* Upgrade the metadata header if required. */
-    return its_mblock_upgrade_meta_header(fs_ctx);
+    err = its_mblock_upgrade_meta_header(fs_ctx);
+#if ITS_RAM_FILE_INDEX
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    /* Build the file index from the active metadata block */
+    err = its_file_index_build(fs_ctx);
+#endif
+
+    return err;
+}
+
+void its_flash_fs_mblock_meta_update_abort(struct its_flash_fs_ctx_t *fs_ctx)
+{
+#if ITS_VALIDATE_METADATA_FROM_FLASH
+    fs_ctx->scratch_xor_valid = false;
+#else
+    (void)fs_ctx;
+#endif
 }
 
 psa_status_t its_flash_fs_mblock_meta_update_finalize(
@@ -1233,6 +1529,10 @@ psa_status_t its_flash_fs_mblock_reset_metablock(
     uint32_t metablock_to_erase_first = ITS_METADATA_BLOCK0;
     struct its_file_meta_t file_metadata;
 
+#if ITS_RAM_FILE_INDEX
+    fs_ctx->file_index_valid = false;
+#endif
+
     /* Erase both metadata blocks. If at least one metadata block is valid,
      * ensure that the active metadata block is erased last to prevent rollback
      * in the case of a power failure between the two erases.
@@ -1252,6 +1552,10 @@ psa_status_t its_flash_fs_mblock_reset_metablock(
         return err;
     }
 
+#if ITS_VALIDATE_METADATA_FROM_FLASH
+    its_mblock_scratch_xor_reset(fs_ctx);
+#endif
+
     fs_ctx->meta_block_header.active_swap_count =
                                     (fs_ctx->cfg->erase_val == 0x00U) ? 1U : 0U;
     fs_ctx->meta_block_header.scratch_dblock = its_init_scratch_dblock(fs_ctx);
@@ -1332,6 +1636,11 @@ psa_status_t its_flash_fs_mblock_reset_metablock(
     /* Swap active and scratch metablocks */
     its_mblock_swap_metablocks(fs_ctx);
 
+#if ITS_RAM_FILE_INDEX
+    /* Every file slot has been recorded while writing the scratch block */
+    fs_ctx->file_index_valid = its_file_index_fits(fs_ctx);
+#endif
+
     return PSA_SUCCESS;
 }
 
@@ -1371,13 +1680,33 @@ psa_status_t its_flash_fs_mblock_update_scratch_file_meta(
                                         uint32_t idx,
                                         const struct its_file_meta_t *file_meta)
 {
+    psa_status_t err;
     size_t pos;
 
+#if ITS_RAM_FILE_INDEX
+    /* Track the scratch block contents so that the index of the new active
+     * block is already in place when the metadata blocks are swapped.
+     */
+    if (its_file_index_fits(fs_ctx)) {
+        its_file_index_set(&fs_ctx->file_index[fs_ctx->scratch_metablock],
+                           idx, file_meta->id);
+    }
+#endif
+
     /* Calculate the position */
     pos = its_mblock_file_meta_offset(fs_ctx, idx);
-    return fs_ctx->ops->write(fs_ctx->cfg, fs_ctx->scratch_metablock,
-                              (const uint8_t *)file_meta, pos,
-                              ITS_FILE_METADATA_SIZE);
+    err = fs_ctx->ops->write(fs_ctx->cfg, fs_ctx->scratch_metablock,
+                             (const uint8_t *)file_meta, pos,
+                             ITS_FILE_METADATA_SIZE);
+
+#if ITS_VALIDATE_METADATA_FROM_FLASH
+    if (err == PSA_SUCCESS) {
+        its_mblock_scratch_xor_update(fs_ctx, pos, (const uint8_t *)file_meta,
+                                      ITS_FILE_METADATA_SIZE);
+    }
+#endif
+
+    return err;
 }
 
 psa_status_t its_flash_fs_block_to_block_move(struct its_flash_fs_ctx_t *fs_ctx,
@@ -1411,6 +1740,13 @@ psa_status_t its_flash_fs_block_to_block_move(struct its_flash_fs_ctx_t *fs_ctx,
             return status;
         }
 
+#if ITS_VALIDATE_METADATA_FROM_FLASH
+        if (dst_block == fs_ctx->scratch_metablock) {
+            its_mblock_scratch_xor_update(fs_ctx, dst_offset,
+                                          dst_block_data_copy, bytes_to_move);
+        }
+#endif
+
         /* Updates pointers to the source and destination flash regions */
         dst_offset += bytes_to_move;
         src_offset += bytes_to_move;
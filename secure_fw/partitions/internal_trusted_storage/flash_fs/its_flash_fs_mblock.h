@@ -12,6 +12,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "config_tfm.h"
 #include "flash/its_flash.h"
 #include "its_flash_fs.h"
 #include "its_utils.h"
@@ -179,6 +180,28 @@ struct its_file_meta_t {
 };
 #undef _T3
 
+#if ITS_RAM_FILE_INDEX
+/*!
+ * \def ITS_FILE_INDEX_MAP_WORDS
+ *
+ * \brief Number of words in the free file slot bitmap.
+ */
+#define ITS_FILE_INDEX_MAP_WORDS  ((ITS_RAM_FILE_INDEX_MAX_FILES + 31) / 32)
+
+/*!
+ * \struct its_file_index_t
+ *
+ * \brief RAM copy of the file ID table of one metadata block.
+ *
+ * \details Bit n of free_map is set when file metadata slot n is free. For a
+ *          used slot, fid_hash[n] holds the hash of its file ID.
+ */
+struct its_file_index_t {
+    uint32_t fid_hash[ITS_RAM_FILE_INDEX_MAX_FILES];
+    uint32_t free_map[ITS_FILE_INDEX_MAP_WORDS];
+};
+#endif
+
 /**
  * \struct its_flash_fs_ctx_t
  *
@@ -192,6 +215,21 @@ struct its_flash_fs_ctx_t {
                                                            */
     uint32_t active_metablock;  /**< Active metadata block */
     uint32_t scratch_metablock; /**< Scratch metadata block */
+#if ITS_VALIDATE_METADATA_FROM_FLASH
+    size_t scratch_xor_len;     /**< Number of metadata bytes written to the
+                                 *   scratch metadata block since its erase
+                                 */
+    uint8_t scratch_xor;        /**< XOR of those metadata bytes */
+    bool scratch_xor_valid;     /**< scratch_xor can be used as the XOR value
+                                 *   of the scratch metadata
+                                 */
+#endif
+#if ITS_RAM_FILE_INDEX
+    struct its_file_index_t file_index[2]; /**< File index of each metadata
+                                            *   block, by physical ID
+                                            */
+    bool file_index_valid;      /**< File index mirrors the metadata blocks */
+#endif
 };
 
 /**
@@ -260,6 +298,17 @@ psa_status_t its_flash_fs_mblock_get_file_idx_flag(
                                               uint32_t flags,
                                               uint32_t *idx);
 
+/**
+ * \brief Aborts an update operation, after a failure left the scratch
+ *        metadata block partially written.
+ *
+ * \details The next update operation then computes the metadata XOR value
+ *          from flash instead of incrementally.
+ *
+ * \param[in,out] fs_ctx  Filesystem context
+ */
+void its_flash_fs_mblock_meta_update_abort(struct its_flash_fs_ctx_t *fs_ctx);
+
 /**
  * \brief Finalizes an update operation.
  *        Last step when a create/write/delete is performed.
@@ -0,0 +1,27 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __FLASH_LAYOUT_H__
+#define __FLASH_LAYOUT_H__
+
+/* Host stand-in for the target flash layout */
+
+#define TFM_HAL_ITS_FLASH_DRIVER        Driver_FLASH0
+#define TFM_HAL_ITS_FLASH_AREA_ADDR     0x0
+#define TFM_HAL_ITS_FLASH_AREA_SIZE     0x4000
+#define TFM_HAL_ITS_SECTORS_PER_BLOCK   1
+#ifndef TFM_HAL_ITS_PROGRAM_UNIT
+#define TFM_HAL_ITS_PROGRAM_UNIT        1
+#endif
+
+#define TFM_HAL_PS_FLASH_DRIVER         Driver_FLASH0
+#define TFM_HAL_PS_FLASH_AREA_ADDR      0x4000
+#define TFM_HAL_PS_FLASH_AREA_SIZE      0x4000
+#define TFM_HAL_PS_SECTORS_PER_BLOCK    1
+#define TFM_HAL_PS_PROGRAM_UNIT         1
+
+#endif /* __FLASH_LAYOUT_H__ */
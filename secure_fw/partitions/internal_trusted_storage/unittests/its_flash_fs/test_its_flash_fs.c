@@ -0,0 +1,371 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "config_tfm.h"
+#include "flash_fs/its_flash_fs.h"
+#include "flash/its_flash_ram.h"
+#include "flash_layout.h"
+
+#define BLOCK_SIZE          (4096u)
+#define NUM_BLOCKS          (4u)
+#define MAX_FILE_SIZE       (512u)
+#define MAX_NUM_FILES       (11u)
+
+/* A small file updated over and over, and files stored beside it */
+#define COUNTER_FILE        (0u)
+#define COUNTER_SIZE        (8u)
+#define NUM_BG_FILES        (4u)
+#define BG_FILE_SIZE(k)     (20u + (k))
+
+/* Number of counter updates whose flash operations are counted */
+#define NUM_UPDATES         (1000u)
+
+/* Writes into an update at which power is lost */
+#define MAX_FAIL_POINT      (40)
+
+/* Sizes that are not a multiple of the program unit, one small enough to be
+ * stored as a log and one too large for it
+ */
+#define UNALIGNED_LOG_SIZE  (13u)
+#define UNALIGNED_FILE_SIZE (41u)
+
+static uint8_t flash_ram[NUM_BLOCKS * BLOCK_SIZE];
+
+static const struct its_flash_fs_config_t flash_cfg = {
+    .flash_dev = flash_ram,
+    .program_unit = TFM_HAL_ITS_PROGRAM_UNIT,
+    .block_size = BLOCK_SIZE,
+    .sector_size = BLOCK_SIZE,
+    .num_blocks = NUM_BLOCKS,
+    .max_file_size = MAX_FILE_SIZE,
+    .max_num_files = MAX_NUM_FILES,
+    .erase_val = 0xFF,
+};
+
+/* Only the metadata block holds file data, so that it can be filled up */
+static const struct its_flash_fs_config_t small_flash_cfg = {
+    .flash_dev = flash_ram,
+    .program_unit = TFM_HAL_ITS_PROGRAM_UNIT,
+    .block_size = BLOCK_SIZE,
+    .sector_size = BLOCK_SIZE,
+    .num_blocks = 2,
+    .max_file_size = MAX_FILE_SIZE,
+    .max_num_files = MAX_NUM_FILES,
+    .erase_val = 0xFF,
+};
+
+static struct its_flash_fs_ctx_t fs_ctx;
+
+/* Flash operation counters */
+static uint32_t num_writes;
+static uint32_t num_erases;
+
+/* Number of writes after which power is lost, or -1 to never lose it. The
+ * write that loses power only programs the first half of its data.
+ */
+static int32_t fail_after = -1;
+
+static psa_status_t counting_init(const struct its_flash_fs_config_t *cfg)
+{
+    return its_flash_fs_ops_ram.init(cfg);
+}
+
+static psa_status_t counting_read(const struct its_flash_fs_config_t *cfg,
+                                  uint32_t block_id, uint8_t *buff,
+                                  size_t offset, size_t size)
+{
+    return its_flash_fs_ops_ram.read(cfg, block_id, buff, offset, size);
+}
+
+static psa_status_t counting_write(const struct its_flash_fs_config_t *cfg,
+                                   uint32_t block_id, const uint8_t *buff,
+                                   size_t offset, size_t size)
+{
+    num_writes++;
+
+    /* Files must start on a program unit boundary */
+    TEST_ASSERT_EQUAL(0, offset % cfg->program_unit);
+
+    if (fail_after == 0) {
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+    if ((fail_after > 0) && (--fail_after == 0)) {
+        (void)its_flash_fs_ops_ram.write(cfg, block_id, buff, offset, size / 2);
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+    return its_flash_fs_ops_ram.write(cfg, block_id, buff, offset, size);
+}
+
+static psa_status_t counting_flush(const struct its_flash_fs_config_t *cfg,
+                                   uint32_t block_id)
+{
+    return its_flash_fs_ops_ram.flush(cfg, block_id);
+}
+
+static psa_status_t counting_erase(const struct its_flash_fs_config_t *cfg,
+                                   uint32_t block_id)
+{
+    num_erases++;
+
+    if (fail_after == 0) {
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+    return its_flash_fs_ops_ram.erase(cfg, block_id);
+}
+
+static const struct its_flash_fs_ops_t counting_ops = {
+    .init = counting_init,
+    .read = counting_read,
+    .write = counting_write,
+    .flush = counting_flush,
+    .erase = counting_erase,
+};
+
+static void make_fid(uint8_t *fid, uint32_t file)
+{
+    memset(fid, 0, ITS_FILE_ID_SIZE);
+    fid[0] = (uint8_t)(file + 1);
+}
+
+static psa_status_t set_file(uint32_t file, const uint8_t *data, size_t size)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    struct its_flash_fs_file_info_t info = {
+        .size_max = size,
+        .flags = ITS_FLASH_FS_FLAG_CREATE | ITS_FLASH_FS_FLAG_TRUNCATE,
+    };
+
+    make_fid(fid, file);
+
+    return its_flash_fs_file_write(&fs_ctx, fid, &info, size, 0, data);
+}
+
+static psa_status_t get_file(uint32_t file, uint8_t *data, size_t *size)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    struct its_flash_fs_file_info_t info;
+    psa_status_t status;
+
+    make_fid(fid, file);
+
+    status = its_flash_fs_file_get_info(&fs_ctx, fid, &info);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    *size = info.size_current;
+
+    return its_flash_fs_file_read(&fs_ctx, fid, *size, 0, data);
+}
+
+/* Loads the file system from flash, as after a reset */
+static void reboot_with_cfg(const struct its_flash_fs_config_t *cfg)
+{
+    memset(&fs_ctx, 0, sizeof(fs_ctx));
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, its_flash_fs_init_ctx(&fs_ctx, cfg, &counting_ops));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, its_flash_fs_prepare(&fs_ctx));
+}
+
+static void reboot(void)
+{
+    reboot_with_cfg(&flash_cfg);
+}
+
+static void assert_file(uint32_t file, const uint8_t *expected, size_t expected_size)
+{
+    uint8_t data[MAX_FILE_SIZE];
+    size_t size;
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, get_file(file, data, &size));
+    TEST_ASSERT_EQUAL(expected_size, size);
+    TEST_ASSERT_EQUAL_MEMORY(expected, data, size);
+}
+
+static void assert_bg_files(void)
+{
+    uint8_t expected[BG_FILE_SIZE(NUM_BG_FILES)];
+
+    for (uint32_t k = 1; k <= NUM_BG_FILES; k++) {
+        memset(expected, (int)k, sizeof(expected));
+        assert_file(k, expected, BG_FILE_SIZE(k));
+    }
+}
+
+static void set_counter(uint8_t *counter, uint32_t val)
+{
+    memcpy(counter, &val, sizeof(val));
+    memset(&counter[sizeof(val)], 0xA5, COUNTER_SIZE - sizeof(val));
+}
+
+void setUp(void)
+{
+    uint8_t data[BG_FILE_SIZE(NUM_BG_FILES)];
+
+    fail_after = -1;
+    memset(flash_ram, 0xFF, sizeof(flash_ram));
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, its_flash_fs_init_ctx(&fs_ctx, &flash_cfg, &counting_ops));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, its_flash_fs_wipe_all(&fs_ctx));
+    reboot();
+
+    for (uint32_t k = 1; k <= NUM_BG_FILES; k++) {
+        memset(data, (int)k, sizeof(data));
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, set_file(k, data, BG_FILE_SIZE(k)));
+    }
+}
+
+void tearDown(void)
+{
+}
+
+void test_its_flash_fs_should_keepLatestValueAcrossReboot(void)
+{
+    uint8_t counter[COUNTER_SIZE];
+
+    for (uint32_t i = 0; i < 50; i++) {
+        set_counter(counter, i);
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, set_file(COUNTER_FILE, counter, sizeof(counter)));
+        assert_file(COUNTER_FILE, counter, sizeof(counter));
+    }
+
+    reboot();
+
+    assert_file(COUNTER_FILE, counter, sizeof(counter));
+    assert_bg_files();
+}
+
+void test_its_flash_fs_should_changeSizeOfSmallFile(void)
+{
+    uint8_t data[MAX_FILE_SIZE];
+
+    set_counter(data, 1);
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, set_file(COUNTER_FILE, data, COUNTER_SIZE));
+
+    memset(data, 7, 16);
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, set_file(COUNTER_FILE, data, 16));
+    assert_file(COUNTER_FILE, data, 16);
+
+    /* Too large to be stored as a log */
+    memset(data, 9, 200);
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, set_file(COUNTER_FILE, data, 200));
+    assert_file(COUNTER_FILE, data, 200);
+
+    reboot();
+
+    assert_file(COUNTER_FILE, data, 200);
+    assert_bg_files();
+}
+
+void test_its_flash_fs_should_keepOldOrNewValueOnPowerLoss(void)
+{
+    uint8_t old_val[COUNTER_SIZE];
+    uint8_t new_val[COUNTER_SIZE];
+    uint8_t data[COUNTER_SIZE];
+    size_t size;
+
+    set_counter(old_val, 0);
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, set_file(COUNTER_FILE, old_val, sizeof(old_val)));
+
+    for (int32_t fail_point = 1; fail_point <= MAX_FAIL_POINT; fail_point++) {
+        set_counter(new_val, (uint32_t)fail_point);
+
+        fail_after = fail_point;
+        (void)set_file(COUNTER_FILE, new_val, sizeof(new_val));
+        fail_after = -1;
+
+        reboot();
+
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, get_file(COUNTER_FILE, data, &size));
+        TEST_ASSERT_EQUAL(COUNTER_SIZE, size);
+        TEST_ASSERT_TRUE((memcmp(data, old_val, size) == 0) ||
+                         (memcmp(data, new_val, size) == 0));
+        assert_bg_files();
+
+        /* Updates carry on normally after recovery */
+        set_counter(old_val, (uint32_t)fail_point + 1000u);
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, set_file(COUNTER_FILE, old_val, sizeof(old_val)));
+        assert_file(COUNTER_FILE, old_val, sizeof(old_val));
+    }
+}
+
+void test_its_flash_fs_should_boundFlashOpsOfCounterUpdates(void)
+{
+    uint8_t counter[COUNTER_SIZE];
+
+    set_counter(counter, 0);
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, set_file(COUNTER_FILE, counter, sizeof(counter)));
+
+    num_writes = 0;
+    num_erases = 0;
+
+    for (uint32_t i = 1; i <= NUM_UPDATES; i++) {
+        set_counter(counter, i);
+        TEST_ASSERT_EQUAL(PSA_SUCCESS, set_file(COUNTER_FILE, counter, sizeof(counter)));
+    }
+
+#if ITS_LOG_MODE
+    /* Only a rewrite of a full log erases blocks */
+    TEST_ASSERT_LESS_OR_EQUAL(2u * (NUM_UPDATES / ITS_LOG_NUM_RECORDS) + 2u, num_erases);
+    /* Most updates only append a record */
+    TEST_ASSERT_LESS_THAN(3u * NUM_UPDATES, num_writes);
+#else
+    /* Each update swaps in the scratch data and metadata blocks */
+    TEST_ASSERT_EQUAL(2u * NUM_UPDATES, num_erases);
+#endif
+
+    assert_file(COUNTER_FILE, counter, sizeof(counter));
+}
+
+void test_its_flash_fs_should_alignFileThatDoesNotFitAsLog(void)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    uint8_t data[MAX_FILE_SIZE];
+    uint32_t file = 0;
+    size_t filler;
+
+    memset(data, 0x5A, sizeof(data));
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, its_flash_fs_init_ctx(&fs_ctx, &small_flash_cfg, &counting_ops));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, its_flash_fs_wipe_all(&fs_ctx));
+    reboot_with_cfg(&small_flash_cfg);
+
+    /* Fill the flash with whole files, then find the largest that still fits */
+    while (set_file(file, data, MAX_FILE_SIZE) == PSA_SUCCESS) {
+        file++;
+    }
+    for (filler = MAX_FILE_SIZE; filler > 0; filler -= TFM_HAL_ITS_PROGRAM_UNIT) {
+        if (set_file(file, data, filler) == PSA_SUCCESS) {
+            break;
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(64u, filler);
+
+    /* Leave room for both unaligned files but not for the log record slots */
+    make_fid(fid, file);
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, its_flash_fs_file_delete(&fs_ctx, fid));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, set_file(file, data, filler - 64u));
+    file++;
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, set_file(file, data, UNALIGNED_LOG_SIZE));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, set_file(file + 1, data, UNALIGNED_FILE_SIZE));
+
+    reboot_with_cfg(&small_flash_cfg);
+
+    assert_file(file, data, UNALIGNED_LOG_SIZE);
+    assert_file(file + 1, data, UNALIGNED_FILE_SIZE);
+}
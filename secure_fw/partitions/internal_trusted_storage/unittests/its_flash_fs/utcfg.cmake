@@ -0,0 +1,38 @@
+#-------------------------------------------------------------------------------
+# SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+#-------------------------------------------------------------------------------
+
+set(ITS_SOURCE_DIR ${TFM_ROOT_DIR}/secure_fw/partitions/internal_trusted_storage)
+
+# Define what is being unit tested and by what
+set(UNIT_UNDER_TEST
+    ${ITS_SOURCE_DIR}/flash_fs/its_flash_fs.c
+    ${ITS_SOURCE_DIR}/flash_fs/its_flash_fs_dblock.c
+    ${ITS_SOURCE_DIR}/flash_fs/its_flash_fs_mblock.c
+)
+set(UNIT_TEST_SUITE ${CMAKE_CURRENT_LIST_DIR}/test_its_flash_fs.c)
+
+# Dependencies for the UUT, that get linked into the executable
+set(UNIT_TEST_DEPS
+    ${ITS_SOURCE_DIR}/flash/its_flash_ram.c
+    ${ITS_SOURCE_DIR}/its_utils.c
+)
+
+# Include directories for compilation
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${ITS_SOURCE_DIR}/unittests/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${ITS_SOURCE_DIR})
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${ITS_SOURCE_DIR}/flash)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${ITS_SOURCE_DIR}/flash_fs)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/spm/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/interface/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/platform/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/config)
+
+# Headers to be mocked
+
+# Compile-time definitions
+list(APPEND UNIT_TEST_COMPILE_DEFS ITS_LOG_MODE=0)
@@ -139,7 +139,7 @@ void tfm_rpc_client_call_reply(void)
     rpc_ops.reply(handle->client_data, handle->replied_value);
 
     if (handle->status == TFM_HANDLE_STATUS_TO_FREE) {
-        spm_free_connection(handle);
+        spm_release_connection(handle);
     } else {
         handle->status = TFM_HANDLE_STATUS_IDLE;
     }
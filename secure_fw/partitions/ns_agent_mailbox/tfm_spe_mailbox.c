@@ -51,6 +51,40 @@ struct vectors {
 };
 static struct vectors vectors[NUM_MAILBOX_QUEUE_SLOT] = {0};
 
+#if MAILBOX_RING_PROTOCOL
+#define MAILBOX_RING_MASK                   (MAILBOX_RING_SIZE - 1)
+
+/* Head of the completion ring, including the replies not published yet */
+static uint32_t comp_ring_head;
+
+/* NSPE slots which have been taken from the request ring but not replied */
+static mailbox_queue_status_t ns_slots_in_flight;
+
+static void mailbox_ring_push_reply(uint8_t ns_slot_idx)
+{
+    struct mailbox_ring_t *comp = &spe_mailbox_queue.ns_rings->comp;
+
+    comp->entries[comp_ring_head & MAILBOX_RING_MASK] = ns_slot_idx;
+    comp_ring_head++;
+    ns_slots_in_flight &= ~(1UL << ns_slot_idx);
+}
+
+/* Makes all the pushed replies visible to NSPE at once */
+static void mailbox_ring_publish_replies(void)
+{
+    struct mailbox_ring_t *comp = &spe_mailbox_queue.ns_rings->comp;
+
+    /*
+     * The entries must be visible before the new head. Cache maintenance
+     * does not order the stores, so a barrier is required as well.
+     */
+    MAILBOX_CLEAN_CACHE(comp->entries, sizeof(comp->entries));
+    __DMB();
+    comp->head = comp_ring_head;
+    MAILBOX_CLEAN_CACHE(&comp->head, sizeof(comp->head));
+}
+#endif /* MAILBOX_RING_PROTOCOL */
+
 
 __STATIC_INLINE void set_spe_queue_empty_status(uint8_t idx)
 {
@@ -171,6 +205,10 @@ static void mailbox_direct_reply(uint8_t idx, uint32_t result)
 
     MAILBOX_CLEAN_CACHE(reply_ptr, sizeof(*reply_ptr));
 
+#if MAILBOX_RING_PROTOCOL
+    mailbox_ring_push_reply(spe_mailbox_queue.queue[idx].ns_slot_idx);
+#endif
+
     mailbox_clean_queue_slot(idx);
 
     /*
@@ -346,14 +384,123 @@ static int32_t tfm_mailbox_dispatch(const struct mailbox_msg_t *msg_ptr,
     return MAILBOX_SUCCESS;
 }
 
+/* Copies the message in NSPE slot ns_slot_idx to SPE slot idx and dispatches
+ * it. If it is replied immediately, updates reply_slots accordingly.
+ */
+static int32_t mailbox_handle_slot(uint8_t idx, uint8_t ns_slot_idx,
+                                   mailbox_queue_status_t *reply_slots)
+{
+    struct mailbox_msg_t *msg_ptr;
+    int32_t status;
+
+    clear_spe_queue_empty_status(idx);
+    spe_mailbox_queue.queue[idx].ns_slot_idx = ns_slot_idx;
+
+    msg_ptr = &spe_mailbox_queue.queue[idx].msg;
+    MAILBOX_INVALIDATE_CACHE(&spe_mailbox_queue.ns_slots[ns_slot_idx].msg,
+                             sizeof(*msg_ptr));
+    spm_memcpy(msg_ptr, &spe_mailbox_queue.ns_slots[ns_slot_idx].msg,
+               sizeof(*msg_ptr));
+
+    get_spe_mailbox_msg_handle(idx,
+                               &spe_mailbox_queue.queue[idx].msg_handle);
+
+    status = tfm_mailbox_dispatch(msg_ptr, idx, reply_slots);
+    if (status != MAILBOX_SUCCESS) {
+        mailbox_clean_queue_slot(idx);
+    }
+
+    return status;
+}
+
+#if MAILBOX_RING_PROTOCOL
+int32_t tfm_mailbox_handle_msg(void)
+{
+    uint8_t idx, ns_slot_idx;
+    uint32_t head, tail;
+    mailbox_queue_status_t reply_slots = 0;
+    struct mailbox_ring_t *req = spe_mailbox_queue.ns_rings ?
+                                 &spe_mailbox_queue.ns_rings->req : NULL;
+    int32_t msg_dispatched = 0;
+
+    assert(req != NULL);
+
+    MAILBOX_INVALIDATE_CACHE(&req->head, sizeof(req->head));
+    head = req->head;
+    /* Only SPE updates the tail */
+    tail = req->tail;
+
+    /* Check if NSPE mailbox did assert a PSA client call request */
+    if (head == tail) {
+        return MAILBOX_NO_PEND_EVENT;
+    }
+
+    /* NSPE cannot have more requests in flight than slots */
+    if ((head - tail) > spe_mailbox_queue.ns_slot_count) {
+        return MAILBOX_INVAL_PARAMS;
+    }
+
+    /* The entries must be read after the head */
+    __DMB();
+    MAILBOX_INVALIDATE_CACHE(req->entries, sizeof(req->entries));
+
+    for (; tail != head; tail++) {
+        ns_slot_idx = req->entries[tail & MAILBOX_RING_MASK];
+        if ((ns_slot_idx >= NUM_MAILBOX_QUEUE_SLOT) ||
+            (ns_slot_idx >= spe_mailbox_queue.ns_slot_count)) {
+            continue;
+        }
+
+        /*
+         * A slot already being handled cannot be submitted again before it is
+         * replied. Drop the duplicate rather than overwrite the ongoing call.
+         */
+        if (ns_slots_in_flight & (1UL << ns_slot_idx)) {
+            continue;
+        }
+
+        /* Select an empty SPE mailbox queue slot */
+        for (idx = 0; idx < NUM_MAILBOX_QUEUE_SLOT; idx++) {
+            if (get_spe_queue_empty_status(idx)) {
+                break;
+            }
+        }
+
+        /* Leave the remaining requests in the ring until a slot is freed */
+        if (idx >= NUM_MAILBOX_QUEUE_SLOT) {
+            break;
+        }
+
+        ns_slots_in_flight |= (1UL << ns_slot_idx);
+
+        if (mailbox_handle_slot(idx, ns_slot_idx, &reply_slots) ==
+            MAILBOX_SUCCESS) {
+            msg_dispatched++;
+        } else {
+            ns_slots_in_flight &= ~(1UL << ns_slot_idx);
+        }
+    }
+
+    /* Release the consumed entries to NSPE once they have been read */
+    __DMB();
+    req->tail = tail;
+    MAILBOX_CLEAN_CACHE(&req->tail, sizeof(req->tail));
+
+    /* A single notification covers all the replies of the batch */
+    if (reply_slots) {
+        mailbox_ring_publish_replies();
+        tfm_mailbox_hal_notify_peer();
+    }
+
+    return msg_dispatched;
+}
+#else /* MAILBOX_RING_PROTOCOL */
 int32_t tfm_mailbox_handle_msg(void)
 {
     uint8_t idx;
     mailbox_queue_status_t mask_bits, pend_slots, reply_slots = 0;
     struct mailbox_status_t *ns_status = spe_mailbox_queue.ns_status;
-    struct mailbox_msg_t *msg_ptr;
     uint32_t critical_section;
-    int32_t status;
     int32_t msg_dispatched = 0;
 
     assert(ns_status != NULL);
@@ -383,22 +530,8 @@ int32_t tfm_mailbox_handle_msg(void)
          * A more general implementation should dynamically search and
          * select an empty SPE mailbox queue slot.
          */
-        clear_spe_queue_empty_status(idx);
-        spe_mailbox_queue.queue[idx].ns_slot_idx = idx;
-
-        msg_ptr = &spe_mailbox_queue.queue[idx].msg;
-        MAILBOX_INVALIDATE_CACHE(&spe_mailbox_queue.ns_slots[idx].msg, sizeof(*msg_ptr));
-        spm_memcpy(msg_ptr, &spe_mailbox_queue.ns_slots[idx].msg, sizeof(*msg_ptr));
-
-        get_spe_mailbox_msg_handle(idx,
-                                   &spe_mailbox_queue.queue[idx].msg_handle);
-
-        status = tfm_mailbox_dispatch(msg_ptr, idx, &reply_slots);
-        if (status == MAILBOX_SUCCESS) {
+        if (mailbox_handle_slot(idx, idx, &reply_slots) == MAILBOX_SUCCESS) {
             msg_dispatched++;
-        } else {
-            mailbox_clean_queue_slot(idx);
-            continue;
         }
     }
 
@@ -418,15 +551,18 @@ int32_t tfm_mailbox_handle_msg(void)
 
     return (int32_t)msg_dispatched;
 }
+#endif /* MAILBOX_RING_PROTOCOL */
 
 int32_t tfm_mailbox_reply_msg(mailbox_msg_handle_t handle, int32_t reply)
 {
     uint8_t idx;
     int32_t ret;
+#if !MAILBOX_RING_PROTOCOL
     uint32_t critical_section;
     struct mailbox_status_t *ns_status = spe_mailbox_queue.ns_status;
 
     assert(ns_status != NULL);
+#endif
 
     /*
      * If handle == MAILBOX_MSG_NULL_HANDLE, reply to the mailbox message
@@ -449,12 +585,16 @@ int32_t tfm_mailbox_reply_msg(mailbox_msg_handle_t handle, int32_t reply)
 
     mailbox_direct_reply(idx, (uint32_t)reply);
 
+#if MAILBOX_RING_PROTOCOL
+    mailbox_ring_publish_replies();
+#else
     critical_section = tfm_mailbox_hal_enter_critical();
 
     /* Set the NSPE mailbox replied status */
     set_nspe_queue_replied_status(ns_status, (1 << idx));
 
     tfm_mailbox_hal_exit_critical(critical_section);
+#endif
 
     tfm_mailbox_hal_notify_peer();
 
@@ -530,6 +670,19 @@ static int32_t tfm_mailbox_init(void)
         return ret;
     }
 
+#if MAILBOX_RING_PROTOCOL
+    if (spe_mailbox_queue.ns_rings == NULL) {
+        tfm_rpc_unregister_ops();
+
+        return MAILBOX_INIT_ERROR;
+    }
+
+    MAILBOX_INVALIDATE_CACHE(&spe_mailbox_queue.ns_rings->comp.head,
+                             sizeof(spe_mailbox_queue.ns_rings->comp.head));
+    comp_ring_head = spe_mailbox_queue.ns_rings->comp.head;
+    ns_slots_in_flight = 0;
+#endif
+
     return MAILBOX_SUCCESS;
 }
 
@@ -0,0 +1,35 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __CMSIS_COMPILER_H
+#define __CMSIS_COMPILER_H
+
+#include <stdint.h>
+
+/* Host stand-in for the CMSIS compiler helpers used by the mailbox */
+
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE     static inline
+#endif
+
+#ifndef __ALIGNED
+#define __ALIGNED(x)        __attribute__((aligned(x)))
+#endif
+
+#ifndef __NO_RETURN
+#define __NO_RETURN         __attribute__((__noreturn__))
+#endif
+
+#ifndef __PACKED_STRUCT
+#define __PACKED_STRUCT     struct __attribute__((packed))
+#endif
+
+/* SPE and NSPE run as host threads, so the barriers must order between CPUs */
+#define __DMB()             __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __DSB()             __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#endif /* __CMSIS_COMPILER_H */
@@ -0,0 +1,16 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __PSA_FRAMEWORK_FEATURE_H__
+#define __PSA_FRAMEWORK_FEATURE_H__
+
+/* Host stand-in for the generated framework feature header */
+
+#define PSA_FRAMEWORK_ISOLATION_LEVEL  1
+#define PSA_FRAMEWORK_HAS_MM_IOVEC     0
+
+#endif /* __PSA_FRAMEWORK_FEATURE_H__ */
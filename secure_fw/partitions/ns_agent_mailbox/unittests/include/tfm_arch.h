@@ -0,0 +1,16 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_ARCH_H__
+#define __TFM_ARCH_H__
+
+/* Host stand-in: the mailbox does not use any architecture operation */
+
+#include <stdint.h>
+#include "cmsis_compiler.h"
+
+#endif /* __TFM_ARCH_H__ */
@@ -0,0 +1,22 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef _TFM_MAILBOX_CONFIG_
+#define _TFM_MAILBOX_CONFIG_
+
+/* Host stand-in for the header generated from tfm_mailbox_config.h.in */
+
+#ifndef NUM_MAILBOX_QUEUE_SLOT
+#define NUM_MAILBOX_QUEUE_SLOT              8
+#endif
+
+/* Selected by each unit, for the SPE and NSPE code under test alike */
+#ifndef MAILBOX_RING_PROTOCOL
+#define MAILBOX_RING_PROTOCOL               0
+#endif
+
+#endif /* _TFM_MAILBOX_CONFIG_ */
@@ -0,0 +1,43 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_RPC_H__
+#define __TFM_RPC_H__
+
+/*
+ * Host stand-in for the SPM RPC interface used by the mailbox. It declares
+ * the same operations without pulling in the SPM headers. The test suite
+ * implements them.
+ */
+
+#include <stdint.h>
+#include "psa/client.h"
+#include "psa/service.h"
+#include "ffm/mailbox_agent_api.h"
+
+#define TFM_RPC_SUCCESS             (0)
+
+struct tfm_rpc_ops_t {
+    void (*handle_req)(void);
+    void (*reply)(const void *owner, int32_t ret);
+    void (*handle_req_irq_src)(uint32_t irq_src);
+    int32_t (*process_new_msg)(uint32_t *nr_msg);
+};
+
+uint32_t tfm_rpc_psa_framework_version(void);
+
+uint32_t tfm_rpc_psa_version(uint32_t sid);
+
+psa_status_t tfm_rpc_psa_call(psa_handle_t handle, uint32_t control,
+                              const struct client_params_t *params,
+                              const void *client_data_stateless);
+
+int32_t tfm_rpc_register_ops(const struct tfm_rpc_ops_t *ops_ptr);
+
+void tfm_rpc_unregister_ops(void);
+
+#endif /* __TFM_RPC_H__ */
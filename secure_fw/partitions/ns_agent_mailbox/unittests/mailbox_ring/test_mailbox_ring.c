@@ -0,0 +1,416 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "unity.h"
+
+#include "internal_status_code.h"
+#include "tfm_multi_core.h"
+#include "tfm_ns_mailbox.h"
+#include "tfm_rpc.h"
+#include "tfm_spe_mailbox.h"
+
+/*
+ * SPE and NSPE mailbox instances are built into one host executable. Each
+ * side runs in its own thread and the doorbells between the cores are
+ * semaphores, so the shared queue is accessed concurrently as on a real
+ * multi-core platform.
+ */
+
+#define CLIENT_THREADS              2
+#define CALLS_PER_THREAD            20000
+
+int32_t tfm_inter_core_comm_init(void);
+
+/* Cross-core lock and doorbells */
+static atomic_flag xcore_lock = ATOMIC_FLAG_INIT;
+static sem_t s_doorbell, ns_doorbell;
+static atomic_long nr_xcore_lock, nr_s_notify;
+
+/* Handshake of the platform HALs */
+#if MAILBOX_RING_PROTOCOL
+static struct mailbox_init_v2_t ns_init;
+#else
+static struct mailbox_init_t ns_init;
+#endif
+static bool ns_init_sent;
+
+static struct ns_mailbox_queue_t ns_queue;
+
+/* Last message handle passed to SPM by a PSA client call */
+static const void *last_rpc_handle;
+static int nr_rpc_call;
+
+static uint32_t xcore_lock_acquire(void)
+{
+    while (atomic_flag_test_and_set(&xcore_lock)) {
+    }
+    nr_xcore_lock++;
+
+    return 0;
+}
+
+static void xcore_lock_release(void)
+{
+    atomic_flag_clear(&xcore_lock);
+}
+
+/* SPE side stubs */
+void psa_panic(void)
+{
+    TEST_FAIL_MESSAGE("psa_panic()");
+    abort();
+}
+
+uint32_t tfm_rpc_psa_framework_version(void)
+{
+    return 0x0101;
+}
+
+uint32_t tfm_rpc_psa_version(uint32_t sid)
+{
+    /* Echo a value derived from the request, so each reply can be checked */
+    return sid + 1;
+}
+
+psa_status_t tfm_rpc_psa_call(psa_handle_t handle, uint32_t control,
+                              const struct client_params_t *params,
+                              const void *client_data_stateless)
+{
+    /* Leave the call in flight, replied later by tfm_mailbox_reply_msg() */
+    last_rpc_handle = client_data_stateless;
+    nr_rpc_call++;
+
+    return PSA_SUCCESS;
+}
+
+int32_t tfm_rpc_register_ops(const struct tfm_rpc_ops_t *ops_ptr)
+{
+    return TFM_RPC_SUCCESS;
+}
+
+void tfm_rpc_unregister_ops(void)
+{
+}
+
+int32_t tfm_multi_core_hal_client_id_translate(void *owner,
+                                               int32_t client_id_in,
+                                               int32_t *client_id_out)
+{
+    *client_id_out = client_id_in;
+
+    return SPM_SUCCESS;
+}
+
+int32_t tfm_mailbox_hal_init(struct secure_mailbox_queue_t *s_queue)
+{
+    /* Same as the platform HALs, once the NSPE address has been received */
+    if (!ns_init_sent || (ns_init.slot_count > NUM_MAILBOX_QUEUE_SLOT)) {
+        return MAILBOX_INIT_ERROR;
+    }
+
+#if MAILBOX_RING_PROTOCOL
+    s_queue->ns_rings = ns_init.rings;
+#else
+    s_queue->ns_status = ns_init.status;
+#endif
+    s_queue->ns_slot_count = ns_init.slot_count;
+    s_queue->ns_slots = ns_init.slots;
+
+    return MAILBOX_SUCCESS;
+}
+
+int32_t tfm_mailbox_hal_notify_peer(void)
+{
+    nr_s_notify++;
+    sem_post(&ns_doorbell);
+
+    return MAILBOX_SUCCESS;
+}
+
+uint32_t tfm_mailbox_hal_enter_critical(void)
+{
+    return xcore_lock_acquire();
+}
+
+void tfm_mailbox_hal_exit_critical(uint32_t state)
+{
+    xcore_lock_release();
+}
+
+/* NSPE side stubs */
+struct ns_task_t {
+    sem_t reply;
+};
+
+static __thread struct ns_task_t *current_task;
+static sem_t ns_slots_sem;
+static pthread_spinlock_t ns_spinlock;
+
+int32_t tfm_ns_mailbox_os_lock_init(void)
+{
+    sem_init(&ns_slots_sem, 0, NUM_MAILBOX_QUEUE_SLOT);
+    pthread_spin_init(&ns_spinlock, PTHREAD_PROCESS_PRIVATE);
+
+    return MAILBOX_SUCCESS;
+}
+
+int32_t tfm_ns_mailbox_os_lock_acquire(void)
+{
+    sem_wait(&ns_slots_sem);
+
+    return MAILBOX_SUCCESS;
+}
+
+int32_t tfm_ns_mailbox_os_lock_release(void)
+{
+    sem_post(&ns_slots_sem);
+
+    return MAILBOX_SUCCESS;
+}
+
+const void *tfm_ns_mailbox_os_get_task_handle(void)
+{
+    return current_task;
+}
+
+void tfm_ns_mailbox_os_wait_reply(void)
+{
+    sem_wait(&current_task->reply);
+}
+
+void tfm_ns_mailbox_os_wake_task_isr(const void *task_handle)
+{
+    sem_post(&((struct ns_task_t *)task_handle)->reply);
+}
+
+void tfm_ns_mailbox_os_spin_lock(void)
+{
+    pthread_spin_lock(&ns_spinlock);
+}
+
+void tfm_ns_mailbox_os_spin_unlock(void)
+{
+    pthread_spin_unlock(&ns_spinlock);
+}
+
+int32_t tfm_ns_mailbox_hal_init(struct ns_mailbox_queue_t *queue)
+{
+#if MAILBOX_RING_PROTOCOL
+    ns_init.rings = &queue->rings;
+#else
+    ns_init.status = &queue->status;
+#endif
+    ns_init.slot_count = NUM_MAILBOX_QUEUE_SLOT;
+    ns_init.slots = &queue->slots[0];
+    ns_init_sent = true;
+
+    return MAILBOX_SUCCESS;
+}
+
+int32_t tfm_ns_mailbox_hal_notify_peer(void)
+{
+    sem_post(&s_doorbell);
+
+    return MAILBOX_SUCCESS;
+}
+
+uint32_t tfm_ns_mailbox_hal_enter_critical(void)
+{
+    return xcore_lock_acquire();
+}
+
+void tfm_ns_mailbox_hal_exit_critical(uint32_t state)
+{
+    xcore_lock_release();
+}
+
+uint32_t tfm_ns_mailbox_hal_enter_critical_isr(void)
+{
+    return xcore_lock_acquire();
+}
+
+void tfm_ns_mailbox_hal_exit_critical_isr(uint32_t state)
+{
+    xcore_lock_release();
+}
+
+/* Threads standing for the SPE core, the NSPE reply ISR and NS clients */
+static atomic_bool threads_stop;
+static atomic_long reply_errors;
+
+static void *spe_core_thread(void *arg)
+{
+    while (!threads_stop) {
+        sem_wait(&s_doorbell);
+        while (tfm_mailbox_handle_msg() > 0) {
+        }
+    }
+
+    return NULL;
+}
+
+static void *ns_reply_isr_thread(void *arg)
+{
+    while (!threads_stop) {
+        sem_wait(&ns_doorbell);
+        tfm_ns_mailbox_wake_reply_owner_isr();
+    }
+
+    return NULL;
+}
+
+static void *ns_client_thread(void *arg)
+{
+    struct ns_task_t task;
+    struct psa_client_params_t params = {0};
+    struct mailbox_reply_t reply;
+    uint32_t base = (uint32_t)(uintptr_t)arg * CALLS_PER_THREAD;
+
+    sem_init(&task.reply, 0, 0);
+    current_task = &task;
+
+    for (uint32_t i = 0; i < CALLS_PER_THREAD; i++) {
+        params.psa_version_params.sid = base + i;
+        if ((tfm_ns_mailbox_client_call(MAILBOX_PSA_VERSION, &params, 0,
+                                        &reply) != MAILBOX_SUCCESS) ||
+            (reply.return_val != (int32_t)(base + i + 1))) {
+            reply_errors++;
+        }
+    }
+
+    current_task = NULL;
+    sem_destroy(&task.reply);
+
+    return NULL;
+}
+
+void setUp(void)
+{
+    sem_init(&s_doorbell, 0, 0);
+    sem_init(&ns_doorbell, 0, 0);
+    nr_xcore_lock = 0;
+    nr_s_notify = 0;
+    ns_init_sent = false;
+    last_rpc_handle = NULL;
+    nr_rpc_call = 0;
+
+    TEST_ASSERT_EQUAL(MAILBOX_SUCCESS, tfm_ns_mailbox_init(&ns_queue));
+    TEST_ASSERT_EQUAL(MAILBOX_SUCCESS, tfm_inter_core_comm_init());
+}
+
+void tearDown(void)
+{
+    sem_destroy(&s_doorbell);
+    sem_destroy(&ns_doorbell);
+}
+
+void test_mailbox_init_passes_ns_queue(void)
+{
+    struct psa_client_params_t params = {0};
+
+    /* The SPE side reaches the NSPE queue through what the HAL passed */
+    params.psa_version_params.sid = 41;
+    ns_queue.slots[3].msg.call_type = MAILBOX_PSA_VERSION;
+    ns_queue.slots[3].msg.params = params;
+#if MAILBOX_RING_PROTOCOL
+    ns_queue.rings.req.entries[0] = 3;
+    ns_queue.rings.req.head = 1;
+#else
+    ns_queue.status.pend_slots = (1UL << 3);
+#endif
+
+    TEST_ASSERT_EQUAL(1, tfm_mailbox_handle_msg());
+    TEST_ASSERT_EQUAL(42, ns_queue.slots[3].reply.return_val);
+#if MAILBOX_RING_PROTOCOL
+    TEST_ASSERT_EQUAL(1, ns_queue.rings.req.tail);
+    TEST_ASSERT_EQUAL(1, ns_queue.rings.comp.head);
+    TEST_ASSERT_EQUAL(3, ns_queue.rings.comp.entries[0]);
+#else
+    TEST_ASSERT_EQUAL(0, ns_queue.status.pend_slots);
+    TEST_ASSERT_EQUAL((1UL << 3), ns_queue.status.replied_slots);
+#endif
+}
+
+void test_mailbox_ring_rejects_slot_in_flight(void)
+{
+#if MAILBOX_RING_PROTOCOL
+    const mailbox_msg_handle_t *handle;
+
+    ns_queue.slots[2].msg.call_type = MAILBOX_PSA_CALL;
+    ns_queue.rings.req.entries[0] = 2;
+    ns_queue.rings.req.head = 1;
+
+    TEST_ASSERT_EQUAL(1, tfm_mailbox_handle_msg());
+    TEST_ASSERT_EQUAL(1, nr_rpc_call);
+    handle = last_rpc_handle;
+    TEST_ASSERT_NOT_NULL(handle);
+
+    /* The same slot is submitted again before it is replied */
+    ns_queue.rings.req.entries[1] = 2;
+    ns_queue.rings.req.head = 2;
+
+    TEST_ASSERT_EQUAL(0, tfm_mailbox_handle_msg());
+    TEST_ASSERT_EQUAL(1, nr_rpc_call);
+    TEST_ASSERT_EQUAL(2, ns_queue.rings.req.tail);
+
+    /* The ongoing call is replied only once */
+    TEST_ASSERT_EQUAL(MAILBOX_SUCCESS,
+                      tfm_mailbox_reply_msg(*handle, PSA_SUCCESS));
+    TEST_ASSERT_EQUAL(1, ns_queue.rings.comp.head);
+    TEST_ASSERT_EQUAL(2, ns_queue.rings.comp.entries[0]);
+    TEST_ASSERT_EQUAL(MAILBOX_NO_PEND_EVENT,
+                      tfm_mailbox_reply_msg(*handle, PSA_SUCCESS));
+
+    /* Once replied, the slot can be submitted again */
+    ns_queue.rings.req.entries[2] = 2;
+    ns_queue.rings.req.head = 3;
+
+    TEST_ASSERT_EQUAL(1, tfm_mailbox_handle_msg());
+    TEST_ASSERT_EQUAL(2, nr_rpc_call);
+#else
+    TEST_IGNORE_MESSAGE("MAILBOX_RING_PROTOCOL not enabled");
+#endif
+}
+
+void test_mailbox_concurrent_calls_should_allBeReplied(void)
+{
+    pthread_t spe, isr, clients[CLIENT_THREADS];
+    long nr_calls = CLIENT_THREADS * CALLS_PER_THREAD;
+
+    threads_stop = false;
+    reply_errors = 0;
+
+    pthread_create(&spe, NULL, spe_core_thread, NULL);
+    pthread_create(&isr, NULL, ns_reply_isr_thread, NULL);
+
+    for (uintptr_t i = 0; i < CLIENT_THREADS; i++) {
+        pthread_create(&clients[i], NULL, ns_client_thread, (void *)i);
+    }
+    for (int i = 0; i < CLIENT_THREADS; i++) {
+        pthread_join(clients[i], NULL);
+    }
+
+    threads_stop = true;
+    sem_post(&s_doorbell);
+    sem_post(&ns_doorbell);
+    pthread_join(spe, NULL);
+    pthread_join(isr, NULL);
+
+    TEST_ASSERT_EQUAL(0, reply_errors);
+
+    /* Replies which are found together share a notification */
+    TEST_ASSERT_LESS_OR_EQUAL(nr_calls, nr_s_notify);
+#if MAILBOX_RING_PROTOCOL
+    /* Each ring has a single producer and a single consumer */
+    TEST_ASSERT_EQUAL(0, nr_xcore_lock);
+#endif
+}
@@ -0,0 +1,40 @@
+#-------------------------------------------------------------------------------
+# SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+#-------------------------------------------------------------------------------
+
+# Define what is being unit tested and by what
+set(UNIT_UNDER_TEST
+    ${TFM_ROOT_DIR}/secure_fw/partitions/ns_agent_mailbox/tfm_spe_mailbox.c
+    ${TFM_ROOT_DIR}/interface/src/multi_core/tfm_ns_mailbox.c
+    ${TFM_ROOT_DIR}/interface/src/multi_core/tfm_ns_mailbox_common.c
+)
+# The suite is shared with mailbox_ring, which tests the ring protocol
+set(UNIT_TEST_SUITE ${CMAKE_CURRENT_LIST_DIR}/../mailbox_ring/test_mailbox_ring.c)
+
+# Dependencies for the UUT, that get linked into the executable
+list(APPEND UNIT_TEST_LINK_LIBS pthread)
+
+# Include directories for compilation
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/partitions/ns_agent_mailbox/unittests/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/partitions/ns_agent_mailbox)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/spm/core)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/spm/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/interface/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/interface/include/multi_core)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/platform/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/config)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/tfm_log/inc)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/tfm_vprintf/inc)
+
+# Headers to be mocked
+
+# Compile-time definitions
+list(APPEND UNIT_TEST_COMPILE_DEFS LOG_LEVEL=LOG_LEVEL_NONE)
+list(APPEND UNIT_TEST_COMPILE_DEFS TFM_MULTI_CORE_NS_OS)
+list(APPEND UNIT_TEST_COMPILE_DEFS MAILBOX_IS_UNCACHED_S=1)
+list(APPEND UNIT_TEST_COMPILE_DEFS MAILBOX_IS_UNCACHED_NS=1)
+list(APPEND UNIT_TEST_COMPILE_DEFS MAILBOX_RING_PROTOCOL=0)
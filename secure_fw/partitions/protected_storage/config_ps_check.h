@@ -32,4 +32,8 @@
 #error "Invalid config: ITS_VALIDATE_METADATA_FROM_FLASH shall be enabled when PS_VALIDATE_METADATA_FROM_FLASH is enabled"
 #endif
 
+#if PS_AEAD_CHUNKED && (PS_AES_KEY_USAGE_LIMIT != 0)
+#error "Invalid config: PS_AES_KEY_USAGE_LIMIT shall be 0 when PS_AEAD_CHUNKED is enabled"
+#endif
+
 #endif /* __CONFIG_PARTITION_PS_H__ */
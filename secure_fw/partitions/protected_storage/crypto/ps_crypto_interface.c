@@ -135,6 +135,130 @@ err_release_op:
     return PSA_ERROR_GENERIC_ERROR;
 }
 
+#if PS_CRYPTO_KEY_CACHE_SIZE > 0
+/* A derived storage key kept alive between crypto operations */
+struct ps_key_cache_entry_t {
+    uint8_t label[LABEL_LEN]; /* Label the key was derived from */
+    psa_key_id_t key;         /* Derived key, PSA_KEY_ID_NULL if unused */
+    uint32_t last_use;        /* Value of the use counter at the last hit */
+};
+
+static struct ps_key_cache_entry_t ps_key_cache[PS_CRYPTO_KEY_CACHE_SIZE];
+static uint32_t ps_key_cache_use_cnt;
+#endif /* PS_CRYPTO_KEY_CACHE_SIZE > 0 */
+
+/*
+ * \brief Gets the storage key derived from the given label.
+ *
+ * With the key cache enabled, a key derived earlier from the same label is
+ * reused. Otherwise the key is derived and the least recently used cached key
+ * is destroyed to make room for it.
+ */
+static psa_status_t ps_crypto_get_key(psa_key_id_t *ps_key,
+                                      const uint8_t *key_label)
+{
+#if PS_CRYPTO_KEY_CACHE_SIZE > 0
+    psa_status_t status;
+    struct ps_key_cache_entry_t *entry;
+    struct ps_key_cache_entry_t *victim = &ps_key_cache[0];
+    uint32_t i;
+
+    ps_key_cache_use_cnt++;
+
+    for (i = 0; i < PS_CRYPTO_KEY_CACHE_SIZE; i++) {
+        entry = &ps_key_cache[i];
+        if (entry->key == PSA_KEY_ID_NULL) {
+            victim = entry;
+            continue;
+        }
+
+        if (memcmp(entry->label, key_label, LABEL_LEN) == 0) {
+            entry->last_use = ps_key_cache_use_cnt;
+            *ps_key = entry->key;
+            return PSA_SUCCESS;
+        }
+
+        /* Unsigned difference keeps the LRU order across counter wraps */
+        if (victim->key != PSA_KEY_ID_NULL &&
+            (ps_key_cache_use_cnt - entry->last_use) >
+            (ps_key_cache_use_cnt - victim->last_use)) {
+            victim = entry;
+        }
+    }
+
+    /* Free the key slot first, so the cache never holds more keys than its
+     * size in the crypto service.
+     */
+    if (victim->key != PSA_KEY_ID_NULL) {
+        (void)psa_destroy_key(victim->key);
+        victim->key = PSA_KEY_ID_NULL;
+    }
+
+    status = ps_crypto_setkey(ps_key, key_label, LABEL_LEN);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    (void)memcpy(victim->label, key_label, LABEL_LEN);
+    victim->key = *ps_key;
+    victim->last_use = ps_key_cache_use_cnt;
+
+    return PSA_SUCCESS;
+#else
+    return ps_crypto_setkey(ps_key, key_label, LABEL_LEN);
+#endif
+}
+
+/*
+ * \brief Releases a key obtained with ps_crypto_get_key. The key is only
+ *        destroyed if it is not kept in the key cache.
+ */
+static psa_status_t ps_crypto_put_key(psa_key_id_t ps_key)
+{
+#if PS_CRYPTO_KEY_CACHE_SIZE > 0
+    (void)ps_key;
+    return PSA_SUCCESS;
+#else
+    return psa_destroy_key(ps_key);
+#endif
+}
+
+void ps_crypto_evict_key(const union ps_crypto_t *crypto)
+{
+#if PS_CRYPTO_KEY_CACHE_SIZE > 0
+    uint8_t label[LABEL_LEN];
+    uint32_t i;
+
+    fill_key_label(crypto, label);
+
+    for (i = 0; i < PS_CRYPTO_KEY_CACHE_SIZE; i++) {
+        if (ps_key_cache[i].key != PSA_KEY_ID_NULL &&
+            memcmp(ps_key_cache[i].label, label, LABEL_LEN) == 0) {
+            (void)psa_destroy_key(ps_key_cache[i].key);
+            ps_key_cache[i].key = PSA_KEY_ID_NULL;
+            (void)memset(ps_key_cache[i].label, 0, LABEL_LEN);
+        }
+    }
+#else
+    (void)crypto;
+#endif
+}
+
+void ps_crypto_flush_key_cache(void)
+{
+#if PS_CRYPTO_KEY_CACHE_SIZE > 0
+    uint32_t i;
+
+    for (i = 0; i < PS_CRYPTO_KEY_CACHE_SIZE; i++) {
+        if (ps_key_cache[i].key != PSA_KEY_ID_NULL) {
+            (void)psa_destroy_key(ps_key_cache[i].key);
+            ps_key_cache[i].key = PSA_KEY_ID_NULL;
+        }
+        (void)memset(ps_key_cache[i].label, 0, LABEL_LEN);
+    }
+#endif
+}
+
 psa_status_t ps_crypto_init(void)
 {
     /* For GCM and CCM it is essential that nonce doesn't get repeated. If there
@@ -234,7 +358,7 @@ psa_status_t ps_crypto_encrypt_and_tag(union ps_crypto_t *crypto,
 
     fill_key_label(crypto, label);
 
-    status = ps_crypto_setkey(&ps_key, label, sizeof(label));
+    status = ps_crypto_get_key(&ps_key, label);
     if (status != PSA_SUCCESS) {
         return status;
     }
@@ -245,7 +369,7 @@ psa_status_t ps_crypto_encrypt_and_tag(union ps_crypto_t *crypto,
                               in, in_len,
                               out, out_size, out_len);
     if (status != PSA_SUCCESS) {
-        (void)psa_destroy_key(ps_key);
+        (void)ps_crypto_put_key(ps_key);
         return PSA_ERROR_GENERIC_ERROR;
     }
 
@@ -253,8 +377,8 @@ psa_status_t ps_crypto_encrypt_and_tag(union ps_crypto_t *crypto,
     *out_len -= PS_TAG_LEN_BYTES;
     (void)memcpy(crypto->ref.tag, (out + *out_len), PS_TAG_LEN_BYTES);
 
-    /* Destroy the transient key */
-    status = psa_destroy_key(ps_key);
+    /* Release the storage key */
+    status = ps_crypto_put_key(ps_key);
     if (status != PSA_SUCCESS) {
         return PSA_ERROR_GENERIC_ERROR;
     }
@@ -281,7 +405,7 @@ psa_status_t ps_crypto_auth_and_decrypt(const union ps_crypto_t *crypto,
     (void)memcpy((in + in_len), crypto->ref.tag, PS_TAG_LEN_BYTES);
     in_len += PS_TAG_LEN_BYTES;
 
-    status = ps_crypto_setkey(&ps_key, label, sizeof(label));
+    status = ps_crypto_get_key(&ps_key, label);
     if (status != PSA_SUCCESS) {
         return status;
     }
@@ -292,12 +416,12 @@ psa_status_t ps_crypto_auth_and_decrypt(const union ps_crypto_t *crypto,
                               in, in_len,
                               out, out_size, out_len);
     if (status != PSA_SUCCESS) {
-        (void)psa_destroy_key(ps_key);
+        (void)ps_crypto_put_key(ps_key);
         return PSA_ERROR_INVALID_SIGNATURE;
     }
 
-    /* Destroy the transient key */
-    status = psa_destroy_key(ps_key);
+    /* Release the storage key */
+    status = ps_crypto_put_key(ps_key);
     if (status != PSA_SUCCESS) {
         return PSA_ERROR_GENERIC_ERROR;
     }
@@ -316,7 +440,7 @@ psa_status_t ps_crypto_generate_auth_tag(union ps_crypto_t *crypto,
 
     fill_key_label(crypto, label);
 
-    status = ps_crypto_setkey(&ps_key, label, sizeof(label));
+    status = ps_crypto_get_key(&ps_key, label);
     if (status != PSA_SUCCESS) {
         return status;
     }
@@ -327,12 +451,12 @@ psa_status_t ps_crypto_generate_auth_tag(union ps_crypto_t *crypto,
                               0, 0,
                               crypto->ref.tag, PS_TAG_LEN_BYTES, &out_len);
     if (status != PSA_SUCCESS || out_len != PS_TAG_LEN_BYTES) {
-        (void)psa_destroy_key(ps_key);
+        (void)ps_crypto_put_key(ps_key);
         return PSA_ERROR_GENERIC_ERROR;
     }
 
-    /* Destroy the transient key */
-    status = psa_destroy_key(ps_key);
+    /* Release the storage key */
+    status = ps_crypto_put_key(ps_key);
     if (status != PSA_SUCCESS) {
         return PSA_ERROR_GENERIC_ERROR;
     }
@@ -351,7 +475,7 @@ psa_status_t ps_crypto_authenticate(const union ps_crypto_t *crypto,
 
     fill_key_label(crypto, label);
 
-    status = ps_crypto_setkey(&ps_key, label, sizeof(label));
+    status = ps_crypto_get_key(&ps_key, label);
     if (status != PSA_SUCCESS) {
         return status;
     }
@@ -362,12 +486,12 @@ psa_status_t ps_crypto_authenticate(const union ps_crypto_t *crypto,
                               crypto->ref.tag, PS_TAG_LEN_BYTES,
                               0, 0, &out_len);
     if (status != PSA_SUCCESS || out_len != 0) {
-        (void)psa_destroy_key(ps_key);
+        (void)ps_crypto_put_key(ps_key);
         return PSA_ERROR_INVALID_SIGNATURE;
     }
 
-    /* Destroy the transient key */
-    status = psa_destroy_key(ps_key);
+    /* Release the storage key */
+    status = ps_crypto_put_key(ps_key);
     if (status != PSA_SUCCESS) {
         return PSA_ERROR_GENERIC_ERROR;
     }
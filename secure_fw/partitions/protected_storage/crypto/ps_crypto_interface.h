@@ -142,6 +142,26 @@ void ps_crypto_set_iv(const union ps_crypto_t *crypto);
  */
 psa_status_t ps_crypto_get_iv(union ps_crypto_t *crypto);
 
+/**
+ * \brief Destroys the cached storage key of the given crypto union, if any.
+ *
+ * Must be called before the key label of the crypto union changes for good,
+ * e.g. before a key generation switch. Does nothing if the key cache is
+ * disabled.
+ *
+ * \param[in] crypto  Pointer to the crypto union
+ */
+void ps_crypto_evict_key(const union ps_crypto_t *crypto);
+
+/**
+ * \brief Destroys all the storage keys kept in the key cache.
+ *
+ * Must be called whenever the keys derived so far are no longer to be used,
+ * e.g. after a key generation switch or when the storage is wiped. Does
+ * nothing if the key cache is disabled.
+ */
+void ps_crypto_flush_key_cache(void);
+
 #ifdef PS_SUPPORT_FORMAT_TRANSITION
 /**
  * \brief Authenticate old format data against the tag.
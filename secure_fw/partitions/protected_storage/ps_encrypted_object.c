@@ -43,6 +43,350 @@ __PACKED_STRUCT auth_data_t {
 #endif
 };
 
+#if PS_AEAD_CHUNKED
+/* Size (in bytes) of the stored object header, which is the IV followed by the
+ * encrypted object information, including any padding
+ */
+#define PS_CHUNKED_HEADER_SIZE (offsetof(struct ps_object_t, data) \
+                                - offsetof(struct ps_object_t, header.crypto.ref.iv))
+
+/* Offset (in bytes) of a data chunk in the stored object */
+#define PS_CHUNK_OFFSET(chunk) (PS_CHUNKED_HEADER_SIZE + \
+                                ((chunk) * PS_AEAD_CHUNK_SIZE))
+
+/* Offset (in bytes) of a chunk metadata in the stored object, which follows
+ * the data of the object
+ */
+#define PS_CHUNK_META_OFFSET(cur_size, chunk) \
+    (PS_CHUNKED_HEADER_SIZE + (cur_size) + \
+     ((chunk) * sizeof(struct ps_aead_chunk_meta_t)))
+
+__PACKED_STRUCT chunk_auth_data_t {
+    uint32_t fid;
+    uint32_t chunk;
+    uint8_t header_tag[PS_TAG_LEN_BYTES];
+};
+
+/* Window used to encrypt and decrypt one chunk, followed by its tag */
+static uint8_t ps_chunk_buf[PS_AEAD_CHUNK_SIZE + PS_TAG_LEN_BYTES];
+
+/**
+ * \brief Gets the size of a data chunk of an object.
+ *
+ * \param[in] cur_size  Size of the object data
+ * \param[in] chunk     Chunk index
+ *
+ * \return Returns the size of the chunk in bytes
+ */
+static uint32_t ps_chunk_size(uint32_t cur_size, uint32_t chunk)
+{
+    return PS_UTILS_MIN(PS_AEAD_CHUNK_SIZE, cur_size - (chunk * PS_AEAD_CHUNK_SIZE));
+}
+
+/**
+ * \brief Fills the crypto metadata of a chunk. The chunk uses the key of the
+ *        object and is bound to the object header through the associated
+ *        data.
+ *
+ * \param[in]  fid         File ID
+ * \param[in]  chunk       Chunk index
+ * \param[in]  obj         Pointer to the object
+ * \param[out] crypto      Pointer to the chunk crypto metadata to fill
+ * \param[out] auth_data   Pointer to the chunk associated data to fill
+ */
+static void ps_chunk_crypto_init(uint32_t fid, uint32_t chunk,
+                                 const struct ps_object_t *obj,
+                                 union ps_crypto_t *crypto,
+                                 struct chunk_auth_data_t *auth_data)
+{
+    (void)memset(crypto, 0, sizeof(*crypto));
+    crypto->ref.uid = obj->header.crypto.ref.uid;
+    crypto->ref.client_id = obj->header.crypto.ref.client_id;
+
+    auth_data->fid = fid;
+    auth_data->chunk = chunk;
+    (void)memcpy(auth_data->header_tag, obj->header.crypto.ref.tag,
+                 PS_TAG_LEN_BYTES);
+}
+
+psa_status_t ps_encrypted_object_read_header(uint32_t fid,
+                                             struct ps_object_t *obj,
+                                             uint32_t *p_blocks)
+{
+    psa_status_t err;
+    size_t data_length;
+    size_t out_len;
+    const struct auth_data_t auth_data = {
+        .fid = fid,
+    };
+    uint8_t *p_info = (uint8_t *)&obj->header.info;
+
+    /* Read the IV and the encrypted object information */
+    err = psa_its_get(fid, PS_OBJECT_START_POSITION, PS_CHUNKED_HEADER_SIZE,
+                      (void *)obj->header.crypto.ref.iv, &data_length);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    if (data_length != PS_CHUNKED_HEADER_SIZE) {
+        return PSA_ERROR_DATA_CORRUPT;
+    }
+
+    *p_blocks = ps_crypto_to_blocks(sizeof(struct ps_object_info_t));
+
+    /* The tag of the header is the one stored in the object table */
+    err = ps_crypto_auth_and_decrypt(&obj->header.crypto,
+                                     (const uint8_t *)&auth_data,
+                                     sizeof(auth_data),
+                                     p_info,
+                                     sizeof(struct ps_object_info_t),
+                                     p_info,
+                                     sizeof(*obj) - offsetof(struct ps_object_t, header.info),
+                                     &out_len);
+    if (err != PSA_SUCCESS || out_len != sizeof(struct ps_object_info_t)) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    if (obj->header.info.current_size > PS_MAX_OBJECT_DATA_SIZE) {
+        return PSA_ERROR_DATA_CORRUPT;
+    }
+
+    return PSA_SUCCESS;
+}
+
+/**
+ * \brief Authenticates and decrypts a data chunk of an object.
+ *
+ * \param[in]     fid      File ID
+ * \param[in]     chunk    Chunk index
+ * \param[in]     obj      Pointer to the object, with a decrypted header
+ * \param[in]     meta     Pointer to the chunk metadata
+ * \param[in]     in       Pointer to the encrypted chunk
+ * \param[out]    out      Pointer to the buffer to fill in with the decrypted
+ *                         chunk. It can be the same as in.
+ * \param[in,out] p_blocks Pointer to a counter of decryption blocks used.
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t ps_chunk_auth_decrypt(uint32_t fid, uint32_t chunk,
+                                          const struct ps_object_t *obj,
+                                          const struct ps_aead_chunk_meta_t *meta,
+                                          uint8_t *in, uint8_t *out,
+                                          uint32_t *p_blocks)
+{
+    psa_status_t err;
+    size_t out_len;
+    union ps_crypto_t crypto;
+    struct chunk_auth_data_t auth_data;
+    uint32_t chunk_size = ps_chunk_size(obj->header.info.current_size, chunk);
+
+    ps_chunk_crypto_init(fid, chunk, obj, &crypto, &auth_data);
+    (void)memcpy(crypto.ref.iv, meta->iv, PS_IV_LEN_BYTES);
+    (void)memcpy(crypto.ref.tag, meta->tag, PS_TAG_LEN_BYTES);
+
+    /* Assume that we used the key even if the crypto operation fails */
+    *p_blocks += ps_crypto_to_blocks(chunk_size);
+
+    err = ps_crypto_auth_and_decrypt(&crypto,
+                                     (const uint8_t *)&auth_data,
+                                     sizeof(auth_data),
+                                     in,
+                                     chunk_size,
+                                     out,
+                                     chunk_size,
+                                     &out_len);
+    if (err != PSA_SUCCESS || out_len != chunk_size) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t ps_encrypted_object_read_chunk(uint32_t fid,
+                                            const struct ps_object_t *obj,
+                                            uint32_t chunk,
+                                            uint8_t *buf,
+                                            uint32_t *p_blocks)
+{
+    psa_status_t err;
+    size_t data_length;
+    struct ps_aead_chunk_meta_t meta;
+    uint32_t cur_size = obj->header.info.current_size;
+    uint32_t chunk_size;
+
+    if (chunk >= PS_AEAD_NUM_CHUNKS(cur_size)) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    chunk_size = ps_chunk_size(cur_size, chunk);
+
+    err = psa_its_get(fid, PS_CHUNK_META_OFFSET(cur_size, chunk), sizeof(meta),
+                      (void *)&meta, &data_length);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    if (data_length != sizeof(meta)) {
+        return PSA_ERROR_DATA_CORRUPT;
+    }
+
+    err = psa_its_get(fid, PS_CHUNK_OFFSET(chunk), chunk_size,
+                      (void *)ps_chunk_buf, &data_length);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    if (data_length != chunk_size) {
+        return PSA_ERROR_DATA_CORRUPT;
+    }
+
+    return ps_chunk_auth_decrypt(fid, chunk, obj, &meta, ps_chunk_buf, buf,
+                                 p_blocks);
+}
+
+psa_status_t ps_encrypted_object_read(uint32_t fid,
+                                      struct ps_object_t *obj,
+                                      uint32_t *p_blocks)
+{
+    psa_status_t err;
+    size_t data_length;
+    uint32_t cur_size;
+    uint32_t num_chunks;
+    uint32_t chunk;
+    const struct ps_aead_chunk_meta_t *p_meta;
+
+    err = ps_encrypted_object_read_header(fid, obj, p_blocks);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    cur_size = obj->header.info.current_size;
+    num_chunks = PS_AEAD_NUM_CHUNKS(cur_size);
+    if (num_chunks == 0) {
+        return PSA_SUCCESS;
+    }
+
+    /* Read all the chunks and their metadata at once, then decrypt the
+     * chunks in place.
+     */
+    err = psa_its_get(fid, PS_CHUNK_OFFSET(0),
+                      PS_CHUNK_META_OFFSET(cur_size, num_chunks) - PS_CHUNK_OFFSET(0),
+                      (void *)obj->data, &data_length);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    if (data_length != PS_CHUNK_META_OFFSET(cur_size, num_chunks) - PS_CHUNK_OFFSET(0)) {
+        return PSA_ERROR_DATA_CORRUPT;
+    }
+
+    p_meta = (const struct ps_aead_chunk_meta_t *)(obj->data + cur_size);
+
+    for (chunk = 0; chunk < num_chunks; chunk++) {
+        err = ps_chunk_auth_decrypt(fid, chunk, obj, &p_meta[chunk],
+                                    obj->data + (chunk * PS_AEAD_CHUNK_SIZE),
+                                    obj->data + (chunk * PS_AEAD_CHUNK_SIZE),
+                                    p_blocks);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+    }
+
+    return PSA_SUCCESS;
+}
+
+uint32_t ps_encrypted_object_blocks(uint32_t size)
+{
+    uint32_t blocks = ps_crypto_to_blocks(sizeof(struct ps_object_info_t));
+    uint32_t chunk;
+
+    for (chunk = 0; chunk < PS_AEAD_NUM_CHUNKS(size); chunk++) {
+        blocks += ps_crypto_to_blocks(ps_chunk_size(size, chunk));
+    }
+
+    return blocks;
+}
+
+psa_status_t ps_encrypted_object_write(uint32_t fid, struct ps_object_t *obj)
+{
+    psa_status_t err;
+    size_t out_len;
+    union ps_crypto_t crypto;
+    struct chunk_auth_data_t auth_data;
+    struct ps_aead_chunk_meta_t *p_meta;
+    const struct auth_data_t header_auth_data = {
+        .fid = fid,
+    };
+    uint32_t cur_size = obj->header.info.current_size;
+    uint32_t chunk_size;
+    uint32_t chunk;
+    uint8_t *p_chunk;
+
+    /* Get a new IV for the header */
+    err = ps_crypto_get_iv(&obj->header.crypto);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    /* Encrypt the object information. The tag is stored in the object
+     * table.
+     */
+    err = ps_crypto_encrypt_and_tag(&obj->header.crypto,
+                                    (const uint8_t *)&header_auth_data,
+                                    sizeof(header_auth_data),
+                                    (const uint8_t *)&obj->header.info,
+                                    sizeof(struct ps_object_info_t),
+                                    ps_chunk_buf,
+                                    sizeof(ps_chunk_buf),
+                                    &out_len);
+    if (err != PSA_SUCCESS || out_len != sizeof(struct ps_object_info_t)) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    (void)memcpy(&obj->header.info, ps_chunk_buf, out_len);
+
+    /* Encrypt each chunk in place, with its metadata after the object data */
+    for (chunk = 0; chunk < PS_AEAD_NUM_CHUNKS(cur_size); chunk++) {
+        chunk_size = ps_chunk_size(cur_size, chunk);
+        p_chunk = obj->data + (chunk * PS_AEAD_CHUNK_SIZE);
+        p_meta = (struct ps_aead_chunk_meta_t *)(obj->data + cur_size +
+                              (chunk * sizeof(struct ps_aead_chunk_meta_t)));
+
+        ps_chunk_crypto_init(fid, chunk, obj, &crypto, &auth_data);
+
+        err = ps_crypto_get_iv(&crypto);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        err = ps_crypto_encrypt_and_tag(&crypto,
+                                        (const uint8_t *)&auth_data,
+                                        sizeof(auth_data),
+                                        p_chunk,
+                                        chunk_size,
+                                        ps_chunk_buf,
+                                        sizeof(ps_chunk_buf),
+                                        &out_len);
+        if (err != PSA_SUCCESS || out_len != chunk_size) {
+            return PSA_ERROR_GENERIC_ERROR;
+        }
+
+        (void)memcpy(p_chunk, ps_chunk_buf, chunk_size);
+        (void)memcpy(p_meta->iv, crypto.ref.iv, PS_IV_LEN_BYTES);
+        (void)memcpy(p_meta->tag, crypto.ref.tag, PS_TAG_LEN_BYTES);
+    }
+
+    /* Write the IV, the encrypted object and the chunks metadata to the
+     * persistent area. The tag of the header is not copied as it is stored
+     * in the object table.
+     */
+    return psa_its_set(fid, PS_CHUNK_META_OFFSET(cur_size,
+                                                 PS_AEAD_NUM_CHUNKS(cur_size)),
+                       (const void *)obj->header.crypto.ref.iv,
+                       PSA_STORAGE_FLAG_NONE);
+}
+#else /* PS_AEAD_CHUNKED */
+
 /**
  * \brief Performs authenticated decryption on object data, with the header as
  *        the associated data.
@@ -232,3 +576,12 @@ psa_status_t ps_encrypted_object_write(uint32_t fid, struct ps_object_t *obj)
     return psa_its_set(fid, wrt_size, (const void *)obj->header.crypto.ref.iv,
                        PSA_STORAGE_FLAG_NONE);
 }
+
+psa_status_t ps_encrypted_object_read_header(uint32_t fid,
+                                             struct ps_object_t *obj,
+                                             uint32_t *p_blocks)
+{
+    /* The object data and information share a single tag */
+    return ps_encrypted_object_read(fid, obj, p_blocks);
+}
+#endif /* PS_AEAD_CHUNKED */
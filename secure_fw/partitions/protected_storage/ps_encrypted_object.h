@@ -31,6 +31,44 @@ psa_status_t ps_encrypted_object_read(uint32_t fid,
                                       struct ps_object_t *obj,
                                       uint32_t *p_blocks);
 
+/**
+ * \brief Reads and authenticates only the header of the object referenced by
+ *        the object File ID. When PS_AEAD_CHUNKED is disabled, the object
+ *        data and header share a single tag, so the whole object is read.
+ *
+ * \param[in]  fid      File ID
+ * \param[out] obj      Pointer to the object structure to fill in
+ * \param[out] p_blocks Pointer to a counter of decryption blocks used.
+ *
+ * \return Returns error code specified in \ref psa_status_t
+ */
+psa_status_t ps_encrypted_object_read_header(uint32_t fid,
+                                             struct ps_object_t *obj,
+                                             uint32_t *p_blocks);
+
+#if PS_AEAD_CHUNKED
+/**
+ * \brief Reads, authenticates and decrypts a single data chunk of the object
+ *        referenced by the object File ID.
+ *
+ * \param[in]     fid      File ID
+ * \param[in]     obj      Pointer to the object structure, with a header
+ *                         read by \ref ps_encrypted_object_read_header
+ * \param[in]     chunk    Index of the chunk to read
+ * \param[out]    buf      Buffer of PS_AEAD_CHUNK_SIZE bytes to fill in with
+ *                         the decrypted chunk
+ * \param[in,out] p_blocks Pointer to a counter of decryption blocks used,
+ *                         incremented by the blocks used for the chunk.
+ *
+ * \return Returns error code specified in \ref psa_status_t
+ */
+psa_status_t ps_encrypted_object_read_chunk(uint32_t fid,
+                                            const struct ps_object_t *obj,
+                                            uint32_t chunk,
+                                            uint8_t *buf,
+                                            uint32_t *p_blocks);
+#endif /* PS_AEAD_CHUNKED */
+
 /**
  * \brief Creates and writes a new encrypted object based on the given
  *        ps_object_t structure data.
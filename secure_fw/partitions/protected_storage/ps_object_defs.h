@@ -48,7 +48,27 @@ struct ps_obj_header_t {
 
 #define PS_MAX_OBJECT_DATA_SIZE  PS_MAX_ASSET_SIZE
 
-#ifdef PS_ENCRYPTION
+#if defined(PS_ENCRYPTION) && PS_AEAD_CHUNKED
+/*!
+ * \struct ps_aead_chunk_meta_t
+ *
+ * \brief Nonce and tag of an object data chunk, stored after the encrypted
+ *        object data.
+ */
+struct ps_aead_chunk_meta_t {
+    uint8_t iv[PS_IV_LEN_BYTES];   /*!< IV value of the chunk */
+    uint8_t tag[PS_TAG_LEN_BYTES]; /*!< MAC value of the chunk */
+};
+
+/* Number of chunks needed to store the given number of data bytes */
+#define PS_AEAD_NUM_CHUNKS(size) \
+    (((size) + PS_AEAD_CHUNK_SIZE - 1) / PS_AEAD_CHUNK_SIZE)
+
+/* The object data is followed by the metadata of its chunks */
+#define PS_OBJECT_BUF_SIZE (PS_MAX_OBJECT_DATA_SIZE + PS_TAG_LEN_BYTES + \
+                            (PS_AEAD_NUM_CHUNKS(PS_MAX_OBJECT_DATA_SIZE) * \
+                             sizeof(struct ps_aead_chunk_meta_t)))
+#elif defined(PS_ENCRYPTION)
 #define PS_OBJECT_BUF_SIZE (PS_MAX_OBJECT_DATA_SIZE + PS_TAG_LEN_BYTES)
 #else
 #define PS_OBJECT_BUF_SIZE PS_MAX_OBJECT_DATA_SIZE
@@ -75,8 +95,13 @@ struct ps_object_t {
  *
  * \brief Specifies the maximum number of objects in the system, which is the
  *        number of defined assets, the object table and 2 temporary objects to
- *        store the temporary object table and temporary updated object.
+ *        store the temporary object table and temporary updated object. The
+ *        object table journal needs one more object.
  */
+#if PS_OBJ_TABLE_JOURNAL
+#define PS_MAX_NUM_OBJECTS (PS_NUM_ASSETS + 4)
+#else
 #define PS_MAX_NUM_OBJECTS (PS_NUM_ASSETS + 3)
+#endif
 
 #endif /* __PS_OBJECT_DEFS_H__ */
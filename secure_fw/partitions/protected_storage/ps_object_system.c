@@ -114,6 +114,8 @@ static void ps_switch_key(void)
         /* We've run out of keys */
         tfm_core_panic();
     }
+    /* The key of the previous generation is never used again */
+    ps_crypto_evict_key(&g_ps_object.header.crypto);
     g_ps_object.header.crypto.ref.key_gen_nr++;
     g_obj_tbl_info.num_blocks = 0;
 }
@@ -309,6 +311,12 @@ psa_status_t ps_object_read(psa_storage_uid_t uid, int32_t client_id,
     psa_status_t err;
 #ifdef PS_ENCRYPTION
     uint32_t num_blocks = 0;
+#if PS_AEAD_CHUNKED
+    uint32_t chunk;
+    uint32_t chunk_offset;
+    uint32_t chunk_len;
+    uint32_t copied;
+#endif
 #endif
 
     /* Retrieve the object information from the object table if the object
@@ -324,7 +332,12 @@ psa_status_t ps_object_read(psa_storage_uid_t uid, int32_t client_id,
     g_ps_object.header.crypto.ref.uid = uid;
     g_ps_object.header.crypto.ref.client_id = client_id;
 
+#if PS_AEAD_CHUNKED
+    err = ps_encrypted_object_read_header(g_obj_tbl_info.fid, &g_ps_object,
+                                          &num_blocks);
+#else
     err = ps_encrypted_object_read(g_obj_tbl_info.fid, &g_ps_object, &num_blocks);
+#endif
 #if PS_AES_KEY_USAGE_LIMIT != 0
     g_obj_tbl_info.num_blocks += num_blocks;
 #endif
@@ -345,8 +358,32 @@ psa_status_t ps_object_read(psa_storage_uid_t uid, int32_t client_id,
     size = PS_UTILS_MIN(size,
                         g_ps_object.header.info.current_size - offset);
 
+#if defined(PS_ENCRYPTION) && PS_AEAD_CHUNKED
+    /* Only authenticate and decrypt the chunks covering the requested range,
+     * using the object data buffer as a window of one chunk.
+     */
+    for (chunk = offset / PS_AEAD_CHUNK_SIZE, copied = 0; copied < size;
+         chunk++) {
+        err = ps_encrypted_object_read_chunk(g_obj_tbl_info.fid, &g_ps_object,
+                                             chunk, g_ps_object.data,
+                                             &num_blocks);
+        if (err != PSA_SUCCESS) {
+            goto switch_keys_and_return;
+        }
+
+        chunk_offset = (offset + copied) - (chunk * PS_AEAD_CHUNK_SIZE);
+        chunk_len = PS_UTILS_MIN(PS_AEAD_CHUNK_SIZE - chunk_offset,
+                                 size - copied);
+
+        /* Copy the decrypted chunk data to the output buffer */
+        ps_req_mngr_write_asset_data(g_ps_object.data + chunk_offset,
+                                     chunk_len);
+        copied += chunk_len;
+    }
+#else
     /* Copy the decrypted object data to the output buffer */
     ps_req_mngr_write_asset_data(g_ps_object.data + offset, size);
+#endif
 
     *p_data_length = size;
 
@@ -401,7 +438,7 @@ psa_status_t ps_object_create(psa_storage_uid_t uid, int32_t client_id,
         g_ps_object.header.crypto.ref.uid = uid;
         g_ps_object.header.crypto.ref.client_id = client_id;
 
-        err = ps_encrypted_object_read(g_obj_tbl_info.fid, &g_ps_object, &num_blocks);
+        err = ps_encrypted_object_read_header(g_obj_tbl_info.fid, &g_ps_object, &num_blocks);
 #if PS_AES_KEY_USAGE_LIMIT != 0
         g_obj_tbl_info.num_blocks += num_blocks;
 #endif /* PS_AES_KEY_USAGE_LIMIT */
@@ -625,7 +662,7 @@ psa_status_t ps_object_get_info(psa_storage_uid_t uid, int32_t client_id,
     g_ps_object.header.crypto.ref.uid = uid;
     g_ps_object.header.crypto.ref.client_id = client_id;
 
-    err = ps_encrypted_object_read(g_obj_tbl_info.fid, &g_ps_object, &num_blocks);
+    err = ps_encrypted_object_read_header(g_obj_tbl_info.fid, &g_ps_object, &num_blocks);
 #if PS_AES_KEY_USAGE_LIMIT != 0
     g_obj_tbl_info.num_blocks += num_blocks;
 #endif
@@ -682,7 +719,7 @@ psa_status_t ps_object_delete(psa_storage_uid_t uid, int32_t client_id)
     g_ps_object.header.crypto.ref.uid = uid;
     g_ps_object.header.crypto.ref.client_id = client_id;
 
-    err = ps_encrypted_object_read(g_obj_tbl_info.fid, &g_ps_object, &num_blocks);
+    err = ps_encrypted_object_read_header(g_obj_tbl_info.fid, &g_ps_object, &num_blocks);
 #if PS_AES_KEY_USAGE_LIMIT != 0
     g_obj_tbl_info.num_blocks += num_blocks;
 #endif
@@ -756,5 +793,9 @@ psa_status_t ps_system_wipe_all(void)
      * this function doesn't block on the lock and directly
      * moves to erasing the flash instead.
      */
+#ifdef PS_ENCRYPTION
+    ps_crypto_flush_key_cache();
+#endif
+
     return ps_object_table_create();
 }
@@ -8,6 +8,7 @@
 #include "ps_object_table.h"
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -139,6 +140,66 @@ static inline uint32_t ps_object_fs_id_to_idx(uint32_t fid)
     return idx;
 }
 
+/* Table entry index value which does not reference any table entry */
+#define PS_OBJ_TABLE_NO_IDX 0xFFFFFFFFU
+
+#if PS_OBJ_TABLE_JOURNAL
+/*!
+ * \def PS_JOURNAL_FS_ID
+ *
+ * \brief File ID used to store the object table journal in the file system.
+ *        It follows the file IDs of the objects.
+ */
+#define PS_JOURNAL_FS_ID PS_OBJECT_FS_ID(PS_OBJ_TABLE_ENTRIES)
+
+/* Maximum number of table entries changed by a single object table update */
+#define PS_OBJ_TABLE_DELTA_CHANGES 2
+
+/*!
+ * \struct ps_obj_table_delta_t
+ *
+ * \brief Journaled object table update. It holds the new content of the
+ *        table entries changed by the update.
+ */
+struct ps_obj_table_delta_t {
+#ifdef PS_ENCRYPTION
+    union ps_crypto_t crypto;    /*!< Crypto metadata. The tag chains the
+                                  *   delta to the previous one, or to the
+                                  *   checkpoint table for the first delta.
+                                  */
+#endif
+    uint32_t idx[PS_OBJ_TABLE_DELTA_CHANGES]; /*!< Changed entry indexes, or
+                                               *   PS_OBJ_TABLE_NO_IDX
+                                               */
+    struct ps_obj_table_entry_t entry[PS_OBJ_TABLE_DELTA_CHANGES]; /*!< New
+                                                                    *   entry
+                                                                    *   values
+                                                                    */
+};
+
+/*!
+ * \struct ps_obj_table_journal_t
+ *
+ * \brief Object table journal. It holds the deltas committed since the last
+ *        object table checkpoint.
+ */
+struct ps_obj_table_journal_t {
+#ifndef PS_ENCRYPTION
+    uint32_t swap_count;         /*!< Swap count of the checkpoint table */
+#endif
+    uint32_t num_deltas;         /*!< Number of valid deltas */
+    struct ps_obj_table_delta_t delta[PS_OBJ_TABLE_JOURNAL_MAX_DELTAS]; /*!<
+                                                                 * Deltas */
+};
+
+/* Size of the journal header, which precedes the deltas in the journal file */
+#define PS_JOURNAL_HEADER_SIZE offsetof(struct ps_obj_table_journal_t, delta)
+
+/* Size of the journal file holding the given number of deltas */
+#define PS_JOURNAL_FILE_SIZE(num_deltas) (PS_JOURNAL_HEADER_SIZE + \
+                               ((num_deltas) * sizeof(struct ps_obj_table_delta_t)))
+#endif /* PS_OBJ_TABLE_JOURNAL */
+
 /*!
  * \struct ps_obj_table_ctx_t
  *
@@ -148,6 +209,14 @@ struct ps_obj_table_ctx_t {
     struct ps_obj_table_t obj_table;  /*!< Object tables */
     uint8_t active_table;             /*!< Active object table */
     uint8_t scratch_table;            /*!< Scratch object table */
+#if PS_OBJ_TABLE_JOURNAL
+    bool checkpoint_needed;           /*!< Next update must save the whole
+                                       *   table
+                                       */
+    struct ps_obj_table_journal_t journal; /*!< Deltas committed on top of the
+                                            *   active table
+                                            */
+#endif
 };
 
 /* Object table context */
@@ -203,6 +272,14 @@ struct ps_crypto_assoc_data_t {
 PS_UTILS_BOUND_CHECK(OBJ_TABLE_NOT_FIT_IN_STATIC_OBJ_DATA_BUF,
                      PS_OBJ_TABLE_SIZE, PS_MAX_ASSET_SIZE);
 
+#if PS_OBJ_TABLE_JOURNAL
+/* Check at compilation time if the journal fits in a file of the file system,
+ * which can store at least PS_MAX_ASSET_SIZE bytes.
+ */
+PS_UTILS_BOUND_CHECK(JOURNAL_NOT_FIT_IN_FILE,
+                     sizeof(struct ps_obj_table_journal_t), PS_MAX_ASSET_SIZE);
+#endif
+
 enum ps_obj_table_state {
     PS_OBJ_TABLE_VALID = 0,   /*!< Table content is valid */
     PS_OBJ_TABLE_INVALID,     /*!< Table content is invalid */
@@ -232,8 +309,23 @@ struct ps_obj_table_init_ctx_t {
     uint32_t nvc_1;        /*!< Non-volatile counter value 1 */
     uint32_t nvc_3;        /*!< Non-volatile counter value 3 */
 #endif /* PS_ROLLBACK_PROTECTION */
+#if PS_OBJ_TABLE_JOURNAL
+    uint32_t journal_len;  /*!< Number of journaled deltas expected on top of
+                            *   the object tables
+                            */
+    bool journal_valid[PS_NUM_OBJ_TABLES]; /*!< Array to indicate if the
+                                            *   journal applies to the object
+                                            *   table X
+                                            */
+#endif /* PS_OBJ_TABLE_JOURNAL */
 };
 
+#if PS_OBJ_TABLE_JOURNAL
+#define PS_INIT_CTX_JOURNAL_LEN(init_ctx) ((init_ctx)->journal_len)
+#else
+#define PS_INIT_CTX_JOURNAL_LEN(init_ctx) 0U
+#endif
+
 /**
  * \brief Reads object table from persistent memory.
  *
@@ -392,8 +484,10 @@ static void ps_object_table_authenticate(uint8_t table_idx,
     union ps_crypto_t *crypto = &init_ctx->p_table[table_idx]->crypto;
     psa_status_t err;
 
-    /* Init associated data with NVC 1 */
-    assoc_data.nv_counter = init_ctx->nvc_1;
+    /* Init associated data with NVC 1. Each journaled delta incremented
+     * NVC 1 after the table was saved.
+     */
+    assoc_data.nv_counter = init_ctx->nvc_1 - PS_INIT_CTX_JOURNAL_LEN(init_ctx);
     (void)memcpy(assoc_data.obj_table_data,
                  PS_CRYPTO_ASSOCIATED_DATA(crypto),
                  PS_OBJ_TABLE_AUTH_DATA_SIZE);
@@ -417,7 +511,7 @@ static void ps_object_table_authenticate(uint8_t table_idx,
     }
 
     /* Check with NVC 3 */
-    assoc_data.nv_counter = init_ctx->nvc_3;
+    assoc_data.nv_counter = init_ctx->nvc_3 - PS_INIT_CTX_JOURNAL_LEN(init_ctx);
 
     err = ps_crypto_authenticate(crypto, (const uint8_t *)&assoc_data,
                                  PS_CRYPTO_ASSOCIATED_DATA_LEN);
@@ -634,6 +728,474 @@ static psa_status_t ps_object_table_save_table(
     return err;
 }
 
+#if PS_OBJ_TABLE_JOURNAL
+#ifdef PS_ENCRYPTION
+/* Delta data authenticated by the delta tag, which follows the crypto data */
+#define PS_DELTA_AUTH_DATA(delta) ((const uint8_t *)(delta) + \
+                                   offsetof(struct ps_obj_table_delta_t, idx))
+
+/* Size of the delta data authenticated by the delta tag */
+#define PS_DELTA_AUTH_DATA_SIZE (sizeof(struct ps_obj_table_delta_t) - \
+                                 offsetof(struct ps_obj_table_delta_t, idx))
+
+/*!
+ * \struct ps_obj_table_delta_assoc_t
+ *
+ * \brief Associated data authenticated by a delta tag.
+ */
+struct ps_obj_table_delta_assoc_t {
+    uint8_t prev_tag[PS_TAG_LEN_BYTES]; /*!< Tag of the previous delta, or of
+                                         *   the checkpoint table
+                                         */
+#if PS_ROLLBACK_PROTECTION
+    uint32_t nv_counter;                /*!< Value of NVC 1 for the delta */
+#endif
+    uint8_t delta_data[PS_DELTA_AUTH_DATA_SIZE]; /*!< Delta content */
+};
+
+/**
+ * \brief Fills the associated data authenticated by a delta tag.
+ *
+ * \param[in]  delta       Pointer to the delta
+ * \param[in]  prev_tag    Tag the delta is chained to
+ * \param[in]  nv_counter  Value of PS non-volatile counter 1 for the delta.
+ *                         Ignored without rollback protection.
+ * \param[out] assoc_data  Pointer to the associated data to fill
+ */
+static void ps_object_table_delta_assoc_data(
+                                  const struct ps_obj_table_delta_t *delta,
+                                  const uint8_t *prev_tag,
+                                  uint32_t nv_counter,
+                                  struct ps_obj_table_delta_assoc_t *assoc_data)
+{
+    /* Clear the padding, as it is authenticated too */
+    (void)memset(assoc_data, 0, sizeof(*assoc_data));
+
+    (void)memcpy(assoc_data->prev_tag, prev_tag, PS_TAG_LEN_BYTES);
+#if PS_ROLLBACK_PROTECTION
+    assoc_data->nv_counter = nv_counter;
+#else
+    (void)nv_counter;
+#endif
+    (void)memcpy(assoc_data->delta_data, PS_DELTA_AUTH_DATA(delta),
+                 PS_DELTA_AUTH_DATA_SIZE);
+}
+#endif /* PS_ENCRYPTION */
+
+/**
+ * \brief Reads the object table journal from persistent memory.
+ *
+ * \param[out] init_ctx  Pointer to the init object table context
+ *
+ */
+static void ps_object_table_journal_read(
+                                       struct ps_obj_table_init_ctx_t *init_ctx)
+{
+    struct ps_obj_table_journal_t *journal = &ps_obj_table_ctx.journal;
+    psa_status_t err;
+    size_t data_length = 0;
+    uint32_t i;
+    uint32_t j;
+
+    init_ctx->journal_valid[PS_OBJ_TABLE_IDX_0] = false;
+    init_ctx->journal_valid[PS_OBJ_TABLE_IDX_1] = false;
+
+    err = psa_its_get(PS_JOURNAL_FS_ID, 0, sizeof(*journal),
+                      (void *)journal, &data_length);
+    if ((err != PSA_SUCCESS)
+        || (data_length < PS_JOURNAL_HEADER_SIZE)
+        || (journal->num_deltas > PS_OBJ_TABLE_JOURNAL_MAX_DELTAS)
+        || (data_length < PS_JOURNAL_FILE_SIZE(journal->num_deltas))) {
+        journal->num_deltas = 0;
+    }
+
+    /* Discard a journal which references entries out of the table */
+    for (i = 0; i < journal->num_deltas; i++) {
+        for (j = 0; j < PS_OBJ_TABLE_DELTA_CHANGES; j++) {
+            if ((journal->delta[i].idx[j] >= PS_OBJ_TABLE_ENTRIES)
+                && (journal->delta[i].idx[j] != PS_OBJ_TABLE_NO_IDX)) {
+                journal->num_deltas = 0;
+            }
+        }
+    }
+
+    init_ctx->journal_len = journal->num_deltas;
+}
+
+/**
+ * \brief Checks if the journal applies to an object table, which is the case
+ *        when its deltas are chained to that table.
+ *
+ * \param[in]     table_idx  Table index in the init context
+ * \param[in,out] init_ctx   Pointer to the init object table context
+ *
+ */
+static void ps_object_table_journal_authenticate(uint8_t table_idx,
+                                       struct ps_obj_table_init_ctx_t *init_ctx)
+{
+    struct ps_obj_table_journal_t *journal = &ps_obj_table_ctx.journal;
+#ifdef PS_ENCRYPTION
+    struct ps_obj_table_delta_assoc_t assoc_data;
+    const union ps_crypto_t *table_crypto =
+                                       &init_ctx->p_table[table_idx]->crypto;
+    const uint8_t *prev_tag = table_crypto->ref.tag;
+    struct ps_obj_table_delta_t *delta;
+    uint32_t nv_counter = 0;
+    psa_status_t err;
+    uint32_t i;
+#endif
+
+    init_ctx->journal_valid[table_idx] = false;
+
+    if ((init_ctx->journal_len == 0)
+        || (init_ctx->table_state[table_idx] == PS_OBJ_TABLE_INVALID)) {
+        return;
+    }
+
+#ifdef PS_ENCRYPTION
+#if PS_ROLLBACK_PROTECTION
+    /* The table was authenticated with the NVC value of the last delta minus
+     * the number of deltas.
+     */
+    if (init_ctx->table_state[table_idx] == PS_OBJ_TABLE_NVC_1_VALID) {
+        nv_counter = init_ctx->nvc_1 - init_ctx->journal_len;
+    } else {
+        nv_counter = init_ctx->nvc_3 - init_ctx->journal_len;
+    }
+#endif
+
+    for (i = 0; i < init_ctx->journal_len; i++) {
+        delta = &journal->delta[i];
+
+        /* Deltas are authenticated with the object table key */
+        delta->crypto.ref.client_id = PS_OBJ_TABLE_CLIENT_ID;
+        delta->crypto.ref.uid = PS_OBJ_TABLE_UID;
+#if PS_AES_KEY_USAGE_LIMIT != 0
+        delta->crypto.ref.key_gen_nr = table_crypto->ref.key_gen_nr;
+#endif
+
+        /* Each delta incremented NVC 1 once */
+        nv_counter++;
+        ps_object_table_delta_assoc_data(delta, prev_tag, nv_counter,
+                                         &assoc_data);
+
+        err = ps_crypto_authenticate(&delta->crypto,
+                                     (const uint8_t *)&assoc_data,
+                                     sizeof(assoc_data));
+        if (err != PSA_SUCCESS) {
+            return;
+        }
+
+        prev_tag = delta->crypto.ref.tag;
+    }
+
+    init_ctx->journal_valid[table_idx] = true;
+#else
+    init_ctx->journal_valid[table_idx] =
+         (journal->swap_count == init_ctx->p_table[table_idx]->swap_count);
+#endif /* PS_ENCRYPTION */
+}
+
+/**
+ * \brief Checks which object tables the journal applies to.
+ *
+ * \param[in,out] init_ctx  Pointer to the init object table context
+ *
+ */
+static void ps_object_table_journal_authenticate_ctx_tables(
+                                       struct ps_obj_table_init_ctx_t *init_ctx)
+{
+    uint8_t i;
+
+    for (i = 0; i < PS_NUM_OBJ_TABLES; i++) {
+        ps_object_table_journal_authenticate(i, init_ctx);
+
+#if PS_ROLLBACK_PROTECTION
+        /* A table authenticated with an NVC value which leaves room for the
+         * deltas is only valid with them.
+         */
+        if ((init_ctx->journal_len != 0) && !init_ctx->journal_valid[i]) {
+            init_ctx->table_state[i] = PS_OBJ_TABLE_INVALID;
+        }
+#endif
+    }
+}
+
+#if PS_ROLLBACK_PROTECTION
+/**
+ * \brief Authenticates tables of objects and the journal on top of them.
+ *
+ * \param[in,out] init_ctx  Pointer to the object table to authenticate
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t ps_object_table_journal_nvc_authenticate(
+                                      struct ps_obj_table_init_ctx_t *init_ctx)
+{
+    enum ps_obj_table_state table_state[PS_NUM_OBJ_TABLES];
+    psa_status_t err;
+
+    (void)memcpy(table_state, init_ctx->table_state, sizeof(table_state));
+
+    err = ps_object_table_nvc_authenticate(init_ctx);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    ps_object_table_journal_authenticate_ctx_tables(init_ctx);
+
+    if ((init_ctx->journal_len == 0)
+        || (init_ctx->table_state[PS_OBJ_TABLE_IDX_0] != PS_OBJ_TABLE_INVALID)
+        || (init_ctx->table_state[PS_OBJ_TABLE_IDX_1] !=
+                                                      PS_OBJ_TABLE_INVALID)) {
+        return PSA_SUCCESS;
+    }
+
+    /* The journal is stale when a power failure happened after a checkpoint
+     * was saved, but before the journal was removed. Authenticate the tables
+     * without it.
+     */
+    (void)memcpy(init_ctx->table_state, table_state, sizeof(table_state));
+    init_ctx->journal_len = 0;
+
+    return ps_object_table_nvc_authenticate(init_ctx);
+}
+#endif /* PS_ROLLBACK_PROTECTION */
+
+/**
+ * \brief Replays the journaled deltas on top of the active object table, if
+ *        the journal applies to it.
+ *
+ * \param[in] init_ctx  Pointer to the init object table context
+ *
+ */
+static void ps_object_table_journal_apply(
+                                 const struct ps_obj_table_init_ctx_t *init_ctx)
+{
+    struct ps_obj_table_t *p_table = &ps_obj_table_ctx.obj_table;
+    struct ps_obj_table_journal_t *journal = &ps_obj_table_ctx.journal;
+    const struct ps_obj_table_delta_t *delta;
+    uint32_t i;
+    uint32_t j;
+
+    ps_obj_table_ctx.checkpoint_needed = false;
+
+    if (!init_ctx->journal_valid[ps_obj_table_ctx.active_table]) {
+        /* New deltas overwrite the journal file */
+        journal->num_deltas = 0;
+    }
+
+#ifndef PS_ENCRYPTION
+    journal->swap_count = p_table->swap_count;
+#endif
+
+#if PS_ROLLBACK_PROTECTION
+    /* NVC 1 is ahead of the active table when it was authenticated with
+     * NVC 3, so new deltas would not be chained to consecutive NVC values.
+     */
+    if (init_ctx->table_state[ps_obj_table_ctx.active_table] !=
+                                                    PS_OBJ_TABLE_NVC_1_VALID) {
+        ps_obj_table_ctx.checkpoint_needed = true;
+    }
+#endif
+
+    for (i = 0; i < journal->num_deltas; i++) {
+        delta = &journal->delta[i];
+
+        for (j = 0; j < PS_OBJ_TABLE_DELTA_CHANGES; j++) {
+            if (delta->idx[j] != PS_OBJ_TABLE_NO_IDX) {
+                (void)memcpy(&p_table->obj_db[delta->idx[j]],
+                             &delta->entry[j], PS_OBJECTS_TABLE_ENTRY_SIZE);
+            }
+        }
+    }
+}
+
+/**
+ * \brief Saves a checkpoint of the object table in the persistent memory and
+ *        clears the journal.
+ *
+ * \param[in,out] obj_table  Pointer to the object table to save
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t ps_object_table_checkpoint(
+                                              struct ps_obj_table_t *obj_table)
+{
+    psa_status_t err;
+
+    err = ps_object_table_save_table(obj_table);
+    if (err != PSA_SUCCESS) {
+        /* The table header in RAM may no longer match the saved table, so
+         * deltas cannot be chained to it.
+         */
+        ps_obj_table_ctx.checkpoint_needed = true;
+        return err;
+    }
+
+    ps_obj_table_ctx.checkpoint_needed = false;
+    ps_obj_table_ctx.journal.num_deltas = 0;
+#ifndef PS_ENCRYPTION
+    ps_obj_table_ctx.journal.swap_count = obj_table->swap_count;
+#endif
+
+    /* The deltas are part of the saved table now. A journal left behind is
+     * not chained to the new table, so it is ignored at the next init.
+     */
+    (void)psa_its_remove(PS_JOURNAL_FS_ID);
+
+    return PSA_SUCCESS;
+}
+
+/**
+ * \brief Appends a delta holding the given table entries to the journal in
+ *        the persistent memory.
+ *
+ * \param[in] idx  Indexes of the changed table entries, or
+ *                 PS_OBJ_TABLE_NO_IDX
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t ps_object_table_journal_append(
+                                const uint32_t idx[PS_OBJ_TABLE_DELTA_CHANGES])
+{
+    struct ps_obj_table_t *p_table = &ps_obj_table_ctx.obj_table;
+    struct ps_obj_table_journal_t *journal = &ps_obj_table_ctx.journal;
+    struct ps_obj_table_delta_t *delta = &journal->delta[journal->num_deltas];
+    psa_status_t err;
+    uint32_t i;
+#ifdef PS_ENCRYPTION
+    struct ps_obj_table_delta_assoc_t assoc_data;
+    const uint8_t *prev_tag;
+#endif
+#if PS_ROLLBACK_PROTECTION
+    uint32_t nvc_1 = 0;
+#endif
+
+    (void)memset(delta, PS_DEFAULT_EMPTY_BUFF_VAL,
+                 sizeof(struct ps_obj_table_delta_t));
+
+    for (i = 0; i < PS_OBJ_TABLE_DELTA_CHANGES; i++) {
+        delta->idx[i] = idx[i];
+        if (idx[i] != PS_OBJ_TABLE_NO_IDX) {
+            (void)memcpy(&delta->entry[i], &p_table->obj_db[idx[i]],
+                         PS_OBJECTS_TABLE_ENTRY_SIZE);
+        }
+    }
+
+    /* If the delta is not appended, NVC 1 can be ahead of the journal. The
+     * next update then saves the whole table.
+     */
+    ps_obj_table_ctx.checkpoint_needed = true;
+
+#if PS_ROLLBACK_PROTECTION
+    err = ps_increment_nv_counter(TFM_PS_NV_COUNTER_1);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    err = ps_read_nv_counter(TFM_PS_NV_COUNTER_1, &nvc_1);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+#endif /* PS_ROLLBACK_PROTECTION */
+
+#ifdef PS_ENCRYPTION
+    delta->crypto.ref.client_id = PS_OBJ_TABLE_CLIENT_ID;
+    delta->crypto.ref.uid = PS_OBJ_TABLE_UID;
+#if PS_AES_KEY_USAGE_LIMIT != 0
+    delta->crypto.ref.key_gen_nr = p_table->crypto.ref.key_gen_nr;
+#endif
+
+    if (journal->num_deltas == 0) {
+        prev_tag = p_table->crypto.ref.tag;
+    } else {
+        prev_tag = journal->delta[journal->num_deltas - 1].crypto.ref.tag;
+    }
+
+    /* Get new IV */
+    err = ps_crypto_get_iv(&delta->crypto);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+#if PS_ROLLBACK_PROTECTION
+    ps_object_table_delta_assoc_data(delta, prev_tag, nvc_1, &assoc_data);
+#else
+    ps_object_table_delta_assoc_data(delta, prev_tag, 0, &assoc_data);
+#endif
+
+    err = ps_crypto_generate_auth_tag(&delta->crypto,
+                                      (const uint8_t *)&assoc_data,
+                                      sizeof(assoc_data));
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+#endif /* PS_ENCRYPTION */
+
+    journal->num_deltas++;
+
+    err = psa_its_set(PS_JOURNAL_FS_ID,
+                      PS_JOURNAL_FILE_SIZE(journal->num_deltas),
+                      (const void *)journal,
+                      PSA_STORAGE_FLAG_NONE);
+    if (err != PSA_SUCCESS) {
+        journal->num_deltas--;
+        return err;
+    }
+
+#if PS_ROLLBACK_PROTECTION
+    /* Align PS NV counters to have the same value */
+    err = ps_object_table_align_nv_counters(nvc_1);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+#endif /* PS_ROLLBACK_PROTECTION */
+
+    ps_obj_table_ctx.checkpoint_needed = false;
+
+    return PSA_SUCCESS;
+}
+#endif /* PS_OBJ_TABLE_JOURNAL */
+
+/**
+ * \brief Commits an update of the object table in the persistent memory.
+ *
+ * \param[in] idx0  Index of a table entry changed by the update
+ * \param[in] idx1  Index of another table entry changed by the update, or
+ *                  PS_OBJ_TABLE_NO_IDX
+ *
+ * \note Without PS_OBJ_TABLE_JOURNAL the whole table is saved. Otherwise, the
+ *       update is appended to the journal, unless a checkpoint is due.
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t ps_object_table_commit(uint32_t idx0, uint32_t idx1)
+{
+#if PS_OBJ_TABLE_JOURNAL
+    const uint32_t idx[PS_OBJ_TABLE_DELTA_CHANGES] = {idx0, idx1};
+    psa_status_t err;
+
+    if (!ps_obj_table_ctx.checkpoint_needed
+        && (ps_obj_table_ctx.journal.num_deltas <
+                                            PS_OBJ_TABLE_JOURNAL_MAX_DELTAS)) {
+        err = ps_object_table_journal_append(idx);
+        if (err != PSA_ERROR_INSUFFICIENT_STORAGE) {
+            return err;
+        }
+
+        /* Space runs low, save the whole table instead */
+    }
+
+    return ps_object_table_checkpoint(&ps_obj_table_ctx.obj_table);
+#else
+    (void)idx0;
+    (void)idx1;
+
+    return ps_object_table_save_table(&ps_obj_table_ctx.obj_table);
+#endif /* PS_OBJ_TABLE_JOURNAL */
+}
+
 /**
  * \brief Checks the validity of the table version.
  *
@@ -771,6 +1333,197 @@ static psa_status_t ps_set_active_object_table(
     return PSA_SUCCESS;
 }
 
+#if PS_OBJ_TABLE_INDEX
+/* Number of slots in the object table index. Keeping the load factor at or
+ * below one half keeps the probe sequences short.
+ */
+#define PS_OBJ_INDEX_SLOTS      (2U * PS_OBJ_TABLE_ENTRIES)
+
+/* Index slot value which does not reference any table entry */
+#define PS_OBJ_INDEX_EMPTY      0U
+
+/* Number of 32-bit words in the free entry bitmap */
+#define PS_OBJ_INDEX_MAP_WORDS  ((PS_OBJ_TABLE_ENTRIES + 31U) / 32U)
+
+/*!
+ * \struct ps_obj_table_index_t
+ *
+ * \brief Open-addressed RAM index of the object table entries, keyed on the
+ *        object UID and client ID.
+ */
+struct ps_obj_table_index_t {
+    uint16_t slot[PS_OBJ_INDEX_SLOTS];         /*!< Entry index plus one, or
+                                                *   PS_OBJ_INDEX_EMPTY
+                                                */
+    uint32_t free_map[PS_OBJ_INDEX_MAP_WORDS]; /*!< Bit set for each free
+                                                *   table entry, most
+                                                *   significant bit first
+                                                */
+    uint32_t free_count;                       /*!< Number of free entries */
+};
+
+/* Object table index */
+static struct ps_obj_table_index_t ps_obj_table_index;
+
+/* Check at compilation time if the entry indexes fit in the index slots */
+PS_UTILS_BOUND_CHECK(OBJ_TABLE_ENTRIES_NOT_FIT_IN_INDEX_SLOT,
+                     PS_OBJ_TABLE_ENTRIES, (UINT16_MAX - 1));
+
+/**
+ * \brief Gets the first index slot to probe for the given object.
+ *
+ * \param[in] uid        Object UID
+ * \param[in] client_id  Client UID
+ *
+ * \return Returns the home slot of the object in the index
+ */
+static uint32_t ps_obj_index_home(psa_storage_uid_t uid, int32_t client_id)
+{
+    uint32_t hash = (uint32_t)uid ^ (uint32_t)(uid >> 32);
+
+    hash ^= (uint32_t)client_id * 0x9E3779B9U;
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6BU;
+    hash ^= hash >> 13;
+
+    return hash % PS_OBJ_INDEX_SLOTS;
+}
+
+/**
+ * \brief Gets the home slot of the object stored in the given table entry.
+ *
+ * \param[in] idx  Table entry index
+ *
+ * \return Returns the home slot of the entry in the index
+ */
+static uint32_t ps_obj_index_entry_home(uint32_t idx)
+{
+    const struct ps_obj_table_entry_t *entry =
+                                       &ps_obj_table_ctx.obj_table.obj_db[idx];
+
+    return ps_obj_index_home(entry->uid, entry->client_id);
+}
+
+/**
+ * \brief Marks a table entry as used or free in the free entry bitmap.
+ *
+ * \param[in] idx      Table entry index
+ * \param[in] is_free  Whether the entry is free
+ */
+static void ps_obj_index_set_free(uint32_t idx, bool is_free)
+{
+    uint32_t *word = &ps_obj_table_index.free_map[idx / 32U];
+    uint32_t mask = 1U << (31U - (idx % 32U));
+
+    if (is_free && ((*word & mask) == 0U)) {
+        *word |= mask;
+        ps_obj_table_index.free_count++;
+    } else if (!is_free && ((*word & mask) != 0U)) {
+        *word &= ~mask;
+        ps_obj_table_index.free_count--;
+    }
+}
+
+/**
+ * \brief Adds a table entry to the index. The entry must already hold the
+ *        object UID and client ID.
+ *
+ * \param[in] idx  Table entry index
+ *
+ * \note If the object is already indexed, the existing index slot is kept so
+ *       that lookups return the lowest entry, as a linear scan would.
+ */
+static void ps_obj_index_insert(uint32_t idx)
+{
+    const struct ps_obj_table_entry_t *p_db = ps_obj_table_ctx.obj_table.obj_db;
+    uint32_t slot = ps_obj_index_entry_home(idx);
+    uint32_t cur;
+
+    ps_obj_index_set_free(idx, false);
+
+    /* The index has more slots than the table has entries, so an empty slot
+     * is always found.
+     */
+    while (ps_obj_table_index.slot[slot] != PS_OBJ_INDEX_EMPTY) {
+        cur = ps_obj_table_index.slot[slot] - 1U;
+        if (p_db[cur].uid == p_db[idx].uid
+            && p_db[cur].client_id == p_db[idx].client_id) {
+            return;
+        }
+        slot = (slot + 1U) % PS_OBJ_INDEX_SLOTS;
+    }
+
+    ps_obj_table_index.slot[slot] = (uint16_t)(idx + 1U);
+}
+
+/**
+ * \brief Removes a table entry from the index. The entry must still hold the
+ *        object UID and client ID it was indexed with.
+ *
+ * \param[in] idx  Table entry index
+ */
+static void ps_obj_index_remove(uint32_t idx)
+{
+    uint32_t hole = ps_obj_index_entry_home(idx);
+    uint32_t next;
+    uint32_t home;
+
+    ps_obj_index_set_free(idx, true);
+
+    while (ps_obj_table_index.slot[hole] != (uint16_t)(idx + 1U)) {
+        if (ps_obj_table_index.slot[hole] == PS_OBJ_INDEX_EMPTY) {
+            /* Entry is not indexed (e.g. duplicated object) */
+            return;
+        }
+        hole = (hole + 1U) % PS_OBJ_INDEX_SLOTS;
+    }
+
+    /* Shift back the following slots of the probe sequence which would no
+     * longer be reachable from their home slot, so that no tombstones are
+     * needed.
+     */
+    next = hole;
+    for (;;) {
+        next = (next + 1U) % PS_OBJ_INDEX_SLOTS;
+        if (ps_obj_table_index.slot[next] == PS_OBJ_INDEX_EMPTY) {
+            break;
+        }
+
+        home = ps_obj_index_entry_home(ps_obj_table_index.slot[next] - 1U);
+        if ((hole <= next) ? ((hole < home) && (home <= next))
+                           : ((hole < home) || (home <= next))) {
+            /* Slot is still reachable from its home slot */
+            continue;
+        }
+
+        ps_obj_table_index.slot[hole] = ps_obj_table_index.slot[next];
+        hole = next;
+    }
+
+    ps_obj_table_index.slot[hole] = PS_OBJ_INDEX_EMPTY;
+}
+
+/**
+ * \brief Rebuilds the index from the object table in the context.
+ */
+static void ps_obj_index_build(void)
+{
+    uint32_t i;
+
+    (void)memset(&ps_obj_table_index, 0, sizeof(ps_obj_table_index));
+
+    for (i = 0; i < PS_OBJ_TABLE_ENTRIES; i++) {
+        ps_obj_index_set_free(i, true);
+    }
+
+    for (i = 0; i < PS_OBJ_TABLE_ENTRIES; i++) {
+        if (ps_obj_table_ctx.obj_table.obj_db[i].uid != TFM_PS_INVALID_UID) {
+            ps_obj_index_insert(i);
+        }
+    }
+}
+#endif /* PS_OBJ_TABLE_INDEX */
+
 /**
  * \brief Gets table's entry index based on the given object UID and client ID.
  *
@@ -788,6 +1541,19 @@ static psa_status_t ps_get_object_entry_idx(psa_storage_uid_t uid,
     uint32_t i;
     struct ps_obj_table_t *p_table = &ps_obj_table_ctx.obj_table;
 
+#if PS_OBJ_TABLE_INDEX
+    uint32_t slot = ps_obj_index_home(uid, client_id);
+
+    while (ps_obj_table_index.slot[slot] != PS_OBJ_INDEX_EMPTY) {
+        i = ps_obj_table_index.slot[slot] - 1U;
+        if (p_table->obj_db[i].uid == uid
+            && p_table->obj_db[i].client_id == client_id) {
+            *idx = i;
+            return PSA_SUCCESS;
+        }
+        slot = (slot + 1U) % PS_OBJ_INDEX_SLOTS;
+    }
+#else
     for (i = 0; i < PS_OBJ_TABLE_ENTRIES; i++) {
         if (p_table->obj_db[i].uid == uid
             && p_table->obj_db[i].client_id == client_id) {
@@ -795,6 +1561,7 @@ static psa_status_t ps_get_object_entry_idx(psa_storage_uid_t uid,
             return PSA_SUCCESS;
         }
     }
+#endif /* PS_OBJ_TABLE_INDEX */
 
     return PSA_ERROR_DOES_NOT_EXIST;
 }
@@ -825,6 +1592,24 @@ __STATIC_INLINE psa_status_t ps_table_free_idx(uint32_t idx_num,
         return PSA_ERROR_INVALID_ARGUMENT;
     }
 
+#if PS_OBJ_TABLE_INDEX
+    (void)p_table;
+    (void)last_free;
+
+    if (ps_obj_table_index.free_count < idx_num) {
+        return PSA_ERROR_INSUFFICIENT_STORAGE;
+    }
+
+    /* Return the lowest free entry, there are at least idx_num of them */
+    for (i = 0; i < PS_OBJ_INDEX_MAP_WORDS; i++) {
+        if (ps_obj_table_index.free_map[i] != 0U) {
+            *idx = (i * 32U) + __CLZ(ps_obj_table_index.free_map[i]);
+            return PSA_SUCCESS;
+        }
+    }
+
+    return PSA_ERROR_INSUFFICIENT_STORAGE;
+#else
     for (i = 0; i < PS_OBJ_TABLE_ENTRIES && idx_num > 0; i++) {
         if (p_table->obj_db[i].uid == TFM_PS_INVALID_UID) {
             last_free = i;
@@ -838,6 +1623,7 @@ __STATIC_INLINE psa_status_t ps_table_free_idx(uint32_t idx_num,
         *idx = last_free;
         return PSA_SUCCESS;
     }
+#endif /* PS_OBJ_TABLE_INDEX */
 }
 
 /**
@@ -848,6 +1634,12 @@ __STATIC_INLINE psa_status_t ps_table_free_idx(uint32_t idx_num,
  */
 static void ps_table_delete_entry(uint32_t idx)
 {
+#if PS_OBJ_TABLE_INDEX
+    if (ps_obj_table_ctx.obj_table.obj_db[idx].uid != TFM_PS_INVALID_UID) {
+        ps_obj_index_remove(idx);
+    }
+#endif
+
     /* Initialise object table entry structure */
     (void)memset(&ps_obj_table_ctx.obj_table.obj_db[idx],
                  PS_DEFAULT_EMPTY_BUFF_VAL, PS_OBJECTS_TABLE_ENTRY_SIZE);
@@ -877,8 +1669,16 @@ psa_status_t ps_object_table_create(void)
 
     p_table->version = PS_OBJECT_SYSTEM_VERSION;
 
+#if PS_OBJ_TABLE_INDEX
+    ps_obj_index_build();
+#endif
+
     /* Save object table contents */
+#if PS_OBJ_TABLE_JOURNAL
+    return ps_object_table_checkpoint(p_table);
+#else
     return ps_object_table_save_table(p_table);
+#endif
 }
 
 psa_status_t ps_object_table_init(uint8_t *obj_data)
@@ -899,6 +1699,11 @@ psa_status_t ps_object_table_init(uint8_t *obj_data)
     /* Read table from the file system */
     ps_object_table_fs_read_table(&init_ctx);
 
+#if PS_OBJ_TABLE_JOURNAL
+    /* Read the deltas committed since the last table checkpoint */
+    ps_object_table_journal_read(&init_ctx);
+#endif
+
 #ifdef PS_ENCRYPTION
     for (uint32_t i = 0; i < PS_NUM_OBJ_TABLES; i++) {
         init_ctx.p_table[i]->crypto.ref.client_id = PS_OBJ_TABLE_CLIENT_ID;
@@ -906,7 +1711,11 @@ psa_status_t ps_object_table_init(uint8_t *obj_data)
     }
 #if PS_ROLLBACK_PROTECTION
     /* Authenticate table */
+#if PS_OBJ_TABLE_JOURNAL
+    err = ps_object_table_journal_nvc_authenticate(&init_ctx);
+#else
     err = ps_object_table_nvc_authenticate(&init_ctx);
+#endif
     if (err != PSA_SUCCESS) {
         return err;
     }
@@ -915,6 +1724,11 @@ psa_status_t ps_object_table_init(uint8_t *obj_data)
 #endif /* PS_ROLLBACK_PROTECTION */
 #endif /* PS_ENCRYPTION */
 
+#if PS_OBJ_TABLE_JOURNAL && !PS_ROLLBACK_PROTECTION
+    /* Check which table the journal applies to */
+    ps_object_table_journal_authenticate_ctx_tables(&init_ctx);
+#endif
+
     /* Check tables version */
     ps_object_table_validate_version(&init_ctx);
 
@@ -924,6 +1738,16 @@ psa_status_t ps_object_table_init(uint8_t *obj_data)
         return err;
     }
 
+#if PS_OBJ_TABLE_JOURNAL
+    /* Replay the journaled deltas on top of the active table */
+    ps_object_table_journal_apply(&init_ctx);
+#endif
+
+#if PS_OBJ_TABLE_INDEX
+    /* Index the active object table */
+    ps_obj_index_build();
+#endif
+
     /* Remove the old object table file */
     err = psa_its_remove(PS_TABLE_FS_ID(ps_obj_table_ctx.scratch_table));
     if (err != PSA_SUCCESS && err != PSA_ERROR_DOES_NOT_EXIST) {
@@ -932,6 +1756,13 @@ psa_status_t ps_object_table_init(uint8_t *obj_data)
 
 #ifdef PS_ENCRYPTION
     ps_crypto_set_iv(&ps_obj_table_ctx.obj_table.crypto);
+#if PS_OBJ_TABLE_JOURNAL
+    if (ps_obj_table_ctx.journal.num_deltas != 0) {
+        /* The last delta holds the most recent IV */
+        ps_crypto_set_iv(&ps_obj_table_ctx.journal.delta[
+                               ps_obj_table_ctx.journal.num_deltas - 1].crypto);
+    }
+#endif
 #endif
 
     return PSA_SUCCESS;
@@ -994,6 +1825,11 @@ void ps_object_table_set_gen(uint32_t new_gen)
         tfm_core_panic();
     }
     p_table->crypto.ref.key_gen_nr = new_gen;
+
+#if PS_OBJ_TABLE_JOURNAL
+    /* Deltas do not carry the table header */
+    ps_obj_table_ctx.checkpoint_needed = true;
+#endif
 }
 #endif /* PS_AES_KEY_USAGE_LIMIT != 0 */
 
@@ -1028,6 +1864,12 @@ psa_status_t ps_object_table_set_obj_tbl_info(psa_storage_uid_t uid,
     }
 
     idx = PS_OBJECT_FS_ID_TO_IDX(obj_tbl_info->fid);
+#if PS_OBJ_TABLE_INDEX
+    /* The file ID is allocated from a free entry, but drop any stale object
+     * so that it does not stay indexed under this entry.
+     */
+    ps_table_delete_entry(idx);
+#endif
     p_table->obj_db[idx].uid = uid;
     p_table->obj_db[idx].client_id = client_id;
 
@@ -1042,15 +1884,29 @@ psa_status_t ps_object_table_set_obj_tbl_info(psa_storage_uid_t uid,
     p_table->obj_db[idx].version = obj_tbl_info->version;
 #endif
 
-    err = ps_object_table_save_table(p_table);
+#if PS_OBJ_TABLE_INDEX
+    ps_obj_index_insert(idx);
+#endif
+
+    if (backup_entry.uid != TFM_PS_INVALID_UID) {
+        err = ps_object_table_commit(idx, backup_idx);
+    } else {
+        err = ps_object_table_commit(idx, PS_OBJ_TABLE_NO_IDX);
+    }
     if (err != PSA_SUCCESS) {
+        /* Delete the new entry first, so that the index does not hold the
+         * object twice when the old entry is restored.
+         */
+        ps_table_delete_entry(idx);
+
         if (backup_entry.uid != TFM_PS_INVALID_UID) {
             /* Rollback the change in the table */
             (void)memcpy(&p_table->obj_db[backup_idx], &backup_entry,
                          PS_OBJECTS_TABLE_ENTRY_SIZE);
+#if PS_OBJ_TABLE_INDEX
+            ps_obj_index_insert(backup_idx);
+#endif
         }
-
-        ps_table_delete_entry(idx);
     }
 
     return err;
@@ -1110,11 +1966,14 @@ psa_status_t ps_object_table_delete_object(psa_storage_uid_t uid,
 
     ps_table_delete_entry(backup_idx);
 
-    err = ps_object_table_save_table(p_table);
+    err = ps_object_table_commit(backup_idx, PS_OBJ_TABLE_NO_IDX);
     if (err != PSA_SUCCESS) {
        /* Rollback the change in the table */
        (void)memcpy(&p_table->obj_db[backup_idx], &backup_entry,
                     PS_OBJECTS_TABLE_ENTRY_SIZE);
+#if PS_OBJ_TABLE_INDEX
+       ps_obj_index_insert(backup_idx);
+#endif
     }
 
     return err;
@@ -1123,6 +1982,17 @@ psa_status_t ps_object_table_delete_object(psa_storage_uid_t uid,
 psa_status_t ps_object_table_delete_old_table(void)
 {
     uint32_t table_id = PS_TABLE_FS_ID(ps_obj_table_ctx.scratch_table);
+#if PS_OBJ_TABLE_JOURNAL
+    psa_status_t err;
+
+    /* A journaled commit does not leave an old table behind */
+    err = psa_its_remove(table_id);
+    if (err == PSA_ERROR_DOES_NOT_EXIST) {
+        err = PSA_SUCCESS;
+    }
 
+    return err;
+#else
     return psa_its_remove(table_id);
+#endif
 }
@@ -8,6 +8,80 @@
 #include "crt_impl_private.h"
 #include "coverity_check.h"
 
+/* Copy whole bursts of words, each burst maps to a single LDM/STM pair. */
+static void copy_word_bursts(union composite_addr_t *p_dst,
+                             union composite_addr_t *p_src, size_t *n)
+{
+    uint32_t w0, w1, w2, w3;
+
+    while (*n >= CRT_BURST_SIZE) {
+        w0 = p_src->p_word[0];
+        w1 = p_src->p_word[1];
+        w2 = p_src->p_word[2];
+        w3 = p_src->p_word[3];
+        p_dst->p_word[0] = w0;
+        p_dst->p_word[1] = w1;
+        p_dst->p_word[2] = w2;
+        p_dst->p_word[3] = w3;
+        p_src->p_word += CRT_BURST_WORDS;
+        p_dst->p_word += CRT_BURST_WORDS;
+        *n -= CRT_BURST_SIZE;
+    }
+
+    while (*n >= sizeof(uint32_t)) {
+        *(p_dst->p_word)++ = *(p_src->p_word)++;
+        *n -= sizeof(uint32_t);
+    }
+}
+
+#if CRT_LITTLE_ENDIAN
+/*
+ * Copy words to an aligned destination from a misaligned source, by reading
+ * the aligned words which hold the source and merging each adjacent pair.
+ * Only words holding at least one source byte are read.
+ */
+static void copy_words_shift_merge(union composite_addr_t *p_dst,
+                                   union composite_addr_t *p_src, size_t *n)
+{
+    const uint32_t shift = (uint32_t)ADDR_WORD_UNALIGNED(p_src->uint_addr) * 8u;
+    union composite_addr_t p_aligned;
+    uint32_t *p_word;
+    uint32_t w0, w1, w2, w3, w4;
+    size_t copied = 0;
+
+    p_aligned.uint_addr = p_src->uint_addr -
+                          ADDR_WORD_UNALIGNED(p_src->uint_addr);
+    p_word = p_aligned.p_word;
+
+    w0 = *p_word++;
+
+    while ((*n - copied) >= CRT_BURST_SIZE) {
+        w1 = p_word[0];
+        w2 = p_word[1];
+        w3 = p_word[2];
+        w4 = p_word[3];
+        p_dst->p_word[0] = (w0 >> shift) | (w1 << (32u - shift));
+        p_dst->p_word[1] = (w1 >> shift) | (w2 << (32u - shift));
+        p_dst->p_word[2] = (w2 >> shift) | (w3 << (32u - shift));
+        p_dst->p_word[3] = (w3 >> shift) | (w4 << (32u - shift));
+        w0 = w4;
+        p_word += CRT_BURST_WORDS;
+        p_dst->p_word += CRT_BURST_WORDS;
+        copied += CRT_BURST_SIZE;
+    }
+
+    while ((*n - copied) >= sizeof(uint32_t)) {
+        w1 = *p_word++;
+        *(p_dst->p_word)++ = (w0 >> shift) | (w1 << (32u - shift));
+        w0 = w1;
+        copied += sizeof(uint32_t);
+    }
+
+    p_src->p_byte += copied;
+    *n -= copied;
+}
+#endif /* CRT_LITTLE_ENDIAN */
+
 void *memcpy(void *dest, const void *src, size_t n)
 {
     union composite_addr_t p_dst, p_src;
@@ -17,17 +91,21 @@ void *memcpy(void *dest, const void *src, size_t n)
     p_src.uint_addr = (uintptr_t)src;
     TFM_COVERITY_BLOCK_END(MISRA_C_2023_Rule_11_6)
 
-    /* Byte copy for unaligned address. check the last bit of address. */
-    while (n && (ADDR_WORD_UNALIGNED(p_dst.uint_addr) ||
-                 ADDR_WORD_UNALIGNED(p_src.uint_addr))) {
-        *p_dst.p_byte++ = *p_src.p_byte++;
-        n--;
-    }
+    /* Word accesses are not worth the setup for short copies. */
+    if (n >= CRT_BURST_SIZE) {
+        /* Byte copy until the destination is word aligned. */
+        while (ADDR_WORD_UNALIGNED(p_dst.uint_addr)) {
+            *p_dst.p_byte++ = *p_src.p_byte++;
+            n--;
+        }
 
-    /* Quad byte copy for aligned address. */
-    while (n >= sizeof(uint32_t)) {
-        *(p_dst.p_word)++ = *(p_src.p_word)++;
-        n -= sizeof(uint32_t);
+        if (!ADDR_WORD_UNALIGNED(p_src.uint_addr)) {
+            copy_word_bursts(&p_dst, &p_src, &n);
+        } else {
+#if CRT_LITTLE_ENDIAN
+            copy_words_shift_merge(&p_dst, &p_src, &n);
+#endif
+        }
     }
 
     /* Byte copy for the remaining bytes. */
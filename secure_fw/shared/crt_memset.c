@@ -13,14 +13,23 @@ void *memset(void *s, int c, size_t n)
     uint32_t pattern_word;
 
     p_mem.p_byte = (uint8_t *)s;
-    pattern_word = (((uint32_t)c) << 24) | (((uint32_t)c) << 16) |
-                   (((uint32_t)c) << 8) | ((uint32_t)c);
+    pattern_word = ((uint32_t)(uint8_t)c) * 0x01010101u;
 
     while (n && ADDR_WORD_UNALIGNED(p_mem.uint_addr)) {
         *p_mem.p_byte++ = (uint8_t)c;
         n--;
     }
 
+    /* Fill whole bursts of words, each burst maps to a single STM. */
+    while (n >= CRT_BURST_SIZE) {
+        p_mem.p_word[0] = pattern_word;
+        p_mem.p_word[1] = pattern_word;
+        p_mem.p_word[2] = pattern_word;
+        p_mem.p_word[3] = pattern_word;
+        p_mem.p_word += CRT_BURST_WORDS;
+        n -= CRT_BURST_SIZE;
+    }
+
     while (n >= sizeof(uint32_t)) {
         *p_mem.p_word++ = pattern_word;
         n -= sizeof(uint32_t);
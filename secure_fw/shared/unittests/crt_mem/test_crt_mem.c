@@ -0,0 +1,128 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "unity.h"
+
+/* Lengths up to and including this value are checked for every alignment */
+#define MAX_LEN         (4096u)
+/* Guard bytes around the destination, which must be left untouched */
+#define GUARD_LEN       (8u)
+#define BUF_LEN         (GUARD_LEN + sizeof(uint32_t) + MAX_LEN + GUARD_LEN)
+#define FILL_BYTE       (0xA5u)
+
+static uint8_t src_buf[BUF_LEN] __attribute__((aligned(4)));
+static uint8_t dst_buf[BUF_LEN] __attribute__((aligned(4)));
+
+static void fill(uint8_t *buf, size_t len, uint8_t seed)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = (uint8_t)((i * 7u) + seed);
+    }
+}
+
+static void fill_byte(uint8_t *buf, size_t len, uint8_t val)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = val;
+    }
+}
+
+/* Checks the destination against the source without relying on memcmp */
+static void check_copy(size_t src_off, size_t dst_off, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < BUF_LEN; i++) {
+        uint8_t expected = FILL_BYTE;
+
+        if ((i >= dst_off) && (i < (dst_off + len))) {
+            expected = src_buf[src_off + (i - dst_off)];
+        }
+
+        if (dst_buf[i] != expected) {
+            char msg[96];
+
+            snprintf(msg, sizeof(msg),
+                     "src_off %zu dst_off %zu len %zu byte %zu",
+                     src_off, dst_off, len, i);
+            TEST_FAIL_MESSAGE(msg);
+        }
+    }
+}
+
+static void check_set(size_t dst_off, size_t len, uint8_t val)
+{
+    size_t i;
+
+    for (i = 0; i < BUF_LEN; i++) {
+        uint8_t expected = ((i >= dst_off) && (i < (dst_off + len))) ?
+                           val : FILL_BYTE;
+
+        if (dst_buf[i] != expected) {
+            char msg[64];
+
+            snprintf(msg, sizeof(msg), "dst_off %zu len %zu byte %zu",
+                     dst_off, len, i);
+            TEST_FAIL_MESSAGE(msg);
+        }
+    }
+}
+
+void test_memcpy_returns_dest(void)
+{
+    TEST_ASSERT_EQUAL_PTR(dst_buf + 1, memcpy(dst_buf + 1, src_buf + 2, 17));
+    TEST_ASSERT_EQUAL_PTR(dst_buf, memcpy(dst_buf, src_buf, 0));
+}
+
+void test_memcpy_all_alignments_and_lengths(void)
+{
+    size_t src_align, dst_align, len;
+
+    fill(src_buf, BUF_LEN, 0x3C);
+
+    for (src_align = 0; src_align < sizeof(uint32_t); src_align++) {
+        for (dst_align = 0; dst_align < sizeof(uint32_t); dst_align++) {
+            for (len = 0; len <= MAX_LEN; len++) {
+                fill_byte(dst_buf, BUF_LEN, FILL_BYTE);
+
+                memcpy(dst_buf + GUARD_LEN + dst_align,
+                       src_buf + GUARD_LEN + src_align, len);
+
+                check_copy(GUARD_LEN + src_align, GUARD_LEN + dst_align, len);
+            }
+        }
+    }
+}
+
+void test_memset_returns_dest(void)
+{
+    TEST_ASSERT_EQUAL_PTR(dst_buf + 3, memset(dst_buf + 3, 0, 29));
+    TEST_ASSERT_EQUAL_PTR(dst_buf, memset(dst_buf, 0, 0));
+}
+
+void test_memset_all_alignments_and_lengths(void)
+{
+    size_t dst_align, len;
+
+    for (dst_align = 0; dst_align < sizeof(uint32_t); dst_align++) {
+        for (len = 0; len <= MAX_LEN; len++) {
+            fill_byte(dst_buf, BUF_LEN, FILL_BYTE);
+
+            /* Only the low byte of the value is used */
+            memset(dst_buf + GUARD_LEN + dst_align, 0x1C3, len);
+
+            check_set(GUARD_LEN + dst_align, len, 0xC3);
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#-------------------------------------------------------------------------------
+# SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+#-------------------------------------------------------------------------------
+
+set(CRT_SOURCE_DIR ${TFM_ROOT_DIR}/secure_fw/shared)
+
+#-------------------------------------------------------------------------------
+# Unit under test
+#-------------------------------------------------------------------------------
+set(UNIT_UNDER_TEST
+    ${CRT_SOURCE_DIR}/crt_memcpy.c
+    ${CRT_SOURCE_DIR}/crt_memset.c
+)
+
+#-------------------------------------------------------------------------------
+# Test suite
+#-------------------------------------------------------------------------------
+set(UNIT_TEST_SUITE ${CMAKE_CURRENT_LIST_DIR}/test_crt_mem.c)
+
+#-------------------------------------------------------------------------------
+# Dependencies
+#-------------------------------------------------------------------------------
+
+#-------------------------------------------------------------------------------
+# Include dirs
+#-------------------------------------------------------------------------------
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/config)
+
+#-------------------------------------------------------------------------------
+# Compiledefs for UUT
+#-------------------------------------------------------------------------------
+
+#-------------------------------------------------------------------------------
+# Mocks for UUT
+#-------------------------------------------------------------------------------
+
+#-------------------------------------------------------------------------------
+# Labels for UT (Optional, tests can be grouped by labels)
+#-------------------------------------------------------------------------------
+list(APPEND UT_LABELS "LIBRARIES")
@@ -111,9 +111,9 @@ static uint32_t query_state(const struct thread_t *p_thrd, uint32_t *p_retval)
              */
             *p_retval = (uint32_t)p_pt->p_replied->replied_value;
             if (p_pt->p_replied->status == TFM_HANDLE_STATUS_TO_FREE) {
-                spm_free_connection(p_pt->p_replied);
+                spm_release_connection(p_pt->p_replied);
             }
-            p_pt->p_replied = NULL;
+            UNI_QUEUE_INIT(p_pt->p_replied, p_pt->p_replied_tail);
         } else {
             *p_retval = retval_signals;
         }
@@ -198,6 +198,7 @@ static void prv_process_metadata(struct partition_t *p_pt)
 psa_status_t backend_messaging(struct connection_t *p_connection)
 {
     struct partition_t *p_owner = NULL;
+    struct service_t *p_service = NULL;
     psa_signal_t signal = 0;
     psa_status_t ret = PSA_SUCCESS;
     struct critical_section_t cs = CRITICAL_SECTION_STATIC_INIT;
@@ -211,8 +212,12 @@ psa_status_t backend_messaging(struct connection_t *p_connection)
     p_owner = p_connection->service->partition;
     signal = p_connection->service->p_ldinf->signal;
 
+    /* The writable runtime service which holds the request queue */
+    p_service = &p_owner->p_services[p_connection->service - p_owner->p_services];
+
     CRITICAL_SECTION_ENTER(cs);
-    UNI_LIST_INSERT_AFTER(p_owner, p_connection, p_reqs);
+    UNI_QUEUE_PUSH_TAIL(p_service->p_reqs_head, p_service->p_reqs_tail,
+                        p_connection, p_reqs);
     CRITICAL_SECTION_LEAVE(cs);
 
     /* Messages put. Update signals */
@@ -245,12 +250,13 @@ psa_status_t backend_replying(struct connection_t *handle, int32_t status)
     /* Mount the replied handle. There are two mode for replying.
      *
      *  - For synchronous reply, only one node is mounted.
-     *  - For asynchronous reply, the first moundted is at the tail of the list
-     *    and will be first replied.
+     *  - For asynchronous reply, the first mounted is at the head of the
+     *    queue and will be first replied.
      *    - Currently, this is used for mailbox multi-core technology.
      */
     CRITICAL_SECTION_ENTER(cs);
-    UNI_LIST_INSERT_AFTER(client, handle, p_replied);
+    UNI_QUEUE_PUSH_TAIL(client->p_replied, client->p_replied_tail,
+                        handle, p_replied);
     CRITICAL_SECTION_LEAVE(cs);
 
     return backend_assert_signal(handle->p_client, ASYNC_MSG_REPLY);
@@ -262,6 +268,7 @@ static thrd_fn_t partition_init(struct partition_t *p_pt,
                                 uint32_t service_setting, uint32_t *param)
 {
     thrd_fn_t thrd_entry;
+    uint32_t i;
 
     (void)param;
     assert(p_pt);
@@ -277,8 +284,11 @@ static thrd_fn_t partition_init(struct partition_t *p_pt,
         p_pt->signals_allowed |= ASYNC_MSG_REPLY;
     }
 
-    UNI_LIST_INIT_NODE(p_pt, p_reqs);
-    UNI_LIST_INIT_NODE(p_pt, p_replied);
+    for (i = 0; i < p_pt->p_ldinf->nservices; i++) {
+        UNI_QUEUE_INIT(p_pt->p_services[i].p_reqs_head,
+                       p_pt->p_services[i].p_reqs_tail);
+    }
+    UNI_QUEUE_INIT(p_pt->p_replied, p_pt->p_replied_tail);
 
     if (IS_IPC_MODEL(p_pt->p_ldinf)) {
         /* IPC Partition */
@@ -413,6 +423,7 @@ psa_signal_t backend_wait_signals(struct partition_t *p_pt, psa_signal_t signals
     ret = p_pt->signals_asserted & signals;
     if (ret == (psa_signal_t)0) {
         p_pt->signals_waiting = signals;
+        thrd_clear_ready(&p_pt->thrd);
     }
 
     CRITICAL_SECTION_LEAVE(cs_signal);
@@ -502,6 +513,7 @@ psa_status_t backend_assert_signal(struct partition_t *p_pt, psa_signal_t signal
 #endif
 
     if (p_pt->signals_asserted & p_pt->signals_waiting) {
+        thrd_set_ready(&p_pt->thrd);
         ret = STATUS_NEED_SCHEDULE;
     }
     CRITICAL_SECTION_LEAVE(cs_signal);
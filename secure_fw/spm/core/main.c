@@ -145,6 +145,9 @@ int main(void)
     }
 #endif
 
+    /* Write out boot logs before partitions start to run */
+    tfm_log_flush();
+
     /* Further SPM initialization. */
     BACKEND_SPM_INIT();
 
@@ -183,7 +183,7 @@ psa_status_t tfm_spm_client_psa_call(psa_handle_t handle,
     status = spm_associate_call_params(p_connection, ctrl_param, inptr, outptr);
     if (status != PSA_SUCCESS) {
         if (IS_STATIC_HANDLE(handle)) {
-            spm_free_connection(p_connection);
+            spm_release_connection(p_connection);
         }
         return status;
     }
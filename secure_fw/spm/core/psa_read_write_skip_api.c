@@ -14,6 +14,27 @@
 #include "tfm_hal_isolation.h"
 #include "coverity_check.h"
 
+#if CONFIG_TFM_SPM_COPY_ENGINE_THRESHOLD > 0
+#include "tfm_hal_copy_engine.h"
+#endif
+
+/*
+ * Copies IOVEC data between a client and a service. Both buffers have been
+ * checked by the caller, so large transfers can be handed to the platform copy
+ * engine, with the CPU copy as a fallback whenever the engine declines.
+ */
+static void spm_iovec_copy(void *dest, const void *src, size_t n)
+{
+#if CONFIG_TFM_SPM_COPY_ENGINE_THRESHOLD > 0
+    if ((n >= CONFIG_TFM_SPM_COPY_ENGINE_THRESHOLD) &&
+        (tfm_hal_copy_engine_copy(dest, src, n) == TFM_HAL_SUCCESS)) {
+        return;
+    }
+#endif
+
+    spm_memcpy(dest, src, n);
+}
+
 size_t tfm_spm_partition_psa_read(psa_handle_t msg_handle, uint32_t invec_idx,
                                   void *buffer, size_t num_bytes)
 {
@@ -82,8 +103,8 @@ size_t tfm_spm_partition_psa_read(psa_handle_t msg_handle, uint32_t invec_idx,
 
     bytes = (num_bytes < remaining) ? num_bytes : remaining;
 
-    spm_memcpy(buffer, (char *)handle->invec_base[invec_idx] +
-                               handle->invec_accessed[invec_idx], bytes);
+    spm_iovec_copy(buffer, (char *)handle->invec_base[invec_idx] +
+                                   handle->invec_accessed[invec_idx], bytes);
 
     /* Update the data size read */
     handle->invec_accessed[invec_idx] += bytes;
@@ -229,8 +250,8 @@ psa_status_t tfm_spm_partition_psa_write(psa_handle_t msg_handle, uint32_t outve
         tfm_core_panic();
     }
 
-    spm_memcpy((char *)handle->outvec_base[outvec_idx] +
-               handle->outvec_written[outvec_idx], buffer, num_bytes);
+    spm_iovec_copy((char *)handle->outvec_base[outvec_idx] +
+                   handle->outvec_written[outvec_idx], buffer, num_bytes);
 
     /* Update the data size written */
     handle->outvec_written[outvec_idx] += num_bytes;
@@ -176,17 +176,36 @@ struct partition_t *load_a_partition_assuredly(struct partition_head_t *head)
     return partition;
 }
 
+uint32_t sorted_sid_tbl_index(uint32_t sid)
+{
+    uint32_t lo = 0, hi = sorted_sid_tbl_num, mid;
+
+    while (lo < hi) {
+        mid = lo + ((hi - lo) / 2);
+        if (sorted_sid_tbl[mid] < sid) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if ((lo < sorted_sid_tbl_num) && (sorted_sid_tbl[lo] == sid)) {
+        return lo;
+    }
+
+    return sorted_sid_tbl_num;
+}
+
 uint32_t load_services_assuredly(struct partition_t *p_partition,
-                                 struct service_head_t *services_listhead,
                                  struct service_t **stateless_services_ref_tbl,
                                  size_t ref_tbl_size)
 {
-    uint32_t i, serv_ldflags, hidx, service_setting = 0;
+    uint32_t i, serv_ldflags, hidx, sidx, service_setting = 0;
     struct service_t *services;
     const struct partition_load_info_t *p_ptldinf;
     const struct service_load_info_t *p_servldinf;
 
-    if (!p_partition || !services_listhead) {
+    if (!p_partition) {
         tfm_core_panic();
     }
 
@@ -198,10 +217,12 @@ uint32_t load_services_assuredly(struct partition_t *p_partition,
      * The loop won't go in the NULL case.
      */
     services = tfm_allocate_service_assuredly(p_ptldinf->nservices);
+#if CONFIG_TFM_SPM_BACKEND_IPC == 1
+    p_partition->p_services = services;
+#endif
     for (i = 0; (i < p_ptldinf->nservices) && services; i++) {
         services[i].p_ldinf = &p_servldinf[i];
         services[i].partition = p_partition;
-        services[i].next = NULL;
 
         BACKEND_SERVICE_SET(service_setting, &p_servldinf[i]);
 
@@ -224,7 +245,12 @@ uint32_t load_services_assuredly(struct partition_t *p_partition,
             stateless_services_ref_tbl[hidx] = &services[i];
         }
 
-        UNI_LIST_INSERT_AFTER(services_listhead, &services[i], next);
+        /* Bind the service to its SID in the sorted SID table */
+        sidx = sorted_sid_tbl_index(p_servldinf[i].sid);
+        if ((sidx >= sorted_sid_tbl_num) || sorted_services_ref_tbl[sidx]) {
+            tfm_core_panic();
+        }
+        sorted_services_ref_tbl[sidx] = &services[i];
     }
 
     return service_setting;
@@ -27,7 +27,8 @@ enum connection_status {
     TFM_HANDLE_STATUS_IDLE = 0,     /* Handle created, idle */
     TFM_HANDLE_STATUS_ACTIVE = 1,   /* Handle in use */
     TFM_HANDLE_STATUS_TO_FREE = 2,  /* Handle to be freed */
-    TFM_HANDLE_STATUS_MAX = 3,
+    TFM_HANDLE_STATUS_PARKED = 3,   /* Kept by a stateless service for reuse */
+    TFM_HANDLE_STATUS_MAX = 4,
 
     _TFM_HANDLE_STATUS_PAD = UINT32_MAX,
 };
@@ -112,11 +113,13 @@ struct partition_t {
     const struct runtime_metadata_t    *p_metadata;
     struct context_ctrl_t              ctx_ctrl;
     struct thread_t                    thrd;       /* IPC model */
-    struct connection_t                *p_replied; /* Handle(s) to record replied connections */
+    struct connection_t                *p_replied; /* Oldest replied connection not yet taken */
+    struct connection_t                *p_replied_tail; /* Newest replied connection */
+    struct service_t                   *p_services; /* Runtime services, request queues inside */
 #else
     uint32_t                           state;      /* SFN model */
-#endif
     struct connection_t                *p_reqs;    /* Handle(s) to record request connections to service. */
+#endif
     struct partition_t                 *next;
 };
 
@@ -124,7 +127,14 @@ struct partition_t {
 struct service_t {
     const struct service_load_info_t *p_ldinf;     /* Service load info      */
     struct partition_t *partition;                 /* Owner of the service   */
-    struct service_t *next;                        /* For list operation     */
+#if CONFIG_TFM_SPM_BACKEND_IPC == 1
+    struct connection_t *p_reqs_head;              /* Oldest pending request */
+    struct connection_t *p_reqs_tail;              /* Newest pending request */
+    struct connection_t *p_idle_conn;              /* Stateless connection kept for reuse */
+    const struct partition_t *p_granted_client;    /* Last client granted access */
+    uint32_t granted_version;                      /* Version requested by it */
+    bool granted_ns_caller;                        /* Granted to a NS caller */
+#endif
 };
 
 /**
@@ -144,27 +154,42 @@ psa_status_t spm_validate_connection(const struct connection_t *p_connection);
 /* Panic if invalid connection is given. */
 void spm_free_connection(struct connection_t *p_connection);
 
+/*
+ * Release a connection which finished its work. In the IPC backend, the
+ * connection of a stateless service is kept by the service to serve its next
+ * request if it does not hold one yet. Otherwise it is freed.
+ */
+void spm_release_connection(struct connection_t *p_connection);
+
+#if CONFIG_TFM_SPM_BACKEND_IPC == 1
+/*
+ * Take back a stateless connection kept by a service. Called when the
+ * connection pool runs out, so that kept connections never make an allocation
+ * fail. Returns NULL if no service keeps one.
+ */
+struct connection_t *spm_reclaim_idle_connection(void);
+#endif
+
 /******************** Partition management functions *************************/
 
 #if CONFIG_TFM_SPM_BACKEND_IPC == 1
 
 /*
  * Get the replied handles in the asynchnorous reply mode. The first handle to
- * be replied is at the tail of list. Take the handle one by one and clean the
- * asynchronous signal after all handles are operated.
+ * be replied is at the head of the queue. Take the handle one by one and clean
+ * the asynchronous signal after all handles are operated.
  */
 struct connection_t *spm_get_async_replied_handle(struct partition_t *partition);
 
 /*
- * Lookup and grab the last spotted handles containing the message
- * by the given signal. Only ONE signal bit can be accepted in 'signal',
- * multiple bits lead to 'no matched handles found to that signal'.
+ * Grab the oldest handle in the request queue of the service owning the given
+ * signal. Only ONE signal bit can be accepted in 'signal', multiple bits lead
+ * to 'no matched handles found to that signal'.
  *
  * Returns NULL if no handles matched with the given signal.
  * Returns an internal handle instance if spotted, the instance
- * is moved out of partition handles. Partition available signals
- * also get updated based on the count of handles with given signal
- * still in the partition handles.
+ * is moved out of the service queue. The signal is cleared from the
+ * partition asserted signals once the queue becomes empty.
  */
 struct connection_t *spm_get_handle_by_signal(struct partition_t *p_ptn,
                                               psa_signal_t signal);
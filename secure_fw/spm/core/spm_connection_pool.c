@@ -21,9 +21,29 @@
 #endif
 
 /* Pools */
+#if CONFIG_TFM_CONN_POOL_BITMAP == 1
+TFM_BITMAP_POOL_DECLARE(connection_pool, sizeof(struct connection_t),
+                        CONFIG_TFM_CONN_HANDLE_MAX_NUM);
+
+#define POOL_START                  ((uintptr_t)connection_pool->chunks)
+#define POOL_INIT(pool, num)        tfm_bitmap_pool_init(pool,                          \
+                                        BITMAP_POOL_BUFFER_SIZE(pool),                  \
+                                        sizeof(struct connection_t), num)
+#define POOL_ALLOC(pool)            tfm_bitmap_pool_alloc(pool)
+#define POOL_FREE(pool, ptr)        tfm_bitmap_pool_free(pool, ptr)
+#define POOL_IS_VALID(pool, ptr)    is_valid_chunk_data_in_bitmap_pool(pool, ptr)
+#else
 TFM_POOL_DECLARE(connection_pool, sizeof(struct connection_t),
                  CONFIG_TFM_CONN_HANDLE_MAX_NUM);
 
+#define POOL_START                  ((uintptr_t)connection_pool)
+#define POOL_INIT(pool, num)        tfm_pool_init(pool, POOL_BUFFER_SIZE(pool),         \
+                                                  sizeof(struct connection_t), num)
+#define POOL_ALLOC(pool)            tfm_pool_alloc(pool)
+#define POOL_FREE(pool, ptr)        tfm_pool_free(pool, ptr)
+#define POOL_IS_VALID(pool, ptr)    is_valid_chunk_data_in_pool(pool, ptr)
+#endif /* CONFIG_TFM_CONN_POOL_BITMAP == 1 */
+
 /*********************** Connection handle conversion APIs *******************/
 
 #define CONVERSION_FACTOR_BITOFFSET    3
@@ -66,11 +86,11 @@ psa_handle_t connection_to_handle(struct connection_t *p_connection)
 {
     psa_handle_t handle;
 
-    assert(is_valid_chunk_data_in_pool(connection_pool, (uint8_t *)p_connection));
+    assert(POOL_IS_VALID(connection_pool, (uint8_t *)p_connection));
 
     loop_index = (loop_index + 1) % CONVERSION_FACTOR_VALUE;
     handle = (psa_handle_t)((((uintptr_t)p_connection -
-                  (uintptr_t)connection_pool) << CONVERSION_FACTOR_BITOFFSET) +
+                  POOL_START) << CONVERSION_FACTOR_BITOFFSET) +
                   CLIENT_HANDLE_VALUE_MIN + loop_index);
 
     return handle;
@@ -102,9 +122,9 @@ struct connection_t *handle_to_connection(psa_handle_t handle)
 
     p_connection = (struct connection_t *)((((uintptr_t)handle -
                     CLIENT_HANDLE_VALUE_MIN) >> CONVERSION_FACTOR_BITOFFSET) +
-                    (uintptr_t)connection_pool);
+                    POOL_START);
 
-    assert(is_valid_chunk_data_in_pool(connection_pool, (uint8_t *)p_connection));
+    assert(POOL_IS_VALID(connection_pool, (uint8_t *)p_connection));
 
     return p_connection;
 }
@@ -112,25 +132,33 @@ struct connection_t *handle_to_connection(psa_handle_t handle)
 /* Service handle management functions */
 void spm_init_connection_space(void)
 {
-    if (tfm_pool_init(connection_pool,
-                      POOL_BUFFER_SIZE(connection_pool),
-                      sizeof(struct connection_t),
-                      CONFIG_TFM_CONN_HANDLE_MAX_NUM) != PSA_SUCCESS) {
+    if (POOL_INIT(connection_pool,
+                  CONFIG_TFM_CONN_HANDLE_MAX_NUM) != PSA_SUCCESS) {
         tfm_core_panic();
     }
 }
 
 struct connection_t *spm_allocate_connection(void)
 {
+    struct connection_t *p_connection;
+
     TFM_COVERITY_DEVIATE_LINE(MISRA_C_2023_Rule_11_5, "It's API design to use pointer to void")
-    return (struct connection_t *)tfm_pool_alloc(connection_pool);
+    p_connection = (struct connection_t *)POOL_ALLOC(connection_pool);
+
+#if CONFIG_TFM_SPM_BACKEND_IPC == 1
+    /* Connections kept by stateless services go back to any new user */
+    if (p_connection == NULL) {
+        p_connection = spm_reclaim_idle_connection();
+    }
+#endif
+
+    return p_connection;
 }
 
 psa_status_t spm_validate_connection(const struct connection_t *p_connection)
 {
     /* Check the handle address is valid */
-    if (is_valid_chunk_data_in_pool(connection_pool,
-                                    (uint8_t *)p_connection) != true) {
+    if (POOL_IS_VALID(connection_pool, (uint8_t *)p_connection) != true) {
         return SPM_ERROR_GENERIC;
     }
 
@@ -142,5 +170,5 @@ void spm_free_connection(struct connection_t *p_connection)
     assert(p_connection != NULL);
 
     /* Return handle buffer to pool */
-    tfm_pool_free(connection_pool, p_connection);
+    POOL_FREE(connection_pool, p_connection);
 }
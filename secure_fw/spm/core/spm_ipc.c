@@ -42,8 +42,7 @@
 #include "tfm_nspm.h"
 #include "uart_stdout.h"
 
-/* Partition and service runtime data list head/runtime data table */
-static struct service_head_t services_listhead;
+/* Stateless service runtime data table */
 struct service_t *stateless_services_ref_tbl[STATIC_HANDLE_NUM_LIMIT];
 
 /* Partition management functions */
@@ -52,20 +51,16 @@ struct service_t *stateless_services_ref_tbl[STATIC_HANDLE_NUM_LIMIT];
 #if CONFIG_TFM_SPM_BACKEND_IPC == 1
 struct connection_t *spm_get_async_replied_handle(struct partition_t *partition)
 {
-    struct connection_t **pr_handle_iter, **prev = NULL, *handle = NULL;
+    struct connection_t *handle;
     struct critical_section_t cs_assert = CRITICAL_SECTION_STATIC_INIT;
 
-    /* Remove tail of the list, which is the first item added */
+    /* Take the head of the queue, which is the first item added */
     CRITICAL_SECTION_ENTER(cs_assert);
-    if (!partition->p_replied) {
+    UNI_QUEUE_POP_HEAD(partition->p_replied, partition->p_replied_tail,
+                       handle, p_replied);
+    if (!handle) {
         tfm_core_panic();
     }
-    UNI_LIST_FOREACH_NODE_PNODE(pr_handle_iter, handle,
-                                partition, p_replied) {
-        prev = pr_handle_iter;
-    }
-    handle = *prev;
-    UNI_LIST_REMOVE_NODE_BY_PNODE(prev, p_replied);
 
     /* Clear the signal if there are no more asynchronous responses waiting */
     if (!partition->p_replied) {
@@ -79,49 +74,48 @@ struct connection_t *spm_get_async_replied_handle(struct partition_t *partition)
 struct connection_t *spm_get_handle_by_signal(struct partition_t *p_ptn,
                                               psa_signal_t signal)
 {
-    struct connection_t *p_handle_iter = NULL;
-    struct connection_t **pr_handle_iter, **last_found_handle_holder = NULL;
+    struct connection_t *p_handle = NULL;
+    struct service_t *p_service = NULL;
     struct critical_section_t cs_assert = CRITICAL_SECTION_STATIC_INIT;
-    uint32_t nr_found_msgs = 0;
+    uint32_t i;
 
-    CRITICAL_SECTION_ENTER(cs_assert);
-
-    /* Return the last found message which applies a FIFO mechanism. */
-    UNI_LIST_FOREACH_NODE_PNODE(pr_handle_iter, p_handle_iter,
-                                p_ptn, p_reqs) {
-        if (p_handle_iter->service->p_ldinf->signal == signal) {
-            last_found_handle_holder = pr_handle_iter;
-            nr_found_msgs++;
+    /* Each service has its own signal and request queue */
+    for (i = 0; i < p_ptn->p_ldinf->nservices; i++) {
+        if (p_ptn->p_services[i].p_ldinf->signal == signal) {
+            p_service = &p_ptn->p_services[i];
+            break;
         }
     }
 
-    if (last_found_handle_holder) {
-        p_handle_iter = *last_found_handle_holder;
-        UNI_LIST_REMOVE_NODE_BY_PNODE(last_found_handle_holder, p_reqs);
+    if (!p_service) {
+        return NULL;
+    }
 
-        if (nr_found_msgs == 1) {
-            p_ptn->signals_asserted &= ~signal;
-        }
+    CRITICAL_SECTION_ENTER(cs_assert);
+
+    /* The head of the queue is the oldest message, which keeps FIFO order. */
+    UNI_QUEUE_POP_HEAD(p_service->p_reqs_head, p_service->p_reqs_tail,
+                       p_handle, p_reqs);
+
+    if (!p_service->p_reqs_head) {
+        p_ptn->signals_asserted &= ~signal;
     }
 
     CRITICAL_SECTION_LEAVE(cs_assert);
 
-    return p_handle_iter;
+    return p_handle;
 }
 #endif /* CONFIG_TFM_SPM_BACKEND_IPC == 1 */
 
 const struct service_t *tfm_spm_get_service_by_sid(uint32_t sid)
 {
-    struct service_t *p_prev, *p_curr;
+    uint32_t idx = sorted_sid_tbl_index(sid);
 
-    UNI_LIST_FOREACH_NODE_PREV(p_prev, p_curr, &services_listhead, next) {
-        if (p_curr->p_ldinf->sid == sid) {
-            UNI_LIST_MOVE_AFTER(&services_listhead, p_prev, p_curr, next);
-            return p_curr;
-        }
+    if (idx >= sorted_sid_tbl_num) {
+        return NULL;
     }
 
-    return NULL;
+    return sorted_services_ref_tbl[idx];
 }
 
 #if CONFIG_TFM_DOORBELL_API == 1
@@ -204,13 +198,56 @@ int32_t tfm_spm_check_authorization(uint32_t sid,
     return PSA_SUCCESS;
 }
 
+#if CONFIG_TFM_SPM_BACKEND_IPC == 1
+struct connection_t *spm_reclaim_idle_connection(void)
+{
+    struct connection_t *connection;
+    uint32_t i;
+
+    for (i = 0; i < STATIC_HANDLE_NUM_LIMIT; i++) {
+        if (stateless_services_ref_tbl[i] &&
+            stateless_services_ref_tbl[i]->p_idle_conn) {
+            connection = stateless_services_ref_tbl[i]->p_idle_conn;
+            stateless_services_ref_tbl[i]->p_idle_conn = NULL;
+            return connection;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Prepare a kept stateless connection for a new request. The service and the
+ * connection stay bound, so only the per-request fields are reset.
+ */
+static void reuse_idle_connection(struct connection_t *p_connection,
+                                  int32_t client_id)
+{
+    p_connection->p_client = GET_CURRENT_COMPONENT();
+    p_connection->msg.client_id = client_id;
+    p_connection->msg.rhandle = NULL;
+    spm_memset(p_connection->msg.in_size, 0, sizeof(p_connection->msg.in_size));
+    spm_memset(p_connection->msg.out_size, 0, sizeof(p_connection->msg.out_size));
+    p_connection->msg.handle = connection_to_handle(p_connection);
+
+    p_connection->status = TFM_HANDLE_STATUS_IDLE;
+#if PSA_FRAMEWORK_HAS_MM_IOVEC
+    p_connection->iovec_status = 0;
+#endif
+
+#ifdef TFM_PARTITION_NS_AGENT_MAILBOX
+    p_connection->client_data = NULL;
+#endif
+}
+#endif /* CONFIG_TFM_SPM_BACKEND_IPC == 1 */
+
 /* Message functions */
 psa_status_t spm_get_idle_connection(struct connection_t **p_connection,
                                      psa_handle_t handle,
                                      int32_t client_id)
 {
     struct connection_t *connection;
-    const struct service_t *service;
+    struct service_t *service;
     uint32_t sid, version, index;
     int32_t psa_ret;
     bool ns_caller;
@@ -234,21 +271,46 @@ psa_status_t spm_get_idle_connection(struct connection_t **p_connection,
 
         sid = service->p_ldinf->sid;
         ns_caller = tfm_spm_is_ns_caller();
+        version = GET_VERSION_FROM_STATIC_HANDLE(handle);
 
+#if CONFIG_TFM_SPM_BACKEND_IPC == 1
         /*
-         * It is a PROGRAMMER ERROR if the caller is not authorized to access
-         * the RoT Service.
+         * Authorization and version policies only depend on the static load
+         * information, the caller and the requested version. Skip them if the
+         * last granted request to this service had the same inputs.
          */
-        psa_ret = tfm_spm_check_authorization(sid, service, ns_caller);
-        if (psa_ret != PSA_SUCCESS) {
-            return PSA_ERROR_CONNECTION_REFUSED;
+        if ((service->p_granted_client != GET_CURRENT_COMPONENT()) ||
+            (service->granted_ns_caller != ns_caller) ||
+            (service->granted_version != version)) {
+#endif
+            /*
+             * It is a PROGRAMMER ERROR if the caller is not authorized to
+             * access the RoT Service.
+             */
+            psa_ret = tfm_spm_check_authorization(sid, service, ns_caller);
+            if (psa_ret != PSA_SUCCESS) {
+                return PSA_ERROR_CONNECTION_REFUSED;
+            }
+
+            if (tfm_spm_check_client_version(service, version) != PSA_SUCCESS) {
+                return PSA_ERROR_PROGRAMMER_ERROR;
+            }
+#if CONFIG_TFM_SPM_BACKEND_IPC == 1
+            service->p_granted_client = GET_CURRENT_COMPONENT();
+            service->granted_ns_caller = ns_caller;
+            service->granted_version = version;
         }
 
-        version = GET_VERSION_FROM_STATIC_HANDLE(handle);
+        /* Reuse the connection kept by the service from its last request */
+        connection = service->p_idle_conn;
+        if (connection != NULL) {
+            service->p_idle_conn = NULL;
+            reuse_idle_connection(connection, client_id);
+            *p_connection = connection;
 
-        if (tfm_spm_check_client_version(service, version) != PSA_SUCCESS) {
-            return PSA_ERROR_PROGRAMMER_ERROR;
+            return PSA_SUCCESS;
         }
+#endif
 
         /*
          * Current SPM doesn't support multiple context management. There is
@@ -325,9 +387,40 @@ struct connection_t *spm_msg_handle_to_connection(psa_handle_t msg_handle)
         return NULL;
     }
 
+    /* A stateless connection kept for reuse carries no message */
+    if (p_conn_handle->status == TFM_HANDLE_STATUS_PARKED) {
+        return NULL;
+    }
+
     return p_conn_handle;
 }
 
+void spm_release_connection(struct connection_t *p_connection)
+{
+#if CONFIG_TFM_SPM_BACKEND_IPC == 1
+    struct service_t *service;
+    uint32_t flags;
+
+    assert(p_connection != NULL);
+
+    flags = p_connection->service->p_ldinf->flags;
+    if (SERVICE_IS_STATELESS(flags)) {
+        service = stateless_services_ref_tbl[SERVICE_GET_STATELESS_HINDEX(flags)];
+        if (service->p_idle_conn == NULL) {
+            /*
+             * A parked connection is neither idle nor active, so that its
+             * connection or message handle is refused until it is reused.
+             */
+            p_connection->status = TFM_HANDLE_STATUS_PARKED;
+            service->p_idle_conn = p_connection;
+            return;
+        }
+    }
+#endif
+
+    spm_free_connection(p_connection);
+}
+
 void spm_init_idle_connection(struct connection_t *p_connection,
                               const struct service_t *service,
                               int32_t client_id)
@@ -404,7 +497,6 @@ uint32_t tfm_spm_init(void)
     spm_init_connection_space();
 
     UNI_LIST_INIT_NODE(PARTITION_LIST_ADDR, next);
-    UNI_LIST_INIT_NODE(&services_listhead, next);
 
     /* Init the nonsecure context. */
     tfm_nspm_ctx_init();
@@ -417,7 +509,6 @@ uint32_t tfm_spm_init(void)
 
         service_setting = load_services_assuredly(
                                 partition,
-                                &services_listhead,
                                 stateless_services_ref_tbl,
                                 sizeof(stateless_services_ref_tbl));
 
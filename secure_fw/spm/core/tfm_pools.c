@@ -48,8 +48,10 @@ psa_status_t tfm_pool_init(struct tfm_pool_instance_t *pool, size_t poolsz,
     pchunk = (struct tfm_pool_chunk_t *)pool->chunks;
     for (i = 0; i < num; i++) {
         UNI_LIST_INSERT_AFTER(pool, pchunk, next);
+        /* Step by the same stride is_valid_chunk_data_in_pool() checks */
         TFM_COVERITY_DEVIATE_LINE(MISRA_C_2023_Rule_11_3, "Intentional pointer cast");
-        pchunk = (struct tfm_pool_chunk_t *)&pchunk->data[chunksz];
+        pchunk = (struct tfm_pool_chunk_t *)((uint8_t *)pchunk +
+                                             sizeof(struct tfm_pool_chunk_t) + chunksz);
     }
 
     /* Prepare instance and insert to pool list */
@@ -132,3 +134,92 @@ bool is_valid_chunk_data_in_pool(struct tfm_pool_instance_t *pool,
 
     return true;
 }
+
+#define BITMAP_POOL_BIT(idx)    (1UL << (31U - ((idx) % 32U)))
+
+psa_status_t tfm_bitmap_pool_init(struct tfm_bitmap_pool_t *pool,
+                                  size_t poolsz, size_t chunksz, size_t num)
+{
+    size_t i;
+
+    if (!pool || !pool->bitmap || !pool->chunks || (num == 0)) {
+        return SPM_ERROR_BAD_PARAMETERS;
+    }
+
+    /* Ensure buffer is large enough */
+    if (poolsz != (TFM_BITMAP_POOL_STRIDE(chunksz) * num)) {
+        return SPM_ERROR_BAD_PARAMETERS;
+    }
+
+    /* Buffer should be BSS cleared but clear it again */
+    spm_memset(pool->chunks, 0, poolsz);
+
+    /* Mark all chunks as free */
+    for (i = 0; i < TFM_BITMAP_POOL_WORDS(num); i++) {
+        pool->bitmap[i] = 0;
+    }
+    for (i = 0; i < num; i++) {
+        pool->bitmap[i / 32] |= BITMAP_POOL_BIT(i);
+    }
+
+    pool->stride = TFM_BITMAP_POOL_STRIDE(chunksz);
+    pool->chunksz = chunksz;
+    pool->num = num;
+
+    return PSA_SUCCESS;
+}
+
+void *tfm_bitmap_pool_alloc(struct tfm_bitmap_pool_t *pool)
+{
+    size_t i, idx;
+
+    assert(pool != NULL);
+
+    for (i = 0; i < TFM_BITMAP_POOL_WORDS(pool->num); i++) {
+        if (pool->bitmap[i] != 0) {
+            idx = (i * 32) + __CLZ(pool->bitmap[i]);
+            pool->bitmap[i] &= ~BITMAP_POOL_BIT(idx);
+            return &pool->chunks[idx * pool->stride];
+        }
+    }
+
+    return NULL;
+}
+
+void tfm_bitmap_pool_free(struct tfm_bitmap_pool_t *pool, void *ptr)
+{
+    size_t idx;
+
+    /* In debug builds, trap invalid frees. */
+    assert(is_valid_chunk_data_in_bitmap_pool(pool, ptr));
+
+    idx = ((uintptr_t)ptr - (uintptr_t)pool->chunks) / pool->stride;
+    pool->bitmap[idx / 32] |= BITMAP_POOL_BIT(idx);
+
+    /* In debug builds, overwrite the data to catch use-after-free bugs. */
+#ifndef NDEBUG
+    spm_memset(ptr, 0xFF, pool->chunksz);
+#endif
+}
+
+bool is_valid_chunk_data_in_bitmap_pool(struct tfm_bitmap_pool_t *pool,
+                                        uint8_t *data)
+{
+    size_t offset, idx;
+
+    if (pool == NULL) {
+        return false;
+    }
+
+    offset = (uintptr_t)data - (uintptr_t)pool->chunks;
+
+    /* Wraps around for data below the chunk array */
+    if ((offset >= (pool->stride * pool->num)) ||
+        ((offset % pool->stride) != 0)) {
+        return false;
+    }
+
+    idx = offset / pool->stride;
+
+    return (pool->bitmap[idx / 32] & BITMAP_POOL_BIT(idx)) == 0;
+}
@@ -8,6 +8,7 @@
 #define __TFM_POOLS_H__
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "psa/error.h"
 #include "lists.h"
 
@@ -100,4 +101,99 @@ void tfm_pool_free(struct tfm_pool_instance_t *pool, void *ptr);
 bool is_valid_chunk_data_in_pool(struct tfm_pool_instance_t *pool,
                                  uint8_t *data);
 
+/*
+ * Bitmap Pool Instance:
+ *  [ Pool Instance ] -> [ Free bitmap ] + N * [ Dense aligned chunks ]
+ *
+ * Chunk state is kept in a packed bitmap beside the chunk array instead of a
+ * per-chunk header. A set bit marks a free chunk. Chunk 'n' is tracked by bit
+ * (31 - n % 32) of word 'n / 32', so CLZ finds the lowest free chunk.
+ */
+#define TFM_BITMAP_POOL_CHUNK_ALIGN     32
+
+/* Stride of chunks in the bitmap pool, aligned to the chunk alignment */
+#define TFM_BITMAP_POOL_STRIDE(chunksz)                                     \
+    (((chunksz) + TFM_BITMAP_POOL_CHUNK_ALIGN - 1) &                        \
+     ~((size_t)TFM_BITMAP_POOL_CHUNK_ALIGN - 1))
+
+/* Number of 32-bit words in the bitmap of 'num' chunks */
+#define TFM_BITMAP_POOL_WORDS(num)      (((num) + 31) / 32)
+
+struct tfm_bitmap_pool_t {
+    uint32_t *bitmap;                     /* Free chunk bitmap              */
+    uint8_t *chunks;                      /* Chunk array                    */
+    size_t stride;                        /* Chunk stride in bytes          */
+    size_t chunksz;                       /* Chunks size of pool member     */
+    size_t num;                           /* Number of chunks               */
+};
+
+/*
+ * This will declare a static bitmap pool variable with chunk memory.
+ * Parameters:
+ *  name        -   Variable name, will be used when register
+ *  chunksz     -   chunk size in bytes
+ *  num         -   Number of chunks
+ */
+#define TFM_BITMAP_POOL_DECLARE(name, chunksz, num)                         \
+    static uint32_t name##_bitmap[TFM_BITMAP_POOL_WORDS(num)];              \
+    static uint8_t name##_chunks[TFM_BITMAP_POOL_STRIDE(chunksz) * (num)]   \
+                                __aligned(TFM_BITMAP_POOL_CHUNK_ALIGN);     \
+    static struct tfm_bitmap_pool_t name##_instance = {                     \
+        .bitmap = name##_bitmap,                                            \
+        .chunks = name##_chunks,                                            \
+    };                                                                      \
+    static struct tfm_bitmap_pool_t *name = &name##_instance
+
+/* Get the chunk array size of a bitmap pool */
+#define BITMAP_POOL_BUFFER_SIZE(name)   sizeof(name##_chunks)
+
+/**
+ * \brief Register a bitmap pool.
+ *
+ * \param[in] pool              Pointer to bitmap pool declared by
+ *                              \ref TFM_BITMAP_POOL_DECLARE
+ * \param[in] poolsz            Size of the chunk array.
+ * \param[in] chunksz           Size of chunks.
+ * \param[in] num               Number of chunks.
+ *
+ * \retval PSA_SUCCESS          Success.
+ * \retval SPM_ERROR_BAD_PARAMETERS Parameters error.
+ */
+psa_status_t tfm_bitmap_pool_init(struct tfm_bitmap_pool_t *pool,
+                                  size_t poolsz, size_t chunksz, size_t num);
+
+/**
+ * \brief Allocate a memory from bitmap pool.
+ *
+ * \param[in] pool              pool pointer declared by
+ *                              \ref TFM_BITMAP_POOL_DECLARE
+ *
+ * \retval buffer pointer       Success.
+ * \retval NULL                 Failed.
+ */
+void *tfm_bitmap_pool_alloc(struct tfm_bitmap_pool_t *pool);
+
+/**
+ * \brief Free the memory allocated from bitmap pool.
+ *
+ * \param[in] pool              pool pointer declared by
+ *                              \ref TFM_BITMAP_POOL_DECLARE
+ * \param[in] ptr               Buffer pointer want to free.
+ */
+void tfm_bitmap_pool_free(struct tfm_bitmap_pool_t *pool, void *ptr);
+
+/**
+ * \brief Checks whether a pointer points to a valid allocated chunk of data in
+ *        the bitmap pool.
+ *
+ * \param[in] pool              Pointer to bitmap pool declared by
+ *                              \ref TFM_BITMAP_POOL_DECLARE.
+ * \param[in] data              The pointer to check.
+ *
+ * \retval true                 Data is an allocated chunk in the pool.
+ * \retval false                Data is not an allocated chunk in the pool.
+ */
+bool is_valid_chunk_data_in_bitmap_pool(struct tfm_bitmap_pool_t *pool,
+                                        uint8_t *data);
+
 #endif /* __TFM_POOLS_H__ */
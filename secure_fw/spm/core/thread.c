@@ -20,7 +20,9 @@ struct thread_t *p_curr_thrd;
 
 /* Force ZERO in case ZI(bss) clear is missing. */
 static struct thread_t *p_thrd_head = NULL; /* Point to the first thread. */
+#if CONFIG_TFM_SPM_SCHED_READY_BITMAP != 1
 static struct thread_t *p_rnbl_head = NULL; /* Point to the first runnable. */
+#endif
 
 /* Define Macro to fetch global to support future expansion (PERCPU e.g.) */
 #define LIST_HEAD   p_thrd_head
@@ -34,6 +36,111 @@ void thrd_set_query_callback(thrd_query_state_t fn)
     query_state_cb = fn;
 }
 
+#if CONFIG_TFM_SPM_SCHED_READY_BITMAP == 1
+/*
+ * Ready bitmap. Threads are indexed by their position in the priority-sorted
+ * thread list, so the lowest set index is the highest priority ready thread.
+ * Index 'n' maps to bit (31 - n % 32) of word 'n / 32' so that CLZ yields the
+ * lowest index. Bit (31 - w) of the group word is set while word 'w' of the
+ * map is non-zero.
+ */
+#define RDY_WORD_BITS       32U
+#define RDY_WORD_NUM        ((CONFIG_TFM_SPM_THREAD_MAX_NUM + RDY_WORD_BITS - 1) / \
+                             RDY_WORD_BITS)
+#define RDY_BIT(n)          (1UL << ((RDY_WORD_BITS - 1U) - ((n) % RDY_WORD_BITS)))
+
+static uint32_t rdy_group;
+static uint32_t rdy_map[RDY_WORD_NUM];
+static struct thread_t *rdy_thrds[CONFIG_TFM_SPM_THREAD_MAX_NUM];
+
+void thrd_set_ready(struct thread_t *p_thrd)
+{
+    uint32_t word = p_thrd->rdy_idx / RDY_WORD_BITS;
+
+    p_thrd->flags |= THRD_FLAG_READY;
+    rdy_map[word] |= RDY_BIT(p_thrd->rdy_idx);
+    rdy_group |= RDY_BIT(word);
+}
+
+void thrd_clear_ready(struct thread_t *p_thrd)
+{
+    uint32_t word = p_thrd->rdy_idx / RDY_WORD_BITS;
+
+    p_thrd->flags &= ~THRD_FLAG_READY;
+    rdy_map[word] &= ~RDY_BIT(p_thrd->rdy_idx);
+    if (rdy_map[word] == 0) {
+        rdy_group &= ~RDY_BIT(word);
+    }
+}
+
+/*
+ * Re-index all threads after the thread list changed, and rebuild the
+ * bitmap from the per-thread ready flags.
+ */
+static void rdy_reindex(void)
+{
+    struct thread_t *p_thrd;
+    uint32_t idx = 0;
+
+    rdy_group = 0;
+    for (uint32_t i = 0; i < RDY_WORD_NUM; i++) {
+        rdy_map[i] = 0;
+    }
+
+    for (p_thrd = LIST_HEAD; p_thrd != NULL; p_thrd = p_thrd->next) {
+        if (idx >= CONFIG_TFM_SPM_THREAD_MAX_NUM) {
+            tfm_core_panic();
+        }
+
+        p_thrd->rdy_idx = (uint16_t)idx;
+        rdy_thrds[idx] = p_thrd;
+        if (p_thrd->flags & THRD_FLAG_READY) {
+            thrd_set_ready(p_thrd);
+        }
+        idx++;
+    }
+}
+
+struct thread_t *thrd_next(void)
+{
+    struct thread_t *p_thrd = NULL;
+    uint32_t retval = 0;
+    uint32_t word;
+    struct critical_section_t cs_signal = CRITICAL_SECTION_STATIC_INIT;
+
+    CRITICAL_SECTION_ENTER(cs_signal);
+
+    assert(query_state_cb != NULL);
+
+    /*
+     * The bitmap holds every thread that may be runnable. The highest
+     * priority candidate is confirmed by querying its state. Candidates
+     * which turn out to be blocked are dropped from the bitmap.
+     */
+    while (rdy_group != 0) {
+        word = __CLZ(rdy_group);
+        p_thrd = rdy_thrds[(word * RDY_WORD_BITS) + __CLZ(rdy_map[word])];
+
+        /* Change thread state if any signal changed */
+        p_thrd->state = query_state_cb(p_thrd, &retval);
+
+        if (p_thrd->state == THRD_STATE_RET_VAL_AVAIL) {
+            tfm_arch_set_context_ret_code(p_thrd->p_context_ctrl, retval);
+            p_thrd->state = THRD_STATE_RUNNABLE;
+        }
+
+        if (p_thrd->state == THRD_STATE_RUNNABLE) {
+            break;
+        }
+
+        thrd_clear_ready(p_thrd);
+        p_thrd = NULL;
+    }
+    CRITICAL_SECTION_LEAVE(cs_signal);
+
+    return p_thrd;
+}
+#else /* CONFIG_TFM_SPM_SCHED_READY_BITMAP == 1 */
 struct thread_t *thrd_next(void)
 {
     struct thread_t *p_thrd = RNBL_HEAD;
@@ -67,6 +174,7 @@ struct thread_t *thrd_next(void)
 
     return p_thrd;
 }
+#endif /* CONFIG_TFM_SPM_SCHED_READY_BITMAP == 1 */
 
 static void insert_by_prior(struct thread_t **head, struct thread_t *node)
 {
@@ -93,6 +201,10 @@ void thrd_start(struct thread_t *p_thrd, thrd_fn_t fn, thrd_fn_t exit_fn, void *
     /* Insert a new thread with priority */
     insert_by_prior(&LIST_HEAD, p_thrd);
 
+#if CONFIG_TFM_SPM_SCHED_READY_BITMAP == 1
+    rdy_reindex();
+#endif
+
     tfm_arch_init_context(p_thrd->p_context_ctrl, (uintptr_t)fn, param,
                           (uintptr_t)exit_fn);
 
@@ -106,6 +218,13 @@ void thrd_set_state(struct thread_t *p_thrd, uint32_t new_state)
 
     p_thrd->state = new_state;
 
+#if CONFIG_TFM_SPM_SCHED_READY_BITMAP == 1
+    if (new_state == THRD_STATE_RUNNABLE) {
+        thrd_set_ready(p_thrd);
+    } else if (new_state == THRD_STATE_BLOCK) {
+        thrd_clear_ready(p_thrd);
+    }
+#else
     /*
      * Set first runnable thread as head to reduce enumerate
      * depth while searching for a first runnable thread.
@@ -116,6 +235,7 @@ void thrd_set_state(struct thread_t *p_thrd, uint32_t new_state)
     } else {
         RNBL_HEAD = LIST_HEAD;
     }
+#endif
 }
 
 uint32_t thrd_start_scheduler(struct thread_t **ppth)
@@ -14,6 +14,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "config_tfm.h"
 #include "tfm_arch.h"
 
 /* State codes */
@@ -31,6 +32,9 @@
 #define THRD_PRIOR_LOW            0x7F
 #define THRD_PRIOR_LOWEST         0xFF
 
+/* Flags */
+#define THRD_FLAG_READY           (1U << 0)
+
 /* Error codes */
 #define THRD_SUCCESS              0
 #define THRD_ERR_GENERIC          1
@@ -46,6 +50,7 @@ struct thread_t {
     uint16_t               priority;          /* Priority                          */
     uint8_t                state;             /* State                             */
     uint16_t               flags;             /* Flags and align, DO NOT REMOVE!   */
+    uint16_t               rdy_idx;           /* Index in the ready bitmap         */
     struct context_ctrl_t *p_context_ctrl;    /* Context control (sp, splimit, lr) */
     struct thread_t       *next;              /* Next thread in list               */
 };
@@ -72,6 +77,7 @@ extern struct thread_t *p_curr_thrd;
                         (p_thrd)->priority       = (uint16_t)(prio);      \
                         (p_thrd)->state          = THRD_STATE_CREATING;  \
                         (p_thrd)->flags          = 0;                    \
+                        (p_thrd)->rdy_idx        = 0;                    \
                         (p_thrd)->p_context_ctrl = p_ctx_ctrl;           \
                     } while (0)
 
@@ -114,6 +120,35 @@ void thrd_set_query_callback(thrd_query_state_t fn);
  */
 void thrd_set_state(struct thread_t *p_thrd, uint32_t new_state);
 
+#if CONFIG_TFM_SPM_SCHED_READY_BITMAP == 1
+/*
+ * Mark the thread as ready in the ready bitmap. The thread is considered by
+ * the scheduler in the next selection.
+ *
+ * Parameters :
+ *  p_thrd         -     Pointer of thread_t struct
+ *
+ * Note :
+ *  - Caller must be in a critical section.
+ */
+void thrd_set_ready(struct thread_t *p_thrd);
+
+/*
+ * Remove the thread from the ready bitmap. The thread is skipped by the
+ * scheduler until it is marked ready again.
+ *
+ * Parameters :
+ *  p_thrd         -     Pointer of thread_t struct
+ *
+ * Note :
+ *  - Caller must be in a critical section.
+ */
+void thrd_clear_ready(struct thread_t *p_thrd);
+#else
+#define thrd_set_ready(p_thrd)          do { (void)(p_thrd); } while (0)
+#define thrd_clear_ready(p_thrd)        do { (void)(p_thrd); } while (0)
+#endif /* CONFIG_TFM_SPM_SCHED_READY_BITMAP == 1 */
+
 /*
  * Prepare thread context with given info and insert it into schedulable list.
  *
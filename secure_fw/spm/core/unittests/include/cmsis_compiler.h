@@ -0,0 +1,28 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __CMSIS_COMPILER_H
+#define __CMSIS_COMPILER_H
+
+#include <stdint.h>
+
+/* Host stand-in for the CMSIS compiler helpers used by the SPM core */
+
+#ifndef __aligned
+#define __aligned(x)        __attribute__((aligned(x)))
+#endif
+
+#ifndef __NO_RETURN
+#define __NO_RETURN         __attribute__((__noreturn__))
+#endif
+
+static inline uint8_t __CLZ(uint32_t value)
+{
+    return (value == 0U) ? 32U : (uint8_t)__builtin_clz(value);
+}
+
+#endif /* __CMSIS_COMPILER_H */
@@ -0,0 +1,16 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __CONFIG_IMPL_H__
+#define __CONFIG_IMPL_H__
+
+/* Host stand-in for the generated SPM implementation config */
+
+#define CONFIG_TFM_SPM_BACKEND_IPC                  1
+#define CONFIG_TFM_SPM_BACKEND_SFN                  0
+
+#endif /* __CONFIG_IMPL_H__ */
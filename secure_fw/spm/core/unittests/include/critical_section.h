@@ -0,0 +1,28 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_CRITICAL_SECTION_H__
+#define __TFM_CRITICAL_SECTION_H__
+
+/*
+ * Host stand-in for the SPM critical section. It is the same as the real one
+ * but picks the host tfm_arch.h next to it.
+ */
+
+#include <stdint.h>
+#include "tfm_arch.h"
+
+struct critical_section_t {
+    uint32_t   state;
+};
+
+#define CRITICAL_SECTION_STATIC_INIT   {.state = 0,}
+#define CRITICAL_SECTION_INIT(cs)      (cs).state = (0)
+#define CRITICAL_SECTION_ENTER(cs)     (cs).state = __save_disable_irq()
+#define CRITICAL_SECTION_LEAVE(cs)     __restore_irq((cs).state)
+
+#endif /* __TFM_CRITICAL_SECTION_H__ */
@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __CURRENT_H__
+#define __CURRENT_H__
+
+/*
+ * Host stand-in for the current component accessors. There is no thread
+ * context on the host, so the test suite sets the current partition directly,
+ * as the SFN backend does.
+ */
+
+#include "spm.h"
+
+extern struct partition_t *p_current_partition;
+/* Get current component */
+#define GET_CURRENT_COMPONENT()  p_current_partition
+/* Set current component */
+#define SET_CURRENT_COMPONENT(p) p_current_partition = p
+
+#endif /* __CURRENT_H__ */
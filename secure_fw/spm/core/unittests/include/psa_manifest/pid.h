@@ -0,0 +1,13 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __PSA_MANIFEST_PID_H__
+#define __PSA_MANIFEST_PID_H__
+
+/* Host stand-in for the generated partition ID header */
+
+#endif /* __PSA_MANIFEST_PID_H__ */
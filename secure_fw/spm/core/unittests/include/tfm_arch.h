@@ -0,0 +1,49 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_ARCH_H__
+#define __TFM_ARCH_H__
+
+/* Host stand-in for the architecture operations used by the SPM core */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include "cmsis_compiler.h"
+/* The architecture headers provide the SPM utilities to their users */
+#include "utilities.h"
+
+struct context_ctrl_t {
+    uint32_t                sp;
+    uint32_t                exc_ret;
+    uint32_t                sp_limit;
+    uint32_t                sp_base;
+};
+
+/* There are no interrupts to mask on the host */
+static inline uint32_t __save_disable_irq(void)
+{
+    return 0;
+}
+
+static inline void __restore_irq(uint32_t state)
+{
+    (void)state;
+}
+
+/* Provided by the test suite */
+void tfm_arch_set_context_ret_code(const struct context_ctrl_t *p_ctx_ctrl, uint32_t ret_code);
+
+void tfm_arch_init_context(struct context_ctrl_t *p_ctx_ctrl,
+                           uintptr_t pfn, void *param, uintptr_t pfnlr);
+
+uint32_t tfm_arch_refresh_hardware_context(const struct context_ctrl_t *p_ctx_ctrl);
+
+uint32_t arch_attempt_schedule(void);
+
+#endif /* __TFM_ARCH_H__ */
@@ -0,0 +1,13 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_PERIPHERALS_DEF_H__
+#define __TFM_PERIPHERALS_DEF_H__
+
+/* Host stand-in: no peripheral is used by the SPM core on the host */
+
+#endif /* __TFM_PERIPHERALS_DEF_H__ */
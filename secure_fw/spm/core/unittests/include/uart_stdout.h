@@ -0,0 +1,15 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UART_STDOUT_H__
+#define __UART_STDOUT_H__
+
+/* Host stand-in for the platform stdio */
+
+void stdio_uninit(void);
+
+#endif /* __UART_STDOUT_H__ */
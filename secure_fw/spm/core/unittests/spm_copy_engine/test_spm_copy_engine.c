@@ -0,0 +1,224 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "current.h"
+#include "spm.h"
+#include "ffm/psa_api.h"
+#include "tfm_hal_copy_engine.h"
+#include "tfm_hal_isolation.h"
+
+#define BUF_SIZE                128
+#define GUARD_VAL               0xEE
+
+/* Largest misalignment of either buffer covered by the width test */
+#define MAX_OFFSET              4
+
+/* Only psa_read() and psa_write() at least this large use the engine */
+#define ENGINE_SIZE             CONFIG_TFM_SPM_COPY_ENGINE_THRESHOLD
+#define CPU_SIZE                (CONFIG_TFM_SPM_COPY_ENGINE_THRESHOLD - 1)
+
+/* Word aligned so that offsets into them select the element width */
+static uint32_t src_words[BUF_SIZE / sizeof(uint32_t)];
+static uint32_t dst_words[BUF_SIZE / sizeof(uint32_t)];
+static uint8_t *const src = (uint8_t *)src_words;
+static uint8_t *const dst = (uint8_t *)dst_words;
+
+static struct partition_t partition;
+static struct connection_t connection;
+
+/* Number of copies left to the CPU */
+static uint32_t num_cpu_copies;
+
+/* Stubs of the SPM parts not under test */
+struct partition_t *p_current_partition;
+
+void tfm_core_panic(void)
+{
+    TEST_FAIL_MESSAGE("tfm_core_panic()");
+    abort();
+}
+
+struct connection_t *spm_msg_handle_to_connection(psa_handle_t msg_handle)
+{
+    return &connection;
+}
+
+FIH_RET_TYPE(psa_status_t) tfm_hal_memory_check(uintptr_t boundary,
+                                                uintptr_t base,
+                                                size_t size,
+                                                uint32_t access_type)
+{
+    FIH_RET(fih_int_encode(PSA_SUCCESS));
+}
+
+void *spm_memcpy(void *dest, const void *src, size_t n)
+{
+    num_cpu_copies++;
+
+    /* The test hands overlapping buffers to the CPU on purpose */
+    return memmove(dest, src, n);
+}
+
+static void fill_src(void)
+{
+    for (uint32_t i = 0; i < BUF_SIZE; i++) {
+        src[i] = (uint8_t)(i + 1);
+    }
+}
+
+/* Checks that dst holds size bytes of src at the given offsets, and that the
+ * bytes around them are untouched.
+ */
+static void assert_copied(size_t dst_off, size_t src_off, size_t size)
+{
+    for (size_t i = 0; i < BUF_SIZE; i++) {
+        if ((i >= dst_off) && (i < dst_off + size)) {
+            TEST_ASSERT_EQUAL_HEX8(src[src_off + i - dst_off], dst[i]);
+        } else {
+            TEST_ASSERT_EQUAL_HEX8(GUARD_VAL, dst[i]);
+        }
+    }
+}
+
+void setUp(void)
+{
+    fill_src();
+    memset(dst, GUARD_VAL, BUF_SIZE);
+
+    memset(&connection, 0, sizeof(connection));
+    connection.msg.type = PSA_IPC_CALL;
+
+    p_current_partition = &partition;
+    num_cpu_copies = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void test_copy_engine_should_copyWithEachElementWidth(void)
+{
+    /* Word, halfword and byte elements, depending on the buffers and size */
+    for (size_t dst_off = 0; dst_off < MAX_OFFSET; dst_off++) {
+        for (size_t src_off = 0; src_off < MAX_OFFSET; src_off++) {
+            for (size_t size = 1; size <= 24; size++) {
+                memset(dst, GUARD_VAL, BUF_SIZE);
+
+                TEST_ASSERT_EQUAL(TFM_HAL_SUCCESS,
+                                  tfm_hal_copy_engine_copy(&dst[dst_off],
+                                                           &src[src_off],
+                                                           size));
+                assert_copied(dst_off, src_off, size);
+            }
+        }
+    }
+}
+
+void test_copy_engine_should_copyInSeveralBlocks(void)
+{
+    /* Word, halfword and byte transfers several blocks long */
+    TEST_ASSERT_EQUAL(TFM_HAL_SUCCESS,
+                      tfm_hal_copy_engine_copy(dst, src, BUF_SIZE - 4));
+    assert_copied(0, 0, BUF_SIZE - 4);
+
+    memset(dst, GUARD_VAL, BUF_SIZE);
+    TEST_ASSERT_EQUAL(TFM_HAL_SUCCESS,
+                      tfm_hal_copy_engine_copy(&dst[2], src, BUF_SIZE - 6));
+    assert_copied(2, 0, BUF_SIZE - 6);
+
+    memset(dst, GUARD_VAL, BUF_SIZE);
+    TEST_ASSERT_EQUAL(TFM_HAL_SUCCESS,
+                      tfm_hal_copy_engine_copy(&dst[1], &src[2], BUF_SIZE - 3));
+    assert_copied(1, 2, BUF_SIZE - 3);
+}
+
+void test_copy_engine_should_refuseOverlappingBuffers(void)
+{
+    uint8_t expected[BUF_SIZE];
+
+    memcpy(expected, src, sizeof(expected));
+
+    TEST_ASSERT_EQUAL(TFM_HAL_ERROR_NOT_SUPPORTED,
+                      tfm_hal_copy_engine_copy(&src[8], src, 16));
+    TEST_ASSERT_EQUAL(TFM_HAL_ERROR_NOT_SUPPORTED,
+                      tfm_hal_copy_engine_copy(src, &src[15], 16));
+    TEST_ASSERT_EQUAL(TFM_HAL_ERROR_NOT_SUPPORTED,
+                      tfm_hal_copy_engine_copy(src, src, 16));
+
+    /* Nothing was moved */
+    TEST_ASSERT_EQUAL_MEMORY(expected, src, BUF_SIZE);
+
+    /* Adjacent buffers do not overlap */
+    TEST_ASSERT_EQUAL(TFM_HAL_SUCCESS,
+                      tfm_hal_copy_engine_copy(&src[16], src, 16));
+    TEST_ASSERT_EQUAL_MEMORY(src, &src[16], 16);
+}
+
+void test_copy_engine_should_checkArguments(void)
+{
+    TEST_ASSERT_EQUAL(TFM_HAL_SUCCESS, tfm_hal_copy_engine_copy(NULL, NULL, 0));
+    TEST_ASSERT_EQUAL(TFM_HAL_ERROR_INVALID_INPUT,
+                      tfm_hal_copy_engine_copy(NULL, src, 16));
+    TEST_ASSERT_EQUAL(TFM_HAL_ERROR_INVALID_INPUT,
+                      tfm_hal_copy_engine_copy(dst, NULL, 16));
+    TEST_ASSERT_EQUAL(TFM_HAL_ERROR_INVALID_INPUT,
+                      tfm_hal_copy_engine_copy((void *)(UINTPTR_MAX - 8), src, 16));
+}
+
+void test_psa_read_should_useCopyEngineFromThreshold(void)
+{
+    connection.invec_base[0] = &src[1];
+    connection.msg.in_size[0] = BUF_SIZE - 1;
+
+    TEST_ASSERT_EQUAL(ENGINE_SIZE,
+                      tfm_spm_partition_psa_read(0, 0, dst, ENGINE_SIZE));
+    TEST_ASSERT_EQUAL(CPU_SIZE,
+                      tfm_spm_partition_psa_read(0, 0, &dst[ENGINE_SIZE], CPU_SIZE));
+
+    /* Only the copy below the threshold was left to the CPU */
+    TEST_ASSERT_EQUAL(1, num_cpu_copies);
+    assert_copied(0, 1, ENGINE_SIZE + CPU_SIZE);
+}
+
+void test_psa_write_should_useCopyEngineFromThreshold(void)
+{
+    connection.outvec_base[0] = dst;
+    connection.msg.out_size[0] = BUF_SIZE;
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      tfm_spm_partition_psa_write(0, 0, src, ENGINE_SIZE + 3));
+    TEST_ASSERT_EQUAL(0, num_cpu_copies);
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      tfm_spm_partition_psa_write(0, 0, &src[ENGINE_SIZE + 3], 5));
+    TEST_ASSERT_EQUAL(1, num_cpu_copies);
+
+    assert_copied(0, 0, ENGINE_SIZE + 8);
+}
+
+void test_psa_write_should_fallBackToCpuWhenEngineRefuses(void)
+{
+    uint8_t expected[ENGINE_SIZE];
+
+    /* The client output vector overlaps the service buffer */
+    connection.outvec_base[0] = &src[4];
+    connection.msg.out_size[0] = BUF_SIZE - 4;
+    memcpy(expected, src, sizeof(expected));
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      tfm_spm_partition_psa_write(0, 0, src, ENGINE_SIZE));
+
+    TEST_ASSERT_EQUAL(1, num_cpu_copies);
+    TEST_ASSERT_EQUAL_MEMORY(expected, &src[4], ENGINE_SIZE);
+    TEST_ASSERT_EQUAL(ENGINE_SIZE, connection.outvec_written[0]);
+}
@@ -0,0 +1,39 @@
+#-------------------------------------------------------------------------------
+# SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+#-------------------------------------------------------------------------------
+
+# Define what is being unit tested and by what
+set(UNIT_UNDER_TEST
+    ${TFM_ROOT_DIR}/platform/ext/common/template/tfm_hal_copy_engine_sw.c
+    ${TFM_ROOT_DIR}/secure_fw/spm/core/psa_read_write_skip_api.c
+)
+set(UNIT_TEST_SUITE ${CMAKE_CURRENT_LIST_DIR}/test_spm_copy_engine.c)
+
+# Dependencies for the UUT, that get linked into the executable
+set(UNIT_TEST_DEPS)
+
+# Include directories for compilation
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/spm/core/unittests/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/spm/core)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/spm/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/spm/include/interface)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/interface/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/platform/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/config)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/tfm_log/inc)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/tfm_vprintf/inc)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/fih/inc)
+
+# Headers to be mocked
+
+# Compile-time definitions
+list(APPEND UNIT_TEST_COMPILE_DEFS LOG_LEVEL=LOG_LEVEL_NONE)
+list(APPEND UNIT_TEST_COMPILE_DEFS CONFIG_TFM_SPM_COPY_ENGINE_THRESHOLD=32)
+# Small blocks, so that a transfer spans several of them
+list(APPEND UNIT_TEST_COMPILE_DEFS TFM_HAL_COPY_ENGINE_SW_MAX_BLOCK_ELEMS=4)
+# CPU copies go through the counting stub of the test suite
+list(APPEND UNIT_TEST_COMPILE_DEFS spm_memcpy=spm_memcpy)
@@ -0,0 +1,302 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdlib.h>
+
+#include "unity.h"
+
+#include "current.h"
+#include "spm.h"
+#include "tfm_psa_call_pack.h"
+#include "ffm/psa_api.h"
+#include "tfm_hal_isolation.h"
+#include "tfm_nspm.h"
+#include "ffm/backend.h"
+#include "load/partition_defs.h"
+#include "load/service_defs.h"
+#include "load/spm_load_api.h"
+
+#define TEST_SID_A              0x40
+#define TEST_SID_B              0x41
+#define TEST_VERSION            1
+
+/* Number of psa_call() to a stateless service made in a row */
+#define STATELESS_CALLS         100
+
+/* A client partition load info followed by its extendable part and deps */
+static struct {
+    struct partition_load_info_t ldinf;
+    uintptr_t                    ext[LOAD_INFO_EXT_LENGTH];
+    uint32_t                     deps[2];
+} client_ldinf = {
+    .ldinf = {
+        .pid   = 256,
+        .ndeps = 2,
+    },
+    .deps = {TEST_SID_A, TEST_SID_B},
+};
+
+/* The partition providing both services */
+static const struct partition_load_info_t server_ldinf = {
+    .pid = 257,
+};
+
+static const struct service_load_info_t service_ldinf[2] = {
+    {
+        .sid     = TEST_SID_A,
+        .flags   = SERVICE_FLAG_STATELESS | SERVICE_VERSION_POLICY_RELAXED | 0,
+        .version = TEST_VERSION,
+    },
+    {
+        .sid     = TEST_SID_B,
+        .flags   = SERVICE_FLAG_STATELESS | SERVICE_VERSION_POLICY_RELAXED | 1,
+        .version = TEST_VERSION,
+    },
+};
+
+/* Defined by spm_ipc.c, filled by the loader on the target */
+extern struct service_t *stateless_services_ref_tbl[STATIC_HANDLE_NUM_LIMIT];
+
+static struct partition_t client_partition, server_partition;
+static struct service_t services[2];
+
+/* Stubs of the SPM parts not under test */
+struct partition_t *p_current_partition;
+struct partition_head_t partition_listhead;
+struct service_t *sorted_services_ref_tbl[1];
+const uint32_t sorted_sid_tbl_num = 0;
+
+void tfm_core_panic(void)
+{
+    TEST_FAIL_MESSAGE("tfm_core_panic()");
+    abort();
+}
+
+uint32_t sorted_sid_tbl_index(uint32_t sid)
+{
+    return sorted_sid_tbl_num;
+}
+
+struct partition_t *load_a_partition_assuredly(struct partition_head_t *head)
+{
+    return NO_MORE_PARTITION;
+}
+
+uint32_t load_services_assuredly(struct partition_t *p_partition,
+                                 struct service_t **stateless_services_ref_tbl,
+                                 size_t ref_tbl_size)
+{
+    return 0;
+}
+
+void load_irqs_assuredly(struct partition_t *p_partition)
+{
+}
+
+void backend_init_comp_assuredly(struct partition_t *p_pt,
+                                 uint32_t service_setting)
+{
+}
+
+uint32_t backend_system_run(void)
+{
+    return 0;
+}
+
+FIH_RET_TYPE(enum tfm_hal_status_t) tfm_hal_bind_boundary(
+                                    const struct partition_load_info_t *p_ldinf,
+                                    uintptr_t *p_boundary)
+{
+    FIH_RET(fih_int_encode(TFM_HAL_SUCCESS));
+}
+
+void tfm_nspm_ctx_init(void)
+{
+}
+
+int32_t tfm_nspm_get_current_client_id(void)
+{
+    return -1;
+}
+
+void stdio_uninit(void)
+{
+}
+
+psa_status_t backend_messaging(struct connection_t *p_connection)
+{
+    TEST_FAIL_MESSAGE("backend_messaging()");
+    return PSA_ERROR_PROGRAMMER_ERROR;
+}
+
+FIH_RET_TYPE(psa_status_t) tfm_hal_memory_check(uintptr_t boundary,
+                                                uintptr_t base,
+                                                size_t size,
+                                                uint32_t access_type)
+{
+    FIH_RET(fih_int_encode(PSA_SUCCESS));
+}
+
+static psa_handle_t static_handle(const struct service_t *service)
+{
+    return (psa_handle_t)((1UL << STATIC_HANDLE_INDICATOR_OFFSET) |
+                          (TEST_VERSION << STATIC_HANDLE_VER_OFFSET) |
+                          SERVICE_GET_STATELESS_HINDEX(service->p_ldinf->flags));
+}
+
+static struct connection_t *get_stateless_connection(struct service_t *service)
+{
+    struct connection_t *connection = NULL;
+
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      spm_get_idle_connection(&connection,
+                                              static_handle(service),
+                                              client_ldinf.ldinf.pid));
+    TEST_ASSERT_NOT_NULL(connection);
+    TEST_ASSERT_EQUAL_PTR(service, connection->service);
+
+    return connection;
+}
+
+void setUp(void)
+{
+    spm_init_connection_space();
+    spm_memset(stateless_services_ref_tbl, 0,
+               sizeof(stateless_services_ref_tbl));
+
+    client_partition.p_ldinf = &client_ldinf.ldinf;
+    server_partition.p_ldinf = &server_ldinf;
+    p_current_partition = &client_partition;
+
+    for (uint32_t i = 0; i < 2; i++) {
+        spm_memset(&services[i], 0, sizeof(services[i]));
+        services[i].p_ldinf = &service_ldinf[i];
+        services[i].partition = &server_partition;
+        stateless_services_ref_tbl[i] = &services[i];
+    }
+}
+
+void tearDown(void)
+{
+}
+
+void test_stateless_connection_reused(void)
+{
+    struct connection_t *first, *second;
+
+    first = get_stateless_connection(&services[0]);
+    spm_release_connection(first);
+    TEST_ASSERT_EQUAL_PTR(first, services[0].p_idle_conn);
+
+    /* The kept connection serves the next request */
+    second = get_stateless_connection(&services[0]);
+    TEST_ASSERT_EQUAL_PTR(first, second);
+    TEST_ASSERT_NULL(services[0].p_idle_conn);
+    TEST_ASSERT_EQUAL(TFM_HANDLE_STATUS_IDLE, second->status);
+    TEST_ASSERT_EQUAL(client_ldinf.ldinf.pid, second->msg.client_id);
+
+    spm_release_connection(second);
+}
+
+void test_kept_connection_not_a_message(void)
+{
+    struct connection_t *connection;
+
+    connection = get_stateless_connection(&services[0]);
+    spm_release_connection(connection);
+
+    /* A stale message handle must not reach the kept connection */
+    p_current_partition = &server_partition;
+    TEST_ASSERT_NULL(spm_msg_handle_to_connection(connection->msg.handle));
+}
+
+void test_kept_connection_refuses_connection_handle(void)
+{
+    struct connection_t *connection;
+    psa_handle_t conn_handle;
+
+    connection = get_stateless_connection(&services[0]);
+    spm_release_connection(connection);
+    TEST_ASSERT_EQUAL_PTR(connection, services[0].p_idle_conn);
+
+    /*
+     * The handle of a kept connection is derived from its place in the pool,
+     * so the last client can work it out. It must not reach the connection.
+     */
+    conn_handle = connection_to_handle(connection);
+    TEST_ASSERT_EQUAL(PSA_ERROR_PROGRAMMER_ERROR,
+                      tfm_spm_client_psa_call(conn_handle,
+                                              PARAM_PACK(PSA_IPC_CALL, 0, 0),
+                                              NULL, NULL));
+    TEST_ASSERT_EQUAL(PSA_ERROR_PROGRAMMER_ERROR,
+                      spm_psa_close_client_id_associated(conn_handle,
+                                                         client_ldinf.ldinf.pid));
+
+    /* The connection is still kept, and serves the next stateless call */
+    TEST_ASSERT_EQUAL_PTR(connection, services[0].p_idle_conn);
+    TEST_ASSERT_EQUAL_PTR(connection, get_stateless_connection(&services[0]));
+}
+
+void test_kept_connections_do_not_exhaust_pool(void)
+{
+    struct connection_t *kept[2], *conn[CONFIG_TFM_CONN_HANDLE_MAX_NUM];
+    uint32_t i;
+
+    /* Both stateless services keep a connection from the pool */
+    kept[0] = get_stateless_connection(&services[0]);
+    kept[1] = get_stateless_connection(&services[1]);
+    spm_release_connection(kept[0]);
+    spm_release_connection(kept[1]);
+
+    /*
+     * Any other user, such as psa_connect(), still gets the whole pool. The
+     * kept connections are taken back once the free ones run out.
+     */
+    for (i = 0; i < CONFIG_TFM_CONN_HANDLE_MAX_NUM; i++) {
+        conn[i] = spm_allocate_connection();
+        TEST_ASSERT_NOT_NULL(conn[i]);
+    }
+    TEST_ASSERT_NULL(services[0].p_idle_conn);
+    TEST_ASSERT_NULL(services[1].p_idle_conn);
+    TEST_ASSERT_NULL(spm_allocate_connection());
+
+    /* A stateless call gets a connection again once one is freed */
+    spm_free_connection(conn[0]);
+    get_stateless_connection(&services[0]);
+
+    for (i = 1; i < CONFIG_TFM_CONN_HANDLE_MAX_NUM; i++) {
+        spm_free_connection(conn[i]);
+    }
+}
+
+void test_stateless_calls_should_holdOneConnection(void)
+{
+    struct connection_t *first, *connection;
+    struct connection_t *conn[CONFIG_TFM_CONN_HANDLE_MAX_NUM];
+    uint32_t i;
+
+    first = get_stateless_connection(&services[0]);
+    spm_release_connection(first);
+
+    /* Repeated calls keep going through the same connection */
+    for (i = 0; i < STATELESS_CALLS; i++) {
+        connection = get_stateless_connection(&services[0]);
+        TEST_ASSERT_EQUAL_PTR(first, connection);
+        spm_release_connection(connection);
+    }
+
+    /* Every other connection is still free in the pool */
+    for (i = 0; i < CONFIG_TFM_CONN_HANDLE_MAX_NUM - 1; i++) {
+        conn[i] = spm_allocate_connection();
+        TEST_ASSERT_NOT_NULL(conn[i]);
+        TEST_ASSERT_EQUAL_PTR(first, services[0].p_idle_conn);
+    }
+
+    for (i = 0; i < CONFIG_TFM_CONN_HANDLE_MAX_NUM - 1; i++) {
+        spm_free_connection(conn[i]);
+    }
+}
@@ -0,0 +1,38 @@
+#-------------------------------------------------------------------------------
+# SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+#-------------------------------------------------------------------------------
+
+# Define what is being unit tested and by what
+set(UNIT_UNDER_TEST
+    ${TFM_ROOT_DIR}/secure_fw/spm/core/spm_ipc.c
+    ${TFM_ROOT_DIR}/secure_fw/spm/core/spm_connection_pool.c
+    ${TFM_ROOT_DIR}/secure_fw/spm/core/psa_call_api.c
+    ${TFM_ROOT_DIR}/secure_fw/spm/core/psa_connection_api.c
+)
+set(UNIT_TEST_SUITE ${CMAKE_CURRENT_LIST_DIR}/test_spm_stateless_conn.c)
+
+# Dependencies for the UUT, that get linked into the executable
+set(UNIT_TEST_DEPS ${TFM_ROOT_DIR}/secure_fw/spm/core/tfm_pools.c)
+
+# Include directories for compilation
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/spm/core/unittests/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/spm/core)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/spm/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/spm/include/interface)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/secure_fw/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/interface/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/platform/include)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/config)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/tfm_log/inc)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/tfm_vprintf/inc)
+list(APPEND UNIT_TEST_INCLUDE_DIRS ${TFM_ROOT_DIR}/lib/fih/inc)
+
+# Headers to be mocked
+
+# Compile-time definitions
+list(APPEND UNIT_TEST_COMPILE_DEFS LOG_LEVEL=LOG_LEVEL_NONE)
+list(APPEND UNIT_TEST_COMPILE_DEFS CONFIG_TFM_CONN_HANDLE_MAX_NUM=4)
+list(APPEND UNIT_TEST_COMPILE_DEFS CONFIG_TFM_CONNECTION_BASED_SERVICE_API=1)
@@ -0,0 +1,198 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "unity.h"
+
+#include "internal_status_code.h"
+#include "tfm_pools.h"
+
+/* Chunk size, in the range of a connection */
+#define CHUNK_SIZE      (72u)
+
+/* Pool sizes tested, the typical values of CONFIG_TFM_CONN_HANDLE_MAX_NUM */
+#define POOL_SMALL      (8u)
+#define POOL_MEDIUM     (32u)
+#define POOL_LARGE      (128u)
+
+/* Number of times the free half of each pool is allocated and freed */
+#define CHURN_ROUNDS    (100u)
+
+TFM_BITMAP_POOL_DECLARE(bitmap_small, CHUNK_SIZE, POOL_SMALL);
+TFM_BITMAP_POOL_DECLARE(bitmap_medium, CHUNK_SIZE, POOL_MEDIUM);
+TFM_BITMAP_POOL_DECLARE(bitmap_large, CHUNK_SIZE, POOL_LARGE);
+
+TFM_POOL_DECLARE(list_small, CHUNK_SIZE, POOL_SMALL);
+TFM_POOL_DECLARE(list_medium, CHUNK_SIZE, POOL_MEDIUM);
+TFM_POOL_DECLARE(list_large, CHUNK_SIZE, POOL_LARGE);
+
+static void *chunks[POOL_LARGE];
+
+void tfm_core_panic(void)
+{
+    TEST_FAIL_MESSAGE("tfm_core_panic");
+    for (;;) {
+    }
+}
+
+static void init_bitmap_pools(void)
+{
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      tfm_bitmap_pool_init(bitmap_small, BITMAP_POOL_BUFFER_SIZE(bitmap_small),
+                                           CHUNK_SIZE, POOL_SMALL));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      tfm_bitmap_pool_init(bitmap_medium, BITMAP_POOL_BUFFER_SIZE(bitmap_medium),
+                                           CHUNK_SIZE, POOL_MEDIUM));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      tfm_bitmap_pool_init(bitmap_large, BITMAP_POOL_BUFFER_SIZE(bitmap_large),
+                                           CHUNK_SIZE, POOL_LARGE));
+}
+
+static void init_list_pools(void)
+{
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      tfm_pool_init(list_small, POOL_BUFFER_SIZE(list_small),
+                                    CHUNK_SIZE, POOL_SMALL));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      tfm_pool_init(list_medium, POOL_BUFFER_SIZE(list_medium),
+                                    CHUNK_SIZE, POOL_MEDIUM));
+    TEST_ASSERT_EQUAL(PSA_SUCCESS,
+                      tfm_pool_init(list_large, POOL_BUFFER_SIZE(list_large),
+                                    CHUNK_SIZE, POOL_LARGE));
+}
+
+void setUp(void)
+{
+    init_bitmap_pools();
+    init_list_pools();
+}
+
+void tearDown(void)
+{
+}
+
+void test_tfm_bitmap_pool_init_should_rejectBadParameters(void)
+{
+    TEST_ASSERT_EQUAL(SPM_ERROR_BAD_PARAMETERS,
+                      tfm_bitmap_pool_init(NULL, BITMAP_POOL_BUFFER_SIZE(bitmap_small),
+                                           CHUNK_SIZE, POOL_SMALL));
+    TEST_ASSERT_EQUAL(SPM_ERROR_BAD_PARAMETERS,
+                      tfm_bitmap_pool_init(bitmap_small, BITMAP_POOL_BUFFER_SIZE(bitmap_small),
+                                           CHUNK_SIZE, 0));
+    TEST_ASSERT_EQUAL(SPM_ERROR_BAD_PARAMETERS,
+                      tfm_bitmap_pool_init(bitmap_small, BITMAP_POOL_BUFFER_SIZE(bitmap_small),
+                                           CHUNK_SIZE, POOL_SMALL + 1));
+}
+
+void test_tfm_bitmap_pool_alloc_should_returnEachChunkOnceInOrder(void)
+{
+    const size_t stride = TFM_BITMAP_POOL_STRIDE(CHUNK_SIZE);
+
+    for (uint32_t i = 0; i < POOL_LARGE; i++) {
+        chunks[i] = tfm_bitmap_pool_alloc(bitmap_large);
+
+        TEST_ASSERT_EQUAL_PTR(&bitmap_large_chunks[i * stride], chunks[i]);
+        TEST_ASSERT_EQUAL(0, (uintptr_t)chunks[i] % TFM_BITMAP_POOL_CHUNK_ALIGN);
+    }
+
+    TEST_ASSERT_NULL(tfm_bitmap_pool_alloc(bitmap_large));
+}
+
+void test_tfm_bitmap_pool_free_should_makeLowestChunkAvailable(void)
+{
+    for (uint32_t i = 0; i < POOL_MEDIUM; i++) {
+        chunks[i] = tfm_bitmap_pool_alloc(bitmap_medium);
+    }
+
+    tfm_bitmap_pool_free(bitmap_medium, chunks[17]);
+    tfm_bitmap_pool_free(bitmap_medium, chunks[5]);
+
+    TEST_ASSERT_EQUAL_PTR(chunks[5], tfm_bitmap_pool_alloc(bitmap_medium));
+    TEST_ASSERT_EQUAL_PTR(chunks[17], tfm_bitmap_pool_alloc(bitmap_medium));
+    TEST_ASSERT_NULL(tfm_bitmap_pool_alloc(bitmap_medium));
+}
+
+void test_is_valid_chunk_data_in_bitmap_pool_should_acceptOnlyAllocatedChunks(void)
+{
+    uint8_t *chunk = tfm_bitmap_pool_alloc(bitmap_small);
+    uint8_t *last = &bitmap_small_chunks[(POOL_SMALL - 1) * TFM_BITMAP_POOL_STRIDE(CHUNK_SIZE)];
+
+    TEST_ASSERT_TRUE(is_valid_chunk_data_in_bitmap_pool(bitmap_small, chunk));
+
+    /* Inside the pool but not at the start of a chunk */
+    TEST_ASSERT_FALSE(is_valid_chunk_data_in_bitmap_pool(bitmap_small, chunk + 4));
+
+    /* At the start of a chunk which is free */
+    TEST_ASSERT_FALSE(is_valid_chunk_data_in_bitmap_pool(bitmap_small, last));
+
+    /* Outside the pool on either side */
+    TEST_ASSERT_FALSE(is_valid_chunk_data_in_bitmap_pool(bitmap_small,
+                          (uint8_t *)((uintptr_t)bitmap_small_chunks -
+                                      TFM_BITMAP_POOL_STRIDE(CHUNK_SIZE))));
+    TEST_ASSERT_FALSE(is_valid_chunk_data_in_bitmap_pool(bitmap_small,
+                          last + TFM_BITMAP_POOL_STRIDE(CHUNK_SIZE)));
+
+    /* Not from this pool at all */
+    TEST_ASSERT_FALSE(is_valid_chunk_data_in_bitmap_pool(bitmap_medium, chunk));
+    TEST_ASSERT_FALSE(is_valid_chunk_data_in_bitmap_pool(NULL, chunk));
+
+    tfm_bitmap_pool_free(bitmap_small, chunk);
+
+    TEST_ASSERT_FALSE(is_valid_chunk_data_in_bitmap_pool(bitmap_small, chunk));
+}
+
+/*
+ * Connections are short lived, so the pool is kept half full and each round
+ * allocates the other half and frees it again. Every round must get a whole
+ * pool of distinct valid chunks, and leave the long lived half untouched.
+ */
+#define CHURN_POOL(num, alloc, free, valid, pool)                               \
+    do {                                                                        \
+        for (uint32_t i = 0; i < ((num) / 2u); i++) {                           \
+            chunks[i] = alloc(pool);                                            \
+            TEST_ASSERT_NOT_NULL(chunks[i]);                                    \
+        }                                                                       \
+                                                                                \
+        for (uint32_t round = 0; round < CHURN_ROUNDS; round++) {               \
+            for (uint32_t j = (num) / 2u; j < (num); j++) {                     \
+                chunks[j] = alloc(pool);                                        \
+                TEST_ASSERT_NOT_NULL(chunks[j]);                                \
+                for (uint32_t k = 0; k < j; k++) {                              \
+                    TEST_ASSERT_NOT_EQUAL(chunks[k], chunks[j]);                \
+                }                                                               \
+            }                                                                   \
+            TEST_ASSERT_NULL(alloc(pool));                                      \
+                                                                                \
+            for (uint32_t j = (num) / 2u; j < (num); j++) {                     \
+                TEST_ASSERT_TRUE(valid(pool, chunks[j]));                       \
+                free(pool, chunks[j]);                                          \
+            }                                                                   \
+        }                                                                       \
+                                                                                \
+        for (uint32_t i = 0; i < ((num) / 2u); i++) {                           \
+            TEST_ASSERT_TRUE(valid(pool, chunks[i]));                           \
+        }                                                                       \
+    } while (0)
+
+void test_tfm_pools_should_reuseChunksUnderChurn(void)
+{
+    CHURN_POOL(POOL_SMALL, tfm_pool_alloc, tfm_pool_free,
+               is_valid_chunk_data_in_pool, list_small);
+    CHURN_POOL(POOL_SMALL, tfm_bitmap_pool_alloc, tfm_bitmap_pool_free,
+               is_valid_chunk_data_in_bitmap_pool, bitmap_small);
+    CHURN_POOL(POOL_MEDIUM, tfm_pool_alloc, tfm_pool_free,
+               is_valid_chunk_data_in_pool, list_medium);
+    CHURN_POOL(POOL_MEDIUM, tfm_bitmap_pool_alloc, tfm_bitmap_pool_free,
+               is_valid_chunk_data_in_bitmap_pool, bitmap_medium);
+    CHURN_POOL(POOL_LARGE, tfm_pool_alloc, tfm_pool_free,
+               is_valid_chunk_data_in_pool, list_large);
+    CHURN_POOL(POOL_LARGE, tfm_bitmap_pool_alloc, tfm_bitmap_pool_free,
+               is_valid_chunk_data_in_bitmap_pool, bitmap_large);
+}
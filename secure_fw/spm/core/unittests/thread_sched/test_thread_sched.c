@@ -0,0 +1,232 @@
+/*
+ * SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "unity.h"
+
+#include "thread.h"
+
+/* More than one word of the ready bitmap, with the idle thread last */
+#define NUM_THREADS     (40u)
+#define IDLE_THREAD     (NUM_THREADS - 1u)
+
+static struct thread_t thrds[NUM_THREADS];
+static struct context_ctrl_t ctx_ctrls[NUM_THREADS];
+
+/* State reported to the scheduler for each thread */
+static uint32_t thrd_states[NUM_THREADS];
+static uint32_t thrd_retvals[NUM_THREADS];
+static uint32_t ret_codes[NUM_THREADS];
+static uint32_t query_count;
+static bool threads_started;
+
+static uint32_t thrd_index(const struct thread_t *p_thrd)
+{
+    return (uint32_t)(p_thrd - thrds);
+}
+
+static uint32_t query_state(const struct thread_t *p_thrd, uint32_t *p_retval)
+{
+    uint32_t idx = thrd_index(p_thrd);
+
+    query_count++;
+    *p_retval = thrd_retvals[idx];
+
+    return thrd_states[idx];
+}
+
+/* Mirrors how the backend signals a thread becoming runnable or blocked */
+static void make_runnable(uint32_t idx, uint32_t state)
+{
+    thrd_states[idx] = state;
+    thrd_set_ready(&thrds[idx]);
+}
+
+static void make_blocked(uint32_t idx)
+{
+    thrd_states[idx] = THRD_STATE_BLOCK;
+    thrd_clear_ready(&thrds[idx]);
+}
+
+/* The runnable thread with the highest priority, first started on a tie */
+static struct thread_t *expected_next(void)
+{
+    struct thread_t *p_best = NULL;
+
+    for (uint32_t i = 0; i < NUM_THREADS; i++) {
+        if ((thrd_states[i] == THRD_STATE_RUNNABLE) &&
+            ((p_best == NULL) || (thrds[i].priority <= p_best->priority))) {
+            p_best = &thrds[i];
+        }
+    }
+
+    return p_best;
+}
+
+void tfm_core_panic(void)
+{
+    TEST_FAIL_MESSAGE("tfm_core_panic");
+    for (;;) {
+    }
+}
+
+void tfm_arch_set_context_ret_code(const struct context_ctrl_t *p_ctx_ctrl, uint32_t ret_code)
+{
+    ret_codes[p_ctx_ctrl - ctx_ctrls] = ret_code;
+}
+
+void tfm_arch_init_context(struct context_ctrl_t *p_ctx_ctrl,
+                           uintptr_t pfn, void *param, uintptr_t pfnlr)
+{
+    (void)p_ctx_ctrl;
+    (void)pfn;
+    (void)param;
+    (void)pfnlr;
+}
+
+uint32_t tfm_arch_refresh_hardware_context(const struct context_ctrl_t *p_ctx_ctrl)
+{
+    (void)p_ctx_ctrl;
+
+    return 0;
+}
+
+uint32_t arch_attempt_schedule(void)
+{
+    return 0;
+}
+
+static void thread_entry(void *param)
+{
+    (void)param;
+}
+
+void setUp(void)
+{
+    uint32_t prio;
+
+    /* The thread list cannot be emptied, so it is only built once */
+    if (!threads_started) {
+        thrd_set_query_callback(query_state);
+
+        for (uint32_t i = 0; i < NUM_THREADS; i++) {
+            /* Spread the priorities so the start order is not the list order */
+            prio = (i == IDLE_THREAD) ? THRD_PRIOR_LOWEST : ((i * 7u) % 24u) + 1u;
+            THRD_INIT(&thrds[i], &ctx_ctrls[i], prio);
+            thrd_start(&thrds[i], thread_entry, NULL, NULL);
+        }
+        threads_started = true;
+    }
+
+    for (uint32_t i = 0; i < NUM_THREADS; i++) {
+        thrd_retvals[i] = 0;
+        ret_codes[i] = 0;
+        make_blocked(i);
+    }
+    query_count = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void test_thrd_next_should_returnNullWhenNothingRunnable(void)
+{
+    TEST_ASSERT_NULL(thrd_next());
+}
+
+void test_thrd_next_should_returnHighestPriorityRunnable(void)
+{
+    uint32_t seed = 0x12345678u;
+
+    make_runnable(IDLE_THREAD, THRD_STATE_RUNNABLE);
+
+    for (uint32_t iter = 0; iter < 1000u; iter++) {
+        /* Flip the state of a pseudo-random thread other than the idle one */
+        seed = (seed * 1103515245u) + 12345u;
+        uint32_t idx = (seed >> 16) % IDLE_THREAD;
+
+        if (thrd_states[idx] == THRD_STATE_RUNNABLE) {
+            make_blocked(idx);
+        } else {
+            make_runnable(idx, THRD_STATE_RUNNABLE);
+        }
+
+        TEST_ASSERT_EQUAL_PTR(expected_next(), thrd_next());
+    }
+}
+
+void test_thrd_next_should_skipThreadsWhichBlockedSinceSignalled(void)
+{
+    make_runnable(3, THRD_STATE_RUNNABLE);
+    make_runnable(IDLE_THREAD, THRD_STATE_RUNNABLE);
+
+    /* Signalled, but the signal was consumed before the thread ran */
+    make_runnable(5, THRD_STATE_BLOCK);
+
+    TEST_ASSERT_EQUAL_PTR(&thrds[3], thrd_next());
+
+    make_blocked(3);
+
+    TEST_ASSERT_EQUAL_PTR(&thrds[IDLE_THREAD], thrd_next());
+
+#if CONFIG_TFM_SPM_SCHED_READY_BITMAP == 1
+    /* The stale candidate is dropped once it has been found blocked */
+    query_count = 0;
+    TEST_ASSERT_EQUAL_PTR(&thrds[IDLE_THREAD], thrd_next());
+    TEST_ASSERT_EQUAL(1, query_count);
+#endif
+}
+
+void test_thrd_next_should_setReturnValueOfWokenThread(void)
+{
+    thrd_retvals[8] = 0x5A5A;
+    make_runnable(8, THRD_STATE_RET_VAL_AVAIL);
+    make_runnable(IDLE_THREAD, THRD_STATE_RUNNABLE);
+
+    TEST_ASSERT_EQUAL_PTR(&thrds[8], thrd_next());
+    TEST_ASSERT_EQUAL_HEX32(0x5A5A, ret_codes[8]);
+    TEST_ASSERT_EQUAL(THRD_STATE_RUNNABLE, thrds[8].state);
+}
+
+void test_thrd_next_should_queryFewThreadsPerSchedule(void)
+{
+    static const uint32_t num_runnable[] = {1, 2, 8, NUM_THREADS / 2u};
+    uint32_t prio, n;
+
+    for (uint32_t i = 0; i < (sizeof(num_runnable) / sizeof(num_runnable[0])); i++) {
+        /* Only the idle thread and the lowest priority threads are runnable,
+         * the usual case for a system waiting on the NSPE.
+         */
+        make_runnable(IDLE_THREAD, THRD_STATE_RUNNABLE);
+        n = 1;
+        for (prio = THRD_PRIOR_LOWEST - 1u; (n < num_runnable[i]) && (prio > 0u); prio--) {
+            for (uint32_t idx = 0; (n < num_runnable[i]) && (idx < IDLE_THREAD); idx++) {
+                if (thrds[idx].priority == prio) {
+                    make_runnable(idx, THRD_STATE_RUNNABLE);
+                    n++;
+                }
+            }
+        }
+
+        query_count = 0;
+        TEST_ASSERT_EQUAL_PTR(expected_next(), thrd_next());
+
+#if CONFIG_TFM_SPM_SCHED_READY_BITMAP == 1
+        /* Only the chosen thread is asked for its state */
+        TEST_ASSERT_EQUAL(1, query_count);
+#else
+        /* Every thread is asked at most once */
+        TEST_ASSERT_LESS_OR_EQUAL(NUM_THREADS, query_count);
+#endif
+
+        setUp();
+    }
+}
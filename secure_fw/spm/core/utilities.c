@@ -12,9 +12,9 @@
 #include "fih.h"
 #include "utilities.h"
 #include "tfm_hal_platform.h"
+#include "tfm_log.h"
 
 #ifdef CONFIG_TFM_BACKTRACE_ON_CORE_PANIC
-#include "tfm_log.h"
 #include "backtrace.h"
 #endif
 
@@ -24,6 +24,8 @@ void tfm_core_panic(void)
 #ifdef CONFIG_TFM_BACKTRACE_ON_CORE_PANIC
     tfm_dump_backtrace(__func__, tfm_log);
 #endif
+    /* Buffered log output would be lost across a halt or reset */
+    tfm_log_flush();
 
 /* Suppress Pe111 (statement is unreachable) and Pe128 (loop is unreachable) for
  * IAR as redundant code is needed for FIH
@@ -138,4 +138,39 @@ struct bi_list_node_t {
          node != NULL;                                       \
          pnode = &(node)->link, node = (node)->link)
 
+/********* Uni-directional FIFO queue operations ********/
+/*
+ * A queue is a uni-directional list tracked by 'head' (oldest) and 'tail'
+ * (newest) pointers, which gives constant time enqueue and dequeue.
+ */
+
+/* Initialize an empty queue. */
+#define UNI_QUEUE_INIT(head, tail) do {                     \
+    (head) = NULL;                                          \
+    (tail) = NULL;                                          \
+} while (0)
+
+/* Append a node at the tail of the queue. */
+#define UNI_QUEUE_PUSH_TAIL(head, tail, node, link) do {    \
+    (node)->link = NULL;                                    \
+    if ((tail) != NULL) {                                   \
+        (tail)->link = (node);                              \
+    } else {                                                \
+        (head) = (node);                                    \
+    }                                                       \
+    (tail) = (node);                                        \
+} while (0)
+
+/* Take the head node out of the queue, 'node' is NULL if the queue is empty. */
+#define UNI_QUEUE_POP_HEAD(head, tail, node, link) do {     \
+    (node) = (head);                                        \
+    if ((node) != NULL) {                                   \
+        (head) = (node)->link;                              \
+        if ((head) == NULL) {                               \
+            (tail) = NULL;                                  \
+        }                                                   \
+        (node)->link = NULL;                                \
+    }                                                       \
+} while (0)
+
 #endif /* __LISTS_H__ */
@@ -52,11 +52,14 @@ struct partition_head_t {
     struct partition_t *next;           /* Next partition node  */
 };
 
-/* Runtime service struct list head node type */
-struct service_head_t {
-    uint32_t reserved;                  /* Reserved             */
-    struct service_t *next;             /* Next service node    */
-};
+/*
+ * Sorted SID table generated by the manifest tool. A loaded service is bound
+ * to the entry of 'sorted_services_ref_tbl' at the index of its SID in
+ * 'sorted_sid_tbl'.
+ */
+extern const uint32_t sorted_sid_tbl[];
+extern struct service_t *sorted_services_ref_tbl[];
+extern const uint32_t sorted_sid_tbl_num;
 
 /*
  * Load a partition object to linked list and return if a load is successful.
@@ -67,7 +70,15 @@ struct service_head_t {
 struct partition_t *load_a_partition_assuredly(struct partition_head_t *head);
 
 /*
- * Load numbers of service objects to linked list based on given partition.
+ * Binary search the SID in the sorted SID table.
+ * Return the index of the SID, or 'sorted_sid_tbl_num' if the SID is not in
+ * the table.
+ */
+uint32_t sorted_sid_tbl_index(uint32_t sid);
+
+/*
+ * Load numbers of service objects to the sorted SID table based on given
+ * partition.
  * It loads connection based services and stateless services that partition
  * contains.
  * As an 'assuredly' function, errors simply panic the system and never
@@ -76,7 +87,6 @@ struct partition_t *load_a_partition_assuredly(struct partition_head_t *head);
  * ZERO if services are not represented by signals.
  */
 uint32_t load_services_assuredly(struct partition_t *p_partition,
-                                 struct service_head_t *services_listhead,
                                  struct service_t **stateless_services_ref_tbl,
                                  size_t ref_tbl_size);
 
@@ -0,0 +1,292 @@
+#-------------------------------------------------------------------------------
+# SPDX-FileCopyrightText: Copyright The TrustedFirmware-M Contributors
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+#-------------------------------------------------------------------------------
+
+"""
+Decodes log output of an image built with TFM_LOG_TOKENIZED.
+
+Each tokenized record is a line of the form "$<base64>". The record holds the
+address of the format string in the .tfm_log_fmt section of the ELF and the
+argument descriptor, both as LEB128 varints, followed by the arguments: integers
+as varints and strings as a one byte length and the characters. The format
+string is read back from the ELF, checked against the descriptor and rendered
+the same way tfm_vprintf() would have on the target. Anything else in the log
+is passed through unchanged.
+
+Usage: tfm_log_decode.py --elf tfm_s.elf [log file]
+"""
+
+import argparse
+import base64
+import binascii
+import logging
+import re
+import struct
+import sys
+
+FMT_SECTION = '.tfm_log_fmt'
+
+# A record is always a whole line, so plain text holding a '$' is left alone
+RECORD_RE = re.compile(r'^\$([A-Za-z0-9+/]+={0,2})\r?$')
+
+LOG_RAW_VALUE = 60
+LOG_PREFIXES = {
+    10: '[ERR]',
+    20: '[NOT]',
+    30: '[WRN]',
+    40: '[INF]',
+    50: '[VER]',
+}
+
+def read_elf_section(path, name):
+    """
+    Returns the address and contents of the named section of an ELF file.
+    """
+    with open(path, 'rb') as f:
+        elf = f.read()
+
+    if elf[:4] != b'\x7fELF':
+        raise ValueError('{} is not an ELF file'.format(path))
+
+    is_64 = elf[4] == 2
+    endian = '<' if elf[5] == 1 else '>'
+
+    if is_64:
+        shoff, = struct.unpack_from(endian + 'Q', elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + 'HHH', elf, 0x3A)
+        shdr_fmt = endian + 'IIQQQQIIQQ'
+    else:
+        shoff, = struct.unpack_from(endian + 'I', elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + 'HHH', elf, 0x2E)
+        shdr_fmt = endian + 'IIIIIIIIII'
+
+    headers = [struct.unpack_from(shdr_fmt, elf, shoff + (i * shentsize))
+               for i in range(shnum)]
+
+    strtab = headers[shstrndx]
+    names = elf[strtab[4]:strtab[4] + strtab[5]]
+
+    for sh_name, sh_type, _, sh_addr, sh_offset, sh_size, *_ in headers:
+        if names[sh_name:names.index(b'\0', sh_name)].decode() == name:
+            return sh_addr, elf[sh_offset:sh_offset + sh_size]
+
+    raise ValueError('{} has no {} section. Was it built with TFM_LOG_TOKENIZED?'
+                     .format(path, name))
+
+class Record:
+    """
+    Reads the fields of a decoded record.
+    """
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def varint(self):
+        val = 0
+        shift = 0
+
+        while True:
+            if self.pos >= len(self.data):
+                return None
+            byte = self.data[self.pos]
+            self.pos += 1
+            val |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return val & 0xFFFFFFFF
+
+    def string(self):
+        if self.pos >= len(self.data):
+            return None
+        length = self.data[self.pos]
+        val = self.data[self.pos + 1:self.pos + 1 + length]
+        self.pos += 1 + length
+        return val.decode('utf-8', errors='replace')
+
+def pad(text, width, left_aligned, pad_char):
+    if left_aligned:
+        return text.ljust(width, pad_char)
+    return text.rjust(width, pad_char)
+
+def conversions(fmt):
+    """
+    Splits a format string the same way as tfm_vprintf(). Yields each literal
+    character as a string, and each conversion as a tuple of the conversion
+    character, width, left alignment and zero padding.
+    """
+    i = 0
+
+    while i < len(fmt):
+        c = fmt[i]
+        i += 1
+
+        if c != '%':
+            yield c
+            continue
+
+        width = 0
+        zero_padding = False
+        left_aligned = False
+
+        while i < len(fmt):
+            c = fmt[i]
+            i += 1
+
+            if c in 'lz':
+                continue
+            if c == '-':
+                left_aligned = True
+                continue
+            if c == '0' and width == 0:
+                zero_padding = True
+                continue
+            if c.isdigit():
+                width = (width * 10) + int(c)
+                continue
+            break
+
+        yield c, width, left_aligned, zero_padding
+
+def arg_desc(fmt):
+    """
+    Returns the argument descriptor a call with this format string should have:
+    the number of arguments in bits [3:0] and a bit from bit 4 for each string.
+    """
+    num_args = 0
+    str_mask = 0
+
+    for conv in conversions(fmt):
+        if isinstance(conv, tuple) and conv[0] in 'sudixX':
+            if conv[0] == 's':
+                str_mask |= 1 << num_args
+            num_args += 1
+
+    return num_args | (str_mask << 4)
+
+def render(fmt, record):
+    """
+    Renders a format string the same way as tfm_vprintf().
+    """
+    out = []
+
+    for conv in conversions(fmt):
+        if not isinstance(conv, tuple):
+            out.append(conv)
+            continue
+
+        c, width, left_aligned, zero_padding = conv
+        pad_char = '0' if zero_padding else ' '
+
+        if c == '%':
+            out.append('%')
+        elif c == 's':
+            val = record.string()
+            out.append(pad('<missing>' if val is None else val, width, left_aligned, ' '))
+        elif c in 'udixX':
+            val = record.varint()
+            if val is None:
+                out.append('<missing>')
+                continue
+
+            sign = ''
+            if c in 'di' and val & 0x80000000:
+                val = 0x100000000 - val
+                sign = '-'
+
+            if c in 'xX':
+                digits = '{:x}'.format(val) if c == 'x' else '{:X}'.format(val)
+            else:
+                digits = str(val)
+
+            # The target puts the sign before zero padding, and pads the digits
+            if zero_padding and sign:
+                out.append(sign + pad(digits, width, left_aligned, pad_char))
+            else:
+                out.append(pad(sign + digits, width, left_aligned, pad_char))
+        else:
+            out.append('[Unsupported]')
+
+    return ''.join(out)
+
+class Decoder:
+    def __init__(self, elf_path):
+        self.base, self.strings = read_elf_section(elf_path, FMT_SECTION)
+
+    def format_string(self, token):
+        offset = token - self.base
+        if offset < 0 or offset >= len(self.strings):
+            return None
+        end = self.strings.index(b'\0', offset)
+        return self.strings[offset:end].decode('utf-8', errors='replace')
+
+    def decode_record(self, data):
+        record = Record(data)
+        token = record.varint()
+        desc = record.varint()
+        fmt = self.format_string(token) if token is not None else None
+
+        if not fmt:
+            return '[Unknown log token {}]\n'.format(token)
+
+        # The descriptor is picked from the argument types on the target, so a
+        # mismatch means the arguments cannot be read back reliably
+        if desc != arg_desc(fmt[1:]):
+            return '[Log arguments of token {} do not match "{}"]\n'.format(
+                token, fmt[1:].rstrip('\n'))
+
+        marker = ord(fmt[0])
+        if marker == LOG_RAW_VALUE:
+            prefix = ''
+        elif marker in LOG_PREFIXES:
+            prefix = LOG_PREFIXES[marker] + ' '
+        else:
+            return '[Bad log marker {} for token {}]\n'.format(marker, token)
+
+        return prefix + render(fmt[1:], record)
+
+    def decode_line(self, line):
+        line = line.rstrip('\r\n')
+        decoded = line
+
+        match = RECORD_RE.match(line)
+        if match:
+            try:
+                decoded = self.decode_record(
+                    base64.b64decode(match.group(1), validate=True))
+            except binascii.Error:
+                pass
+
+        if not decoded.endswith('\n'):
+            decoded += '\n'
+        return decoded
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='Decode tokenized TF-M log output')
+    parser.add_argument('--elf',
+                        required=True,
+                        help='ELF of the image that produced the log')
+    parser.add_argument('log',
+                        nargs='?',
+                        type=argparse.FileType('r', errors='replace'),
+                        default=sys.stdin,
+                        help='Log to decode, read from stdin if not given')
+    return parser.parse_args()
+
+def main():
+    args = parse_args()
+
+    try:
+        decoder = Decoder(args.elf)
+    except (OSError, ValueError) as e:
+        logging.error(str(e))
+        sys.exit(1)
+
+    for line in args.log:
+        sys.stdout.write(decoder.decode_line(line))
+        sys.stdout.flush()
+
+if __name__ == '__main__':
+    main()
@@ -638,6 +638,7 @@ def process_partition_manifests(manifest_lists, configs):
     context['partitions'] = partition_list
     context['config_impl'] = config_impl
     context['stateless_services'] = process_stateless_services(partition_list)
+    context['sorted_services'] = process_sorted_services(partition_list)
 
     return context
 
@@ -728,6 +729,20 @@ def gen_summary_files(context, gen_file_lists):
         outfile.write(template.render(context))
         outfile.close()
 
+def process_sorted_services(partitions):
+    """
+    This function collects all services together and sorts them in ascending
+    order of their SIDs. SPM looks up a service by binary searching the
+    generated SID table instead of walking all the services.
+    """
+
+    collected_services = []
+
+    for partition in partitions:
+        collected_services.extend(partition['manifest'].get('services', []))
+
+    return sorted(collected_services, key=lambda srv: int(str(srv['sid']), 0))
+
 def process_stateless_services(partitions):
     """
     This function collects all stateless services together, and allocates